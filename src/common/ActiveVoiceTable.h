@@ -0,0 +1,206 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+#ifndef SURGE_SRC_COMMON_ACTIVEVOICETABLE_H
+#define SURGE_SRC_COMMON_ACTIVEVOICETABLE_H
+
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include "SurgeVoice.h"
+
+/*
+ * The voices playing in a scene. The voices themselves live in
+ * SurgeSynthesizer::voices_array; this is a fixed capacity table of pointers to the ones in
+ * use, in the order they were started, which has the iteration and front/back/size/empty
+ * API the std::list it replaces had so the voice loops read the same.
+ *
+ * Alongside the pointers we keep each voice's host note id in a contiguous array, so the
+ * "does any other voice still play this note id" questions which note-off and freeVoice ask
+ * scan a few dozen ints rather than chasing every voice, and an index from (channel, key) to
+ * a bitmask of positions, so note-off and choke go straight to the voices playing that note.
+ * Both are copied when the voice is added, so if you change a voice's host_note_id, key or
+ * channel after that (legato, reclaiming a voice) call updateNote.
+ *
+ * Erase keeps the remaining voices in order rather than swapping the last one into the hole,
+ * since voice stealing, polyphony enforcement and the mono modes all rely on oldest-first.
+ * At MAX_VOICES entries that is a short move, plus moving the shifted voices' index bits.
+ */
+class ActiveVoiceTable
+{
+  public:
+    typedef SurgeVoice **iterator;
+    typedef SurgeVoice *const *const_iterator;
+
+    iterator begin() { return voices.data(); }
+    iterator end() { return voices.data() + count; }
+    const_iterator begin() const { return voices.data(); }
+    const_iterator end() const { return voices.data() + count; }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    SurgeVoice *front() const
+    {
+        assert(count > 0);
+        return voices[0];
+    }
+    SurgeVoice *back() const
+    {
+        assert(count > 0);
+        return voices[count - 1];
+    }
+
+    // The voice has to be fully constructed, since we read its host note id and key here
+    void push_back(SurgeVoice *v)
+    {
+        assert(count < MAX_VOICES);
+        voices[count] = v;
+        hostNoteIds[count] = v->host_note_id;
+        noteSlots[count] = noteSlot(v->state.channel, v->state.key);
+        noteMasks[noteSlots[count]] |= bit(count);
+        count++;
+    }
+
+    iterator erase(iterator it)
+    {
+        size_t idx = it - begin();
+        assert(idx < count);
+
+        noteMasks[noteSlots[idx]] &= ~bit(idx);
+
+        for (size_t i = idx + 1; i < count; ++i)
+        {
+            voices[i - 1] = voices[i];
+            hostNoteIds[i - 1] = hostNoteIds[i];
+            noteSlots[i - 1] = noteSlots[i];
+
+            auto &m = noteMasks[noteSlots[i]];
+            m = (m & ~bit(i)) | bit(i - 1);
+        }
+
+        count--;
+        return begin() + idx;
+    }
+
+    iterator find(const SurgeVoice *v)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (voices[i] == v)
+            {
+                return begin() + i;
+            }
+        }
+
+        return end();
+    }
+
+    bool contains(const SurgeVoice *v) const
+    {
+        return const_cast<ActiveVoiceTable *>(this)->find(v) != end();
+    }
+
+    void remove(const SurgeVoice *v)
+    {
+        auto it = find(v);
+
+        if (it != end())
+        {
+            erase(it);
+        }
+    }
+
+    void clear()
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            noteMasks[noteSlots[i]] = 0;
+        }
+
+        count = 0;
+    }
+
+    // Refresh our copies of the voice's host note id, key and channel
+    void updateNote(const SurgeVoice *v)
+    {
+        auto it = find(v);
+
+        if (it != end())
+        {
+            size_t idx = it - begin();
+
+            hostNoteIds[idx] = v->host_note_id;
+            noteMasks[noteSlots[idx]] &= ~bit(idx);
+            noteSlots[idx] = noteSlot(v->state.channel, v->state.key);
+            noteMasks[noteSlots[idx]] |= bit(idx);
+        }
+    }
+
+    int countWithHostNoteId(int32_t id) const
+    {
+        int res = 0;
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            res += (hostNoteIds[i] == id);
+        }
+
+        return res;
+    }
+
+    /*
+     * Calls f on each voice whose channel and key match, oldest first. f may change the voices
+     * but must not add or remove them.
+     */
+    template <typename F> void forEachWithNote(int channel, int key, F &&f) const
+    {
+        auto m = noteMasks[noteSlot(channel, key)];
+
+        for (size_t i = 0; m; ++i, m >>= 1)
+        {
+            // the slot folds out of range channels and keys in, so check the voice itself
+            if ((m & 1) && voices[i]->state.channel == channel && voices[i]->state.key == key)
+            {
+                f(voices[i]);
+            }
+        }
+    }
+
+  private:
+    static_assert(MAX_VOICES <= 64, "The note index holds voice positions in a uint64_t");
+
+    static constexpr int noteChannels{16}, noteKeys{128};
+
+    static uint64_t bit(size_t i) { return (uint64_t)1 << i; }
+    static uint16_t noteSlot(int channel, int key)
+    {
+        return (uint16_t)((channel & (noteChannels - 1)) * noteKeys + (key & (noteKeys - 1)));
+    }
+
+    std::array<SurgeVoice *, MAX_VOICES> voices{};
+    std::array<int32_t, MAX_VOICES> hostNoteIds{};
+    std::array<uint16_t, MAX_VOICES> noteSlots{};
+    std::array<uint64_t, noteChannels * noteKeys> noteMasks{};
+    size_t count{0};
+};
+
+#endif // SURGE_SRC_COMMON_ACTIVEVOICETABLE_H
@@ -199,6 +199,63 @@ bool Surge::LuaSupport::loadSurgePrelude(lua_State *s)
 
 std::string Surge::LuaSupport::getSurgePrelude() { return LuaSources::surge_prelude; }
 
+lua_State *Surge::LuaSupport::openSurgeState()
+{
+#if HAS_LUA
+    auto L = lua_open();
+    luaL_openlibs(L);
+    loadSurgePrelude(L);
+    return L;
+#else
+    return nullptr;
+#endif
+}
+
+Surge::LuaSupport::StatePool::~StatePool()
+{
+#if HAS_LUA
+    for (auto L : all)
+        lua_close(L);
+#endif
+}
+
+Surge::LuaSupport::StatePool::Lease Surge::LuaSupport::StatePool::lease()
+{
+    {
+        std::lock_guard<std::mutex> g(mutex);
+        if (!idle.empty())
+        {
+            auto L = idle.back();
+            idle.pop_back();
+            return Lease(this, L);
+        }
+    }
+
+    // opening a state loads the prelude, so do it outside the lock
+    auto L = openSurgeState();
+    if (L)
+    {
+        std::lock_guard<std::mutex> g(mutex);
+        all.push_back(L);
+    }
+    return Lease(this, L);
+}
+
+size_t Surge::LuaSupport::StatePool::statesCreated()
+{
+    std::lock_guard<std::mutex> g(mutex);
+    return all.size();
+}
+
+Surge::LuaSupport::StatePool::Lease::~Lease()
+{
+    if (pool && L)
+    {
+        std::lock_guard<std::mutex> g(pool->mutex);
+        pool->idle.push_back(L);
+    }
+}
+
 Surge::LuaSupport::SGLD::~SGLD()
 {
     if (L)
@@ -29,6 +29,7 @@
 #ifndef SURGE_SRC_COMMON_LUASUPPORT_H
 #define SURGE_SRC_COMMON_LUASUPPORT_H
 
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -95,6 +96,47 @@ bool loadSurgePrelude(lua_State *s);
  */
 std::string getSurgePrelude();
 
+/*
+ * Open a new lua state with the standard libraries and the surge prelude loaded,
+ * which is the environment all of our lua functions expect. Returns nullptr
+ * without lua.
+ */
+lua_State *openSurgeState();
+
+/*
+ * A lua state can only be used by one thread at a time, so code which may run lua
+ * from several threads at once leases states from one of these. Every state is
+ * made by openSurgeState so they are interchangeable, and a thread holds its
+ * state (and anything it compiled into it) until the lease goes away. States are
+ * kept for reuse and closed with the pool.
+ */
+struct StatePool
+{
+    StatePool() = default;
+    ~StatePool();
+    StatePool(const StatePool &) = delete;
+    StatePool &operator=(const StatePool &) = delete;
+
+    struct Lease
+    {
+        Lease(StatePool *p, lua_State *L) : pool(p), L(L) {}
+        Lease(Lease &&o) noexcept : pool(o.pool), L(o.L) { o.L = nullptr; }
+        Lease(const Lease &) = delete;
+        Lease &operator=(const Lease &) = delete;
+        ~Lease();
+
+        StatePool *pool;
+        lua_State *L;
+    };
+
+    Lease lease();
+    size_t statesCreated();
+
+  private:
+    std::mutex mutex;
+    std::vector<lua_State *> all, idle;
+};
+
 /*
  * A little leak debugger. Make this on your stack and if you exit the
  * block with a different stack than you start, it complains for you
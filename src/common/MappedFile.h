@@ -0,0 +1,62 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+#ifndef SURGE_SRC_COMMON_MAPPEDFILE_H
+#define SURGE_SRC_COMMON_MAPPEDFILE_H
+
+#include "filesystem/import.h"
+
+#include <cstddef>
+
+namespace Surge
+{
+namespace Storage
+{
+/*
+ * A read only memory mapping of a whole file, which lives as long as this object does. If the
+ * file can't be opened or mapped (or is empty), data() is nullptr and callers should fall back
+ * to reading the file normally.
+ */
+struct MappedFile
+{
+    explicit MappedFile(const fs::path &path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    const char *data() const { return mapped; }
+    size_t size() const { return mappedSize; }
+
+  private:
+    const char *mapped{nullptr};
+    size_t mappedSize{0};
+
+#if WINDOWS
+    void *fileHandle{nullptr};
+    void *mappingHandle{nullptr};
+#endif
+};
+} // namespace Storage
+} // namespace Surge
+
+#endif // SURGE_SRC_COMMON_MAPPEDFILE_H
@@ -23,43 +23,66 @@
 #ifndef SURGE_SRC_COMMON_MEMORYPOOL_H
 #define SURGE_SRC_COMMON_MEMORYPOOL_H
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <functional>
+
 namespace Surge
 {
 namespace Memory
 {
-// pre-alloc must be at least one
-template <typename T, size_t preAlloc, size_t growBy, size_t capacity = 16384> struct MemoryPool
+/*
+ * A pool of pre-constructed items for the audio thread, which is the only thread that calls
+ * getItem and returnItem. When the free items fall below lowWater, the pool asks for more
+ * through wakeGrower, and whichever thread owns the pool calls growInBackground to construct
+ * them. The new items are published through a single producer / single consumer ring, which
+ * getItem drains without locking. Only if that hasn't kept up does getItem construct items on
+ * the audio thread, and each time it does emergencyAllocations is bumped.
+ *
+ * pre-alloc must be at least one
+ */
+template <typename T, size_t preAlloc, size_t growBy, size_t capacity = 16384,
+          size_t lowWater = growBy>
+struct MemoryPool
 {
     template <typename... Args> MemoryPool(Args &&...args)
     {
         while (position < preAlloc)
             refreshPool(std::forward<Args>(args)...);
+        publishLevel();
     }
     ~MemoryPool()
     {
         for (size_t i = 0; i < position; ++i)
             delete pool[i];
+        for (auto i = grownTail.load(); i != grownHead.load(); ++i)
+            delete grown[i % grownCapacity];
     }
     template <typename... Args> T *getItem(Args &&...args)
     {
+        collectGrownItems();
         if (position == 0)
         {
+            emergencyAllocations++;
             refreshPool(std::forward<Args>(args)...);
         }
         auto q = pool[position - 1];
         pool[position - 1] = nullptr; // just to flag bugs
         position--;
+        publishLevel();
         return q;
     }
     void returnItem(T *t)
     {
         pool[position] = t;
         position++;
+        publishLevel();
     }
     template <typename... Args> void refreshPool(Args &&...args)
     {
-        // In an ideal world, this grow would be off thread.
-        // For XT 1 leave it here and have a reasonable prealloc
         assert(position < (growBy + capacity));
         for (size_t i = 0; i < growBy; ++i)
         {
@@ -75,6 +98,7 @@ template <typename T, size_t preAlloc, size_t growBy, size_t capacity = 16384> s
             pool[position] = new T(std::forward<Args>(args)...);
             position++;
         }
+        publishLevel();
     }
 
     void returnToPreAllocSize()
@@ -85,6 +109,44 @@ template <typename T, size_t preAlloc, size_t growBy, size_t capacity = 16384> s
             pool[position - 1] = nullptr;
             position--;
         }
+        publishLevel();
+    }
+
+    /*
+     * Asks for the pool to be grown to hold at least upTo free items, without allocating on
+     * the calling thread. Use this rather than setupPoolToSize from the audio thread.
+     */
+    void requestSize(size_t upTo)
+    {
+        if (upTo > targetSize.load(std::memory_order_relaxed))
+        {
+            targetSize = upTo;
+        }
+        requestGrowth();
+    }
+
+    /*
+     * Called off the audio thread by the pool's owner when woken (and it is fine to poll it).
+     * Constructs items until the free items plus those waiting in the ring reach the larger of
+     * the requested size and lowWater + growBy, or the ring is full.
+     */
+    template <typename... Args> void growInBackground(Args &&...args)
+    {
+        if (!growthRequested.exchange(false))
+            return;
+
+        size_t want = std::min(std::max(targetSize.exchange(0), lowWater + growBy), capacity);
+
+        auto head = grownHead.load(std::memory_order_relaxed);
+        while (head - grownTail.load(std::memory_order_acquire) < grownCapacity &&
+               available.load(std::memory_order_relaxed) +
+                       (head - grownTail.load(std::memory_order_acquire)) <
+                   want)
+        {
+            grown[head % grownCapacity] = new T(std::forward<Args>(args)...);
+            head++;
+            grownHead.store(head, std::memory_order_release);
+        }
     }
 
     std::array<T *, capacity> pool;
@@ -95,6 +157,44 @@ template <typename T, size_t preAlloc, size_t growBy, size_t capacity = 16384> s
      * position -1. position == 0 is a sentinel to rebuild.
      */
     size_t position{0};
+
+    // called (on the audio thread) when the pool wants growInBackground to run
+    std::function<void()> wakeGrower;
+
+    // how often getItem found nothing grown in time and had to allocate on the audio thread
+    std::atomic<uint64_t> emergencyAllocations{0};
+
+  private:
+    void collectGrownItems()
+    {
+        auto tail = grownTail.load(std::memory_order_relaxed);
+        auto head = grownHead.load(std::memory_order_acquire);
+        while (tail != head && position < capacity)
+        {
+            pool[position] = grown[tail % grownCapacity];
+            position++;
+            tail++;
+        }
+        grownTail.store(tail, std::memory_order_release);
+    }
+
+    void publishLevel()
+    {
+        available.store(position, std::memory_order_relaxed);
+        if (position < lowWater)
+            requestGrowth();
+    }
+
+    void requestGrowth()
+    {
+        if (!growthRequested.exchange(true) && wakeGrower)
+            wakeGrower();
+    }
+
+    static constexpr size_t grownCapacity = capacity;
+    std::array<T *, grownCapacity> grown;
+    std::atomic<size_t> grownHead{0}, grownTail{0}, available{0}, targetSize{0};
+    std::atomic<bool> growthRequested{false};
 };
 } // namespace Memory
 } // namespace Surge
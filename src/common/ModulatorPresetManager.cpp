@@ -158,6 +158,7 @@ void ModulatorPreset::loadPresetFrom(const fs::path &location, SurgeStorage *s,
         return;
     }
     lfo->shape.val.i = lfotype;
+    lfo->shape.markChanged();
 
     auto params = TINYXML_SAFE_TO_ELEMENT(lfox->FirstChildElement("params"));
     if (!params)
@@ -188,6 +189,7 @@ void ModulatorPreset::loadPresetFrom(const fs::path &location, SurgeStorage *s,
                 if (valNode->QueryDoubleAttribute("v", &v) == TIXML_SUCCESS)
                 {
                     curr->val.f = v;
+                    curr->markChanged();
                 }
             }
             else
@@ -195,6 +197,7 @@ void ModulatorPreset::loadPresetFrom(const fs::path &location, SurgeStorage *s,
                 if (valNode->QueryIntAttribute("i", &q) == TIXML_SUCCESS)
                 {
                     curr->val.i = q;
+                    curr->markChanged();
                 }
             }
 
@@ -1996,6 +1996,8 @@ void Parameter::bound_value(bool force_integer)
         break;
     }
     };
+
+    markChanged();
 }
 
 bool Parameter::supportsDynamicName() const
@@ -2083,6 +2085,8 @@ void Parameter::set_storage_value(int i)
         break;
     }
     }
+
+    markChanged();
 }
 void Parameter::set_storage_value(float f)
 {
@@ -2094,6 +2098,8 @@ void Parameter::set_storage_value(float f)
         break;
     }
     }
+
+    markChanged();
 }
 
 void Parameter::set_extend_range(bool er)
@@ -2219,6 +2225,9 @@ void Parameter::set_extend_range(bool er)
             break;
         }
     }
+
+    // the clamps above can move val
+    markChanged();
 }
 
 float Parameter::get_extended(float f) const
@@ -4474,7 +4483,16 @@ void Parameter::set_error_message(std::string &errMsg, const std::string value,
 
 bool Parameter::set_value_from_string(const std::string &s, std::string &errMsg)
 {
-    return set_value_from_string_onto(s, val, errMsg);
+    auto res = set_value_from_string_onto(s, val, errMsg);
+    markChanged();
+    return res;
+}
+
+void Parameter::markChanged()
+{
+    // our storage may still be building its patch, in which case it will copy everything
+    if (storage && storage->_patch)
+        storage->_patch->markParameterChanged(id);
 }
 
 bool Parameter::set_value_from_string_onto(const std::string &s, pdata &ontoThis,
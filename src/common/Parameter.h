@@ -387,6 +387,12 @@ class Parameter
 
     virtual ~Parameter();
 
+    // the destructor would otherwise leave us copy only, and the FX loader moves these
+    Parameter(const Parameter &) = default;
+    Parameter(Parameter &&) = default;
+    Parameter &operator=(const Parameter &) = default;
+    Parameter &operator=(Parameter &&) = default;
+
     bool can_temposync() const;
     bool can_extend_range() const;
     bool can_be_absolute() const;
@@ -463,6 +469,8 @@ class Parameter
     float value_to_normalized(float value) const;
     float get_default_value_f01() const;
     void set_value_f01(float v, bool force_integer = false);
+    // tells the patch val changed, so the next block copies it into globaldata / scenedata
+    void markChanged();
     bool set_value_from_string(const std::string &s, std::string &errMsg);
     bool set_value_from_string_onto(const std::string &s, pdata &ontoThis, std::string &errMsg);
     bool supports_tuning_value_from_string(const std::string &s, std::string &errMsg);
@@ -0,0 +1,169 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+#include "RenderWorker.h"
+#include <algorithm>
+#include <cassert>
+
+namespace Surge
+{
+namespace Threading
+{
+RenderWorker::RenderWorker() { thread = std::thread([this]() { run(); }); }
+
+RenderWorker::~RenderWorker()
+{
+    {
+        std::lock_guard<std::mutex> g(parkMutex);
+        keepRunning = false;
+    }
+    parkCV.notify_one();
+
+    if (thread.joinable())
+        thread.join();
+}
+
+void RenderWorker::dispatch(job_t j, void *c)
+{
+    assert(state.load() == IDLE);
+
+    job = j;
+    context = c;
+
+    // The store to state and the load of parked are both sequentially consistent, pairing
+    // with the store to parked and the load of state in run(), so we can't miss a wakeup.
+    state.store(PENDING);
+
+    if (parked.load())
+    {
+        std::lock_guard<std::mutex> g(parkMutex);
+        parkCV.notify_one();
+    }
+}
+
+void RenderWorker::join()
+{
+    int spins = 0;
+    while (state.load(std::memory_order_acquire) != DONE)
+    {
+        if (++spins > spinCount)
+        {
+            // if the worker still hasn't started the job, take it back and run it here
+            int expected = PENDING;
+            if (state.compare_exchange_strong(expected, RUNNING, std::memory_order_acq_rel))
+            {
+                reclaimCount.fetch_add(1, std::memory_order_relaxed);
+                job(context);
+                break;
+            }
+
+            // it's running, so we only wait for as long as the job takes
+            std::this_thread::yield();
+        }
+    }
+    state.store(IDLE, std::memory_order_release);
+}
+
+void RenderWorker::run()
+{
+    while (keepRunning)
+    {
+        int spins = 0;
+        while (state.load(std::memory_order_acquire) != PENDING && spins < spinCount)
+        {
+            spins++;
+        }
+
+        if (state.load() != PENDING)
+        {
+            std::unique_lock<std::mutex> lk(parkMutex);
+            parked.store(true);
+            parkCount.fetch_add(1, std::memory_order_relaxed);
+            parkCV.wait(lk, [this]() { return state.load() == PENDING || !keepRunning; });
+            parked.store(false);
+
+            if (!keepRunning)
+                break;
+        }
+
+        // join() may have taken the job back while we were waking up
+        int expected = PENDING;
+        if (!state.compare_exchange_strong(expected, RUNNING, std::memory_order_acq_rel))
+            continue;
+
+        job(context);
+        state.store(DONE, std::memory_order_release);
+    }
+}
+
+RenderWorkerPool::RenderWorkerPool(int nWorkers)
+{
+    for (int i = 0; i < nWorkers; ++i)
+    {
+        workers.push_back(std::make_unique<RenderWorker>());
+    }
+
+    for (int i = 0; i <= nWorkers; ++i)
+    {
+        participants.push_back({this, i});
+    }
+}
+
+void RenderWorkerPool::run(chunk_job_t j, void *c, int n, int maxWorkers)
+{
+    job = j;
+    context = c;
+    nChunks = n;
+    nextChunk.store(0);
+
+    // no point waking more workers than there are chunks left for them
+    int nDispatched = std::min({(int)workers.size(), maxWorkers, n - 1});
+
+    for (int i = 0; i < nDispatched; ++i)
+    {
+        workers[i]->dispatch(workerEntry, &participants[i + 1]);
+    }
+
+    renderChunks(0);
+
+    for (int i = 0; i < nDispatched; ++i)
+    {
+        workers[i]->join();
+    }
+}
+
+void RenderWorkerPool::renderChunks(int participant)
+{
+    int chunk;
+    while ((chunk = nextChunk.fetch_add(1)) < nChunks)
+    {
+        job(context, chunk, participant);
+    }
+}
+
+void RenderWorkerPool::workerEntry(void *p)
+{
+    auto participant = static_cast<Participant *>(p);
+    participant->pool->renderChunks(participant->index);
+}
+} // namespace Threading
+} // namespace Surge
@@ -0,0 +1,143 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+#ifndef SURGE_SRC_COMMON_RENDERWORKER_H
+#define SURGE_SRC_COMMON_RENDERWORKER_H
+
+#include <atomic>
+#include <cstdint>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Surge
+{
+namespace Threading
+{
+/*
+ * A RenderWorker is a single pre-spawned thread which the audio thread can hand one job
+ * at a time to, and then join on later in the same block. The handoff does not allocate
+ * or lock on the audio thread in the common case: the worker spins for a short while
+ * waiting for work and only parks on a condition variable once it has been idle for a
+ * while, in which case dispatch() has to wake it.
+ *
+ * join() never waits on a worker which hasn't started the job: if the worker hasn't picked it
+ * up within spinCount spins (it may be parked, or descheduled), join() takes the job back and
+ * runs it on the calling thread. So the wait is at most the job's own run time.
+ *
+ * Construction and destruction spawn and join the thread, so do those off the audio
+ * thread. dispatch() and join() must be called as a pair from the same (audio) thread.
+ */
+struct RenderWorker
+{
+    typedef void (*job_t)(void *context);
+
+    RenderWorker();
+    ~RenderWorker();
+
+    RenderWorker(const RenderWorker &) = delete;
+    RenderWorker &operator=(const RenderWorker &) = delete;
+
+    void dispatch(job_t job, void *context);
+    void join();
+
+    /*
+     * How many times the worker has gone to sleep on the condition variable. Useful to
+     * tune spinCount and in tests.
+     */
+    uint64_t getParkCount() const { return parkCount.load(std::memory_order_relaxed); }
+
+    // How many jobs join() took back and ran on the calling thread
+    uint64_t getReclaimCount() const { return reclaimCount.load(std::memory_order_relaxed); }
+
+    static constexpr int spinCount = 1 << 14;
+
+  private:
+    void run();
+
+    enum State
+    {
+        IDLE,
+        PENDING,
+        RUNNING,
+        DONE
+    };
+
+    std::atomic<int> state{IDLE};
+    std::atomic<bool> parked{false}, keepRunning{true};
+    std::atomic<uint64_t> parkCount{0}, reclaimCount{0};
+
+    job_t job{nullptr};
+    void *context{nullptr};
+
+    std::mutex parkMutex;
+    std::condition_variable parkCV;
+    std::thread thread;
+};
+
+/*
+ * A RenderWorkerPool splits a job into a number of chunks and renders them on a set of
+ * pre-spawned RenderWorkers plus the calling thread. Each participant claims the next
+ * unrendered chunk from a shared counter until none are left, so a thread which finishes
+ * its chunk early simply takes more of them. run() returns once every chunk is done.
+ *
+ * The job gets the index of the participant rendering it, 0 being the calling thread and
+ * 1..getNumWorkers() the workers, so callers can keep per-thread scratch state. maxWorkers
+ * lets the caller use fewer threads than the pool was built with without respawning it.
+ */
+struct RenderWorkerPool
+{
+    typedef void (*chunk_job_t)(void *context, int chunk, int participant);
+
+    explicit RenderWorkerPool(int nWorkers);
+    ~RenderWorkerPool() = default;
+
+    RenderWorkerPool(const RenderWorkerPool &) = delete;
+    RenderWorkerPool &operator=(const RenderWorkerPool &) = delete;
+
+    void run(chunk_job_t job, void *context, int nChunks, int maxWorkers);
+    int getNumWorkers() const { return (int)workers.size(); }
+
+  private:
+    void renderChunks(int participant);
+    static void workerEntry(void *participant);
+
+    struct Participant
+    {
+        RenderWorkerPool *pool;
+        int index;
+    };
+
+    std::vector<std::unique_ptr<RenderWorker>> workers;
+    std::vector<Participant> participants;
+
+    chunk_job_t job{nullptr};
+    void *context{nullptr};
+    int nChunks{0};
+    std::atomic<int> nextChunk{0};
+};
+} // namespace Threading
+} // namespace Surge
+
+#endif // SURGE_SRC_COMMON_RENDERWORKER_H
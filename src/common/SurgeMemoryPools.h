@@ -26,6 +26,12 @@
 #include "SurgeStorage.h"
 #include "MemoryPool.h"
 #include "SSESincDelayLine.h"
+#include "TwistOscillator.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 
 namespace Surge
 {
@@ -33,7 +39,24 @@ namespace Memory
 {
 struct SurgeMemoryPools
 {
-    SurgeMemoryPools(SurgeStorage *s) : stringDelayLines(s->sinctable) {}
+    SurgeMemoryPools(SurgeStorage *s)
+        : stringDelayLines(s->sinctable), twistVoiceStates(s), growerStorage(s)
+    {
+        // like the other loaders, wake without the lock from the audio thread and poll as well
+        stringDelayLines.wakeGrower = [this]() { growerCV.notify_one(); };
+        twistVoiceStates.wakeGrower = [this]() { growerCV.notify_one(); };
+        growerThread = std::thread([this]() { growerLoop(); });
+    }
+
+    ~SurgeMemoryPools()
+    {
+        {
+            std::lock_guard<std::mutex> g(growerMutex);
+            growerRunning = false;
+        }
+        growerCV.notify_one();
+        growerThread.join();
+    }
 
     /*
      * The largest number of oscillator instances of a particular
@@ -45,36 +68,106 @@ struct SurgeMemoryPools
      * The string needs 2 delay lines per oscillator
      */
     MemoryPool<SSESincDelayLine<16384>, 8, 4, 2 * maxosc + 100> stringDelayLines;
+
+    /*
+     * Twist needs one engine and resampler state per oscillator. Those are big, so keep only
+     * one around until a patch uses Twist
+     */
+    MemoryPool<TwistVoiceState, 1, 2, maxosc + 100, 1> twistVoiceStates;
+
     void resetAllPools(SurgeStorage *storage) { resetOscillatorPools(storage); }
+
+    /*
+     * Sizes the pools for the oscillators in the patch right away. This allocates and frees,
+     * so it is for when the engine is halted; the audio thread uses requestOscillatorPoolSizes.
+     */
     void resetOscillatorPools(SurgeStorage *storage)
     {
-        bool hasString{false}, hasTwist{false};
-        int nString{0};
+        auto nString = poolSizeFor(storage, ot_string, 2);
+
+        if (nString > 0)
+        {
+            stringDelayLines.setupPoolToSize(nString, storage->sinctable);
+        }
+        else
+        {
+            stringDelayLines.returnToPreAllocSize();
+        }
+
+        auto nTwist = poolSizeFor(storage, ot_twist, 1);
+
+        if (nTwist > 0)
+        {
+            twistVoiceStates.setupPoolToSize(nTwist, storage);
+        }
+        else
+        {
+            twistVoiceStates.returnToPreAllocSize();
+        }
+    }
+
+    // grows the pools for the patch on the grower thread, and leaves any shrinking for later
+    void requestOscillatorPoolSizes(SurgeStorage *storage)
+    {
+        auto nString = poolSizeFor(storage, ot_string, 2);
+
+        if (nString > 0)
+        {
+            stringDelayLines.requestSize(nString);
+        }
+
+        auto nTwist = poolSizeFor(storage, ot_twist, 1);
+
+        if (nTwist > 0)
+        {
+            twistVoiceStates.requestSize(nTwist);
+        }
+    }
+
+    // half of what the oscillators of oscType could use at full polyphony
+    int poolSizeFor(SurgeStorage *storage, int oscType, int perOscillator)
+    {
+        int n{0};
         for (int s = 0; s < n_scenes; ++s)
         {
             for (int os = 0; os < n_oscs; ++os)
             {
-                auto ot = storage->getPatch().scene[s].osc[os].type.val.i;
-
-                if (ot == ot_string)
+                if (storage->getPatch().scene[s].osc[os].type.val.i == oscType)
                 {
-                    hasString = true;
-                    nString++;
+                    n++;
                 }
-                hasTwist |= (ot == ot_twist);
             }
         }
 
-        if (hasString)
-        {
-            int maxUsed = nString * 2 * storage->getPatch().polylimit.val.i;
-            stringDelayLines.setupPoolToSize((int)(maxUsed * 0.5), storage->sinctable);
-        }
-        else
+        int maxUsed = n * perOscillator * storage->getPatch().polylimit.val.i;
+        return (int)(maxUsed * 0.5);
+    }
+
+  private:
+    void growerLoop()
+    {
+        while (true)
         {
-            stringDelayLines.returnToPreAllocSize();
+            {
+                std::unique_lock<std::mutex> lk(growerMutex);
+                growerCV.wait_for(lk, std::chrono::milliseconds(20));
+
+                if (!growerRunning)
+                {
+                    return;
+                }
+            }
+
+            stringDelayLines.growInBackground(growerStorage->sinctable);
+            twistVoiceStates.growInBackground(growerStorage);
         }
     }
+
+    SurgeStorage *growerStorage;
+    std::thread growerThread;
+    std::mutex growerMutex;
+    std::condition_variable growerCV;
+    bool growerRunning{true};
 };
 
 } // namespace Memory
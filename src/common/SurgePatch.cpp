@@ -976,6 +976,28 @@ void SurgePatch::init_default_values()
 
 SurgePatch::~SurgePatch() { free(patchptr); }
 
+void SurgePatch::applyMonophonicParamModulation(pdata &d, const MonophonicParamModulation &pm)
+{
+    switch (pm.vt_type)
+    {
+    case vt_float:
+        d.f += pm.value;
+        break;
+    case vt_int:
+    {
+        auto v = std::clamp((int)(round)(d.i + pm.value), pm.imin, pm.imax);
+        d.i = v;
+        break;
+    }
+    case vt_bool:
+        if (pm.value > 0.5) // true + 0.5 is true; false + 0.5 is true
+            d.b = true;
+        if (pm.value < 0.5)
+            d.b = false;
+        break;
+    }
+}
+
 void SurgePatch::copy_scenedata(pdata *d, int scene)
 {
     int s = scene_start[scene];
@@ -991,25 +1013,7 @@ void SurgePatch::copy_scenedata(pdata *d, int scene)
         auto &pm = monophonicParamModulations[i];
         if (pm.param_id >= s && pm.param_id < s + n_scene_params)
         {
-            switch (pm.vt_type)
-            {
-            case vt_float:
-                d[pm.param_id - s].f += pm.value;
-                break;
-            case vt_int:
-            {
-                auto v =
-                    std::clamp((int)(round)(d[pm.param_id - s].i + pm.value), pm.imin, pm.imax);
-                d[pm.param_id - s].i = v;
-                break;
-            }
-            case vt_bool:
-                if (pm.value > 0.5) // true + 0.5 is true; false + 0.5 is true
-                    d[pm.param_id - s].b = true;
-                if (pm.value < 0.5)
-                    d[pm.param_id - s].b = false;
-                break;
-            }
+            applyMonophonicParamModulation(d[pm.param_id - s], pm);
         }
     }
 }
@@ -1027,24 +1031,138 @@ void SurgePatch::copy_globaldata(pdata *d)
         auto &pm = monophonicParamModulations[i];
         if (pm.param_id < n_global_params)
         {
-            switch (pm.vt_type)
-            {
-            case vt_float:
-                d[pm.param_id].f += pm.value;
-                break;
-            case vt_int:
-            {
-                auto v = std::clamp((int)(round)(d[pm.param_id].i + pm.value), pm.imin, pm.imax);
-                d[pm.param_id].i = v;
-                break;
-            }
-            case vt_bool:
-                if (pm.value > 0.5) // true + 0.5 is true; false + 0.5 is true
-                    d[pm.param_id].b = true;
-                if (pm.value < 0.5)
-                    d[pm.param_id].b = false;
-                break;
-            }
+            applyMonophonicParamModulation(d[pm.param_id], pm);
+        }
+    }
+}
+
+void SurgePatch::markParameterChanged(int id)
+{
+    if (id >= 0 && id < n_total_params)
+    {
+        changedParams[id >> 6].fetch_or(1ULL << (id & 63), std::memory_order_release);
+    }
+}
+
+void SurgePatch::markAllParametersChanged()
+{
+    allParamsChanged.store(true, std::memory_order_release);
+}
+
+void SurgePatch::markModulated(int scene, int index)
+{
+    int slot = (scene < 0) ? index : n_global_params + scene * n_scene_params + index;
+
+    if (!slotIsModulated[slot])
+    {
+        slotIsModulated[slot] = true;
+        modulatedSlots[modulatedSlotCount++] = slot;
+    }
+}
+
+void SurgePatch::copy_changed_data(const bool copyScene[n_scenes])
+{
+    // returns the pdata slot which mirrors parameter id, or nullptr if we aren't copying it
+    auto slotFor = [this, copyScene](int id) -> pdata * {
+        if (id < n_global_params)
+            return &globaldata[id];
+
+        for (int sc = 0; sc < n_scenes; ++sc)
+        {
+            if (copyScene[sc] && id >= scene_start[sc] && id < scene_start[sc] + n_scene_params)
+                return &scenedata[sc][id - scene_start[sc]];
+        }
+
+        return nullptr;
+    };
+
+    // slots count through globaldata, then each scene's scenedata
+    auto idForSlot = [this](int slot) {
+        if (slot < n_global_params)
+            return slot;
+
+        int sc = (slot - n_global_params) / n_scene_params;
+        return scene_start[sc] + (slot - n_global_params) % n_scene_params;
+    };
+
+    bool all = allParamsChanged.exchange(false, std::memory_order_acq_rel);
+
+    // undo last block's scene and global modulation. A scene we aren't copying gets copied in
+    // full when it plays again, so it can be skipped
+    for (int i = 0; i < modulatedSlotCount; ++i)
+    {
+        int slot = modulatedSlots[i];
+        slotIsModulated[slot] = false;
+
+        if (all)
+            continue;
+
+        int id = idForSlot(slot);
+        if (auto d = slotFor(id))
+            d->i = param_ptr[id]->val.i;
+    }
+    modulatedSlotCount = 0;
+
+    for (auto &w : changedParams)
+    {
+        auto bits = w.exchange(0, std::memory_order_acq_rel);
+
+        // a full copy below picks these up anyway
+        if (all)
+            continue;
+
+        for (int b = 0; bits; ++b, bits >>= 1)
+        {
+            if (!(bits & 1))
+                continue;
+
+            int id = (int)(&w - &changedParams[0]) * 64 + b;
+            if (auto d = slotFor(id))
+                d->i = param_ptr[id]->val.i;
+        }
+    }
+
+    if (all)
+    {
+        copy_globaldata(globaldata);
+    }
+
+    for (int sc = 0; sc < n_scenes; ++sc)
+    {
+        if (!copyScene[sc])
+        {
+            sceneDataCurrent[sc] = false;
+        }
+        else if (all || !sceneDataCurrent[sc])
+        {
+            copy_scenedata(scenedata[sc], sc);
+            sceneDataCurrent[sc] = true;
+        }
+    }
+
+    if (all)
+        return;
+
+    // a write which missed its markChanged() still turns up within a few hundred blocks
+    for (int i = 0; i < parameterSweepPerBlock; ++i)
+    {
+        int id = idForSlot(paramSweepPosition);
+        paramSweepPosition = (paramSweepPosition + 1) % dataSlots;
+
+        if (auto d = slotFor(id))
+            d->i = param_ptr[id]->val.i;
+    }
+
+    // the copies above put back the unmodulated value, so re-apply monophonic modulation to
+    // anything we just touched. Simplest is to restore and re-apply every target, since there
+    // are at most a handful.
+    for (int i = 0; i < paramModulationCount; ++i)
+    {
+        auto &pm = monophonicParamModulations[i];
+        if (auto d = slotFor(pm.param_id))
+        {
+            d->i = param_ptr[pm.param_id]->val.i;
+            applyMonophonicParamModulation(*d, pm);
         }
     }
 }
@@ -1102,6 +1220,8 @@ void SurgePatch::update_controls(
             }
         }
     }
+
+    markAllParametersChanged();
 }
 
 // BASE 64 SUPPORT, THANKS TO:
@@ -1199,85 +1319,117 @@ std::string base64_decode(std::string const &encoded_string)
 }
 
 void SurgePatch::load_patch(const void *data, int datasize, bool preset)
+{
+    auto prepared = std::make_unique<PreparedLoad>();
+
+    if (prepare_patch(data, datasize, *prepared))
+    {
+        load_patch(*prepared, preset);
+    }
+}
+
+bool SurgePatch::prepare_patch(const void *data, int datasize, PreparedLoad &prepared)
 {
     using namespace sst::io;
 
     if (datasize <= 4)
-        return;
+        return false;
     assert(datasize);
     assert(data);
     void *end = (char *)data + datasize;
     patch_header *ph = (patch_header *)data;
-    ph->xmlsize = mech::endian_read_int32LE(ph->xmlsize);
 
-    if (!memcmp(ph->tag, "sub3", 4))
+    if (memcmp(ph->tag, "sub3", 4))
     {
-        char *dr = (char *)data + sizeof(patch_header);
-        load_xml(dr, ph->xmlsize, preset);
-        dr += ph->xmlsize;
+        prepared.hasXML = parse_xml(data, datasize, prepared.doc);
+        return true;
+    }
 
-        for (int sc = 0; sc < n_scenes; sc++)
+    // read the header without swapping it in place, so the data can be prepared again
+    int xmlsize = mech::endian_read_int32LE(ph->xmlsize);
+    char *dr = (char *)data + sizeof(patch_header);
+    prepared.hasXML = parse_xml(dr, xmlsize, prepared.doc);
+    dr += xmlsize;
+
+    for (int sc = 0; sc < n_scenes; sc++)
+    {
+        for (int osc = 0; osc < n_oscs; osc++)
         {
-            for (int osc = 0; osc < n_oscs; osc++)
+            int wtsize = mech::endian_read_int32LE(ph->wtsize[sc][osc]);
+            if (wtsize)
             {
-                ph->wtsize[sc][osc] = mech::endian_read_int32LE(ph->wtsize[sc][osc]);
-                if (ph->wtsize[sc][osc])
-                {
-                    wt_header *wth = (wt_header *)dr;
-                    if (wth > end)
-                        return;
+                wt_header *wth = (wt_header *)dr;
+                if (wth > end)
+                    return true;
 
-                    scene[sc].osc[osc].wt.queue_id = -1;
-                    scene[sc].osc[osc].wt.current_id = -1;
-                    scene[sc].osc[osc].wt.queue_filename = "";
-                    scene[sc].osc[osc].wt.current_filename = "";
+                void *d = (void *)((char *)dr + sizeof(wt_header));
 
-                    void *d = (void *)((char *)dr + sizeof(wt_header));
+                auto wt = std::make_unique<Wavetable>();
+                wt->BuildWT(d, *wth, false);
+                prepared.wavetables[sc][osc] = std::move(wt);
 
-                    storage->waveTableDataMutex.lock();
-                    scene[sc].osc[osc].wt.BuildWT(d, *wth, false);
+                dr += wtsize;
+            }
+        }
+    }
 
-                    bool hadName{true};
+    return true;
+}
 
-                    if (scene[sc].osc[osc].wavetable_display_name.empty())
-                    {
-                        hadName = false;
+void SurgePatch::load_patch(PreparedLoad &prepared, bool preset)
+{
+    if (prepared.hasXML)
+    {
+        load_xml(prepared.doc, preset);
+    }
 
-                        if (scene[sc].osc[osc].wt.flags & wtf_is_sample)
-                        {
-                            scene[sc].osc[osc].wavetable_display_name = "(Patch Sample)";
-                        }
-                        else
-                        {
-                            scene[sc].osc[osc].wavetable_display_name = "(Patch Wavetable)";
-                        }
-                    }
+    for (int sc = 0; sc < n_scenes; sc++)
+    {
+        for (int osc = 0; osc < n_oscs; osc++)
+        {
+            if (!prepared.wavetables[sc][osc])
+                continue;
 
-                    storage->waveTableDataMutex.unlock();
+            scene[sc].osc[osc].wt.queue_id = -1;
+            scene[sc].osc[osc].wt.current_id = -1;
+            scene[sc].osc[osc].wt.queue_filename = "";
+            scene[sc].osc[osc].wt.current_filename = "";
 
-                    if (hadName && scene[sc].osc[osc].wt.current_id < 0)
+            // the old table ends up in prepared, and goes away with it
+            storage->waveTableDataMutex.lock();
+            scene[sc].osc[osc].wt.swapContents(*prepared.wavetables[sc][osc]);
+
+            bool hadName{true};
+
+            if (scene[sc].osc[osc].wavetable_display_name.empty())
+            {
+                hadName = false;
+
+                if (scene[sc].osc[osc].wt.flags & wtf_is_sample)
+                {
+                    scene[sc].osc[osc].wavetable_display_name = "(Patch Sample)";
+                }
+                else
+                {
+                    scene[sc].osc[osc].wavetable_display_name = "(Patch Wavetable)";
+                }
+            }
+
+            storage->waveTableDataMutex.unlock();
+
+            if (hadName && scene[sc].osc[osc].wt.current_id < 0)
+            {
+                for (int i = 0;
+                     i < storage->wt_list.size() && scene[sc].osc[osc].wt.current_id < 0; ++i)
+                {
+                    if (scene[sc].osc[osc].wavetable_display_name == storage->wt_list[i].name)
                     {
-                        for (int i = 0;
-                             i < storage->wt_list.size() && scene[sc].osc[osc].wt.current_id < 0;
-                             ++i)
-                        {
-                            if (scene[sc].osc[osc].wavetable_display_name ==
-                                storage->wt_list[i].name)
-                            {
-                                scene[sc].osc[osc].wt.current_id = i;
-                            }
-                        }
+                        scene[sc].osc[osc].wt.current_id = i;
                     }
-
-                    dr += ph->wtsize[sc][osc];
                 }
             }
         }
     }
-    else
-    {
-        load_xml(data, datasize, preset);
-    }
 }
 
 unsigned int SurgePatch::save_patch(void **data)
@@ -1381,9 +1533,15 @@ float convert_v11_reso_to_v12_4P(float reso) { return reso * (0.99f / 1.05f); }
 void SurgePatch::load_xml(const void *data, int datasize, bool is_preset)
 {
     TiXmlDocument doc;
-    int j;
-    double d;
 
+    if (parse_xml(data, datasize, doc))
+    {
+        load_xml(doc, is_preset);
+    }
+}
+
+bool SurgePatch::parse_xml(const void *data, int datasize, TiXmlDocument &doc)
+{
     if (datasize >= (1 << 22))
     {
         auto msg = fmt::format(
@@ -1395,7 +1553,7 @@ void SurgePatch::load_xml(const void *data, int datasize, bool is_preset)
 
         storage->reportError(msg, "Patch Load Error");
 
-        return;
+        return false;
     }
 
     if (datasize)
@@ -1407,6 +1565,14 @@ void SurgePatch::load_xml(const void *data, int datasize, bool is_preset)
         free(temp);
     }
 
+    return true;
+}
+
+void SurgePatch::load_xml(TiXmlDocument &doc, bool is_preset)
+{
+    int j;
+    double d;
+
     // clear old modulation routings
     for (int sc = 0; sc < n_scenes; sc++)
     {
@@ -3234,6 +3400,9 @@ void SurgePatch::load_xml(const void *data, int datasize, bool is_preset)
             }
         }
     }
+
+    // loading writes values straight into the parameters, so copy them all next block
+    markAllParametersChanged();
 }
 
 struct srge_header
@@ -24,6 +24,7 @@
 #include "SurgeStorage.h"
 #include <set>
 #include <numeric>
+#include <algorithm>
 #include <cctype>
 #include <map>
 #include <queue>
@@ -48,6 +49,8 @@
 #include "libMTSMaster.h"
 #endif
 #include "FxPresetAndClipboardManager.h"
+#include "WavetableCache.h"
+#include "MappedFile.h"
 #include "ModulatorPresetManager.h"
 #include "SurgeMemoryPools.h"
 #include "sst/basic-blocks/tables/SincTableProvider.h"
@@ -56,6 +59,7 @@
 #include "MSEGModulationHelper.h"
 // FIXME
 #include "FormulaModulationHelper.h"
+#include "FormulaExpressionCompiler.h"
 
 #include "sst/basic-blocks/mechanics/endian-ops.h"
 namespace mech = sst::basic_blocks::mechanics;
@@ -93,6 +97,11 @@ SurgeStorage::SurgeStorage(const SurgeStorage::SurgeStorageConfig &config) : oth
     }
 
     _patch.reset(new SurgePatch(this));
+    activeModRouting = std::make_unique<ModulationRoutingSnapshot>();
+    std::iota(activeModRouting->controllerOrder.begin(), activeModRouting->controllerOrder.end(),
+              0);
+    std::iota(pendingControllerOrder.begin(), pendingControllerOrder.end(), 0);
+    wavetableLoaderThread = std::thread([this]() { wavetableLoaderLoop(); });
 
     namespace tabl = sst::basic_blocks::tables;
     sincTableProvider = std::make_unique<tabl::SurgeSincTableProvider>();
@@ -358,6 +367,7 @@ SurgeStorage::SurgeStorage(const SurgeStorage::SurgeStorageConfig &config) : oth
     userMidiMappingsPath = userDataPath / "MIDI Mappings";
     userModulatorSettingsPath = userDataPath / "Modulator Presets";
     userSkinsPath = userDataPath / "Skins";
+    wavetableCachePath = Surge::Storage::WavetableCache::defaultImageDirectory();
     extraThirdPartyWavetablesPath = config.extraThirdPartyWavetablesPath;
     extraUserWavetablesPath = config.extraUsersWavetablesPath;
 
@@ -1241,10 +1251,37 @@ void SurgeStorage::perform_queued_wtloads()
     SurgePatch &patch =
         getPatch(); // Change here is for performance and ease of debugging, simply not calling
                     // getPatch so many times. Code should behave identically.
+    std::lock_guard<std::mutex> ql(wavetableQueueMutex);
+    auto generation = wavetableLoadGeneration.load();
+
     for (int sc = 0; sc < n_scenes; sc++)
     {
         for (int o = 0; o < n_oscs; o++)
         {
+            // finish anything the loader thread started while the engine was running, unless a
+            // patch has loaded since, in which case the oscillator's own queue is what counts
+            auto &slot = wtLoadSlots[sc][o];
+            auto state = slot.state.load();
+            bool stale = slot.generation != generation;
+
+            if (state == WavetableLoadSlot::READY)
+            {
+                if (stale)
+                {
+                    slot.state = WavetableLoadSlot::RECLAIM;
+                }
+                else
+                {
+                    std::lock_guard<std::mutex> g(waveTableDataMutex);
+                    swap_in_staged_wtload(sc, o);
+                }
+                wakeWavetableLoader();
+            }
+            else if (state == WavetableLoadSlot::REQUESTED && !stale)
+            {
+                continue;
+            }
+
             if (patch.scene[sc].osc[o].wt.queue_id != -1)
             {
                 if (patch.scene[sc].osc[o].wt.everBuilt)
@@ -1262,7 +1299,7 @@ void SurgeStorage::perform_queued_wtloads()
                 int wtidx = -1, ct = 0;
                 for (const auto &wti : wt_list)
                 {
-                    if (path_to_string(wti.path) == patch.scene[sc].osc[0].wt.queue_filename)
+                    if (path_to_string(wti.path) == patch.scene[sc].osc[o].wt.queue_filename)
                     {
                         wtidx = ct;
                     }
@@ -1280,7 +1317,251 @@ void SurgeStorage::perform_queued_wtloads()
     }
 }
 
+void SurgeStorage::hand_off_queued_wtloads()
+{
+    auto &patch = getPatch();
+    auto generation = wavetableLoadGeneration.load();
+    bool wake = false;
+
+    // if the UI is queueing something right now, pick up new requests next block
+    std::unique_lock<std::mutex> ql(wavetableQueueMutex, std::try_to_lock);
+
+    for (int sc = 0; sc < n_scenes; sc++)
+    {
+        for (int o = 0; o < n_oscs; o++)
+        {
+            auto &osc = patch.scene[sc].osc[o];
+            auto &slot = wtLoadSlots[sc][o];
+
+            switch (slot.state)
+            {
+            case WavetableLoadSlot::IDLE:
+            {
+                if (ql.owns_lock() && (osc.wt.queue_id != -1 || osc.wt.queue_filename[0]))
+                {
+                    if (osc.wt.queue_id == -1 && !uses_wavetabledata(osc.type.val.i))
+                    {
+                        osc.queue_type = ot_wavetable;
+                    }
+
+                    // the slot's filename was cleared when it was used, so swapping doesn't
+                    // allocate and leaves the oscillator's queue empty
+                    slot.queueId = osc.wt.queue_id;
+                    std::swap(slot.queueFilename, osc.wt.queue_filename);
+                    osc.wt.queue_id = -1;
+                    slot.generation = generation;
+
+                    slot.state = WavetableLoadSlot::REQUESTED;
+                    wake = true;
+                }
+            }
+            break;
+            case WavetableLoadSlot::READY:
+            {
+                if (slot.generation != generation)
+                {
+                    slot.state = WavetableLoadSlot::RECLAIM;
+                    wake = true;
+                }
+                // the UI reads the tables under this lock, so if it has it just try next block
+                else if (waveTableDataMutex.try_lock())
+                {
+                    swap_in_staged_wtload(sc, o);
+                    waveTableDataMutex.unlock();
+                    wake = true;
+                }
+            }
+            break;
+            default:
+                break;
+            }
+        }
+    }
+
+    if (wake)
+    {
+        wakeWavetableLoader();
+    }
+}
+
+void SurgeStorage::swap_in_staged_wtload(int sc, int o)
+{
+    auto &patch = getPatch();
+    auto &osc = patch.scene[sc].osc[o];
+    auto &slot = wtLoadSlots[sc][o];
+
+    if (osc.wt.everBuilt)
+    {
+        patch.isDirty = true;
+    }
+
+    osc.wt.swapContents(slot.staged);
+    osc.wt.current_id = slot.staged.current_id;
+    std::swap(osc.wt.current_filename, slot.staged.current_filename);
+
+    // a load which doesn't name itself leaves the current name
+    if (!slot.displayName.empty())
+    {
+        std::swap(osc.wavetable_display_name, slot.displayName);
+    }
+    osc.wt.refresh_display = true;
+
+    slot.state = WavetableLoadSlot::RECLAIM;
+}
+
+void SurgeStorage::wakeWavetableLoader()
+{
+    // we don't take the lock here since this is called from the audio thread; the loader
+    // polls as well, so a wakeup which lands just before it waits is only delayed
+    wavetableLoadRequested = true;
+    wavetableLoaderCV.notify_one();
+}
+
+void SurgeStorage::wavetableLoaderLoop()
+{
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lk(wavetableLoaderMutex);
+
+            while (!wavetableLoadRequested && wavetableLoaderRunning)
+            {
+                wavetableLoaderCV.wait_for(lk, std::chrono::milliseconds(20));
+            }
+
+            if (!wavetableLoaderRunning)
+            {
+                return;
+            }
+
+            wavetableLoadRequested = false;
+        }
+
+        for (int sc = 0; sc < n_scenes; sc++)
+        {
+            for (int o = 0; o < n_oscs; o++)
+            {
+                auto &slot = wtLoadSlots[sc][o];
+
+                if (slot.state == WavetableLoadSlot::RECLAIM)
+                {
+                    // the swapped out table goes, so idle slots don't hold a second copy
+                    slot.staged.~Wavetable();
+                    new (&slot.staged) Wavetable();
+                    slot.displayName.clear();
+                    slot.state = WavetableLoadSlot::IDLE;
+                }
+                else if (slot.state == WavetableLoadSlot::REQUESTED)
+                {
+                    slot.state = stage_queued_wtload(sc, o) ? WavetableLoadSlot::READY
+                                                            : WavetableLoadSlot::IDLE;
+                }
+            }
+        }
+
+        // routing snapshots the audio thread retired or asked for
+        reclaimModulationRouting();
+
+        // the disk cache is filled last, so it never holds up a load that's waiting
+        decltype(wavetableCacheWrites) writes;
+        {
+            std::lock_guard<std::mutex> g(wavetableCacheWritesMutex);
+            writes.swap(wavetableCacheWrites);
+        }
+
+        for (const auto &[key, built] : writes)
+        {
+            Surge::Storage::WavetableCache::writeImage(wavetableCachePath, key, *built);
+        }
+
+        if (!writes.empty())
+        {
+            Surge::Storage::WavetableCache::pruneImages(wavetableCachePath);
+        }
+    }
+}
+
+void SurgeStorage::queue_wt_load(OscillatorStorage *osc, int id)
+{
+    std::lock_guard<std::mutex> g(wavetableQueueMutex);
+    osc->wt.queue_id = id;
+}
+
+void SurgeStorage::queue_wt_load(OscillatorStorage *osc, const std::string &filename)
+{
+    std::lock_guard<std::mutex> g(wavetableQueueMutex);
+    osc->wt.queue_filename = filename;
+}
+
+void SurgeStorage::clear_wavetable_cache()
+{
+    Surge::Storage::WavetableCache::clearImages(wavetableCachePath);
+}
+
+void SurgeStorage::queue_wt_cache_write(const std::string &key,
+                                        std::shared_ptr<const Wavetable> built)
+{
+    if (wavetableCachePath.empty() || key.empty())
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> g(wavetableCacheWritesMutex);
+        wavetableCacheWrites.emplace_back(key, std::move(built));
+    }
+
+    wakeWavetableLoader();
+}
+
+bool SurgeStorage::stage_queued_wtload(int sc, int o)
+{
+    auto &slot = wtLoadSlots[sc][o];
+    auto &staged = slot.staged;
+
+    // hand_off moved the request into the slot, so the oscillator isn't touched here
+    int queueId = slot.queueId;
+    std::string queueFilename = slot.queueFilename;
+    slot.queueId = -1;
+    slot.queueFilename.clear();
+
+    slot.displayName.clear();
+
+    if (queueId != -1)
+    {
+        load_wt_into(queueId, &staged, &slot.displayName);
+    }
+    else if (!queueFilename.empty())
+    {
+        int wtidx = -1, ct = 0;
+        for (const auto &wti : wt_list)
+        {
+            if (path_to_string(wti.path) == queueFilename)
+            {
+                wtidx = ct;
+            }
+            ct++;
+        }
+
+        staged.current_id = wtidx;
+        staged.queue_filename = queueFilename;
+        load_wt_into(queueFilename, &staged, &slot.displayName);
+    }
+
+    return staged.everBuilt;
+}
+
 void SurgeStorage::load_wt(int id, Wavetable *wt, OscillatorStorage *osc)
+{
+    load_wt_into(id, wt, osc ? &osc->wavetable_display_name : nullptr);
+}
+
+void SurgeStorage::load_wt(string filename, Wavetable *wt, OscillatorStorage *osc)
+{
+    load_wt_into(filename, wt, osc ? &osc->wavetable_display_name : nullptr);
+}
+
+void SurgeStorage::load_wt_into(int id, Wavetable *wt, std::string *displayName)
 {
     wt->current_id = id;
     wt->queue_id = -1;
@@ -1291,9 +1572,9 @@ void SurgeStorage::load_wt(int id, Wavetable *wt, OscillatorStorage *osc)
         load_wt_wt_mem(SurgeSharedBinary::memoryWavetable_wt,
                        SurgeSharedBinary::memoryWavetable_wtSize, wt);
 #endif
-        if (osc)
+        if (displayName)
         {
-            osc->wavetable_display_name = "Sin to Saw";
+            *displayName = "Sin to Saw";
         }
 
         return;
@@ -1314,15 +1595,15 @@ void SurgeStorage::load_wt(int id, Wavetable *wt, OscillatorStorage *osc)
         return;
     }
 
-    load_wt(path_to_string(wt_list[id].path), wt, osc);
+    load_wt_into(path_to_string(wt_list[id].path), wt, displayName);
 
-    if (osc)
+    if (displayName)
     {
-        osc->wavetable_display_name = wt_list.at(id).name;
+        *displayName = wt_list.at(id).name;
     }
 }
 
-void SurgeStorage::load_wt(string filename, Wavetable *wt, OscillatorStorage *osc)
+void SurgeStorage::load_wt_into(std::string filename, Wavetable *wt, std::string *displayName)
 {
     wt->current_filename = wt->queue_filename;
     wt->queue_filename = "";
@@ -1336,13 +1617,62 @@ void SurgeStorage::load_wt(string filename, Wavetable *wt, OscillatorStorage *os
 
     bool loaded = false;
 
-    if (extension.compare(".wt") == 0)
-    {
-        loaded = load_wt_wt(filename, wt);
-    }
-    else if (extension.compare(".wav") == 0)
+    if (extension.compare(".wt") == 0 || extension.compare(".wav") == 0)
     {
-        loaded = load_wt_wav_portable(filename, wt);
+        auto &cache = Surge::Storage::WavetableCache::global();
+        auto key = cache.keyFor(filename, wt->frame_size_if_absent);
+        auto built = key.empty() ? nullptr : cache.find(key);
+
+        if (built)
+        {
+            // the frame size only applies to the load it was set for
+            wt->frame_size_if_absent = -1;
+        }
+        else
+        {
+            auto fresh = std::make_shared<Wavetable>();
+            fresh->frame_size_if_absent = wt->frame_size_if_absent;
+
+            bool fromDisk = Surge::Storage::WavetableCache::readImage(wavetableCachePath, key,
+                                                                      *fresh);
+
+            if (fromDisk)
+            {
+                wt->frame_size_if_absent = -1;
+                loaded = true;
+            }
+            else
+            {
+                if (extension.compare(".wt") == 0)
+                {
+                    loaded = load_wt_wt(filename, fresh.get());
+                }
+                else
+                {
+                    loaded = load_wt_wav_portable(filename, fresh.get());
+                }
+
+                wt->frame_size_if_absent = fresh->frame_size_if_absent;
+            }
+
+            if (loaded)
+            {
+                built = key.empty() ? fresh : cache.insert(key, fresh);
+
+                if (!fromDisk && built == fresh)
+                {
+                    queue_wt_cache_write(key, built);
+                }
+            }
+        }
+
+        if (built)
+        {
+            waveTableDataMutex.lock();
+            wt->shareFrom(built);
+            waveTableDataMutex.unlock();
+            loaded = true;
+        }
     }
     else
     {
@@ -1352,20 +1682,51 @@ void SurgeStorage::load_wt(string filename, Wavetable *wt, OscillatorStorage *os
         reportError(oss.str(), "Error");
     }
 
-    if (osc && loaded)
+    if (displayName && loaded)
     {
         auto fn = filename.substr(filename.find_last_of(PATH_SEPARATOR) + 1, filename.npos);
         std::string fnnoext = fn.substr(0, fn.find_last_of('.'));
 
         if (fnnoext.length() > 0)
         {
-            osc->wavetable_display_name = fnnoext;
+            *displayName = fnnoext;
         }
     }
 }
 
+static bool wt_header_is_valid(const wt_header &wh)
+{
+    return wh.tag[0] == 'v' && wh.tag[1] == 'a' && wh.tag[2] == 'w' && wh.tag[3] == 't';
+}
+
+static size_t wt_data_size(const wt_header &wh)
+{
+    size_t sampleSize =
+        (mech::endian_read_int16LE(wh.flags) & wtf_int16) ? sizeof(short) : sizeof(float);
+
+    return sampleSize * mech::endian_read_int16LE(wh.n_tables) *
+           mech::endian_read_int32LE(wh.n_samples);
+}
+
 bool SurgeStorage::load_wt_wt(string filename, Wavetable *wt)
 {
+    {
+        // build straight out of a mapping of the file rather than reading it into a buffer
+        // first. files shorter than their header says take the read path below, which pads them
+        Surge::Storage::MappedFile mapped(string_to_path(filename));
+
+        if (mapped.data() && mapped.size() >= sizeof(wt_header))
+        {
+            wt_header wh;
+            memcpy(&wh, mapped.data(), sizeof(wt_header));
+
+            if (wt_header_is_valid(wh) && mapped.size() >= sizeof(wt_header) + wt_data_size(wh))
+            {
+                return load_wt_wt_mem(mapped.data(), mapped.size(), wt);
+            }
+        }
+    }
+
     std::filebuf f;
 
     if (!f.open(string_to_path(filename), std::ios::binary | std::ios::in))
@@ -1379,24 +1740,13 @@ bool SurgeStorage::load_wt_wt(string filename, Wavetable *wt)
 
     size_t read = f.sgetn(reinterpret_cast<char *>(&wh), sizeof(wh));
 
-    if (!(wh.tag[0] == 'v' && wh.tag[1] == 'a' && wh.tag[2] == 'w' && wh.tag[3] == 't'))
+    if (!wt_header_is_valid(wh))
     {
         // SOME sort of error reporting is appropriate
         return false;
     }
 
-    size_t ds;
-
-    if (mech::endian_read_int16LE(wh.flags) & wtf_int16)
-    {
-        ds = sizeof(short) * mech::endian_read_int16LE(wh.n_tables) *
-             mech::endian_read_int32LE(wh.n_samples);
-    }
-    else
-    {
-        ds = sizeof(float) * mech::endian_read_int16LE(wh.n_tables) *
-             mech::endian_read_int32LE(wh.n_samples);
-    }
+    size_t ds = wt_data_size(wh);
 
     const std::unique_ptr<char[]> data{new char[ds]};
     read = f.sgetn(data.get(), ds);
@@ -1446,19 +1796,13 @@ bool SurgeStorage::load_wt_wt_mem(const char *data, size_t dataSize, Wavetable *
 
     memcpy(&wh, data, sizeof(wt_header));
 
-    if (!(wh.tag[0] == 'v' && wh.tag[1] == 'a' && wh.tag[2] == 'w' && wh.tag[3] == 't'))
+    if (!wt_header_is_valid(wh))
     {
         // SOME sort of error reporting is appropriate
         return false;
     }
 
-    size_t ds;
-    if (mech::endian_read_int16LE(wh.flags) & wtf_int16)
-        ds = sizeof(short) * mech::endian_read_int16LE(wh.n_tables) *
-             mech::endian_read_int32LE(wh.n_samples);
-    else
-        ds = sizeof(float) * mech::endian_read_int16LE(wh.n_tables) *
-             mech::endian_read_int32LE(wh.n_samples);
+    size_t ds = wt_data_size(wh);
 
     if (dataSize < ds + sizeof(wt_header))
     {
@@ -1846,6 +2190,7 @@ void SurgeStorage::clipboard_paste(
         cgroup_e = entry;
         id = getPatch().scene[scene].osc[entry].type.id; // first parameter id
         getPatch().scene[scene].osc[entry].type.val.i = clipboard_p[0].val.i;
+        getPatch().scene[scene].osc[entry].type.markChanged();
         start = 1;
         getPatch().update_controls(false, &getPatch().scene[scene].osc[entry]);
 
@@ -1942,6 +2287,7 @@ void SurgeStorage::clipboard_paste(
             Parameter p = clipboard_p[i];
             int pid = p.id + id;
             getPatch().param_ptr[pid]->val.i = p.val.i;
+            getPatch().param_ptr[pid]->markChanged();
             getPatch().param_ptr[pid]->temposync = p.temposync;
             getPatch().param_ptr[pid]->set_extend_range(p.extend_range);
             getPatch().param_ptr[pid]->deactivated = p.deactivated;
@@ -2152,6 +2498,7 @@ void SurgeStorage::clipboard_paste(
         }
     }
 
+    publishModulationRouting();
     modRoutingMutex.unlock();
 }
 
@@ -2339,6 +2686,145 @@ SurgeStorage::~SurgeStorage()
 
     deinitialize_oddsound();
 #endif
+
+    {
+        std::lock_guard<std::mutex> lk(wavetableLoaderMutex);
+        wavetableLoaderRunning = false;
+    }
+    wavetableLoaderCV.notify_one();
+    wavetableLoaderThread.join();
+
+    // the loader is gone, so whatever it didn't get to is ours
+    modRoutingRebuildRequested = false;
+    reclaimModulationRouting();
+    delete pendingModRouting.exchange(nullptr);
+}
+
+void SurgeStorage::publishModulationRouting()
+{
+    // the audio thread doesn't allocate, so it leaves building the snapshot to the loader
+    if (onAudioThread)
+    {
+        modRoutingRebuildRequested.store(true, std::memory_order_release);
+        wakeWavetableLoader();
+        return;
+    }
+
+    std::lock_guard<std::recursive_mutex> g(modRoutingMutex);
+
+    if (modRoutingBatchDepth > 0)
+    {
+        modRoutingPublishDeferred = true;
+        return;
+    }
+
+    modRoutingRebuildRequested.store(false, std::memory_order_release);
+
+    auto snap = new ModulationRoutingSnapshot();
+    snap->global = getPatch().modulation_global;
+    for (int s = 0; s < n_scenes; ++s)
+    {
+        snap->scene[s] = getPatch().scene[s].modulation_scene;
+        snap->voice[s] = getPatch().scene[s].modulation_voice;
+    }
+
+    snap->controllerOrder = pendingControllerOrder;
+    std::iota(pendingControllerOrder.begin(), pendingControllerOrder.end(), 0);
+
+    // a pending snapshot the audio thread never picked up can go straight away, but the
+    // controller swaps it carries still have to happen, ahead of ours
+    if (auto prior = pendingModRouting.exchange(nullptr, std::memory_order_acq_rel))
+    {
+        std::array<int, n_customcontrollers> order;
+        for (int i = 0; i < n_customcontrollers; ++i)
+            order[i] = snap->controllerOrder[prior->controllerOrder[i]];
+        snap->controllerOrder = order;
+
+        delete prior;
+    }
+
+    pendingModRouting.store(snap, std::memory_order_release);
+}
+
+void SurgeStorage::queueMetaControllerSwap(int c1, int c2)
+{
+    std::lock_guard<std::recursive_mutex> g(modRoutingMutex);
+
+    for (auto &o : pendingControllerOrder)
+    {
+        if (o == c1)
+            o = c2;
+        else if (o == c2)
+            o = c1;
+    }
+}
+
+SurgeStorage::ModulationRoutingBatch::ModulationRoutingBatch(SurgeStorage *storage)
+    : storage(storage)
+{
+    storage->modRoutingMutex.lock();
+    storage->modRoutingBatchDepth++;
+}
+
+SurgeStorage::ModulationRoutingBatch::~ModulationRoutingBatch()
+{
+    if (--storage->modRoutingBatchDepth == 0 && storage->modRoutingPublishDeferred)
+    {
+        storage->modRoutingPublishDeferred = false;
+        storage->publishModulationRouting();
+    }
+
+    storage->modRoutingMutex.unlock();
+}
+
+void SurgeStorage::acquireModulationRouting()
+{
+    auto head = retiredModRoutingHead.load(std::memory_order_relaxed);
+
+    // with nowhere to put the snapshot we'd replace, wait for the loader to free some
+    if (head - retiredModRoutingTail.load(std::memory_order_acquire) >= retiredModRoutingSlots)
+    {
+        wakeWavetableLoader();
+        return;
+    }
+
+    auto snap = pendingModRouting.exchange(nullptr, std::memory_order_acq_rel);
+    if (!snap)
+        return;
+
+    std::array<ModulationSource *, n_customcontrollers> sources;
+    for (int i = 0; i < n_customcontrollers; ++i)
+        sources[i] = getPatch().scene[0].modsources[ms_ctrl1 + i];
+
+    for (int sc = 0; sc < n_scenes; ++sc)
+    {
+        for (int i = 0; i < n_customcontrollers; ++i)
+            getPatch().scene[sc].modsources[ms_ctrl1 + snap->controllerOrder[i]] = sources[i];
+    }
+
+    retiredModRouting[head % retiredModRoutingSlots] = activeModRouting.release();
+    retiredModRoutingHead.store(head + 1, std::memory_order_release);
+    activeModRouting.reset(snap);
+
+    wakeWavetableLoader();
+}
+
+void SurgeStorage::reclaimModulationRouting()
+{
+    auto tail = retiredModRoutingTail.load(std::memory_order_relaxed);
+    auto head = retiredModRoutingHead.load(std::memory_order_acquire);
+
+    for (; tail != head; ++tail)
+    {
+        delete retiredModRouting[tail % retiredModRoutingSlots];
+        retiredModRouting[tail % retiredModRoutingSlots] = nullptr;
+    }
+    retiredModRoutingTail.store(tail, std::memory_order_release);
+
+    if (modRoutingRebuildRequested.load(std::memory_order_acquire))
+    {
+        publishModulationRouting();
+    }
 }
 
 double shafted_tanh(double x) { return (exp(x) - exp(-x * 1.2)) / (exp(x) + exp(-x)); }
@@ -3018,6 +3504,15 @@ float SurgeStorage::remapKeyInMidiOnlyMode(float res)
     return res;
 }
 
+void FormulaModulatorStorage::setFormula(const std::string &s)
+{
+    formulaString = s;
+    formulaHash = std::hash<std::string>{}(s);
+
+    auto prior = std::atomic_exchange(&nativeProgram, Surge::Formula::compileNativeProgram(s));
+    Surge::Formula::retireNativeProgram(std::move(prior));
+}
+
 namespace Surge
 {
 namespace Storage
@@ -34,7 +34,10 @@
 #include <vector>
 #include <memory>
 #include <mutex>
+#include <condition_variable>
+#include <thread>
 #include <atomic>
+#include <bitset>
 #include <cstdint>
 #include <fstream>
 #include <iterator>
@@ -849,22 +852,34 @@ struct MSEGStorage
     static constexpr float minimumDuration = 0.0;
 };
 
+namespace Surge
+{
+namespace Formula
+{
+struct NativeProgram;
+}
+} // namespace Surge
+
 struct FormulaModulatorStorage
 {
     std::string formulaString = "";
     size_t formulaHash = 0;
 
+    /*
+     * The formula's process lowered to native code, if it is simple enough (see
+     * FormulaExpressionCompiler.h), or nullptr. setFormula compiles it on the calling thread so
+     * the audio thread never has to. The editor can replace it while voices run, so read it
+     * with std::atomic_load.
+     */
+    std::shared_ptr<const Surge::Formula::NativeProgram> nativeProgram;
+
     // these values stream so don't change the numerical equivalents
     enum Interpreter
     {
         LUA = 1001
     } interpreter = LUA;
 
-    void setFormula(const std::string &s)
-    {
-        formulaString = s;
-        formulaHash = std::hash<std::string>{}(s);
-    }
+    void setFormula(const std::string &s);
 };
 
 /*
@@ -1013,11 +1028,38 @@ class SurgePatch
     void copy_scenedata(pdata *, int scene);
     void copy_globaldata(pdata *);
 
+    /*
+     * processControl doesn't copy every parameter into globaldata and scenedata each block.
+     * Instead copy_changed_data copies the ones marked as changed since the last block: the
+     * Parameter setters mark themselves, and code which rebuilds large parts of the patch
+     * (update_controls, FX type changes, oscillator preset loads) marks everything. A scene
+     * which starts playing again is copied in full, and so is everything after a patch load.
+     * Anything which writes Parameter::val directly rather than through a setter should call
+     * markChanged() afterwards. As a safety net for writes which don't, each call also
+     * re-copies a rotating window of parameterSweepPerBlock parameters, which bounds how long
+     * such a write can go unnoticed.
+     */
+    void markParameterChanged(int id);
+    void markAllParametersChanged();
+    void copy_changed_data(const bool copyScene[n_scenes]);
+    static constexpr int parameterSweepPerBlock = 64;
+
+    /*
+     * processControl adds scene and global modulation onto scenedata and globaldata in place,
+     * so it reports each slot it touched here (scene -1 being globaldata) and the next
+     * copy_changed_data puts the unmodulated value back.
+     */
+    void markModulated(int scene, int index);
+
     // load/save
     // void load_xml();
     // void save_xml();
     void load_xml(const void *data, int size, bool preset);
     unsigned int save_xml(void **data);
+
+    // load_xml in two halves: parse_xml fills doc and touches nothing in the patch
+    bool parse_xml(const void *data, int size, TiXmlDocument &doc);
+    void load_xml(TiXmlDocument &doc, bool preset);
     unsigned int save_RIFF(void **data);
 
     // Factor these so the LFO preset mechanism can use them as well
@@ -1030,6 +1072,21 @@ class SurgePatch
 
     void load_patch(const void *data, int size, bool preset);
     unsigned int save_patch(void **data);
+
+    /*
+     * load_patch split the same way. prepare_patch parses the XML and builds the embedded
+     * wavetables into a PreparedLoad without touching the patch, so a loader can do that while
+     * the previous patch is still playing. Applying it with load_patch then only streams the
+     * document in and swaps the built tables into the oscillators.
+     */
+    struct PreparedLoad
+    {
+        bool hasXML{false};
+        TiXmlDocument doc;
+        std::unique_ptr<Wavetable> wavetables[n_scenes][n_oscs];
+    };
+    bool prepare_patch(const void *data, int size, PreparedLoad &prepared);
+    void load_patch(PreparedLoad &prepared, bool preset);
     Parameter *parameterFromOSCName(std::string stName);
 
     // data
@@ -1116,6 +1173,32 @@ class SurgePatch
     int32_t paramModulationCount{0};
     static constexpr int maxMonophonicParamModulations = 256;
     std::array<MonophonicParamModulation, maxMonophonicParamModulations> monophonicParamModulations;
+    static void applyMonophonicParamModulation(pdata &d, const MonophonicParamModulation &pm);
+
+    static constexpr int changedParamWords = (n_total_params + 63) / 64;
+    std::array<std::atomic<uint64_t>, changedParamWords> changedParams{};
+    std::atomic<bool> allParamsChanged{true};
+    bool sceneDataCurrent[n_scenes]{};
+    int paramSweepPosition{0};
+
+    static constexpr int dataSlots = n_global_params + n_scenes * n_scene_params;
+    std::array<int, dataSlots> modulatedSlots;
+    std::bitset<dataSlots> slotIsModulated;
+    int modulatedSlotCount{0};
+};
+
+/*
+ * An immutable copy of the patch's modulation routing lists, which is what the audio thread
+ * reads. See SurgeStorage::publishModulationRouting.
+ */
+struct ModulationRoutingSnapshot
+{
+    std::vector<ModulationRouting> global;
+    std::vector<ModulationRouting> scene[n_scenes], voice[n_scenes];
+
+    // meta controller i's modulation source moves to slot controllerOrder[i] along with these
+    // lists, so a controller swap and its routing change land in the same block
+    std::array<int, n_customcontrollers> controllerOrder;
 };
 
 struct Patch
@@ -1354,8 +1437,66 @@ class alignas(16) SurgeStorage
 
     void perform_queued_wtloads();
 
+    /*
+     * While the audio engine runs, queued wavetable loads don't happen on the audio thread.
+     * hand_off_queued_wtloads() (called from processControl) moves each oscillator's queued
+     * load into its slot, marks the slot as requested and wakes wavetableLoaderThread. That
+     * thread does the list lookup, file I/O, BuildWT and MipMapWT into the slot's staging
+     * Wavetable, without touching the oscillator. Once the staged table is ready, the next
+     * hand_off swaps it into place with Wavetable::swapContents, which only exchanges
+     * pointers. The table that was swapped out is freed back on the loader thread.
+     *
+     * Loading a patch bumps wavetableLoadGeneration. A slot requested before that is stale:
+     * whatever it builds is thrown away rather than replacing the patch's own table.
+     */
+    void hand_off_queued_wtloads();
+
+    // queue a wavetable load onto an oscillator from outside the audio thread
+    void queue_wt_load(OscillatorStorage *osc, int id);
+    void queue_wt_load(OscillatorStorage *osc, const std::string &filename);
+
+    struct WavetableLoadSlot
+    {
+        enum State
+        {
+            IDLE,
+            REQUESTED,
+            READY,
+            RECLAIM
+        };
+        std::atomic<int> state{IDLE};
+        std::atomic<uint32_t> generation{0};
+        int queueId{-1};
+        std::string queueFilename;
+        Wavetable staged;
+        std::string displayName;
+    };
+
+    void wavetableLoaderLoop();
+    void wakeWavetableLoader();
+    bool stage_queued_wtload(int scene, int osc);
+    void swap_in_staged_wtload(int scene, int osc);
+
+    WavetableLoadSlot wtLoadSlots[n_scenes][n_oscs];
+    std::thread wavetableLoaderThread;
+    std::mutex wavetableLoaderMutex;
+    std::condition_variable wavetableLoaderCV;
+    std::atomic<bool> wavetableLoadRequested{false}, wavetableLoaderRunning{true};
+    std::atomic<uint32_t> wavetableLoadGeneration{0};
+    // guards the oscillators' wt.queue_id and wt.queue_filename; the audio thread only try_locks
+    std::mutex wavetableQueueMutex;
+
+    // freshly built tables waiting for the loader thread to write them to wavetableCachePath
+    void queue_wt_cache_write(const std::string &key, std::shared_ptr<const Wavetable> built);
+    // removes every image from wavetableCachePath; they are rebuilt as tables are next loaded
+    void clear_wavetable_cache();
+    std::mutex wavetableCacheWritesMutex;
+    std::vector<std::pair<std::string, std::shared_ptr<const Wavetable>>> wavetableCacheWrites;
+
     void load_wt(int id, Wavetable *wt, OscillatorStorage *);
     void load_wt(std::string filename, Wavetable *wt, OscillatorStorage *);
+    void load_wt_into(int id, Wavetable *wt, std::string *displayName);
+    void load_wt_into(std::string filename, Wavetable *wt, std::string *displayName);
     bool load_wt_wt(std::string filename, Wavetable *wt);
     bool load_wt_wt_mem(const char *data, const size_t dataSize, Wavetable *wt);
     bool load_wt_wav_portable(std::string filename, Wavetable *wt);
@@ -1406,6 +1547,7 @@ class alignas(16) SurgeStorage
     fs::path userWavetablesExportPath;
     fs::path userSkinsPath;
     fs::path userMidiMappingsPath;
+    fs::path wavetableCachePath; // the platform cache folder, or empty if there is none
     fs::path extraThirdPartyWavetablesPath; // used by rack
     fs::path extraUserWavetablesPath;       // used by rack
 
@@ -1420,6 +1562,73 @@ class alignas(16) SurgeStorage
 
     std::mutex waveTableDataMutex;
     std::recursive_mutex modRoutingMutex;
+
+    /*
+     * The audio thread doesn't take modRoutingMutex to read the routing. Code which edits
+     * modulation_global, modulation_scene or modulation_voice does so holding the mutex as
+     * before, and then calls publishModulationRouting, which copies the lists into a new
+     * snapshot and hands it over. Called on the audio thread (a patch or FX load from
+     * processControl) it only flags the lists as changed, and the wavetable loader thread
+     * builds and publishes the snapshot instead.
+     *
+     * At the start of each block the audio thread calls acquireModulationRouting, which picks
+     * up the latest snapshot without locking or allocating and pushes the one it replaces onto
+     * retiredModRouting. The loader thread drains that queue and frees them. If the queue is
+     * full the audio thread keeps the newer snapshot pending until there is room.
+     */
+    void publishModulationRouting();
+    void acquireModulationRouting();
+    void reclaimModulationRouting();
+
+    /*
+     * The audio thread reads the meta controllers' modulation sources through the patch, so
+     * swapping two of them is queued here (with modRoutingMutex held) and applied by
+     * acquireModulationRouting along with the routing which refers to them.
+     */
+    void queueMetaControllerSwap(int c1, int c2);
+    std::array<int, n_customcontrollers> pendingControllerOrder;
+
+    // set for the duration of SurgeSynthesizer::process on the thread which calls it
+    static inline thread_local bool onAudioThread{false};
+    struct ScopedAudioThread
+    {
+        ScopedAudioThread() : prior(onAudioThread) { onAudioThread = true; }
+        ~ScopedAudioThread() { onAudioThread = prior; }
+
+        ScopedAudioThread(const ScopedAudioThread &) = delete;
+        ScopedAudioThread &operator=(const ScopedAudioThread &) = delete;
+
+      private:
+        bool prior;
+    };
+
+    /*
+     * While a ModulationRoutingBatch is alive it holds modRoutingMutex, and edits which call
+     * publishModulationRouting only note that they need to. The last batch to go away
+     * publishes once, so a run of edits costs one snapshot rather than one each.
+     */
+    struct ModulationRoutingBatch
+    {
+        explicit ModulationRoutingBatch(SurgeStorage *storage);
+        ~ModulationRoutingBatch();
+
+        SurgeStorage *storage;
+    };
+    int modRoutingBatchDepth{0};
+    bool modRoutingPublishDeferred{false};
+
+    const ModulationRoutingSnapshot &audioModulationRouting() const { return *activeModRouting; }
+
+    std::unique_ptr<ModulationRoutingSnapshot> activeModRouting;
+    std::atomic<ModulationRoutingSnapshot *> pendingModRouting{nullptr};
+    std::atomic<bool> modRoutingRebuildRequested{false};
+
+    // written only by the audio thread at retiredModRoutingHead, read and freed only by the
+    // loader thread at retiredModRoutingTail
+    static constexpr uint32_t retiredModRoutingSlots = 16;
+    std::array<ModulationRoutingSnapshot *, retiredModRoutingSlots> retiredModRouting{};
+    std::atomic<uint32_t> retiredModRoutingHead{0}, retiredModRoutingTail{0};
+
     Wavetable WindowWT;
 
     // hardclip
@@ -1706,6 +1915,35 @@ class alignas(16) SurgeStorage
         std::uniform_int_distribution<uint32_t> u32;
     } rngGen;
 
+    /*
+     * A thread can point its random draws at another generator here. Each voice installs its
+     * own generator while it is constructed and while it renders (see SurgeVoice::rng), so
+     * what a voice draws doesn't depend on which thread renders it. The render worker
+     * threads also install one of their own, so anything else they draw stays off rngGen.
+     * This is per thread, not per storage.
+     */
+    static inline thread_local RNGGen *renderThreadRNGGen{nullptr};
+    inline RNGGen &currentRNGGen()
+    {
+        return renderThreadRNGGen ? *renderThreadRNGGen : rngGen;
+    }
+
+    // Installs a generator as this thread's renderThreadRNGGen until it goes out of scope
+    struct ScopedRenderRNG
+    {
+        explicit ScopedRenderRNG(RNGGen &gen) : prior(renderThreadRNGGen)
+        {
+            renderThreadRNGGen = &gen;
+        }
+        ~ScopedRenderRNG() { renderThreadRNGGen = prior; }
+
+        ScopedRenderRNG(const ScopedRenderRNG &) = delete;
+        ScopedRenderRNG &operator=(const ScopedRenderRNG &) = delete;
+
+      private:
+        RNGGen *prior;
+    };
+
 #define DEBUG_RNG_THREADING 0
 #if DEBUG_RNG_THREADING
     std::thread::id audioThreadID{0};
@@ -1728,22 +1966,26 @@ class alignas(16) SurgeStorage
     inline int rand()
     {
         runningOnAudioThread();
-        return rngGen.d(rngGen.g);
+        auto &r = currentRNGGen();
+        return r.d(r.g);
     }
     inline uint32_t rand_u32()
     {
         runningOnAudioThread();
-        return rngGen.u32(rngGen.g);
+        auto &r = currentRNGGen();
+        return r.u32(r.g);
     }
     inline float rand_pm1()
     {
         runningOnAudioThread();
-        return rngGen.pm1(rngGen.g);
+        auto &r = currentRNGGen();
+        return r.pm1(r.g);
     }
     inline float rand_01()
     {
         runningOnAudioThread();
-        return rngGen.z1(rngGen.g);
+        auto &r = currentRNGGen();
+        return r.z1(r.g);
     }
 // void seed_rand(int s) { rngGen.g.seed(s); }
 #else
@@ -40,6 +40,7 @@
 #endif
 
 #include "SurgeMemoryPools.h"
+#include "FormulaExpressionCompiler.h"
 
 #include "sst/basic-blocks/mechanics/block-ops.h"
 #include "sst/basic-blocks/dsp/Clippers.h"
@@ -52,6 +53,16 @@ namespace cutl = sst::cpputils;
 
 using CMSKey = ControllerModulationSourceVector<1>; // sigh see #4286 for failed first try
 
+namespace
+{
+// this synth tells the host about the patch, so the standby engine has nobody to tell
+struct PatchSwitchPluginLayer : SurgeSynthesizer::PluginLayer
+{
+    void surgeParameterUpdated(const SurgeSynthesizer::ID &, float) override {}
+    void surgeMacroUpdated(long, float) override {}
+} patchSwitchPluginLayer;
+} // namespace
+
 SurgeSynthesizer::SurgeSynthesizer(PluginLayer *parent, const std::string &suppliedDataPath)
     : storage(suppliedDataPath), hpA{cutl::make_array<BiquadFilter, n_hpBQ>(&storage)},
       hpB{cutl::make_array<BiquadFilter, n_hpBQ>(&storage)}, _parent(parent), halfbandA(6, true),
@@ -60,6 +71,7 @@ SurgeSynthesizer::SurgeSynthesizer(PluginLayer *parent, const std::string &suppl
     switch_toggled_queued = false;
     audio_processing_active = false;
     halt_engine = false;
+    patchSwitchDataPath = suppliedDataPath;
     release_if_latched[0] = true;
     release_if_latched[1] = true;
     release_anyway[0] = false;
@@ -93,6 +105,7 @@ SurgeSynthesizer::SurgeSynthesizer(PluginLayer *parent, const std::string &suppl
     for (int i = 0; i < n_fx_slots; i++)
     {
         fxsync[i] = storage.getPatch().fx[i];
+        fxLoadSlots[i].staging = storage.getPatch().fx[i];
         fx_reload[i] = false;
         fx_reload_mod[i] = false;
     }
@@ -124,6 +137,13 @@ SurgeSynthesizer::SurgeSynthesizer(PluginLayer *parent, const std::string &suppl
 
     patch.polylimit.val.i = DEFAULT_POLYLIMIT;
 
+    setRenderScenesInParallel(
+        Surge::Storage::getUserDefaultValue(&storage, Surge::Storage::RenderScenesInParallel, 0));
+    setVoiceRenderThreads(
+        Surge::Storage::getUserDefaultValue(&storage, Surge::Storage::VoiceRenderThreads, 0));
+    sampleAccurateNoteOnsets =
+        Surge::Storage::getUserDefaultValue(&storage, Surge::Storage::SampleAccurateNoteOnsets, 0);
+
     for (int sc = 0; sc < n_scenes; sc++)
     {
         SurgeSceneStorage &scene = patch.scene[sc];
@@ -292,19 +312,26 @@ SurgeSynthesizer::SurgeSynthesizer(PluginLayer *parent, const std::string &suppl
 
     patchid_queue = -1;
     has_patchid_file = false;
+
+    patchLoaderThread = std::thread([this]() { patchLoaderLoop(); });
+    fxLoaderThread = std::thread([this]() { fxLoaderLoop(); });
 }
 
 SurgeSynthesizer::~SurgeSynthesizer()
 {
     {
-        /*
-         * This should "never" happen due to cleanup at end of
-         * loadPatchInBackgroundThread
-         */
-        std::lock_guard<std::mutex> mg(patchLoadSpawnMutex);
-        if (patchLoadThread)
-            patchLoadThread->join();
+        std::lock_guard<std::mutex> lk(patchLoaderMutex);
+        patchLoaderRunning = false;
     }
+    patchLoaderCV.notify_one();
+    patchLoaderThread.join();
+
+    {
+        std::lock_guard<std::mutex> lk(fxLoaderMutex);
+        fxLoaderRunning = false;
+    }
+    fxLoaderCV.notify_one();
+    fxLoaderThread.join();
 
     stopSound();
 
@@ -416,6 +443,12 @@ int SurgeSynthesizer::calculateChannelMask(int channel, int key)
 void SurgeSynthesizer::playNote(char channel, char key, char velocity, char detune,
                                 int32_t host_noteid, int32_t forceScene)
 {
+    PatchSwitchEvent ev(this, true);
+    if (ev.standby)
+        ev.standby->playNote(channel, key, velocity, detune, host_noteid, forceScene);
+    if (!ev.here)
+        return;
+
     if (halt_engine)
     {
         return;
@@ -439,12 +472,14 @@ void SurgeSynthesizer::playNote(char channel, char key, char velocity, char detu
         if (sm == scene_mode::sm_split)
         {
             storage.getPatch().param_ptr[learn_param_from_note]->val.i = key;
+            storage.getPatch().param_ptr[learn_param_from_note]->markChanged();
             refresh_editor = true;
         }
 
         if (sm == scene_mode::sm_chsplit)
         {
             storage.getPatch().param_ptr[learn_param_from_note]->val.i = channel * 8;
+            storage.getPatch().param_ptr[learn_param_from_note]->markChanged();
             refresh_editor = true;
         }
 
@@ -525,6 +560,12 @@ void SurgeSynthesizer::playNote(char channel, char key, char velocity, char detu
 // This supports an OSC message that specifies pitch by frequency (rather than by MIDI note number)
 void SurgeSynthesizer::playNoteByFrequency(float freq, char velocity, int32_t id)
 {
+    PatchSwitchEvent ev(this, true);
+    if (ev.standby)
+        ev.standby->playNoteByFrequency(freq, velocity, id);
+    if (!ev.here)
+        return;
+
     auto k = 12 * log2(freq / 440) + 69;
     auto mk = (int)std::floor(k);
     auto off = k - mk;
@@ -537,7 +578,7 @@ void SurgeSynthesizer::playNoteByFrequency(float freq, char velocity, int32_t id
 
 void SurgeSynthesizer::softkillVoice(int s)
 {
-    list<SurgeVoice *>::iterator iter, max_playing, max_released;
+    ActiveVoiceTable::iterator iter, max_playing, max_released;
     int max_age = -1, max_age_release = -1;
     iter = voices[s].begin();
 
@@ -572,7 +613,7 @@ void SurgeSynthesizer::softkillVoice(int s)
 // only allow 'margin' number of voices to be softkilled simultaneously
 void SurgeSynthesizer::enforcePolyphonyLimit(int s, int margin)
 {
-    list<SurgeVoice *>::iterator iter;
+    ActiveVoiceTable::iterator iter;
 
     int paddedPoly = std::min((storage.getPatch().polylimit.val.i + margin), MAX_VOICES - 1);
     if (voices[s].size() > paddedPoly)
@@ -647,46 +688,38 @@ SurgeVoice *SurgeSynthesizer::getUnusedVoice(int scene)
 
 void SurgeSynthesizer::freeVoice(SurgeVoice *v)
 {
-    if (v->host_note_id >= 0)
+    int foundScene{-1}, foundIndex{-1};
+    for (int s = 0; s < n_scenes; ++s)
     {
-        bool used_away = false;
-        // does any other voice have this voiceid
-        for (int s = 0; s < n_scenes; ++s)
-        {
-            for (auto vo : voices[s])
-            {
-                if (vo != v && vo->host_note_id == v->host_note_id)
-                {
-                    used_away = true;
-                }
-            }
-        }
-        if (!used_away)
+        auto first = voices_array[s].data();
+        if (v >= first && v < first + MAX_VOICES)
         {
-            notifyEndedNote(v->host_note_id, v->originating_host_key, v->originating_host_channel);
+            foundScene = s;
+            foundIndex = (int)(v - first);
         }
     }
+    assert(foundScene >= 0);
+    assert(voices_usedby[foundScene][foundIndex]);
 
-    int foundScene{-1}, foundIndex{-1};
-    for (int i = 0; i < MAX_VOICES; i++)
+    if (v->host_note_id >= 0)
     {
-        if (voices_usedby[0][i] && (v == &voices_array[0][i]))
+        // does any other voice have this voiceid
+        int sharing = 0;
+        for (int s = 0; s < n_scenes; ++s)
         {
-            assert(foundScene == -1);
-            assert(foundIndex == -1);
-            foundScene = 0;
-            foundIndex = i;
-            voices_usedby[0][i] = 0;
+            sharing += voices[s].countWithHostNoteId(v->host_note_id);
         }
-        if (voices_usedby[1][i] && (v == &voices_array[1][i]))
+        if (voices[foundScene].contains(v))
         {
-            assert(foundScene == -1);
-            assert(foundIndex == -1);
-            foundScene = 1;
-            foundIndex = i;
-            voices_usedby[1][i] = 0;
+            sharing--;
+        }
+        if (sharing <= 0)
+        {
+            notifyEndedNote(v->host_note_id, v->originating_host_key, v->originating_host_channel);
         }
     }
+
+    voices_usedby[foundScene][foundIndex] = 0;
     v->freeAllocatedElements();
 
     /*
@@ -828,13 +861,14 @@ void SurgeSynthesizer::playVoice(int scene, char channel, char key, char velocit
 
                 int mpeMainChannel = getMpeMainChannel(channel, key);
 
-                voices[scene].push_back(nvoice);
                 new (nvoice) SurgeVoice(&storage, &storage.getPatch().scene[scene],
                                         storage.getPatch().scenedata[scene], key, velocity, channel,
                                         scene, detune, &channelState[channel].keyState[key],
                                         &channelState[mpeMainChannel], &channelState[channel],
                                         mpeEnabled, voiceCounter++, host_noteid,
                                         host_originating_key, host_originating_channel, 0.f, 0.f);
+                nvoice->setOnsetDelay(noteOnsetOffset);
+                voices[scene].push_back(nvoice);
             }
         }
         break;
@@ -843,7 +877,7 @@ void SurgeSynthesizer::playVoice(int scene, char channel, char key, char velocit
     case pm_mono_fp:
     case pm_latch:
     {
-        list<SurgeVoice *>::const_iterator iter;
+        ActiveVoiceTable::const_iterator iter;
         bool glide = false;
 
         int primode = storage.getPatch().scene[scene].monoVoicePriorityMode;
@@ -970,7 +1004,6 @@ void SurgeSynthesizer::playVoice(int scene, char channel, char key, char velocit
                 {
                     int mpeMainChannel = getMpeMainChannel(channel, key);
 
-                    voices[scene].push_back(nvoice);
                     if ((storage.getPatch().scene[scene].polymode.val.i == pm_mono_fp) && !glide)
                         storage.last_key[scene] = key;
                     new (nvoice) SurgeVoice(
@@ -979,6 +1012,8 @@ void SurgeSynthesizer::playVoice(int scene, char channel, char key, char velocit
                         &channelState[channel].keyState[key], &channelState[mpeMainChannel],
                         &channelState[channel], mpeEnabled, voiceCounter++, host_noteid,
                         host_originating_key, host_originating_channel, aegReuse, fegReuse);
+                    nvoice->setOnsetDelay(noteOnsetOffset);
+                    voices[scene].push_back(nvoice);
 
                     if (wasGated && pkeyToReuse > 0)
                     {
@@ -1068,7 +1103,7 @@ void SurgeSynthesizer::playVoice(int scene, char channel, char key, char velocit
 
         if (createVoice)
         {
-            list<SurgeVoice *>::const_iterator iter;
+            ActiveVoiceTable::const_iterator iter;
             SurgeVoice *recycleThis{nullptr};
             float aegStart{0.}, fegStart{0.};
             for (iter = voices[scene].begin(); iter != voices[scene].end(); iter++)
@@ -1090,6 +1125,7 @@ void SurgeSynthesizer::playVoice(int scene, char channel, char key, char velocit
                         v->state.channel = channel;
                         v->state.voiceChannelState = &channelState[channel];
                     }
+                    voices[scene].updateNote(v);
                     break;
                 }
                 else
@@ -1116,13 +1152,14 @@ void SurgeSynthesizer::playVoice(int scene, char channel, char key, char velocit
                 SurgeVoice *nvoice = getUnusedVoice(scene);
                 if (nvoice)
                 {
-                    voices[scene].push_back(nvoice);
                     new (nvoice) SurgeVoice(
                         &storage, &storage.getPatch().scene[scene],
                         storage.getPatch().scenedata[scene], key, velocity, channel, scene, detune,
                         &channelState[channel].keyState[key], &channelState[mpeMainChannel],
                         &channelState[channel], mpeEnabled, voiceCounter++, host_noteid,
                         host_originating_key, host_originating_channel, aegStart, fegStart);
+                    nvoice->setOnsetDelay(noteOnsetOffset);
+                    voices[scene].push_back(nvoice);
                 }
             }
             else
@@ -1163,12 +1200,12 @@ void SurgeSynthesizer::playVoice(int scene, char channel, char key, char velocit
 
 void SurgeSynthesizer::releaseScene(int s)
 {
-    list<SurgeVoice *>::const_iterator iter;
-    for (iter = voices[s].begin(); iter != voices[s].end(); iter++)
+    while (!voices[s].empty())
     {
-        freeVoice(*iter);
+        auto v = voices[s].front();
+        voices[s].erase(voices[s].begin());
+        freeVoice(v);
     }
-    voices[s].clear();
 
     for (int i = 0; i < n_hpBQ; ++i)
     {
@@ -1186,6 +1223,12 @@ void SurgeSynthesizer::releaseScene(int s)
 
 void SurgeSynthesizer::chokeNote(int16_t channel, int16_t key, char velocity, int32_t host_noteid)
 {
+    PatchSwitchEvent ev(this, false);
+    if (ev.standby)
+        ev.standby->chokeNote(channel, key, velocity, host_noteid);
+    if (!ev.here)
+        return;
+
     /*
      * The strategy here is pretty simple. Do a release note, then go find any voice
      * that matches me and do an uber-release. There may be some wierdo MPE mono
@@ -1196,30 +1239,45 @@ void SurgeSynthesizer::chokeNote(int16_t channel, int16_t key, char velocity, in
 
     for (int sc = 0; sc < n_scenes; ++sc)
     {
-        for (auto *v : voices[sc])
-        {
+        auto choke = [&](SurgeVoice *v) {
             if (v->matchesChannelKeyId(channel, key, host_noteid))
             {
                 v->uber_release();
             }
+        };
+
+        // a wildcard channel or key has to look at every voice
+        if (channel >= 0 && key >= 0)
+        {
+            voices[sc].forEachWithNote(channel, key, choke);
+        }
+        else
+        {
+            for (auto *v : voices[sc])
+            {
+                choke(v);
+            }
         }
     }
 }
 
 void SurgeSynthesizer::releaseNote(char channel, char key, char velocity, int32_t host_noteid)
 {
+    PatchSwitchEvent ev(this, false);
+    if (ev.standby)
+        ev.standby->releaseNote(channel, key, velocity, host_noteid);
+    if (!ev.here)
+        return;
+
     midiNoteEvents++;
     bool foundVoice[n_scenes];
     for (int sc = 0; sc < n_scenes; ++sc)
     {
-        foundVoice[sc] = false;
-        for (auto *v : voices[sc])
-        {
-            foundVoice[sc] = true;
-            if ((v->state.key == key) && (v->state.channel == channel) &&
-                (host_noteid < 0 || v->host_note_id == host_noteid))
+        foundVoice[sc] = !voices[sc].empty();
+        voices[sc].forEachWithNote(channel, key, [&](SurgeVoice *v) {
+            if (host_noteid < 0 || v->host_note_id == host_noteid)
                 v->state.releasevelocity = velocity;
-        }
+        });
     }
 
     /*
@@ -1309,8 +1367,20 @@ void SurgeSynthesizer::releaseNotePostHoldCheck(int scene, char channel, char ke
                                                 int32_t host_noteid)
 {
     channelState[channel].keyState[key].keystate = 0;
-    list<SurgeVoice *>::const_iterator iter;
-    for (int s = 0; s < n_scenes; s++)
+
+    // In poly mode a release only concerns the voices playing this note, which the voice
+    // table indexes. The mono modes below need to look at every voice and the held keys.
+    bool scenePoly = storage.getPatch().scene[scene].polymode.val.i == pm_poly;
+    if (scenePoly)
+    {
+        voices[scene].forEachWithNote(channel, key, [&](SurgeVoice *v) {
+            if (v->state.gate && (host_noteid < 0 || v->host_note_id == host_noteid))
+                v->release();
+        });
+    }
+
+    ActiveVoiceTable::const_iterator iter;
+    for (int s = 0; s < n_scenes && !scenePoly; s++)
     {
         bool do_switch = false;
         int k = 0;
@@ -1643,6 +1713,7 @@ void SurgeSynthesizer::releaseNotePostHoldCheck(int scene, char channel, char ke
                         if (k >= 0)
                         {
                             v->legato(k, velocity, channelState[channel].keyState[k].lastdetune);
+                            voices[scene].updateNote(v);
                             do_release = false;
                         }
                     }
@@ -1712,6 +1783,7 @@ void SurgeSynthesizer::releaseNotePostHoldCheck(int scene, char channel, char ke
 
                             v->state.channel = ch;
                             v->state.voiceChannelState = &channelState[ch];
+                            voices[scene].updateNote(v);
                         }
                     }
                     else
@@ -1773,6 +1845,7 @@ void SurgeSynthesizer::releaseNotePostHoldCheck(int scene, char channel, char ke
                             // See the comment above at the other _st legato spot
                             v->state.channel = kchan;
                             v->state.voiceChannelState = &channelState[kchan];
+                            voices[scene].updateNote(v);
                             // std::cout << _D(v->state.gate) << _D(v->state.key) <<
                             // _D(v->state.scene_id ) << std::endl;
                         }
@@ -1801,6 +1874,12 @@ void SurgeSynthesizer::releaseNotePostHoldCheck(int scene, char channel, char ke
 
 void SurgeSynthesizer::releaseNoteByHostNoteID(int32_t host_noteid, char velocity)
 {
+    PatchSwitchEvent ev(this, false);
+    if (ev.standby)
+        ev.standby->releaseNoteByHostNoteID(host_noteid, velocity);
+    if (!ev.here)
+        return;
+
     std::array<uint16_t, 128> done;
     std::fill(done.begin(), done.end(), 0);
 
@@ -1861,6 +1940,12 @@ void SurgeSynthesizer::releaseNoteByHostNoteID(int32_t host_noteid, char velocit
 void SurgeSynthesizer::setNoteExpression(SurgeVoice::NoteExpressionType net, int32_t note_id,
                                          int16_t key, int16_t channel, float value)
 {
+    PatchSwitchEvent ev(this, false);
+    if (ev.standby)
+        ev.standby->setNoteExpression(net, note_id, key, channel, value);
+    if (!ev.here)
+        return;
+
     for (int sc = 0; sc < n_scenes; sc++)
     {
         for (auto v : voices[sc])
@@ -1961,6 +2046,12 @@ void SurgeSynthesizer::resetPitchBend(int8_t channel)
 
 void SurgeSynthesizer::pitchBend(char channel, int value)
 {
+    PatchSwitchEvent ev(this, false);
+    if (ev.standby)
+        ev.standby->pitchBend(channel, value);
+    if (!ev.here)
+        return;
+
     if (mpeEnabled && channel != 0)
     {
         channelState[channel].pitchBend = value;
@@ -2002,6 +2093,12 @@ void SurgeSynthesizer::pitchBend(char channel, int value)
 
 void SurgeSynthesizer::channelAftertouch(char channel, int value)
 {
+    PatchSwitchEvent ev(this, false);
+    if (ev.standby)
+        ev.standby->channelAftertouch(channel, value);
+    if (!ev.here)
+        return;
+
     float fval = (float)value / 127.f;
 
     channelState[channel].pressure = fval;
@@ -2018,6 +2115,12 @@ void SurgeSynthesizer::channelAftertouch(char channel, int value)
 
 void SurgeSynthesizer::polyAftertouch(char channel, int key, int value)
 {
+    PatchSwitchEvent ev(this, false);
+    if (ev.standby)
+        ev.standby->polyAftertouch(channel, key, value);
+    if (!ev.here)
+        return;
+
     float fval = (float)value / 127.f;
     storage.poly_aftertouch[0][channel][key & 127] = fval;
     storage.poly_aftertouch[1][channel][key & 127] = fval;
@@ -2111,6 +2214,12 @@ float int7ToBipolarFloat(int x)
 
 void SurgeSynthesizer::channelController(char channel, int cc, int value)
 {
+    PatchSwitchEvent ev(this, false);
+    if (ev.standby)
+        ev.standby->channelController(channel, cc, value);
+    if (!ev.here)
+        return;
+
     float fval = (float)value * (1.f / 127.f);
 
     // store all possible NRPN & RPNs in a short array... amounts to 128 KB or thereabouts
@@ -2357,12 +2466,24 @@ void SurgeSynthesizer::channelController(char channel, int cc, int value)
 
 void SurgeSynthesizer::allSoundOff()
 {
+    PatchSwitchEvent ev(this, false);
+    if (ev.standby)
+        ev.standby->allSoundOff();
+    if (!ev.here)
+        return;
+
     approachingAllSoundOff = true;
     masterfade = 1.f;
 }
 
 void SurgeSynthesizer::allNotesOff()
 {
+    PatchSwitchEvent ev(this, false);
+    if (ev.standby)
+        ev.standby->allNotesOff();
+    if (!ev.here)
+        return;
+
     /*
      * For now, until we move to a sightly less delicate voice manager,
      * do two things here. First run over all the keys we have pressed. Then
@@ -2509,12 +2630,12 @@ void SurgeSynthesizer::stopSound()
 
     for (int s = 0; s < n_scenes; s++)
     {
-        list<SurgeVoice *>::const_iterator iter;
-        for (iter = voices[s].begin(); iter != voices[s].end(); iter++)
+        while (!voices[s].empty())
         {
-            freeVoice(*iter);
+            auto v = voices[s].front();
+            voices[s].erase(voices[s].begin());
+            freeVoice(v);
         }
-        voices[s].clear();
     }
     holdbuffer[0].clear();
     holdbuffer[1].clear();
@@ -2774,6 +2895,7 @@ bool SurgeSynthesizer::setParameter01(long index, float value, bool external, bo
                     subp->val.i = 0;
                 else
                     subp->val.i = std::min(maxIVal - 1, subp->val.i);
+                subp->markChanged();
                 storage.subtypeMemory[subp->scene - 1][subp->ctrlgroup_entry][filterType] =
                     subp->val.i;
 
@@ -2794,6 +2916,7 @@ bool SurgeSynthesizer::setParameter01(long index, float value, bool external, bo
                 // so funnily we want to set the value *back* so that loadFx picks up the change in
                 // fxsync
                 p->val.i = oldval.i;
+                p->markChanged();
                 Effect *t_fx = spawn_effect(fxsync[cge].type.val.i, &storage, &fxsync[cge], 0);
                 if (t_fx)
                 {
@@ -2825,6 +2948,9 @@ bool SurgeSynthesizer::setParameter01(long index, float value, bool external, bo
                     polarity * storage.getPatch().scene[s].filterunit[0].envmod.val.f;
                 storage.getPatch().scene[s].filterunit[1].keytrack.val.f +=
                     polarity * storage.getPatch().scene[s].filterunit[0].keytrack.val.f;
+                storage.getPatch().scene[s].filterunit[1].cutoff.markChanged();
+                storage.getPatch().scene[s].filterunit[1].envmod.markChanged();
+                storage.getPatch().scene[s].filterunit[1].keytrack.markChanged();
             }
 
             if (down)
@@ -2899,7 +3025,7 @@ void SurgeSynthesizer::switch_toggled()
 {
     for (int s = 0; s < n_scenes; s++)
     {
-        list<SurgeVoice *>::iterator iter;
+        ActiveVoiceTable::iterator iter;
         for (iter = voices[s].begin(); iter != voices[s].end(); iter++)
         {
             SurgeVoice *v = *iter;
@@ -2908,165 +3034,227 @@ void SurgeSynthesizer::switch_toggled()
     }
 }
 
-bool SurgeSynthesizer::loadFx(bool initp, bool force_reload_all)
+bool SurgeSynthesizer::fxSlotNeedsRespawn(int s, bool force_reload_all)
 {
-    load_fx_needed = false;
-    bool localSendFX[n_fx_slots];
-    for (int s = 0; s < n_fx_slots; s++)
+    return (fxsync[s].type.val.i != storage.getPatch().fx[s].type.val.i) || force_reload_all ||
+           fx_reload[s];
+}
+
+Effect *SurgeSynthesizer::spawnFxIntoSlot(int s, bool initp, FxStorage &fxdata, pdata *pd,
+                                          std::unique_ptr<Effect> prebuilt)
+{
+    /*if (!force_reload_all)*/ fxdata.type.val.i = fxsync[s].type.val.i;
+    // else fxsync[s].type.val.i = fxdata.type.val.i;
+
+    for (int j = 0; j < n_fx_params; j++)
     {
-        localSendFX[s] = false;
-        bool something_changed = false;
-        if ((fxsync[s].type.val.i != storage.getPatch().fx[s].type.val.i) || force_reload_all ||
-            fx_reload[s])
-        {
-            localSendFX[s] = true;
-            storage.getPatch().isDirty = true;
-            fx_reload[s] = false;
+        fxdata.p[j].set_type(ct_none);
+        std::string n = "Param ";
+        n += std::to_string(j + 1);
+        fxdata.p[j].set_name(n.c_str());
+        fxdata.p[j].val.i = 0;
+        pd[fxdata.p[j].id].i = 0;
+    }
 
-            std::lock_guard<std::mutex> g(fxSpawnMutex);
+    if (/*!force_reload_all && */ fxdata.type.val.i)
+    {
+        std::copy(std::begin(fxsync[s].p), std::end(fxsync[s].p), std::begin(fxdata.p));
+    }
 
-            fx[s].reset();
-            /*if (!force_reload_all)*/ storage.getPatch().fx[s].type.val.i = fxsync[s].type.val.i;
-            // else fxsync[s].type.val.i = storage.getPatch().fx[s].type.val.i;
+    Effect *res{nullptr};
+    if (prebuilt)
+    {
+        res = prebuilt.release();
+        res->bindParameters(&fxdata, pd);
+    }
+    else
+    {
+        res = spawn_effect(fxdata.type.val.i, &storage, &fxdata, pd);
+    }
 
+    if (res)
+    {
+        res->init_ctrltypes();
+        if (initp)
+        {
+            res->init_default_values();
+        }
+        else
+        {
             for (int j = 0; j < n_fx_params; j++)
             {
-                storage.getPatch().fx[s].p[j].set_type(ct_none);
-                std::string n = "Param ";
-                n += std::to_string(j + 1);
-                storage.getPatch().fx[s].p[j].set_name(n.c_str());
-                storage.getPatch().fx[s].p[j].val.i = 0;
-                storage.getPatch().globaldata[storage.getPatch().fx[s].p[j].id].i = 0;
-            }
-
-            if (/*!force_reload_all && */ storage.getPatch().fx[s].type.val.i)
-            {
-                std::copy(std::begin(fxsync[s].p), std::end(fxsync[s].p),
-                          std::begin(storage.getPatch().fx[s].p));
-            }
+                auto p = &(fxdata.p[j]);
+                /*
+                 * Alright well what the heck is this. "I can remove this" you may be
+                 * thinking? Well - set_extend_range sets up the min and max for a value in
+                 * some cases, and when unstreaming at this point, it is totally unclear
+                 * whether it has been called correctly (and in many cases like move and
+                 * load when I come out as a none but transmogrify to the right type above
+                 * it hasn't) so we just set our extended status back onto ourselves and
+                 * then those side effects which didn't happen through the init path are
+                 * registered here and we can safely check against min and max values
+                 */
+                p->set_extend_range(p->extend_range);
 
-            fx[s].reset(spawn_effect(storage.getPatch().fx[s].type.val.i, &storage,
-                                     &storage.getPatch().fx[s], storage.getPatch().globaldata));
-            if (fx[s])
-            {
-                fx[s]->init_ctrltypes();
-                if (initp)
-                {
-                    fx[s]->init_default_values();
-                }
-                else
+                if (p->ctrltype != ct_none)
                 {
-                    for (int j = 0; j < n_fx_params; j++)
+                    if (p->valtype == vt_float)
                     {
-                        auto p = &(storage.getPatch().fx[s].p[j]);
-                        /*
-                         * Alright well what the heck is this. "I can remove this" you may be
-                         * thinking? Well - set_extend_range sets up the min and max for a value in
-                         * some cases, and when unstreaming at this point, it is totally unclear
-                         * whether it has been called correctly (and in many cases like move and
-                         * load when I come out as a none but transmogrify to the right type above
-                         * it hasn't) so we just set our extended status back onto ourselves and
-                         * then those side effects which didn't happen through the init path are
-                         * registered here and we can safely check against min and max values
-                         */
-                        p->set_extend_range(p->extend_range);
-
-                        if (p->ctrltype != ct_none)
+                        if (p->val.f < p->val_min.f)
                         {
-                            if (p->valtype == vt_float)
-                            {
-                                if (p->val.f < p->val_min.f)
-                                {
-                                    p->val.f = p->val_min.f;
-                                }
-                                if (p->val.f > p->val_max.f)
-                                {
-                                    p->val.f = p->val_max.f;
-                                }
-                            }
-                            else if (p->valtype == vt_int)
-                            {
-                                if (p->val.i < p->val_min.i)
-                                {
-                                    p->val.i = p->val_min.i;
-                                }
-                                if (p->val.i > p->val_max.i)
-                                {
-                                    p->val.i = p->val_max.i;
-                                }
-                            }
+                            p->val.f = p->val_min.f;
                         }
-                    }
-                }
-                /*for(int j=0; j<n_fx_params; j++)
-                {
-                    storage.getPatch().globaldata[storage.getPatch().fx[s].p[j].id].f =
-                    storage.getPatch().fx[s].p[j].val.f;
-                }*/
-
-                fx[s]->init();
-
-                /*
-                ** Clear modulation onto FX otherwise it hangs around from old ones, often with
-                ** disastrously bad meaning. #2036. But only do this if it is a one FX change
-                ** (not a patch load)
-                */
-                if (!force_reload_all)
-                {
-                    for (int j = 0; j < n_fx_params; j++)
-                    {
-                        auto p = &(storage.getPatch().fx[s].p[j]);
-                        for (int ms = 1; ms < n_modsources; ms++)
+                        if (p->val.f > p->val_max.f)
                         {
-                            for (int sc = 0; sc < n_scenes; ++sc)
-                            {
-                                auto mi = getModulationIndicesBetween(p->id, (modsources)ms, sc);
-                                for (auto m : mi)
-                                {
-                                    clearModulation(p->id, (modsources)ms, sc, m, true);
-                                }
-                            }
+                            p->val.f = p->val_max.f;
                         }
                     }
-                    if (fx_reload_mod[s])
+                    else if (p->valtype == vt_int)
                     {
-                        for (auto &t : fxmodsync[s])
+                        if (p->val.i < p->val_min.i)
+                        {
+                            p->val.i = p->val_min.i;
+                        }
+                        if (p->val.i > p->val_max.i)
                         {
-                            setModDepth01(storage.getPatch().fx[s].p[t.whichForReal].id,
-                                          (modsources)t.source_id, t.source_scene, t.source_index,
-                                          t.depth);
-                            muteModulation(storage.getPatch().fx[s].p[t.whichForReal].id,
-                                           (modsources)t.source_id, t.source_scene, t.source_index,
-                                           t.muted);
+                            p->val.i = p->val_max.i;
                         }
-                        fxmodsync[s].clear();
-                        fx_reload_mod[s] = false;
                     }
                 }
             }
-            else
+        }
+        /*for(int j=0; j<n_fx_params; j++)
+        {
+            storage.getPatch().globaldata[storage.getPatch().fx[s].p[j].id].f =
+            storage.getPatch().fx[s].p[j].val.f;
+        }*/
+
+        res->init();
+    }
+
+    return res;
+}
+
+void SurgeSynthesizer::clearFxSlotModulation(int s)
+{
+    for (int j = 0; j < n_fx_params; j++)
+    {
+        auto p = &(storage.getPatch().fx[s].p[j]);
+        for (int ms = 1; ms < n_modsources; ms++)
+        {
+            for (int sc = 0; sc < n_scenes; ++sc)
             {
-                // We have re-loaded to NULL; so we want to clear modulation that points at us
-                // no matter what
-                for (int j = 0; j < n_fx_params; j++)
+                auto mi = getModulationIndicesBetween(p->id, (modsources)ms, sc);
+                for (auto m : mi)
                 {
-                    auto p = &(storage.getPatch().fx[s].p[j]);
-                    for (int ms = 1; ms < n_modsources; ms++)
-                    {
-                        for (int sc = 0; sc < n_scenes; sc++)
-                        {
-                            auto mi = getModulationIndicesBetween(p->id, (modsources)ms, sc);
-                            for (auto m : mi)
-                            {
-                                clearModulation(p->id, (modsources)ms, sc, m, true);
-                            }
-                        }
-                    }
+                    clearModulation(p->id, (modsources)ms, sc, m, true);
+                }
+            }
+        }
+    }
+}
+
+void SurgeSynthesizer::restoreFxSlotModulation(int s)
+{
+    if (fx_reload_mod[s])
+    {
+        for (auto &t : fxmodsync[s])
+        {
+            setModDepth01(storage.getPatch().fx[s].p[t.whichForReal].id, (modsources)t.source_id,
+                          t.source_scene, t.source_index, t.depth);
+            muteModulation(storage.getPatch().fx[s].p[t.whichForReal].id,
+                           (modsources)t.source_id, t.source_scene, t.source_index, t.muted);
+        }
+        fxmodsync[s].clear();
+        fx_reload_mod[s] = false;
+    }
+}
+
+void SurgeSynthesizer::finishFxSlotLoad(int s, bool force_reload_all)
+{
+    if (fx[s])
+    {
+        /*
+        ** Clear modulation onto FX otherwise it hangs around from old ones, often with
+        ** disastrously bad meaning. #2036. But only do this if it is a one FX change
+        ** (not a patch load)
+        */
+        if (!force_reload_all)
+        {
+            clearFxSlotModulation(s);
+            restoreFxSlotModulation(s);
+        }
+    }
+    else
+    {
+        // We have re-loaded to NULL; so we want to clear modulation that points at us
+        // no matter what
+        clearFxSlotModulation(s);
+    }
+
+    refresh_editor = true;
+}
+
+bool SurgeSynthesizer::loadFx(bool initp, bool force_reload_all, PreparedPatch *prepared)
+{
+    load_fx_needed = false;
+
+    // anything the loader thread is still working on has to land before we touch its slot
+    {
+        std::unique_lock<std::mutex> lk(fxLoaderMutex);
+        fxLoadDoneCV.wait(lk, [this]() {
+            for (const auto &slot : fxLoadSlots)
+            {
+                if (slot.state == FxLoadSlot::REQUESTED ||
+                    slot.state == FxLoadSlot::RESTORING_MODULATION)
+                {
+                    return false;
                 }
             }
+            return true;
+        });
+    }
+
+    // the routing edits below go out as one publish
+    SurgeStorage::ModulationRoutingBatch routingBatch(&storage);
+
+    bool localSendFX[n_fx_slots];
+    for (int s = 0; s < n_fx_slots; s++)
+    {
+        localSendFX[s] = false;
+        bool something_changed = false;
+
+        if (fxLoadSlots[s].state == FxLoadSlot::READY)
+        {
+            if (installPreparedFx(s))
+            {
+                restoreFxSlotModulation(s);
+            }
+            fxLoadSlots[s].state = FxLoadSlot::IDLE;
+            localSendFX[s] = true;
+        }
+
+        if (fxSlotNeedsRespawn(s, force_reload_all))
+        {
+            localSendFX[s] = true;
+            storage.getPatch().isDirty = true;
+            fx_reload[s] = false;
+
+            // a patch loader may have constructed this effect already
+            std::unique_ptr<Effect> prebuilt;
+            if (prepared && prepared->fx[s].type == fxsync[s].type.val.i)
+            {
+                prebuilt = std::move(prepared->fx[s].effect);
+            }
+
+            std::lock_guard<std::mutex> g(fxSpawnMutex);
+
+            fx[s].reset();
+            fx[s].reset(spawnFxIntoSlot(s, initp, storage.getPatch().fx[s],
+                                        storage.getPatch().globaldata, std::move(prebuilt)));
+            finishFxSlotLoad(s, force_reload_all);
 
             something_changed = true;
-            refresh_editor = true;
         }
         else if (fx_reload[s])
         {
@@ -3092,6 +3280,11 @@ bool SurgeSynthesizer::loadFx(bool initp, bool force_reload_all)
         {
             fx[s]->updateAfterReload();
         }
+
+        if (something_changed)
+        {
+            storage.getPatch().markAllParametersChanged();
+        }
     }
 
     if (!force_reload_all)
@@ -3106,24 +3299,177 @@ bool SurgeSynthesizer::loadFx(bool initp, bool force_reload_all)
     return true;
 }
 
-bool SurgeSynthesizer::loadOscalgos()
+void SurgeSynthesizer::handOffFxLoads()
 {
-    bool algosChanged{false};
-    bool localResendOscParams[n_scenes][n_oscs];
-    for (int s = 0; s < n_scenes; s++)
+    load_fx_needed = false;
+    bool wake = false;
+
+    for (int s = 0; s < n_fx_slots; s++)
     {
-        for (int i = 0; i < n_oscs; i++)
+        auto &slot = fxLoadSlots[s];
+
+        if (slot.state == FxLoadSlot::READY)
         {
-            localResendOscParams[s][i] = false;
-            if (storage.getPatch().scene[s].osc[i].queue_type > -1)
+            // the routing changes to go with a moved effect are the loader thread's job too
+            if (installPreparedFx(s))
             {
-                algosChanged = true;
-                // clear assigned modulation if we change osc type, see issue #2224
-                if (storage.getPatch().scene[s].osc[i].queue_type !=
-                    storage.getPatch().scene[s].osc[i].type.val.i)
-                {
-                    clear_osc_modulation(s, i);
-                }
+                slot.state = FxLoadSlot::RESTORING_MODULATION;
+                wake = true;
+            }
+            else
+            {
+                slot.state = FxLoadSlot::IDLE;
+            }
+            resendFXParam[s] = true;
+        }
+
+        if (slot.state == FxLoadSlot::REQUESTED ||
+            slot.state == FxLoadSlot::RESTORING_MODULATION)
+        {
+            // look again next block, both for this one landing and for anything queued behind it
+            load_fx_needed = true;
+            continue;
+        }
+
+        if (fxSlotNeedsRespawn(s, false))
+        {
+            storage.getPatch().isDirty = true;
+            fx_reload[s] = false;
+
+            // the slot runs dry until its new effect is ready
+            slot.retired = std::move(fx[s]);
+            slot.state = FxLoadSlot::REQUESTED;
+            load_fx_needed = true;
+            wake = true;
+        }
+    }
+
+    if (wake)
+    {
+        // like the patch loader, don't take the lock on the audio thread; the loader polls too
+        fxLoadRequested = true;
+        fxLoaderCV.notify_one();
+    }
+}
+
+bool SurgeSynthesizer::installPreparedFx(int s)
+{
+    auto &slot = fxLoadSlots[s];
+    auto &patchFx = storage.getPatch().fx[s];
+
+    // swapping only moves the parameters, and leaves the slot with the old ones to reuse
+    patchFx.type.val.i = slot.staging.type.val.i;
+    for (int j = 0; j < n_fx_params; j++)
+    {
+        std::swap(patchFx.p[j], slot.staging.p[j]);
+    }
+
+    fx[s] = std::move(slot.prepared);
+
+    if (fx[s])
+    {
+        fx[s]->bindParameters(&patchFx, storage.getPatch().globaldata);
+    }
+
+    storage.getPatch().markAllParametersChanged();
+    refresh_editor = true;
+
+    return fx[s] && fx_reload_mod[s];
+}
+
+void SurgeSynthesizer::fxLoaderLoop()
+{
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lk(fxLoaderMutex);
+
+            while (!fxLoadRequested && fxLoaderRunning)
+            {
+                fxLoaderCV.wait_for(lk, std::chrono::milliseconds(20));
+            }
+
+            if (!fxLoaderRunning)
+            {
+                return;
+            }
+
+            fxLoadRequested = false;
+        }
+
+        // only slots we worked on change state here; the audio thread owns the others
+        int nextState[n_fx_slots];
+
+        {
+            SurgeStorage::ModulationRoutingBatch routingBatch(&storage);
+
+            for (int s = 0; s < n_fx_slots; s++)
+            {
+                auto &slot = fxLoadSlots[s];
+                nextState[s] = -1;
+
+                if (slot.state == FxLoadSlot::REQUESTED)
+                {
+                    slot.retired.reset();
+
+                    // the slot is dry, so its old modulation can go now rather than at install
+                    clearFxSlotModulation(s);
+
+                    {
+                        std::lock_guard<std::mutex> g(fxSpawnMutex);
+                        slot.prepared.reset(
+                            spawnFxIntoSlot(s, false, slot.staging, slot.scratchData.data()));
+                    }
+
+                    if (slot.prepared)
+                    {
+                        slot.prepared->updateAfterReload();
+                    }
+
+                    nextState[s] = FxLoadSlot::READY;
+                }
+                else if (slot.state == FxLoadSlot::RESTORING_MODULATION)
+                {
+                    restoreFxSlotModulation(s);
+                    nextState[s] = FxLoadSlot::IDLE;
+                }
+            }
+        }
+
+        // the batch has published by now, so an installed effect never sees the old routing
+        for (int s = 0; s < n_fx_slots; s++)
+        {
+            if (nextState[s] >= 0)
+            {
+                fxLoadSlots[s].state = nextState[s];
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lk(fxLoaderMutex);
+        }
+        fxLoadDoneCV.notify_all();
+    }
+}
+
+bool SurgeSynthesizer::loadOscalgos()
+{
+    bool algosChanged{false};
+    bool localResendOscParams[n_scenes][n_oscs];
+    for (int s = 0; s < n_scenes; s++)
+    {
+        for (int i = 0; i < n_oscs; i++)
+        {
+            localResendOscParams[s][i] = false;
+            if (storage.getPatch().scene[s].osc[i].queue_type > -1)
+            {
+                algosChanged = true;
+                // clear assigned modulation if we change osc type, see issue #2224
+                if (storage.getPatch().scene[s].osc[i].queue_type !=
+                    storage.getPatch().scene[s].osc[i].type.val.i)
+                {
+                    clear_osc_modulation(s, i);
+                }
 
                 storage.getPatch().scene[s].osc[i].type.val.i =
                     storage.getPatch().scene[s].osc[i].queue_type;
@@ -3183,6 +3529,8 @@ bool SurgeSynthesizer::loadOscalgos()
                     storage.getPatch().scene[s].osc[i].retrigger.val.b = rt;
                 }
 
+                storage.getPatch().markAllParametersChanged();
+
                 /*
                  * Some oscillator types can change display when you change values
                  */
@@ -3197,7 +3545,7 @@ bool SurgeSynthesizer::loadOscalgos()
 
     if (algosChanged)
     {
-        storage.memoryPools->resetOscillatorPools(&storage);
+        storage.memoryPools->requestOscillatorPoolSizes(&storage);
         for (int s = 0; s < n_scenes; ++s)
         {
             for (int o = 0; o < n_oscs; ++o)
@@ -3493,20 +3841,22 @@ void SurgeSynthesizer::prepareModsourceDoProcess(int scenemask)
                 storage.getPatch().scene[scene].modsource_doprocess[i] = setTo;
             }
 
+            auto &routing = storage.audioModulationRouting();
+
             for (int j = 0; j < 3; j++)
             {
-                vector<ModulationRouting> *modlist;
+                const vector<ModulationRouting> *modlist;
 
                 switch (j)
                 {
                 case 0:
-                    modlist = &storage.getPatch().modulation_global;
+                    modlist = &routing.global;
                     break;
                 case 1:
-                    modlist = &storage.getPatch().scene[scene].modulation_scene;
+                    modlist = &routing.scene[scene];
                     break;
                 case 2:
-                    modlist = &storage.getPatch().scene[scene].modulation_voice;
+                    modlist = &routing.voice[scene];
                     break;
                 }
 
@@ -3563,7 +3913,11 @@ void SurgeSynthesizer::muteModulation(long ptag, modsources modsource, int modso
     ModulationRouting *r = getModRouting(ptag, modsource, modsourceScene, index);
     if (r)
     {
-        r->muted = mute;
+        {
+            std::lock_guard<std::recursive_mutex> g(storage.modRoutingMutex);
+            r->muted = mute;
+            storage.publishModulationRouting();
+        }
         storage.getPatch().isDirty = true;
 
         for (auto l : modListeners)
@@ -3686,6 +4040,7 @@ void SurgeSynthesizer::clear_osc_modulation(int scene, int entry)
         else
             iter++;
     }
+    storage.publishModulationRouting();
     storage.modRoutingMutex.unlock();
 }
 
@@ -3769,6 +4124,7 @@ void SurgeSynthesizer::clearModulation(long ptag, modsources modsource, int mods
         {
             storage.modRoutingMutex.lock();
             modlist->erase(modlist->begin() + i);
+            storage.publishModulationRouting();
             storage.modRoutingMutex.unlock();
             storage.getPatch().isDirty = true;
 
@@ -3847,6 +4203,7 @@ bool SurgeSynthesizer::setModDepth01(long ptag, modsources modsource, int modsou
             modlist->at(found_id).depth = value;
         }
     }
+    storage.publishModulationRouting();
     storage.modRoutingMutex.unlock();
 
     for (auto l : modListeners)
@@ -4065,25 +4422,39 @@ void loadPatchInBackgroundThread(SurgeSynthesizer *sy)
     bool had_patchid_file = false;
 
     SurgeSynthesizer *synth = (SurgeSynthesizer *)sy;
+
+    // the request came off the queue when it was prepared, and is what the standby is playing
+    std::string file;
+    {
+        std::lock_guard<std::mutex> g(synth->preparedPatchMutex);
+
+        if (synth->preparedPatch)
+        {
+            patchid = synth->preparedPatch->patchid;
+
+            if (patchid < 0)
+            {
+                file = synth->preparedPatch->path;
+                ppath = string_to_path(file);
+                had_patchid_file = true;
+            }
+        }
+    }
+
     std::lock_guard<std::mutex> mg(synth->patchLoadSpawnMutex);
-    if (synth->patchid_queue >= 0)
+    if (patchid >= 0)
     {
-        patchid = synth->patchid_queue;
-        synth->patchid_queue = -1;
         synth->stopSound();
         synth->loadPatch(patchid);
     }
-    if (synth->has_patchid_file)
+    if (had_patchid_file)
     {
-        ppath = string_to_path(synth->patchid_file);
-        synth->has_patchid_file = false;
-        had_patchid_file = true;
         synth->stopSound();
 
         int ptid = -1, ct = 0;
         for (const auto &pti : synth->storage.patch_list)
         {
-            if (path_to_string(pti.path) == synth->patchid_file)
+            if (path_to_string(pti.path) == file)
             {
                 ptid = ct;
             }
@@ -4096,13 +4467,24 @@ void loadPatchInBackgroundThread(SurgeSynthesizer *sy)
         }
         else
         {
-            synth->loadPatchByPath(synth->patchid_file, -1, path_to_string(ppath).c_str());
+            synth->loadPatchByPath(file.c_str(), -1, path_to_string(ppath).c_str());
         }
     }
 
     synth->storage.getPatch().isDirty = false;
     synth->patchChanged = true;
+
+    // anything of the prepared patch which wasn't used goes away at the end of this function,
+    // once the engine is running again
+    std::unique_ptr<SurgeSynthesizer::PreparedPatch> unused;
+    {
+        std::lock_guard<std::mutex> g(synth->preparedPatchMutex);
+        unused = std::move(synth->preparedPatch);
+    }
+
+    // new notes start here again, and the standby plays out the ones it has
     synth->halt_engine = false;
+    synth->patchLoadStage = SurgeSynthesizer::PATCH_LOAD_RINGING_OUT;
 
     // Notify the 'patch loaded' listener(s)
     // Note that this is not an if/else for good reason: both cases may occur simultaneously
@@ -4119,166 +4501,466 @@ void loadPatchInBackgroundThread(SurgeSynthesizer *sy)
         for (auto &it : synth->patchLoadedListeners)
             (it.second)(ppath);
     }
-
-    // Now we want to null out the patchLoadThread since everything is done
-    auto myThread = std::move(synth->patchLoadThread);
-    myThread->detach();
-
-    return;
 }
 
-void SurgeSynthesizer::processAudioThreadOpsWhenAudioEngineUnavailable(bool dangerMode)
+bool SurgeSynthesizer::preparePatchLoad()
 {
-    if (!audio_processing_active || dangerMode)
+    auto prepared = std::make_unique<PreparedPatch>();
+    std::string name;
+
     {
-        processEnqueuedPatchIfNeeded();
+        std::lock_guard<std::mutex> mg(patchLoadSpawnMutex);
 
-        auto lg = std::lock_guard<std::mutex>(patchLoadSpawnMutex);
+        // a file queued alongside a patch id would be loaded last and win, so take that one
+        if (has_patchid_file)
+        {
+            prepared->path = patchid_file;
+            name = prepared->path;
+        }
+        else if (patchid_queue >= 0 && !storage.patch_list.empty())
+        {
+            prepared->patchid = patchid_queue;
+            auto &e = storage.patch_list[patchid_queue % storage.patch_list.size()];
+            prepared->path = path_to_string(e.path);
+            name = e.name;
+        }
+        else
+        {
+            return false;
+        }
 
-        // if the audio processing is inactive, patchloading should occur anyway
-        if (patchid_queue >= 0)
+        // this switch owns the request now; one queued meanwhile waits for it to finish
+        has_patchid_file = false;
+        patchid_queue = -1;
+    }
+
+    if (readPatchFile(prepared->path.c_str(), name.c_str(), prepared->data, prepared->size))
+    {
+        prepared->load = std::make_unique<SurgePatch::PreparedLoad>();
+
+        if (!storage.getPatch().prepare_patch(prepared->data.get(), prepared->size,
+                                              *prepared->load))
         {
-            loadPatch(patchid_queue);
-            Patch p = storage.patch_list[patchid_queue];
-            storage.lastLoadedPatch = p.path;
-            patchid_queue = -1;
+            prepared->load.reset();
         }
+    }
 
-        if (has_patchid_file)
+    if (prepared->load && prepared->load->hasXML)
+    {
+        auto patch = TINYXML_SAFE_TO_ELEMENT(prepared->load->doc.FirstChild("patch"));
+        auto parameters =
+            patch ? TINYXML_SAFE_TO_ELEMENT(patch->FirstChild("parameters")) : nullptr;
+
+        for (int s = 0; parameters && s < n_fx_slots; s++)
         {
-            auto p(string_to_path(patchid_file));
-            auto s = path_to_string(p.stem());
-            has_patchid_file = false;
+            auto &pfx = prepared->fx[s];
+            auto p = TINYXML_SAFE_TO_ELEMENT(
+                parameters->FirstChild(storage.getPatch().fx[s].type.get_storage_name()));
 
-            int ptid = -1, ct = 0;
-            for (const auto &pti : storage.patch_list)
-            {
-                if (path_to_string(pti.path) == patchid_file)
-                {
-                    ptid = ct;
-                }
-                ct++;
-            }
-            if (ptid >= 0)
-            {
-                loadPatch(ptid);
-                Patch patch = storage.patch_list[ptid];
-                storage.lastLoadedPatch = patch.path;
-            }
-            else
+            if (!p || p->QueryIntAttribute("value", &pfx.type) != TIXML_SUCCESS ||
+                pfx.type <= fxt_off || pfx.type >= n_fx_types)
             {
-                loadPatchByPath(patchid_file, -1, s.c_str());
-                storage.lastLoadedPatch = p;
+                pfx.type = fxt_off;
+                continue;
             }
-            patchid_file[0] = 0;
-        }
 
-        if (load_fx_needed)
-            loadFx(false, false);
+            // only construct here; loadFx binds the effect to the patch and inits it
+            pfx.fxdata.fxslot = storage.getPatch().fx[s].fxslot;
+            pfx.fxdata.type.val.i = pfx.type;
 
-        loadOscalgos();
+            std::lock_guard<std::mutex> g(fxSpawnMutex);
+            pfx.effect.reset(spawn_effect(pfx.type, &storage, &pfx.fxdata, nullptr));
+        }
+    }
 
-        storage.perform_queued_wtloads();
+    // it reported any error reading the file, and a patch it can't prepare won't load either
+    if (!prepared->load)
+    {
+        return false;
     }
-}
 
-void SurgeSynthesizer::resetStateFromTimeData()
-{
-    if (time_data.timeSigNumerator < 1)
-        time_data.timeSigNumerator = 4;
-    if (time_data.timeSigDenominator < 1)
-        time_data.timeSigDenominator = 4;
-    storage.songpos = time_data.ppqPos;
-    if (time_data.tempo > 0)
+    // the audio thread doesn't touch the standby until it is told the patch is prepared
+    if (!patchSwitchEngine)
     {
-        storage.temposyncratio = time_data.tempo / 120.f;
-        storage.temposyncratio_inv = 1.f / storage.temposyncratio;
+        patchSwitchEngine =
+            std::make_unique<SurgeSynthesizer>(&patchSwitchPluginLayer, patchSwitchDataPath);
     }
-    else
+
+    syncPatchSwitchEngine();
+
+    if (!patchSwitchEngine->loadPatchByPath(prepared->path.c_str(), -1, name.c_str()))
     {
-        storage.temposyncratio = 1.f;
-        storage.temposyncratio_inv = 1.f;
+        return false;
     }
-}
 
-void SurgeSynthesizer::enqueueFXOff(int whichFX)
-{
-    // this can come from the UI thread. I don't think we need the spawn mutex but we might
-    std::lock_guard<std::mutex> lg(fxSpawnMutex);
-    fxsync[whichFX].type.val.i = fxt_off;
-    load_fx_needed = true;
+    {
+        std::lock_guard<std::mutex> g(preparedPatchMutex);
+        std::swap(preparedPatch, prepared);
+    }
+
+    return true;
 }
 
-void SurgeSynthesizer::processControl()
+void SurgeSynthesizer::syncPatchSwitchEngine()
 {
-    processEnqueuedPatchIfNeeded();
+    auto &sb = *patchSwitchEngine;
 
-    storage.perform_queued_wtloads();
-    int sm = storage.getPatch().scenemode.val.i;
-    // TODO: FIX SCENE ASSUMPTION
-    bool playA = (sm == sm_split) || (sm == sm_dual) || (sm == sm_chsplit) ||
-                 (storage.getPatch().scene_active.val.i == 0);
-    bool playB = (sm == sm_split) || (sm == sm_dual) || (sm == sm_chsplit) ||
-                 (storage.getPatch().scene_active.val.i == 1);
+    if (sb.storage.samplerate != storage.samplerate)
+    {
+        sb.setSamplerate(storage.samplerate);
+    }
 
-    storage.songpos = time_data.ppqPos;
-    storage.temposyncratio = time_data.tempo / 120.f;
-    storage.temposyncratio_inv = 1.f / storage.temposyncratio;
+    sb.mpeEnabled = mpeEnabled;
+    sb.storage.mpePitchBendRange = storage.mpePitchBendRange;
+    sb.storage.monoPedalMode = storage.monoPedalMode;
+    sb.storage.mapChannelToOctave = storage.mapChannelToOctave.load();
+    sb.storage.hardclipMode = storage.hardclipMode;
+    sb.storage.tuningApplicationMode = storage.tuningApplicationMode;
+    sb.sampleAccurateNoteOnsets = sampleAccurateNoteOnsets.load();
 
-    // TODO: FIX SCENE ASSUMPTION
-    if (release_if_latched[0])
+    if (storage.isStandardTuning)
     {
-        if (!playA || release_anyway[0])
-            releaseScene(0);
-        release_if_latched[0] = false;
-        release_anyway[0] = false;
+        sb.storage.retuneTo12TETScaleC261Mapping();
     }
-    if (release_if_latched[1])
+    else
     {
-        if (!playB || release_anyway[1])
-            releaseScene(1);
-        release_if_latched[1] = false;
-        release_anyway[1] = false;
+        sb.storage.retuneAndRemapToScaleAndMapping(storage.currentScale, storage.currentMapping);
     }
+}
 
-    // interpolate MIDI controllers
-    for (int i = 0; i < num_controlinterpolators; i++)
+void SurgeSynthesizer::mixPatchSwitchEngine(int stage)
+{
+    auto &sb = *patchSwitchEngine;
+
+    sb.audio_processing_active = audio_processing_active;
+    sb.time_data = time_data;
+    sb.resetStateFromTimeData();
+    sb.process_input = process_input;
+
+    if (process_input)
     {
-        if (mControlInterpolatorUsed[i])
-        {
-            ControllerModulationSource *mc = &mControlInterpolator[i];
-            bool cont = mc->process_block_until_close(0.001f);
-            int id = mc->id;
-            storage.getPatch().param_ptr[id]->set_value_f01(mc->get_output(0));
-            if (!cont)
-            {
-                mControlInterpolatorUsed[i] = false;
-            }
-        }
+        mech::copy_from_to<BLOCK_SIZE>(input[0], sb.input[0]);
+        mech::copy_from_to<BLOCK_SIZE>(input[1], sb.input[1]);
     }
 
-    // Update keys if we are bound
-    prepareModsourceDoProcess((playA ? 1 : 0) | (playB ? 2 : 0));
+    sb.process();
 
-    for (int sc = 0; sc < n_scenes; ++sc)
+    float *ours[] = {output[0],      output[1],      sceneout[0][0],
+                     sceneout[0][1], sceneout[1][0], sceneout[1][1]};
+    float *theirs[] = {sb.output[0],      sb.output[1],      sb.sceneout[0][0],
+                       sb.sceneout[0][1], sb.sceneout[1][0], sb.sceneout[1][1]};
+
+    if (stage == PATCH_LOAD_APPLY_REQUESTED)
     {
-        if (storage.getPatch().scene[sc].modsource_doprocess[ms_highest_key] ||
-            storage.getPatch().scene[sc].modsource_doprocess[ms_lowest_key] ||
-            storage.getPatch().scene[sc].modsource_doprocess[ms_latest_key])
+        for (int c = 0; c < 6; ++c)
         {
-            updateHighLowKeys(sc);
+            mech::copy_from_to<BLOCK_SIZE>(theirs[c], ours[c]);
+        }
+
+        return;
+    }
+
+    // the standby fades out if another patch is queued while it rings out
+    bool fading = stage == PATCH_LOAD_CROSSFADING || patchCrossfadeBlock > 0 ||
+                  patchid_queue >= 0 || has_patchid_file;
+
+    if (fading)
+    {
+        const float dt = 1.f / (patchCrossfadeBlocks * BLOCK_SIZE);
+        float keep alignas(16)[BLOCK_SIZE], add alignas(16)[BLOCK_SIZE];
+
+        for (int i = 0; i < BLOCK_SIZE; ++i)
+        {
+            float a = (patchCrossfadeBlock * BLOCK_SIZE + i + 1) * dt * (float)(0.5 * M_PI);
+
+            // equal power, from the old patch to the new one
+            keep[i] = stage == PATCH_LOAD_CROSSFADING ? std::cos(a) : 1.f;
+            add[i] = stage == PATCH_LOAD_CROSSFADING ? std::sin(a) : std::cos(a);
+        }
+
+        for (int c = 0; c < 6; ++c)
+        {
+            for (int i = 0; i < BLOCK_SIZE; ++i)
+            {
+                ours[c][i] = keep[i] * ours[c][i] + add[i] * theirs[c][i];
+            }
+        }
+
+        patchCrossfadeBlock++;
+    }
+    else
+    {
+        for (int c = 0; c < 6; ++c)
+        {
+            mech::accumulate_from_to<BLOCK_SIZE>(theirs[c], ours[c]);
+        }
+    }
+
+    if (stage == PATCH_LOAD_CROSSFADING)
+    {
+        if (patchCrossfadeBlock == patchCrossfadeBlocks)
+        {
+            // the old patch is silent now, so the loader can load the new one in its place
+            patchCrossfadeBlock = 0;
+            patchSwitchQuietBlocks = 0;
+            patchLoadStage = PATCH_LOAD_APPLY_REQUESTED;
+            patchLoaderCV.notify_one();
+        }
+
+        return;
+    }
+
+    // a second of silence from the standby, with no voices left, ends the switch
+    bool quiet = sb.voices[0].empty() && sb.voices[1].empty() &&
+                 mech::blockAbsMax<BLOCK_SIZE>(sb.output[0]) < 1e-5f &&
+                 mech::blockAbsMax<BLOCK_SIZE>(sb.output[1]) < 1e-5f;
+    patchSwitchQuietBlocks = quiet ? patchSwitchQuietBlocks + 1 : 0;
+
+    if (patchCrossfadeBlock == patchCrossfadeBlocks ||
+        patchSwitchQuietBlocks * BLOCK_SIZE >= storage.samplerate)
+    {
+        patchCrossfadeBlock = 0;
+        patchSwitchQuietBlocks = 0;
+        patchLoadStage = PATCH_LOAD_IDLE;
+    }
+}
+
+std::unique_ptr<SurgeSynthesizer::PreparedPatch>
+SurgeSynthesizer::takePreparedPatch(const char *fxpPath)
+{
+    std::lock_guard<std::mutex> g(preparedPatchMutex);
+
+    if (preparedPatch && preparedPatch->path == fxpPath)
+    {
+        return std::move(preparedPatch);
+    }
+
+    return nullptr;
+}
+
+SurgeSynthesizer::PatchSwitchEvent::PatchSwitchEvent(SurgeSynthesizer *s, bool isNoteOn)
+    : synth(s)
+{
+    if (synth->patchSwitchEventDepth++ > 0)
+    {
+        return;
+    }
+
+    switch (synth->patchLoadStage.load())
+    {
+    case PATCH_LOAD_CROSSFADING:
+        standby = synth->patchSwitchEngine.get();
+        here = !isNoteOn;
+        break;
+    case PATCH_LOAD_APPLY_REQUESTED:
+        standby = synth->patchSwitchEngine.get();
+        here = false;
+        break;
+    case PATCH_LOAD_RINGING_OUT:
+        standby = isNoteOn ? nullptr : synth->patchSwitchEngine.get();
+        break;
+    default:
+        break;
+    }
+
+    if (standby)
+    {
+        standby->noteOnsetOffset = synth->noteOnsetOffset;
+    }
+}
+
+void SurgeSynthesizer::patchLoaderLoop()
+{
+    while (true)
+    {
+        int stage{PATCH_LOAD_IDLE};
+
+        {
+            std::unique_lock<std::mutex> lk(patchLoaderMutex);
+
+            // process() wakes us without taking the lock, so poll as well in case that
+            // notify lands between the predicate check and the wait
+            while (patchLoaderRunning)
+            {
+                stage = patchLoadStage;
+                if (stage == PATCH_LOAD_PREPARE_REQUESTED || stage == PATCH_LOAD_APPLY_REQUESTED)
+                {
+                    break;
+                }
+                patchLoaderCV.wait_for(lk, std::chrono::milliseconds(20));
+            }
+
+            if (!patchLoaderRunning)
+            {
+                return;
+            }
+        }
+
+        if (stage == PATCH_LOAD_PREPARE_REQUESTED)
+        {
+            patchLoadStage = preparePatchLoad() ? PATCH_LOAD_PREPARED : PATCH_LOAD_IDLE;
+        }
+        else
+        {
+            loadPatchInBackgroundThread(this);
+        }
+    }
+}
+
+void SurgeSynthesizer::processAudioThreadOpsWhenAudioEngineUnavailable(bool dangerMode)
+{
+    if (!audio_processing_active || dangerMode)
+    {
+        processEnqueuedPatchIfNeeded();
+
+        auto lg = std::lock_guard<std::mutex>(patchLoadSpawnMutex);
+
+        // if the audio processing is inactive, patchloading should occur anyway
+        if (patchid_queue >= 0)
+        {
+            loadPatch(patchid_queue);
+            Patch p = storage.patch_list[patchid_queue];
+            storage.lastLoadedPatch = p.path;
+            patchid_queue = -1;
+        }
+
+        if (has_patchid_file)
+        {
+            auto p(string_to_path(patchid_file));
+            auto s = path_to_string(p.stem());
+            has_patchid_file = false;
+
+            int ptid = -1, ct = 0;
+            for (const auto &pti : storage.patch_list)
+            {
+                if (path_to_string(pti.path) == patchid_file)
+                {
+                    ptid = ct;
+                }
+                ct++;
+            }
+            if (ptid >= 0)
+            {
+                loadPatch(ptid);
+                Patch patch = storage.patch_list[ptid];
+                storage.lastLoadedPatch = patch.path;
+            }
+            else
+            {
+                loadPatchByPath(patchid_file, -1, s.c_str());
+                storage.lastLoadedPatch = p;
+            }
+            patchid_file[0] = 0;
+        }
+
+        if (load_fx_needed)
+            loadFx(false, false);
+
+        loadOscalgos();
+
+        storage.perform_queued_wtloads();
+    }
+}
+
+void SurgeSynthesizer::resetStateFromTimeData()
+{
+    if (time_data.timeSigNumerator < 1)
+        time_data.timeSigNumerator = 4;
+    if (time_data.timeSigDenominator < 1)
+        time_data.timeSigDenominator = 4;
+    storage.songpos = time_data.ppqPos;
+    if (time_data.tempo > 0)
+    {
+        storage.temposyncratio = time_data.tempo / 120.f;
+        storage.temposyncratio_inv = 1.f / storage.temposyncratio;
+    }
+    else
+    {
+        storage.temposyncratio = 1.f;
+        storage.temposyncratio_inv = 1.f;
+    }
+}
+
+void SurgeSynthesizer::enqueueFXOff(int whichFX)
+{
+    // this can come from the UI thread. I don't think we need the spawn mutex but we might
+    std::lock_guard<std::mutex> lg(fxSpawnMutex);
+    fxsync[whichFX].type.val.i = fxt_off;
+    load_fx_needed = true;
+}
+
+void SurgeSynthesizer::processControl()
+{
+    processEnqueuedPatchIfNeeded();
+
+    if (audio_processing_active)
+    {
+        storage.hand_off_queued_wtloads();
+    }
+    else
+    {
+        storage.perform_queued_wtloads();
+    }
+
+    int sm = storage.getPatch().scenemode.val.i;
+    // TODO: FIX SCENE ASSUMPTION
+    bool playA = (sm == sm_split) || (sm == sm_dual) || (sm == sm_chsplit) ||
+                 (storage.getPatch().scene_active.val.i == 0);
+    bool playB = (sm == sm_split) || (sm == sm_dual) || (sm == sm_chsplit) ||
+                 (storage.getPatch().scene_active.val.i == 1);
+
+    storage.songpos = time_data.ppqPos;
+    storage.temposyncratio = time_data.tempo / 120.f;
+    storage.temposyncratio_inv = 1.f / storage.temposyncratio;
+
+    // TODO: FIX SCENE ASSUMPTION
+    if (release_if_latched[0])
+    {
+        if (!playA || release_anyway[0])
+            releaseScene(0);
+        release_if_latched[0] = false;
+        release_anyway[0] = false;
+    }
+    if (release_if_latched[1])
+    {
+        if (!playB || release_anyway[1])
+            releaseScene(1);
+        release_if_latched[1] = false;
+        release_anyway[1] = false;
+    }
+
+    // interpolate MIDI controllers
+    for (int i = 0; i < num_controlinterpolators; i++)
+    {
+        if (mControlInterpolatorUsed[i])
+        {
+            ControllerModulationSource *mc = &mControlInterpolator[i];
+            bool cont = mc->process_block_until_close(0.001f);
+            int id = mc->id;
+            storage.getPatch().param_ptr[id]->set_value_f01(mc->get_output(0));
+            if (!cont)
+            {
+                mControlInterpolatorUsed[i] = false;
+            }
         }
     }
 
-    storage.getPatch().copy_globaldata(
-        storage.getPatch()
-            .globaldata); // Drains a great deal of CPU while in Debug mode.. optimize?
+    // Update keys if we are bound
+    prepareModsourceDoProcess((playA ? 1 : 0) | (playB ? 2 : 0));
+
+    for (int sc = 0; sc < n_scenes; ++sc)
+    {
+        if (storage.getPatch().scene[sc].modsource_doprocess[ms_highest_key] ||
+            storage.getPatch().scene[sc].modsource_doprocess[ms_lowest_key] ||
+            storage.getPatch().scene[sc].modsource_doprocess[ms_latest_key])
+        {
+            updateHighLowKeys(sc);
+        }
+    }
 
     // TODO: FIX SCENE ASSUMPTION
-    if (playA)
-        storage.getPatch().copy_scenedata(storage.getPatch().scenedata[0], 0); // -""-
-    if (playB)
-        storage.getPatch().copy_scenedata(storage.getPatch().scenedata[1], 1);
+    bool copyScene[n_scenes] = {playA, playB};
+    storage.getPatch().copy_changed_data(copyScene);
 
     // TODO: FIX SCENE ASSUMPTION.
     // Prior to 1.1 we could play before or after copying modulation data but as we
@@ -4327,19 +5009,21 @@ void SurgeSynthesizer::processControl()
             // for(int i=0; i<n_lfos_scene; i++)
             // storage.getPatch().scene[s].modsources[ms_slfo1+i]->process_block();
 
-            int n = storage.getPatch().scene[s].modulation_scene.size();
+            auto &modulation_scene = storage.audioModulationRouting().scene[s];
+            int n = modulation_scene.size();
             for (int i = 0; i < n; i++)
             {
-                int src_id = storage.getPatch().scene[s].modulation_scene[i].source_id;
-                int src_index = storage.getPatch().scene[s].modulation_scene[i].source_index;
+                int src_id = modulation_scene[i].source_id;
+                int src_index = modulation_scene[i].source_index;
                 if (storage.getPatch().scene[s].modsources[src_id])
                 {
-                    int dst_id = storage.getPatch().scene[s].modulation_scene[i].destination_id;
-                    float depth = storage.getPatch().scene[s].modulation_scene[i].depth;
+                    int dst_id = modulation_scene[i].destination_id;
+                    float depth = modulation_scene[i].depth;
                     storage.getPatch().scenedata[s][dst_id].f +=
                         depth *
                         storage.getPatch().scene[s].modsources[src_id]->get_output(src_index) *
-                        (1.0 - storage.getPatch().scene[s].modulation_scene[i].muted);
+                        (1.0 - modulation_scene[i].muted);
+                    storage.getPatch().markModulated(s, dst_id);
                 }
             }
 
@@ -4362,19 +5046,21 @@ void SurgeSynthesizer::processControl()
 
     loadOscalgos();
 
-    int n = storage.getPatch().modulation_global.size();
+    auto &modulation_global = storage.audioModulationRouting().global;
+    int n = modulation_global.size();
     for (int i = 0; i < n; i++)
     {
-        int src_id = storage.getPatch().modulation_global[i].source_id;
-        int src_index = storage.getPatch().modulation_global[i].source_index;
-        int dst_id = storage.getPatch().modulation_global[i].destination_id;
-        float depth = storage.getPatch().modulation_global[i].depth;
-        int source_scene = storage.getPatch().modulation_global[i].source_scene;
+        int src_id = modulation_global[i].source_id;
+        int src_index = modulation_global[i].source_index;
+        int dst_id = modulation_global[i].destination_id;
+        float depth = modulation_global[i].depth;
+        int source_scene = modulation_global[i].source_scene;
 
         storage.getPatch().globaldata[dst_id].f +=
             depth *
             storage.getPatch().scene[source_scene].modsources[src_id]->get_output(src_index) *
-            (1 - storage.getPatch().modulation_global[i].muted);
+            (1 - modulation_global[i].muted);
+        storage.getPatch().markModulated(-1, dst_id);
     }
 
     if (switch_toggled_queued)
@@ -4384,7 +5070,12 @@ void SurgeSynthesizer::processControl()
     }
 
     if (load_fx_needed)
-        loadFx(false, false);
+    {
+        if (audio_processing_active)
+            handOffFxLoads();
+        else
+            loadFx(false, false);
+    }
 
     if (fx_suspend_bitmask)
     {
@@ -4430,6 +5121,9 @@ void SurgeSynthesizer::processControl()
         }
     }
 #endif
+
+    // the evaluators are done with this block, so formula programs edited away can go
+    Surge::Formula::releaseRetiredNativePrograms();
 }
 
 void SurgeSynthesizer::process()
@@ -4437,6 +5131,7 @@ void SurgeSynthesizer::process()
 #if DEBUG_RNG_THREADING
     storage.audioThreadID = std::this_thread::get_id();
 #endif
+    SurgeStorage::ScopedAudioThread audioThread;
     processRunning = 0;
 
 #if DEBUG
@@ -4463,6 +5158,14 @@ void SurgeSynthesizer::process()
     }
 
     float mfade = 1.f;
+    int patchLoad = patchLoadStage;
+
+    if (patchLoad == PATCH_LOAD_APPLY_REQUESTED)
+    {
+        // the loader is loading the new patch into this synth, and the standby plays it
+        mixPatchSwitchEngine(patchLoad);
+        return;
+    }
 
     if (halt_engine)
     {
@@ -4470,35 +5173,20 @@ void SurgeSynthesizer::process()
         mech::clear_block<BLOCK_SIZE>(output[1]);
         return;
     }
-    else if (patchid_queue >= 0 || has_patchid_file)
-    {
-        masterfade = max(0.f, masterfade - 0.05f);
-        mfade = masterfade * masterfade;
-
-        if (masterfade < 0.0001f)
-        {
-            std::lock_guard<std::mutex> mg(patchLoadSpawnMutex);
-            // spawn patch-loading thread
-            stopSound();
-            halt_engine = true;
-
-            /*
-             * In theory, since we only spawn under a lock and the loading thread
-             * also holds that lock, this should "never" happen - namely the patch
-             * load thread should be null always, and we null it out with a move
-             * at the end of the thread operation.
-             */
-            if (patchLoadThread)
-                patchLoadThread->join();
 
-            patchLoadThread = std::make_unique<std::thread>(loadPatchInBackgroundThread, this);
-
-            mech::clear_block<BLOCK_SIZE>(output[0]);
-            mech::clear_block<BLOCK_SIZE>(output[1]);
-            return;
-        }
+    if (patchLoad == PATCH_LOAD_IDLE && (patchid_queue >= 0 || has_patchid_file))
+    {
+        // the loader loads the queued patch into the standby while this one plays on
+        patchLoadStage = PATCH_LOAD_PREPARE_REQUESTED;
+        patchLoaderCV.notify_one();
     }
-    else if (approachingAllSoundOff)
+    else if (patchLoad == PATCH_LOAD_PREPARED)
+    {
+        patchCrossfadeBlock = 0;
+        patchLoadStage = patchLoad = PATCH_LOAD_CROSSFADING;
+    }
+
+    if (approachingAllSoundOff)
     {
         masterfade = max(0.f, masterfade - 0.125f); // kill over 8 blocks
         mfade = masterfade * masterfade;
@@ -4546,7 +5234,7 @@ void SurgeSynthesizer::process()
         }
     }
 
-    storage.modRoutingMutex.lock();
+    storage.acquireModulationRouting();
     processControl();
 
     amp.set_target_smoothed(
@@ -4560,232 +5248,87 @@ void SurgeSynthesizer::process()
 
     if (fx_bypass == fxb_all_fx)
     {
-        for (auto si : sendToIndex)
-        {
-            auto slot = si[0];
-            auto idx = si[1];
-            if (fx[slot])
-            {
-                FX[idx].set_target_smoothed(amp_to_linear(
-                    storage.getPatch().globaldata[storage.getPatch().fx[slot].return_level.id].f));
-                send[idx][0].set_target_smoothed(amp_to_linear(
-                    storage.getPatch()
-                        .scenedata[0][storage.getPatch().scene[0].send_level[idx].param_id_in_scene]
-                        .f));
-                send[idx][1].set_target_smoothed(amp_to_linear(
-                    storage.getPatch()
-                        .scenedata[1][storage.getPatch().scene[1].send_level[idx].param_id_in_scene]
-                        .f));
-            }
-        }
-    }
-
-    list<SurgeVoice *>::iterator iter;
-
-    for (int sc = 0; sc < n_scenes; sc++)
-    {
-        play_scene[sc] = (!voices[sc].empty());
-    }
-
-    int FBentry[n_scenes];
-    int vcount = 0;
-
-    for (int s = 0; s < n_scenes; s++)
-    {
-        FBentry[s] = 0;
-        iter = voices[s].begin();
-        while (iter != voices[s].end())
-        {
-            SurgeVoice *v = *iter;
-            assert(v);
-            bool resume = v->process_block(FBQ[s][FBentry[s] >> 2], FBentry[s] & 3);
-            FBentry[s]++;
-
-            vcount++;
-
-            if (!resume)
-            {
-                freeVoice(v);
-                iter = voices[s].erase(iter);
-            }
-            else
-                iter++;
-        }
-
-        storage.modRoutingMutex.unlock();
-
-        using sst::filters::FilterType, sst::filters::FilterSubType;
-        fbq_global g;
-        if (storage.getPatch().scene[s].filterunit[0].type.deactivated)
-        {
-            g.FU1ptr = nullptr;
-        }
-        else
-        {
-            g.FU1ptr = sst::filters::GetQFPtrFilterUnit(
-                static_cast<FilterType>(storage.getPatch().scene[s].filterunit[0].type.val.i),
-                static_cast<FilterSubType>(
-                    storage.getPatch().scene[s].filterunit[0].subtype.val.i));
-        }
-        if (storage.getPatch().scene[s].filterunit[1].type.deactivated)
-        {
-            g.FU2ptr = nullptr;
-        }
-        else
-        {
-            g.FU2ptr = sst::filters::GetQFPtrFilterUnit(
-                static_cast<FilterType>(storage.getPatch().scene[s].filterunit[1].type.val.i),
-                static_cast<FilterSubType>(
-                    storage.getPatch().scene[s].filterunit[1].subtype.val.i));
-        }
-
-        if (storage.getPatch().scene[s].wsunit.type.deactivated)
-        {
-            g.WSptr = nullptr;
-        }
-        else
-        {
-            g.WSptr =
-                sst::waveshapers::GetQuadWaveshaper(static_cast<sst::waveshapers::WaveshaperType>(
-                    storage.getPatch().scene[s].wsunit.type.val.i));
-        }
-
-        FBQFPtr ProcessQuadFB =
-            GetFBQPointer(storage.getPatch().scene[s].filterblock_configuration.val.i,
-                          g.FU1ptr != 0, g.WSptr != 0, g.FU2ptr != 0);
-
-        for (int e = 0; e < FBentry[s]; e += 4)
-        {
-            int units = FBentry[s] - e;
-            for (int i = units; i < 4; i++)
-            {
-                FBQ[s][e >> 2].FU[0].active[i] = 0;
-                FBQ[s][e >> 2].FU[1].active[i] = 0;
-                FBQ[s][e >> 2].FU[2].active[i] = 0;
-                FBQ[s][e >> 2].FU[3].active[i] = 0;
-            }
-            ProcessQuadFB(FBQ[s][e >> 2], g, sceneout[s][0], sceneout[s][1]);
-        }
-
-        if (s == 0 && storage.otherscene_clients > 0)
-        {
-            // Make available for scene B
-            mech::copy_from_to<BLOCK_SIZE_OS>(sceneout[0][0], storage.audio_otherscene[0]);
-            mech::copy_from_to<BLOCK_SIZE_OS>(sceneout[0][1], storage.audio_otherscene[1]);
-        }
-
-        iter = voices[s].begin();
-
-        while (iter != voices[s].end())
-        {
-            SurgeVoice *v = *iter;
-            assert(v);
-            v->GetQFB(); // save filter state in voices after quad processing is done
-            iter++;
-        }
-
-        storage.modRoutingMutex.lock();
-
-        // mute scene
-        if (storage.getPatch().scene[s].volume.deactivated)
-        {
-            mech::clear_block<BLOCK_SIZE_OS>(sceneout[s][0]);
-            mech::clear_block<BLOCK_SIZE_OS>(sceneout[s][1]);
-        }
-    }
-
-    storage.modRoutingMutex.unlock();
-    polydisplay = vcount;
-
-    // TODO: FIX SCENE ASSUMPTION
-    if (play_scene[0])
-    {
-        switch (storage.sceneHardclipMode[0])
-        {
-        case SurgeStorage::HARDCLIP_TO_18DBFS:
-            sdsp::hardclip_block8<BLOCK_SIZE_OS>(sceneout[0][0]);
-            sdsp::hardclip_block8<BLOCK_SIZE_OS>(sceneout[0][1]);
-            break;
-        case SurgeStorage::HARDCLIP_TO_0DBFS:
-            sdsp::hardclip_block<BLOCK_SIZE_OS>(sceneout[0][0]);
-            sdsp::hardclip_block<BLOCK_SIZE_OS>(sceneout[0][1]);
-            break;
-        case SurgeStorage::BYPASS_HARDCLIP:
-            break;
-        }
-
-        halfbandA.process_block_D2(sceneout[0][0], sceneout[0][1], BLOCK_SIZE_OS);
-    }
-
-    if (play_scene[1])
-    {
-        switch (storage.sceneHardclipMode[1])
+        for (auto si : sendToIndex)
         {
-        case SurgeStorage::HARDCLIP_TO_18DBFS:
-            sdsp::hardclip_block8<BLOCK_SIZE_OS>(sceneout[1][0]);
-            sdsp::hardclip_block8<BLOCK_SIZE_OS>(sceneout[1][1]);
-            break;
-        case SurgeStorage::HARDCLIP_TO_0DBFS:
-            sdsp::hardclip_block<BLOCK_SIZE_OS>(sceneout[1][0]);
-            sdsp::hardclip_block<BLOCK_SIZE_OS>(sceneout[1][1]);
-            break;
-        case SurgeStorage::BYPASS_HARDCLIP:
-            break;
+            auto slot = si[0];
+            auto idx = si[1];
+            if (fx[slot])
+            {
+                FX[idx].set_target_smoothed(amp_to_linear(
+                    storage.getPatch().globaldata[storage.getPatch().fx[slot].return_level.id].f));
+                send[idx][0].set_target_smoothed(amp_to_linear(
+                    storage.getPatch()
+                        .scenedata[0][storage.getPatch().scene[0].send_level[idx].param_id_in_scene]
+                        .f));
+                send[idx][1].set_target_smoothed(amp_to_linear(
+                    storage.getPatch()
+                        .scenedata[1][storage.getPatch().scene[1].send_level[idx].param_id_in_scene]
+                        .f));
+            }
         }
+    }
 
-        halfbandB.process_block_D2(sceneout[1][0], sceneout[1][1], BLOCK_SIZE_OS);
+    for (int sc = 0; sc < n_scenes; sc++)
+    {
+        play_scene[sc] = (!voices[sc].empty());
     }
 
-    /*
-     * ABOVE: Oversampled, Below, Regular sample. So BLOCK_SIZE_OS above BLOCK_SIZE below
-     */
+    int vcount = 0;
 
-    // TODO: FIX SCENE ASSUMPTION
-    if (storage.getPatch().scene[0].lowcut.deactivated == false)
+    if (play_scene[0] && play_scene[1] && renderScenesInParallel && sceneRenderWorkerReady &&
+        canRenderScenesInParallel())
     {
-        auto freq =
-            storage.getPatch().scenedata[0][storage.getPatch().scene[0].lowcut.param_id_in_scene].f;
+        /*
+         * Scene B's voice and filter pipeline runs on the worker while we render scene A
+         * here. We only free ended voices after the join, since freeVoice touches state which
+         * is shared across the scenes. Voices draw their random numbers from their own
+         * generators, so what scene B renders doesn't depend on the thread it renders on.
+         */
+        sceneRenderWorker->dispatch(renderSceneOnWorker, this);
 
-        auto slope = storage.getPatch().scene[0].lowcut.deform_type;
+        renderSceneVoices(0);
+        renderSceneFilterBlock(0);
+        renderSceneOutputStage(0, play_scene[0]);
 
-        for (int i = 0; i <= slope; i++)
+        sceneRenderWorker->join();
+
+        for (int s = 0; s < n_scenes; s++)
         {
-            hpA[i].coeff_HP(hpA[i].calc_omega(freq / 12.0), 0.4); // var 0.707
-            hpA[i].process_block(sceneout[0][0], sceneout[0][1]); // TODO: quadify
+            releaseEndedSceneVoices(s);
+            vcount += sceneFBEntries[s];
         }
     }
-
-    if (storage.getPatch().scene[1].lowcut.deactivated == false)
+    else
     {
-        auto freq =
-            storage.getPatch().scenedata[1][storage.getPatch().scene[1].lowcut.param_id_in_scene].f;
+        for (int s = 0; s < n_scenes; s++)
+        {
+            bool pooled =
+                voiceRenderThreads > 0 && voiceRenderPoolReady && voices[s].size() > 4;
 
-        auto slope = storage.getPatch().scene[1].lowcut.deform_type;
+            vcount += pooled ? renderSceneVoicesOnPool(s) : renderSceneVoices(s);
+            releaseEndedSceneVoices(s);
 
-        for (int i = 0; i <= slope; i++)
-        {
-            hpB[i].coeff_HP(hpB[i].calc_omega(freq / 12.0), 0.4); // var 0.707
-            hpB[i].process_block(sceneout[1][0], sceneout[1][1]); // TODO: quadify
+            if (!pooled)
+            {
+                renderSceneFilterBlock(s);
+            }
+
+            if (s == 0 && storage.otherscene_clients > 0)
+            {
+                // Make available for scene B
+                mech::copy_from_to<BLOCK_SIZE_OS>(sceneout[0][0], storage.audio_otherscene[0]);
+                mech::copy_from_to<BLOCK_SIZE_OS>(sceneout[0][1], storage.audio_otherscene[1]);
+            }
         }
-    }
 
-    for (int cls = 0; cls < n_scenes; ++cls)
-    {
-        switch (storage.sceneHardclipMode[cls])
+        for (int s = 0; s < n_scenes; s++)
         {
-        case SurgeStorage::HARDCLIP_TO_18DBFS:
-            sdsp::hardclip_block8<BLOCK_SIZE>(sceneout[cls][0]);
-            sdsp::hardclip_block8<BLOCK_SIZE>(sceneout[cls][1]);
-            break;
-        case SurgeStorage::HARDCLIP_TO_0DBFS:
-            sdsp::hardclip_block<BLOCK_SIZE>(sceneout[cls][0]);
-            sdsp::hardclip_block<BLOCK_SIZE>(sceneout[cls][1]);
-            break;
-        default:
-            break;
+            renderSceneOutputStage(s, play_scene[s]);
         }
     }
 
+    polydisplay = vcount;
+
     // TODO: FIX SCENE ASSUMPTION
     bool sc_state[n_scenes];
 
@@ -4885,6 +5428,11 @@ void SurgeSynthesizer::process()
     amp.multiply_2_blocks(output[0], output[1], BLOCK_SIZE_QUAD);
     amp_mute.multiply_2_blocks(output[0], output[1], BLOCK_SIZE_QUAD);
 
+    if (patchLoad == PATCH_LOAD_CROSSFADING || patchLoad == PATCH_LOAD_RINGING_OUT)
+    {
+        mixPatchSwitchEngine(patchLoad);
+    }
+
     // VU falloff
     float a = storage.vu_falloff;
     vu_peak[0] = min(2.f, a * vu_peak[0]);
@@ -4933,6 +5481,361 @@ void SurgeSynthesizer::process()
     cpu_level.store(max(c, smoothed_ratio));
 }
 
+void SurgeSynthesizer::runVoiceModulatorBanks(int s)
+{
+    auto &lfoBank = voiceLFOBank[s];
+
+    lfoBank.clear();
+    for (auto v : voices[s])
+    {
+        v->addLFOsToBank(lfoBank);
+    }
+
+    lfoBank.process();
+
+    // the envelopes go second, as in calc_ctrldata
+    auto &envBank = voiceEnvelopeBank[s];
+
+    envBank.clear();
+    for (auto v : voices[s])
+    {
+        v->addEnvelopesToBank(envBank);
+    }
+
+    envBank.process();
+}
+
+int SurgeSynthesizer::renderSceneVoices(int s)
+{
+    sceneFBEntries[s] = 0;
+    endedSceneVoiceCount[s] = 0;
+
+    runVoiceModulatorBanks(s);
+
+    auto iter = voices[s].begin();
+    while (iter != voices[s].end())
+    {
+        SurgeVoice *v = *iter;
+        assert(v);
+        bool resume = v->process_block(FBQ[s][sceneFBEntries[s] >> 2], sceneFBEntries[s] & 3);
+        sceneFBEntries[s]++;
+
+        if (!resume)
+        {
+            endedSceneVoices[s][endedSceneVoiceCount[s]++] = v;
+        }
+
+        iter++;
+    }
+
+    return sceneFBEntries[s];
+}
+
+void SurgeSynthesizer::releaseEndedSceneVoices(int s)
+{
+    for (int i = 0; i < endedSceneVoiceCount[s]; ++i)
+    {
+        auto v = endedSceneVoices[s][i];
+        freeVoice(v);
+        voices[s].remove(v);
+    }
+
+    endedSceneVoiceCount[s] = 0;
+}
+
+FBQFPtr SurgeSynthesizer::prepareSceneFilterBlock(int s, fbq_global &g)
+{
+    using sst::filters::FilterType, sst::filters::FilterSubType;
+    if (storage.getPatch().scene[s].filterunit[0].type.deactivated)
+    {
+        g.FU1ptr = nullptr;
+    }
+    else
+    {
+        g.FU1ptr = sst::filters::GetQFPtrFilterUnit(
+            static_cast<FilterType>(storage.getPatch().scene[s].filterunit[0].type.val.i),
+            static_cast<FilterSubType>(storage.getPatch().scene[s].filterunit[0].subtype.val.i));
+    }
+    if (storage.getPatch().scene[s].filterunit[1].type.deactivated)
+    {
+        g.FU2ptr = nullptr;
+    }
+    else
+    {
+        g.FU2ptr = sst::filters::GetQFPtrFilterUnit(
+            static_cast<FilterType>(storage.getPatch().scene[s].filterunit[1].type.val.i),
+            static_cast<FilterSubType>(storage.getPatch().scene[s].filterunit[1].subtype.val.i));
+    }
+
+    if (storage.getPatch().scene[s].wsunit.type.deactivated)
+    {
+        g.WSptr = nullptr;
+    }
+    else
+    {
+        g.WSptr = sst::waveshapers::GetQuadWaveshaper(static_cast<sst::waveshapers::WaveshaperType>(
+            storage.getPatch().scene[s].wsunit.type.val.i));
+    }
+
+    return GetFBQPointer(storage.getPatch().scene[s].filterblock_configuration.val.i,
+                         g.FU1ptr != 0, g.WSptr != 0, g.FU2ptr != 0);
+}
+
+void SurgeSynthesizer::renderSceneFilterBlock(int s)
+{
+    fbq_global g;
+    FBQFPtr ProcessQuadFB = prepareSceneFilterBlock(s, g);
+    FBOctFPtr ProcessOctFB =
+        GetFBOctPointer(storage.getPatch().scene[s].filterblock_configuration.val.i,
+                        g.FU1ptr != 0, g.WSptr != 0, g.FU2ptr != 0);
+
+    for (int e = 0; e < sceneFBEntries[s]; e += 4)
+    {
+        int units = sceneFBEntries[s] - e;
+        for (int i = units; i < 4; i++)
+        {
+            FBQ[s][e >> 2].FU[0].active[i] = 0;
+            FBQ[s][e >> 2].FU[1].active[i] = 0;
+            FBQ[s][e >> 2].FU[2].active[i] = 0;
+            FBQ[s][e >> 2].FU[3].active[i] = 0;
+        }
+    }
+
+    // run the quads in pairs while there are at least five voices left, see GetFBOctPointer
+    int e = 0;
+    for (; e + 4 < sceneFBEntries[s]; e += 8)
+    {
+        ProcessOctFB(&FBQ[s][e >> 2], g, sceneout[s][0], sceneout[s][1]);
+    }
+    if (e < sceneFBEntries[s])
+    {
+        ProcessQuadFB(FBQ[s][e >> 2], g, sceneout[s][0], sceneout[s][1]);
+    }
+
+    // save filter state in voices after quad processing is done. On the serial path the
+    // voices which ended this block have already been released; on the parallel scene path
+    // they are still in the list until after the join, and saving their state is harmless
+    for (auto v : voices[s])
+    {
+        assert(v);
+        v->GetQFB();
+    }
+}
+
+int SurgeSynthesizer::renderSceneVoicesOnPool(int s)
+{
+    int n = 0;
+    for (auto iter = voices[s].begin(); iter != voices[s].end(); ++iter)
+    {
+        pooledVoices[n] = *iter;
+        n++;
+    }
+
+    int nChunks = (n + 3) >> 2;
+
+    runVoiceModulatorBanks(s);
+
+    sceneFBEntries[s] = n;
+    pooledScene = s;
+    pooledFBQPtr = prepareSceneFilterBlock(s, pooledFBQGlobal);
+
+    voiceRenderPool->run(renderVoiceChunk, this, nChunks, voiceRenderThreads);
+
+    // sum in chunk order, which adds up exactly like the serial filter block does
+    for (int c = 0; c < nChunks; ++c)
+    {
+        mech::accumulate_from_to<BLOCK_SIZE_OS>(voiceChunkOut[c][0], sceneout[s][0]);
+        mech::accumulate_from_to<BLOCK_SIZE_OS>(voiceChunkOut[c][1], sceneout[s][1]);
+    }
+
+    endedSceneVoiceCount[s] = 0;
+    for (int i = 0; i < n; ++i)
+    {
+        if (!pooledVoiceResumes[i])
+        {
+            endedSceneVoices[s][endedSceneVoiceCount[s]++] = pooledVoices[i];
+        }
+    }
+
+    return n;
+}
+
+void SurgeSynthesizer::renderVoiceChunk(void *that, int chunk, int participant)
+{
+    auto synth = static_cast<SurgeSynthesizer *>(that);
+    auto s = synth->pooledScene;
+
+    // as in renderSceneOnWorker, this is for anything other than the voices which draws
+    auto &gen = participant > 0 ? synth->voiceRenderPoolRNG[participant - 1]
+                                : synth->storage.currentRNGGen();
+    SurgeStorage::ScopedRenderRNG threadRNG(gen);
+
+    auto &Q = synth->FBQ[s][chunk];
+    int first = chunk << 2;
+    int units = std::min(4, synth->sceneFBEntries[s] - first);
+
+    for (int i = 0; i < units; ++i)
+    {
+        synth->pooledVoiceResumes[first + i] = synth->pooledVoices[first + i]->process_block(Q, i);
+    }
+
+    for (int i = units; i < 4; i++)
+    {
+        Q.FU[0].active[i] = 0;
+        Q.FU[1].active[i] = 0;
+        Q.FU[2].active[i] = 0;
+        Q.FU[3].active[i] = 0;
+    }
+
+    auto outL = synth->voiceChunkOut[chunk][0], outR = synth->voiceChunkOut[chunk][1];
+    mech::clear_block<BLOCK_SIZE_OS>(outL);
+    mech::clear_block<BLOCK_SIZE_OS>(outR);
+
+    synth->pooledFBQPtr(Q, synth->pooledFBQGlobal, outL, outR);
+
+    for (int i = 0; i < units; ++i)
+    {
+        synth->pooledVoices[first + i]->GetQFB();
+    }
+}
+
+void SurgeSynthesizer::renderSceneOutputStage(int s, bool playScene)
+{
+    // TODO: FIX SCENE ASSUMPTION (for halfbandA/B and hpA/hpB)
+    auto &halfband = (s == 0) ? halfbandA : halfbandB;
+    auto &hp = (s == 0) ? hpA : hpB;
+
+    // mute scene
+    if (storage.getPatch().scene[s].volume.deactivated)
+    {
+        mech::clear_block<BLOCK_SIZE_OS>(sceneout[s][0]);
+        mech::clear_block<BLOCK_SIZE_OS>(sceneout[s][1]);
+    }
+
+    if (playScene)
+    {
+        switch (storage.sceneHardclipMode[s])
+        {
+        case SurgeStorage::HARDCLIP_TO_18DBFS:
+            sdsp::hardclip_block8<BLOCK_SIZE_OS>(sceneout[s][0]);
+            sdsp::hardclip_block8<BLOCK_SIZE_OS>(sceneout[s][1]);
+            break;
+        case SurgeStorage::HARDCLIP_TO_0DBFS:
+            sdsp::hardclip_block<BLOCK_SIZE_OS>(sceneout[s][0]);
+            sdsp::hardclip_block<BLOCK_SIZE_OS>(sceneout[s][1]);
+            break;
+        case SurgeStorage::BYPASS_HARDCLIP:
+            break;
+        }
+
+        halfband.process_block_D2(sceneout[s][0], sceneout[s][1], BLOCK_SIZE_OS);
+    }
+
+    /*
+     * ABOVE: Oversampled, Below, Regular sample. So BLOCK_SIZE_OS above BLOCK_SIZE below
+     */
+
+    if (storage.getPatch().scene[s].lowcut.deactivated == false)
+    {
+        auto freq =
+            storage.getPatch().scenedata[s][storage.getPatch().scene[s].lowcut.param_id_in_scene].f;
+
+        auto slope = storage.getPatch().scene[s].lowcut.deform_type;
+
+        for (int i = 0; i <= slope; i++)
+        {
+            hp[i].coeff_HP(hp[i].calc_omega(freq / 12.0), 0.4); // var 0.707
+            hp[i].process_block(sceneout[s][0], sceneout[s][1]); // TODO: quadify
+        }
+    }
+
+    switch (storage.sceneHardclipMode[s])
+    {
+    case SurgeStorage::HARDCLIP_TO_18DBFS:
+        sdsp::hardclip_block8<BLOCK_SIZE>(sceneout[s][0]);
+        sdsp::hardclip_block8<BLOCK_SIZE>(sceneout[s][1]);
+        break;
+    case SurgeStorage::HARDCLIP_TO_0DBFS:
+        sdsp::hardclip_block<BLOCK_SIZE>(sceneout[s][0]);
+        sdsp::hardclip_block<BLOCK_SIZE>(sceneout[s][1]);
+        break;
+    default:
+        break;
+    }
+}
+
+void SurgeSynthesizer::renderSceneOnWorker(void *that)
+{
+    auto synth = static_cast<SurgeSynthesizer *>(that);
+
+    /*
+     * Voices draw from their own generators, so this only keeps anything else drawn here off
+     * the audio thread's. It is scoped since join() may run this on the audio thread itself.
+     */
+    SurgeStorage::ScopedRenderRNG threadRNG(synth->sceneRenderWorkerRNG);
+
+    synth->renderSceneVoices(1);
+    synth->renderSceneFilterBlock(1);
+    synth->renderSceneOutputStage(1, true);
+}
+
+bool SurgeSynthesizer::canRenderScenesInParallel() const
+{
+    // the audio input oscillator in scene B can read scene A's output
+    return storage.otherscene_clients == 0;
+}
+
+/*
+ * The RNGGen constructor seeds from the clock, and generators made back to back can read the
+ * same tick, which would leave render threads producing the same noise, drift and unison
+ * spread. So the render thread generators are seeded explicitly: from one clock reading, mixed
+ * with the generator's index (and a salt per kind of render thread) through a seed_seq.
+ */
+static void seedRenderThreadRNGs(SurgeStorage::RNGGen *gens, size_t n, uint32_t salt)
+{
+    auto base = (uint32_t)std::chrono::system_clock::now().time_since_epoch().count();
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        std::seed_seq seq{base, salt, (uint32_t)i};
+        uint32_t seed;
+        seq.generate(&seed, &seed + 1);
+        gens[i].g.seed(seed);
+    }
+}
+
+void SurgeSynthesizer::setRenderScenesInParallel(bool b)
+{
+    // spawn the worker from the calling thread, never from the audio thread, and keep it
+    // around once made since the audio thread may be holding on to it
+    if (b && !sceneRenderWorker)
+    {
+        seedRenderThreadRNGs(&sceneRenderWorkerRNG, 1, 0x5ce2e);
+        sceneRenderWorker = std::make_unique<Surge::Threading::RenderWorker>();
+        sceneRenderWorkerReady = true;
+    }
+
+    renderScenesInParallel = b;
+}
+
+void SurgeSynthesizer::setVoiceRenderThreads(int n)
+{
+    // as above, the pool is made once at its largest useful size and then only the number
+    // of workers we hand chunks to changes
+    if (n > 0 && !voiceRenderPool)
+    {
+        auto nWorkers = std::clamp((int)std::thread::hardware_concurrency() - 1, 1,
+                                   maxVoiceRenderThreads);
+
+        voiceRenderPoolRNG.resize(nWorkers);
+        seedRenderThreadRNGs(voiceRenderPoolRNG.data(), voiceRenderPoolRNG.size(), 0x70c1);
+        voiceRenderPool = std::make_unique<Surge::Threading::RenderWorkerPool>(nWorkers);
+        voiceRenderPoolReady = true;
+    }
+
+    voiceRenderThreads = voiceRenderPool ? std::clamp(n, 0, voiceRenderPool->getNumWorkers()) : 0;
+}
+
 SurgeSynthesizer::PluginLayer *SurgeSynthesizer::getParent()
 {
     assert(_parent != nullptr);
@@ -5125,14 +6028,8 @@ void SurgeSynthesizer::swapMetaControllers(int c1, int c2)
 
     storage.modRoutingMutex.lock();
 
-    auto tmp1 = storage.getPatch().scene[0].modsources[ms_ctrl1 + c1];
-    auto tmp2 = storage.getPatch().scene[0].modsources[ms_ctrl1 + c2];
-
-    for (int sc = 0; sc < n_scenes; ++sc)
-    {
-        storage.getPatch().scene[sc].modsources[ms_ctrl1 + c2] = tmp1;
-        storage.getPatch().scene[sc].modsources[ms_ctrl1 + c1] = tmp2;
-    }
+    // the sources themselves change places on the audio thread, with the routing below
+    storage.queueMetaControllerSwap(c1, c2);
 
     // Now swap the routings
     for (int sc = 0; sc < n_scenes; ++sc)
@@ -5175,8 +6072,15 @@ void SurgeSynthesizer::swapMetaControllers(int c1, int c2)
         }
     }
 
+    storage.publishModulationRouting();
     storage.modRoutingMutex.unlock();
 
+    // with no audio thread to pick the swap up, the editor would show the old sources
+    if (!audio_processing_active)
+    {
+        storage.acquireModulationRouting();
+    }
+
     refresh_editor = true;
 }
 
@@ -5361,6 +6265,8 @@ void SurgeSynthesizer::reorderFx(int source, int target, FXReorderMode m)
         mv->erase(mv->begin() + *dt);
     }
 
+    storage.publishModulationRouting();
+
     if (m != FXReorderMode::COPY)
     {
         fx_reload[source] = true;
@@ -5390,6 +6296,7 @@ void SurgeSynthesizer::reorderFx(int source, int target, FXReorderMode m)
     }
 
     storage.getPatch().fx_disable.val.i = startingBitmask;
+    storage.getPatch().fx_disable.markChanged();
     fx_suspend_bitmask = startingBitmask;
 
     fx_reload[target] = true;
@@ -5432,6 +6339,7 @@ void SurgeSynthesizer::reclaimVoiceFor(SurgeVoice *v, char key, char channel, ch
     v->host_note_id = host_noteid;
     v->originating_host_channel = host_originating_channel;
     v->originating_host_key = host_originating_key;
+    voices[scene].updateNote(v);
 
     channelState[channel].keyState[key].voiceOrder = voiceCounter++;
 
@@ -5445,14 +6353,9 @@ void SurgeSynthesizer::reclaimVoiceFor(SurgeVoice *v, char key, char channel, ch
     bool endHostVoice = true;
     for (auto s = 0; s < n_scenes; ++s)
     {
-        if (s == scene)
-            continue;
-        for (auto v : voices[s])
+        if (s != scene && voices[s].countWithHostNoteId(priorNoteId) > 0)
         {
-            if (v->host_note_id == priorNoteId)
-            {
-                endHostVoice = false;
-            }
+            endHostVoice = false;
         }
     }
     if (endHostVoice)
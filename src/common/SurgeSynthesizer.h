@@ -26,6 +26,8 @@
 #include "SurgeVoice.h"
 #include "Effect.h"
 #include "BiquadFilter.h"
+#include "RenderWorker.h"
+#include "ActiveVoiceTable.h"
 #include <set>
 #include <sst/filters/HalfRateFilter.h>
 
@@ -131,7 +133,52 @@ class alignas(16) SurgeSynthesizer
      */
     void
     processAudioThreadOpsWhenAudioEngineUnavailable(bool doItEvenIfAudioIsRunningDANGER = false);
-    bool loadFx(bool initp, bool force_reload_all);
+    struct PreparedPatch;
+    bool loadFx(bool initp, bool force_reload_all, PreparedPatch *prepared = nullptr);
+
+    /*
+     * While the engine runs, processControl calls handOffFxLoads rather than loadFx, so
+     * effects aren't built on the audio thread. A slot which needs a new effect hands its
+     * current one to fxLoaderThread and runs dry. That thread frees the old effect, clears
+     * the modulation onto the slot, and spawns and inits the new effect against the slot's
+     * own copy of the FX parameters and a scratch parameter block, so it never writes the
+     * live patch. A later block installs it: the prepared parameters are swapped into the
+     * patch, which only moves them, and the effect is pointed at them. If the effect was
+     * moved along with its modulation, the loader thread puts that back afterwards.
+     * Routing edits on the loader thread go out as one publish per pass.
+     */
+    void handOffFxLoads();
+    bool fxSlotNeedsRespawn(int s, bool force_reload_all);
+    Effect *spawnFxIntoSlot(int s, bool initp, FxStorage &fxdata, pdata *pd,
+                            std::unique_ptr<Effect> prebuilt = nullptr);
+    void clearFxSlotModulation(int s);
+    void restoreFxSlotModulation(int s);
+    void finishFxSlotLoad(int s, bool force_reload_all);
+    bool installPreparedFx(int s);
+    void fxLoaderLoop();
+
+    struct FxLoadSlot
+    {
+        enum State
+        {
+            IDLE,
+            REQUESTED,
+            READY,
+            RESTORING_MODULATION
+        };
+        std::atomic<int> state{IDLE};
+        std::unique_ptr<Effect> retired, prepared;
+
+        // the loader thread builds into these; they hold the same parameter ids as the patch
+        FxStorage staging{fxslot_ains1};
+        std::array<pdata, n_global_params> scratchData{};
+    };
+    FxLoadSlot fxLoadSlots[n_fx_slots];
+    std::thread fxLoaderThread;
+    std::mutex fxLoaderMutex;
+    std::condition_variable fxLoaderCV, fxLoadDoneCV;
+    std::atomic<bool> fxLoadRequested{false}, fxLoaderRunning{true};
+
     void enqueueFXOff(int whichFX);
     bool loadOscalgos();
     std::atomic<bool> resendOscParam[n_scenes][n_oscs]{};
@@ -177,8 +224,67 @@ class alignas(16) SurgeSynthesizer
 
     int64_t voiceCounter = 1L;
 
+    /*
+     * Each scene's voices, filter block and output stage (hardclip, halfband, low cut) are
+     * independent of the other scene until the insert FX. process() renders them one after
+     * the other, or, with renderScenesInParallel on and a patch which allows it, runs scene
+     * B on sceneRenderWorker while the audio thread does scene A. Voices which end during a
+     * block are collected by renderSceneVoices and freed by releaseEndedSceneVoices.
+     */
+    int renderSceneVoices(int scene);
+    void runVoiceModulatorBanks(int scene);
+    void releaseEndedSceneVoices(int scene);
+    FBQFPtr prepareSceneFilterBlock(int scene, fbq_global &g);
+    void renderSceneFilterBlock(int scene);
+    void renderSceneOutputStage(int scene, bool playScene);
+    bool canRenderScenesInParallel() const;
+    void setRenderScenesInParallel(bool b); // call from the UI thread, not the audio thread
+    static void renderSceneOnWorker(void *synth);
+
+    std::atomic<bool> renderScenesInParallel{false}, sceneRenderWorkerReady{false};
+    std::unique_ptr<Surge::Threading::RenderWorker> sceneRenderWorker;
+    SurgeStorage::RNGGen sceneRenderWorkerRNG;
+    int sceneFBEntries[n_scenes]{};
+    std::array<SurgeVoice *, MAX_VOICES> endedSceneVoices[n_scenes];
+    int endedSceneVoiceCount[n_scenes]{};
+    // refilled by runVoiceModulatorBanks every block
+    VoiceLFOBank voiceLFOBank[n_scenes];
+    VoiceEnvelopeBank voiceEnvelopeBank[n_scenes];
+
+    /*
+     * Within a scene, voices can also be rendered by voiceRenderPool when scenes are rendered
+     * serially. The voices are split in quad sized chunks, each of which renders its four
+     * voices into one QuadFilterChainState, runs the filter block into voiceChunkOut and
+     * saves the filter state back. The chunks are then summed into sceneout in order.
+     */
+    int renderSceneVoicesOnPool(int scene);
+    static void renderVoiceChunk(void *synth, int chunk, int participant);
+    void setVoiceRenderThreads(int n); // call from the UI thread, not the audio thread
+
+    static constexpr int maxVoiceRenderThreads = (MAX_VOICES >> 2) - 1;
+    std::atomic<int> voiceRenderThreads{0};
+    std::atomic<bool> voiceRenderPoolReady{false};
+    std::unique_ptr<Surge::Threading::RenderWorkerPool> voiceRenderPool;
+    std::vector<SurgeStorage::RNGGen> voiceRenderPoolRNG;
+    int pooledScene{0};
+    fbq_global pooledFBQGlobal;
+    FBQFPtr pooledFBQPtr{nullptr};
+    SurgeVoice *pooledVoices[MAX_VOICES];
+    bool pooledVoiceResumes[MAX_VOICES];
+    float voiceChunkOut alignas(16)[MAX_VOICES >> 2][N_OUTPUTS][BLOCK_SIZE_OS];
+
     std::atomic<unsigned int> processRunning{0};
 
+    /*
+     * With sampleAccurateNoteOnsets on, the plugin wrappers apply the note ons which fall
+     * inside the next block before rendering it, with noteOnsetOffset set to each one's
+     * position in that block. A voice started by one (poly or mono) then starts its
+     * oscillators, envelopes and voice LFOs on that sample (see SurgeVoice::setOnsetDelay).
+     * Everything else still takes effect at the block boundary.
+     */
+    std::atomic<bool> sampleAccurateNoteOnsets{false};
+    int noteOnsetOffset{0};
+
     bool doNotifyEndedNote{true};
     int32_t hostNoteEndedDuringBlockCount{0};
     int32_t endedHostNoteIds[MAX_VOICES << 3];
@@ -424,12 +530,99 @@ class alignas(16) SurgeSynthesizer
     void enqueuePatchForLoad(const void *data, int size); // safe from any thread
     void processEnqueuedPatchIfNeeded();                  // only safe from audio thread
 
-    void loadRaw(const void *data, int size, bool preset = false);
+    void loadRaw(const void *data, int size, bool preset = false,
+                 PreparedPatch *prepared = nullptr);
     void loadPatch(int id);
     bool loadPatchByPath(const char *fxpPath, int categoryId, const char *name,
                          bool forceIsPreset = true);
+    bool readPatchFile(const char *fxpPath, const char *name, std::unique_ptr<char[]> &data,
+                       int &size);
     void selectRandomPatch();
-    std::unique_ptr<std::thread> patchLoadThread;
+
+    /*
+     * Patches queued through patchid_queue or patchid_file are switched to without a gap.
+     * patchLoaderThread, which lives as long as the synth, does the loading in two steps.
+     *
+     * As soon as process() sees a queued patch it asks the loader to prepare it, and the old
+     * patch keeps playing meanwhile. preparePatchLoad takes the request off the queue and
+     * loads the patch, completely, into patchSwitchEngine: a second synth which only renders
+     * during a switch. It also prepares the patch for this synth. It reads the file, parses it
+     * and builds its wavetables (SurgePatch::prepare_patch), and constructs an effect of each
+     * type the patch names.
+     *
+     * process() then renders both synths and does an equal power crossfade from the old patch
+     * to the new one over patchCrossfadeBlocks. New notes start on the standby from the start
+     * of the fade. Once the fade is done the loader loads the patch here, while the standby
+     * plays alone; loadPatchByPath picks up the prepared patch if it is for the same file.
+     * After that new notes start here again. The standby hears the ends of its notes and
+     * rings out with its effects alongside, until it falls silent or another patch is queued.
+     *
+     * The audio thread never locks, spawns or joins anything for a patch change, and never
+     * goes silent for one.
+     */
+    struct PreparedPatch
+    {
+        std::string path;
+        int patchid{-1};              // or -1 for a queued file
+        std::unique_ptr<char[]> data; // null if the file couldn't be read
+        int size{0};
+        std::unique_ptr<SurgePatch::PreparedLoad> load;
+
+        // constructed against their own parameters; loadFx binds them to the patch
+        struct PreparedFx
+        {
+            int type{fxt_off};
+            FxStorage fxdata{fxslot_ains1};
+            std::unique_ptr<Effect> effect;
+        } fx[n_fx_slots];
+    };
+    bool preparePatchLoad();
+    std::unique_ptr<PreparedPatch> takePreparedPatch(const char *fxpPath);
+    void patchLoaderLoop();
+
+    enum PatchLoadStage
+    {
+        PATCH_LOAD_IDLE,
+        PATCH_LOAD_PREPARE_REQUESTED, // the loader is loading the queued patch into the standby
+        PATCH_LOAD_PREPARED,          // and the standby is ready to fade to
+        PATCH_LOAD_CROSSFADING,       // both play, and new notes start on the standby
+        PATCH_LOAD_APPLY_REQUESTED,   // the loader is loading the patch here; the standby plays
+        PATCH_LOAD_RINGING_OUT        // new notes start here again; the standby plays its tails
+    };
+    std::atomic<int> patchLoadStage{PATCH_LOAD_IDLE};
+    std::mutex preparedPatchMutex;
+    std::unique_ptr<PreparedPatch> preparedPatch;
+    std::thread patchLoaderThread;
+    std::mutex patchLoaderMutex;
+    std::condition_variable patchLoaderCV;
+    std::atomic<bool> patchLoaderRunning{true};
+
+    // built by the loader the first time a patch is switched to, from the same data path
+    std::unique_ptr<SurgeSynthesizer> patchSwitchEngine;
+    std::string patchSwitchDataPath;
+    static constexpr int patchCrossfadeBlocks = 4096 / BLOCK_SIZE;
+    int patchCrossfadeBlock{0}, patchSwitchQuietBlocks{0};
+    void syncPatchSwitchEngine();
+    void mixPatchSwitchEngine(int stage);
+
+    /*
+     * While a patch switch is under way, the entry points for incoming events hand each
+     * event to the standby as well when it should hear it, and return early when this synth
+     * shouldn't. Only the loader moves the stage on meanwhile, to hand this synth back, and
+     * this synth has no notes of its own until then, so acting on a stale stage is harmless.
+     * Events this synth raises itself while handling one, like the releases behind a choke,
+     * aren't handed over a second time.
+     */
+    struct PatchSwitchEvent
+    {
+        PatchSwitchEvent(SurgeSynthesizer *s, bool isNoteOn);
+        ~PatchSwitchEvent() { synth->patchSwitchEventDepth--; }
+
+        SurgeSynthesizer *synth;
+        SurgeSynthesizer *standby{nullptr}; // set if the standby should hear this event
+        bool here{true};                    // false if this synth shouldn't
+    };
+    int patchSwitchEventDepth{0};
 
     // if increment is true, we go to next patch, else go to previous patch
     void jogCategory(bool increment);
@@ -489,7 +682,7 @@ class alignas(16) SurgeSynthesizer
     bool approachingAllSoundOff{false};
     // TODO: FIX SCENE ASSUMPTION (for halfbandA/B - use std::array)
     sst::filters::HalfRate::HalfRateFilter halfbandA, halfbandB, halfbandIN;
-    std::list<SurgeVoice *> voices[n_scenes];
+    ActiveVoiceTable voices[n_scenes];
     std::unique_ptr<Effect> fx[n_fx_slots];
     std::atomic<bool> halt_engine;
     MidiChannelState channelState[16];
@@ -209,63 +209,33 @@ void SurgeSynthesizer::loadPatch(int id)
 bool SurgeSynthesizer::loadPatchByPath(const char *fxpPath, int categoryId, const char *patchName,
                                        bool forceIsPreset)
 {
-    using namespace sst::io;
+    std::unique_ptr<char[]> data;
+    int cs{0};
 
-    std::filebuf f;
-    if (!f.open(string_to_path(fxpPath), std::ios::binary | std::ios::in))
-    {
-        storage.reportError(std::string() + "Unable to open file " + std::string(fxpPath),
-                            "Unable to open file");
-        return false;
-    }
-    fxChunkSetCustom fxp;
-    auto read = f.sgetn(reinterpret_cast<char *>(&fxp), sizeof(fxp));
-    // FIXME - error if read != chunk size
-    if ((mech::endian_read_int32BE(fxp.chunkMagic) != 'CcnK') ||
-        (mech::endian_read_int32BE(fxp.fxMagic) != 'FPCh') ||
-        (mech::endian_read_int32BE(fxp.fxID) != 'cjs3'))
-    {
-        f.close();
-        auto cm = mech::endian_read_int32BE(fxp.chunkMagic);
-        auto fm = mech::endian_read_int32BE(fxp.fxMagic);
-        auto id = mech::endian_read_int32BE(fxp.fxID);
+    // the patch loader may have read and built this one already, while the last one played
+    auto prepared = takePreparedPatch(fxpPath);
 
-        std::ostringstream oss;
-        oss << "Unable to load " << patchName << ".fxp!";
-        // if( cm != 'CcnK' )
-        //{
-        //   oss << "ChunkMagic is not 'CcnK'. ";
-        //}
-        // if( fm != 'FPCh' )
-        //{
-        //   oss << "FxMagic is not 'FPCh'. ";
-        //}
-        // if( id != 'cjs3' )
-        //{
-        //   union {
-        //      char c[4];
-        //      int id;
-        //   } q;
-        //   q.id = id;
-        //   oss << "Synth ID is '" << q.c[0] << q.c[1] << q.c[2] << q.c[3] << "'; Surge expected
-        //   'cjs3'. ";
-        //}
-        oss << "This error usually occurs when you attempt to load an .fxp that belongs to another "
-               "plugin into Surge XT.";
-        storage.reportError(oss.str(), "Unknown FXP File");
-        return false;
-    }
+    if (prepared)
+    {
+        // it reported any error reading the file when it tried
+        if (!prepared->data)
+        {
+            return false;
+        }
 
-    int cs = mech::endian_read_int32BE(fxp.chunkSize);
-    std::unique_ptr<char[]> data{new char[cs]};
+        data = std::move(prepared->data);
+        cs = prepared->size;
 
-    if (f.sgetn(data.get(), cs) != cs)
+        if (!prepared->load)
+        {
+            prepared.reset();
+        }
+    }
+    else if (!readPatchFile(fxpPath, patchName, data, cs))
     {
-        perror("Error while loading patch!");
+        return false;
     }
 
-    f.close();
-
     storage.getPatch().comment = "";
     storage.getPatch().author = "";
 
@@ -281,7 +251,7 @@ bool SurgeSynthesizer::loadPatchByPath(const char *fxpPath, int categoryId, cons
     current_category_id = categoryId;
     storage.getPatch().name = patchName;
 
-    loadRaw(data.get(), cs, forceIsPreset);
+    loadRaw(data.get(), cs, forceIsPreset, prepared.get());
     data.reset();
 
     // OK so at this point we may have loaded a patch with a tuning override
@@ -376,6 +346,69 @@ bool SurgeSynthesizer::loadPatchByPath(const char *fxpPath, int categoryId, cons
     return true;
 }
 
+bool SurgeSynthesizer::readPatchFile(const char *fxpPath, const char *patchName,
+                                     std::unique_ptr<char[]> &data, int &size)
+{
+    using namespace sst::io;
+
+    std::filebuf f;
+    if (!f.open(string_to_path(fxpPath), std::ios::binary | std::ios::in))
+    {
+        storage.reportError(std::string() + "Unable to open file " + std::string(fxpPath),
+                            "Unable to open file");
+        return false;
+    }
+    fxChunkSetCustom fxp;
+    auto read = f.sgetn(reinterpret_cast<char *>(&fxp), sizeof(fxp));
+    // FIXME - error if read != chunk size
+    if ((mech::endian_read_int32BE(fxp.chunkMagic) != 'CcnK') ||
+        (mech::endian_read_int32BE(fxp.fxMagic) != 'FPCh') ||
+        (mech::endian_read_int32BE(fxp.fxID) != 'cjs3'))
+    {
+        f.close();
+        auto cm = mech::endian_read_int32BE(fxp.chunkMagic);
+        auto fm = mech::endian_read_int32BE(fxp.fxMagic);
+        auto id = mech::endian_read_int32BE(fxp.fxID);
+
+        std::ostringstream oss;
+        oss << "Unable to load " << patchName << ".fxp!";
+        // if( cm != 'CcnK' )
+        //{
+        //   oss << "ChunkMagic is not 'CcnK'. ";
+        //}
+        // if( fm != 'FPCh' )
+        //{
+        //   oss << "FxMagic is not 'FPCh'. ";
+        //}
+        // if( id != 'cjs3' )
+        //{
+        //   union {
+        //      char c[4];
+        //      int id;
+        //   } q;
+        //   q.id = id;
+        //   oss << "Synth ID is '" << q.c[0] << q.c[1] << q.c[2] << q.c[3] << "'; Surge expected
+        //   'cjs3'. ";
+        //}
+        oss << "This error usually occurs when you attempt to load an .fxp that belongs to another "
+               "plugin into Surge XT.";
+        storage.reportError(oss.str(), "Unknown FXP File");
+        return false;
+    }
+
+    size = mech::endian_read_int32BE(fxp.chunkSize);
+    data.reset(new char[size]);
+
+    if (f.sgetn(data.get(), size) != size)
+    {
+        perror("Error while loading patch!");
+    }
+
+    f.close();
+
+    return true;
+}
+
 void SurgeSynthesizer::enqueuePatchForLoad(const void *data, int size)
 {
     {
@@ -398,6 +431,13 @@ void SurgeSynthesizer::enqueuePatchForLoad(const void *data, int size)
 
 void SurgeSynthesizer::processEnqueuedPatchIfNeeded()
 {
+    // a patch switch which hasn't got here yet would land on top of this, so let it finish
+    int stage = patchLoadStage;
+    if (stage != PATCH_LOAD_IDLE && stage != PATCH_LOAD_RINGING_OUT)
+    {
+        return;
+    }
+
     bool expected = true;
     if (rawLoadEnqueued.compare_exchange_weak(expected, true) && expected)
     {
@@ -418,7 +458,7 @@ void SurgeSynthesizer::processEnqueuedPatchIfNeeded()
     }
 }
 
-void SurgeSynthesizer::loadRaw(const void *data, int size, bool preset)
+void SurgeSynthesizer::loadRaw(const void *data, int size, bool preset, PreparedPatch *prepared)
 {
     halt_engine = true;
     stopSound();
@@ -426,16 +466,27 @@ void SurgeSynthesizer::loadRaw(const void *data, int size, bool preset)
         for (int i = 0; i < n_customcontrollers; i++)
             storage.getPatch().scene[s].modsources[ms_ctrl1 + i]->reset();
 
+    // wavetable loads requested before this patch mustn't land on top of it
+    storage.wavetableLoadGeneration++;
+
     storage.getPatch().init_default_values();
-    storage.getPatch().load_patch(data, size, preset);
+    if (prepared)
+    {
+        storage.getPatch().load_patch(*prepared->load, preset);
+    }
+    else
+    {
+        storage.getPatch().load_patch(data, size, preset);
+    }
     storage.getPatch().update_controls(false, nullptr, true);
+    storage.publishModulationRouting();
     for (int i = 0; i < n_fx_slots; i++)
     {
         fxsync[i] = storage.getPatch().fx[i];
         fx_reload[i] = true;
     }
 
-    loadFx(false, true);
+    loadFx(false, true, prepared);
 
     for (int sc = 0; sc < n_scenes; sc++)
     {
@@ -445,14 +496,8 @@ void SurgeSynthesizer::loadRaw(const void *data, int size, bool preset)
 
     storage.memoryPools->resetAllPools(&storage);
 
-    for (int sc = 0; sc < n_scenes; ++sc)
-    {
-        for (int m = 0; m < n_lfos; ++m)
-        {
-            Surge::Formula::removeFunctionsAssociatedWith(&storage,
-                                                          &(storage.getPatch().formulamods[sc][m]));
-        }
-    }
+    // build the patch's wavetables now, so the engine doesn't resume with them still queued
+    storage.perform_queued_wtloads();
 
     storage.getPatch().isDirty = false;
 
@@ -364,6 +364,18 @@ std::string defaultKeyToString(DefaultKey k)
         r = "startOSCOut";
         break;
 
+    case RenderScenesInParallel:
+        r = "renderScenesInParallel";
+        break;
+
+    case VoiceRenderThreads:
+        r = "voiceRenderThreads";
+        break;
+
+    case SampleAccurateNoteOnsets:
+        r = "sampleAccurateNoteOnsets";
+        break;
+
     case nKeys:
         break;
     }
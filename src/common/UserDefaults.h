@@ -173,6 +173,11 @@ enum DefaultKey
     OSCPortOut,
     OSCIPOut,
 
+    // audio engine
+    RenderScenesInParallel,
+    VoiceRenderThreads,
+    SampleAccurateNoteOnsets,
+
     nKeys
 };
 
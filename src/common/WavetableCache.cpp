@@ -0,0 +1,460 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+#include "WavetableCache.h"
+#include "filesystem/import.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+
+namespace Surge
+{
+namespace Storage
+{
+
+WavetableCache &WavetableCache::global()
+{
+    static WavetableCache cache;
+    return cache;
+}
+
+std::string WavetableCache::keyFor(const std::string &filename, int frameSizeIfAbsent)
+{
+    std::error_code ec;
+    auto p = string_to_path(filename);
+
+    auto fileSize = fs::file_size(p, ec);
+
+    if (ec)
+    {
+        return "";
+    }
+
+    auto modified = fs::last_write_time(p, ec);
+
+    if (ec)
+    {
+        return "";
+    }
+
+    // a .wav without a frame size chunk is sliced by the frame size the caller asked for
+    std::ostringstream oss;
+    oss << filename << "|" << fileSize << "|" << modified.time_since_epoch().count() << "|"
+        << frameSizeIfAbsent;
+
+    return oss.str();
+}
+
+std::shared_ptr<const Wavetable> WavetableCache::find(const std::string &key)
+{
+    std::lock_guard<std::mutex> g(mutex);
+
+    auto it = entries.find(key);
+
+    if (it == entries.end())
+    {
+        return nullptr;
+    }
+
+    auto res = it->second.lock();
+
+    if (!res)
+    {
+        entries.erase(it);
+    }
+
+    return res;
+}
+
+std::shared_ptr<const Wavetable> WavetableCache::insert(const std::string &key,
+                                                        std::shared_ptr<const Wavetable> built)
+{
+    std::lock_guard<std::mutex> g(mutex);
+
+    auto &entry = entries[key];
+
+    if (auto existing = entry.lock())
+    {
+        return existing;
+    }
+
+    entry = built;
+
+    // drop tables nobody is using any more while we hold the lock anyway
+    for (auto it = entries.begin(); it != entries.end();)
+    {
+        if (it->second.expired())
+        {
+            it = entries.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    return built;
+}
+
+namespace
+{
+const char imageTag[4] = {'s', 'w', 't', 'i'};
+
+struct ImageHeader
+{
+    char tag[4];
+    uint32_t version;
+    uint32_t keyLength;
+    int32_t size;
+    uint32_t n_tables;
+    int32_t size_po2;
+    int32_t flags;
+    float dt;
+    uint64_t dataSizes;
+};
+
+fs::path imagePathFor(const fs::path &dir, const std::string &key)
+{
+    std::ostringstream oss;
+    oss << std::hex << std::setw(16) << std::setfill('0') << std::hash<std::string>{}(key)
+        << ".wti";
+    return dir / oss.str();
+}
+
+// pointers are stored as offsets into their data block, with -1 for an unused slot
+template <typename T>
+void pointersToOffsets(T *const (&pointers)[max_mipmap_levels][max_subtables], const T *base,
+                       std::vector<int64_t> &offsets)
+{
+    for (int i = 0; i < max_mipmap_levels; i++)
+    {
+        for (int j = 0; j < max_subtables; j++)
+        {
+            offsets.push_back(pointers[i][j] ? (int64_t)(pointers[i][j] - base) : -1);
+        }
+    }
+}
+
+template <typename T>
+bool offsetsToPointers(const int64_t *offsets, T *base, size_t dataSizes, int size,
+                       T *(&pointers)[max_mipmap_levels][max_subtables])
+{
+    for (int i = 0; i < max_mipmap_levels; i++)
+    {
+        for (int j = 0; j < max_subtables; j++)
+        {
+            auto o = offsets[i * max_subtables + j];
+
+            if (o < -1 || (o >= 0 && (size_t)o + (size >> i) > dataSizes))
+            {
+                return false;
+            }
+
+            pointers[i][j] = o < 0 ? nullptr : base + o;
+        }
+    }
+
+    return true;
+}
+} // namespace
+
+bool WavetableCache::readImage(const fs::path &dir, const std::string &key, Wavetable &into)
+{
+    if (dir.empty() || key.empty())
+    {
+        return false;
+    }
+
+    std::ifstream f(path_to_string(imagePathFor(dir, key)), std::ios::binary);
+
+    if (!f)
+    {
+        return false;
+    }
+
+    ImageHeader h;
+
+    if (!f.read((char *)&h, sizeof(h)) || memcmp(h.tag, imageTag, 4) != 0 ||
+        h.version != imageVersion || h.keyLength != key.size())
+    {
+        return false;
+    }
+
+    std::string storedKey(h.keyLength, '\0');
+
+    if (!f.read(&storedKey[0], h.keyLength) || storedKey != key)
+    {
+        return false;
+    }
+
+    if (h.size <= 0 || h.size > max_wtable_size || h.n_tables > max_subtables ||
+        h.dataSizes == 0 || h.dataSizes > (uint64_t)1 << 31)
+    {
+        return false;
+    }
+
+    std::vector<int64_t> offsets(2 * max_mipmap_levels * max_subtables);
+
+    if (!f.read((char *)offsets.data(), offsets.size() * sizeof(int64_t)))
+    {
+        return false;
+    }
+
+    if (into.dataSizes < h.dataSizes || into.sharedData)
+    {
+        into.allocPointers(h.dataSizes);
+    }
+
+    if (!f.read((char *)into.TableF32Data, h.dataSizes * sizeof(float)) ||
+        !f.read((char *)into.TableI16Data, h.dataSizes * sizeof(short)))
+    {
+        return false;
+    }
+
+    if (!offsetsToPointers(offsets.data(), into.TableF32Data, into.dataSizes, h.size,
+                           into.TableF32WeakPointers) ||
+        !offsetsToPointers(offsets.data() + max_mipmap_levels * max_subtables, into.TableI16Data,
+                           into.dataSizes, h.size, into.TableI16WeakPointers))
+    {
+        return false;
+    }
+
+    into.size = h.size;
+    into.n_tables = h.n_tables;
+    into.size_po2 = h.size_po2;
+    into.flags = h.flags;
+    into.dt = h.dt;
+    into.everBuilt = true;
+
+    // mark it recently used, so pruneImages keeps it over ones we haven't needed lately
+    f.close();
+    std::error_code ec;
+    fs::last_write_time(imagePathFor(dir, key), fs::file_time_type::clock::now(), ec);
+
+    return true;
+}
+
+bool WavetableCache::writeImage(const fs::path &dir, const std::string &key, const Wavetable &from)
+{
+    if (dir.empty() || key.empty() || !from.everBuilt)
+    {
+        return false;
+    }
+
+    std::error_code ec;
+    fs::create_directories(dir, ec);
+
+    if (ec)
+    {
+        return false;
+    }
+
+    ImageHeader h;
+    memcpy(h.tag, imageTag, 4);
+    h.version = imageVersion;
+    h.keyLength = (uint32_t)key.size();
+    h.size = from.size;
+    h.n_tables = from.n_tables;
+    h.size_po2 = from.size_po2;
+    h.flags = from.flags;
+    h.dt = from.dt;
+    h.dataSizes = from.dataSizes;
+
+    std::vector<int64_t> offsets;
+    offsets.reserve(2 * max_mipmap_levels * max_subtables);
+    pointersToOffsets(from.TableF32WeakPointers, from.TableF32Data, offsets);
+    pointersToOffsets(from.TableI16WeakPointers, from.TableI16Data, offsets);
+
+    // write next to the image and move it into place, so a reader never sees half a file
+    auto dest = imagePathFor(dir, key);
+    auto temp = dest;
+    temp += ".tmp";
+
+    {
+        std::ofstream f(path_to_string(temp), std::ios::binary | std::ios::trunc);
+
+        f.write((const char *)&h, sizeof(h));
+        f.write(key.data(), key.size());
+        f.write((const char *)offsets.data(), offsets.size() * sizeof(int64_t));
+        f.write((const char *)from.TableF32Data, from.dataSizes * sizeof(float));
+        f.write((const char *)from.TableI16Data, from.dataSizes * sizeof(short));
+
+        if (!f)
+        {
+            f.close();
+            fs::remove(temp, ec);
+            return false;
+        }
+    }
+
+    fs::rename(temp, dest, ec);
+
+    if (ec)
+    {
+        fs::remove(temp, ec);
+        return false;
+    }
+
+    return true;
+}
+
+fs::path WavetableCache::defaultImageDirectory()
+{
+#if WINDOWS
+    if (auto *local = _wgetenv(L"LOCALAPPDATA"))
+    {
+        return fs::path{std::wstring{local}} / "Surge XT" / "Wavetable Cache";
+    }
+#elif MAC
+    if (auto *home = getenv("HOME"))
+    {
+        return fs::path{home} / "Library" / "Caches" / "Surge XT" / "Wavetable Cache";
+    }
+#else
+    if (auto *xdg = getenv("XDG_CACHE_HOME"); xdg && *xdg)
+    {
+        return fs::path{xdg} / "surge-xt" / "wavetable-cache";
+    }
+
+    if (auto *home = getenv("HOME"))
+    {
+        return fs::path{home} / ".cache" / "surge-xt" / "wavetable-cache";
+    }
+#endif
+
+    return fs::path{};
+}
+
+void WavetableCache::pruneImages(const fs::path &dir, uint64_t maxBytes)
+{
+    if (dir.empty())
+    {
+        return;
+    }
+
+    struct Image
+    {
+        fs::path path;
+        fs::file_time_type used;
+        uint64_t bytes;
+    };
+
+    std::vector<Image> images;
+    uint64_t total = 0;
+    std::error_code ec;
+
+    for (auto it = fs::directory_iterator(dir, ec); !ec && it != fs::directory_iterator();
+         it.increment(ec))
+    {
+        auto p = it->path();
+
+        if (p.extension() != ".wti")
+        {
+            continue;
+        }
+
+        std::error_code fec;
+        auto bytes = fs::file_size(p, fec);
+        auto used = fs::last_write_time(p, fec);
+
+        if (!fec)
+        {
+            images.push_back({p, used, bytes});
+            total += bytes;
+        }
+    }
+
+    if (total <= maxBytes)
+    {
+        return;
+    }
+
+    std::sort(images.begin(), images.end(),
+              [](const auto &a, const auto &b) { return a.used < b.used; });
+
+    for (const auto &i : images)
+    {
+        if (total <= maxBytes)
+        {
+            break;
+        }
+
+        if (fs::remove(i.path, ec))
+        {
+            total -= i.bytes;
+        }
+    }
+}
+
+void WavetableCache::clearImages(const fs::path &dir)
+{
+    if (dir.empty())
+    {
+        return;
+    }
+
+    std::vector<fs::path> doomed;
+    std::error_code ec;
+
+    // images, and temporaries left by a write which didn't finish
+    for (auto it = fs::directory_iterator(dir, ec); !ec && it != fs::directory_iterator();
+         it.increment(ec))
+    {
+        auto ext = it->path().extension();
+
+        if (ext == ".wti" || ext == ".tmp")
+        {
+            doomed.push_back(it->path());
+        }
+    }
+
+    for (const auto &p : doomed)
+    {
+        fs::remove(p, ec);
+    }
+}
+
+size_t WavetableCache::liveEntries()
+{
+    std::lock_guard<std::mutex> g(mutex);
+
+    size_t res = 0;
+
+    for (const auto &[k, v] : entries)
+    {
+        if (!v.expired())
+        {
+            res++;
+        }
+    }
+
+    return res;
+}
+
+} // namespace Storage
+} // namespace Surge
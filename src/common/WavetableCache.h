@@ -0,0 +1,103 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+#ifndef SURGE_SRC_COMMON_WAVETABLECACHE_H
+#define SURGE_SRC_COMMON_WAVETABLECACHE_H
+
+#include "dsp/Wavetable.h"
+#include "filesystem/import.h"
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace Surge
+{
+namespace Storage
+{
+/*
+ * A process-wide cache of built wavetables, so the same file loaded into several oscillators
+ * or several plugin instances is parsed and mipmapped once and its table data is held once.
+ * Entries are immutable and only weakly held here; the oscillators sharing them (through
+ * Wavetable::shareFrom) own them, and an entry goes away with its last user.
+ */
+struct WavetableCache
+{
+    static WavetableCache &global();
+
+    /*
+     * The key covers the path, size and modification time of the file, so an edited file is
+     * never served stale. Returns an empty string if the file can't be examined, in which case
+     * the caller should load it uncached.
+     */
+    static std::string keyFor(const std::string &filename, int frameSizeIfAbsent);
+
+    std::shared_ptr<const Wavetable> find(const std::string &key);
+
+    /*
+     * Adds a freshly built table. If another thread added the same key in the meantime, that
+     * entry is kept and returned instead, so every user still shares one copy.
+     */
+    std::shared_ptr<const Wavetable> insert(const std::string &key,
+                                            std::shared_ptr<const Wavetable> built);
+
+    size_t liveEntries();
+
+    /*
+     * Fully built tables are also kept on disk in a directory of images, one per key, so the
+     * next session skips the parse and the mipmapping as well. An image carries the key it was
+     * written for and a format version; anything that doesn't match, or doesn't hold together,
+     * is treated as a miss. Bump imageVersion whenever BuildWT or MipMapWT change what they
+     * produce.
+     */
+    static constexpr uint32_t imageVersion = 1;
+
+    static bool readImage(const fs::path &dir, const std::string &key, Wavetable &into);
+    static bool writeImage(const fs::path &dir, const std::string &key, const Wavetable &from);
+
+    /*
+     * The images can always be rebuilt, so they live in the platform's per-user cache folder
+     * (LOCALAPPDATA on Windows, ~/Library/Caches on macOS, XDG_CACHE_HOME or ~/.cache elsewhere)
+     * rather than with the user's data. Returns an empty path if there is no such folder.
+     */
+    static fs::path defaultImageDirectory();
+
+    /*
+     * The images in a directory are kept to maxImageBytes between them. readImage marks an
+     * image as used by touching its modification time, and pruneImages removes the least
+     * recently used until the rest fit. clearImages removes them all.
+     */
+    static constexpr uint64_t maxImageBytes = 256 * 1024 * 1024;
+
+    static void pruneImages(const fs::path &dir, uint64_t maxBytes = maxImageBytes);
+    static void clearImages(const fs::path &dir);
+
+  private:
+    std::mutex mutex;
+    std::unordered_map<std::string, std::weak_ptr<const Wavetable>> entries;
+};
+} // namespace Storage
+} // namespace Surge
+
+#endif // SURGE_SRC_COMMON_WAVETABLECACHE_H
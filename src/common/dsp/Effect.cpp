@@ -124,10 +124,15 @@ Effect *spawn_effect(int id, SurgeStorage *storage, FxStorage *fxdata, pdata *pd
 Effect::Effect(SurgeStorage *storage, FxStorage *fxdata, pdata *pd)
 {
     // assert(storage);
-    this->fxdata = fxdata;
     this->storage = storage;
-    this->pd = pd;
     ringout = 10000000;
+    bindParameters(fxdata, pd);
+}
+
+void Effect::bindParameters(FxStorage *fxdata, pdata *pd)
+{
+    this->fxdata = fxdata;
+    this->pd = pd;
     if (pd)
     {
         for (int i = 0; i < n_fx_params; i++)
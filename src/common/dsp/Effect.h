@@ -50,6 +50,9 @@ class alignas(16) Effect
     Effect(SurgeStorage *storage, FxStorage *fxdata, pdata *pd);
     virtual ~Effect() { return; }
 
+    // points the effect at another copy of its parameters, which has to have the same ids
+    virtual void bindParameters(FxStorage *fxdata, pdata *pd);
+
     virtual const char *get_effectname() { return 0; }
 
     virtual void init(){};
@@ -20,7 +20,9 @@
  * https://github.com/surge-synthesizer/surge
  */
 #include "QuadFilterChain.h"
+#include "QuadFilterChainDispatch.h"
 #include "SurgeStorage.h"
+#include "CPUFeatures.h"
 #include <vembertech/basic_dsp.h>
 #include <vembertech/portable_intrinsics.h>
 #include "sst/basic-blocks/mechanics/simd-ops.h"
@@ -53,8 +55,14 @@ namespace sdsp = sst::basic_blocks::dsp;
 #define AssertReasonableAudioFloat(x)
 #endif
 
+/*
+ * One sample of the filter chain for one QuadFilterChainState. This is the body of the old
+ * ProcessFBQuad loop; FBQuad and FBOct below step it through the block for one and two
+ * states respectively.
+ */
 template <int config, bool A, bool WS, bool B>
-void ProcessFBQuad(QuadFilterChainState &d, fbq_global &g, float *OutL, float *OutR)
+inline void ProcessFBSample(QuadFilterChainState &d, fbq_global &g, float *OutL, float *OutR,
+                            int k)
 {
     const __m128 hb_c = _mm_set1_ps(0.5f); // If this is changed from 0.5, make sure to change
                                            // this in the code because it is assumed to be half
@@ -63,381 +71,360 @@ void ProcessFBQuad(QuadFilterChainState &d, fbq_global &g, float *OutL, float *O
     switch (config)
     {
     case fc_serial1: // no feedback at all  (saves CPU)
-        for (int k = 0; k < BLOCK_SIZE_OS; k++)
+    {
+        __m128 input = d.DL[k];
+        __m128 x = input, y = d.DR[k];
+        __m128 mask = _mm_load_ps((float *)&d.FU[0].active);
+
+        if (A)
+            x = g.FU1ptr(&d.FU[0], x);
+        if (WS)
         {
-            __m128 input = d.DL[k];
-            __m128 x = input, y = d.DR[k];
-            __m128 mask = _mm_load_ps((float *)&d.FU[0].active);
-
-            if (A)
-                x = g.FU1ptr(&d.FU[0], x);
-            if (WS)
-            {
-                d.wsLPF = _mm_mul_ps(hb_c, _mm_add_ps(d.wsLPF, _mm_and_ps(mask, x)));
-                d.Drive = _mm_add_ps(d.Drive, d.dDrive);
-                x = g.WSptr(&d.WSS[0], d.wsLPF, d.Drive);
-            }
-
-            if (A || WS)
-            {
-                d.Mix1 = _mm_add_ps(d.Mix1, d.dMix1);
-                x = _mm_add_ps(_mm_mul_ps(input, _mm_sub_ps(one, d.Mix1)), _mm_mul_ps(x, d.Mix1));
-            }
+            d.wsLPF = _mm_mul_ps(hb_c, _mm_add_ps(d.wsLPF, _mm_and_ps(mask, x)));
+            d.Drive = _mm_add_ps(d.Drive, d.dDrive);
+            x = g.WSptr(&d.WSS[0], d.wsLPF, d.Drive);
+        }
 
-            y = _mm_add_ps(x, y);
+        if (A || WS)
+        {
+            d.Mix1 = _mm_add_ps(d.Mix1, d.dMix1);
+            x = _mm_add_ps(_mm_mul_ps(input, _mm_sub_ps(one, d.Mix1)), _mm_mul_ps(x, d.Mix1));
+        }
 
-            if (B)
-                y = g.FU2ptr(&d.FU[1], y);
+        y = _mm_add_ps(x, y);
 
-            d.Mix2 = _mm_add_ps(d.Mix2, d.dMix2);
-            x = _mm_add_ps(_mm_mul_ps(x, _mm_sub_ps(one, d.Mix2)), _mm_mul_ps(y, d.Mix2));
-            d.Gain = _mm_add_ps(d.Gain, d.dGain);
-            __m128 out = _mm_and_ps(mask, _mm_mul_ps(x, d.Gain));
+        if (B)
+            y = g.FU2ptr(&d.FU[1], y);
 
-            // output stage
-            MWriteOutputs(out)
-        }
-        break;
+        d.Mix2 = _mm_add_ps(d.Mix2, d.dMix2);
+        x = _mm_add_ps(_mm_mul_ps(x, _mm_sub_ps(one, d.Mix2)), _mm_mul_ps(y, d.Mix2));
+        d.Gain = _mm_add_ps(d.Gain, d.dGain);
+        __m128 out = _mm_and_ps(mask, _mm_mul_ps(x, d.Gain));
+
+        // output stage
+        MWriteOutputs(out)
+    }
+    break;
     case fc_serial2:
-        for (int k = 0; k < BLOCK_SIZE_OS; k++)
+    {
+        d.FB = _mm_add_ps(d.FB, d.dFB);
+        __m128 input = vMul(d.FB, d.FBlineL);
+        input = vAdd(d.DL[k], sdsp::softclip_ps(input));
+        __m128 mask = _mm_load_ps((float *)&d.FU[0].active);
+        __m128 x = input, y = d.DR[k];
+
+        if (A)
+            x = g.FU1ptr(&d.FU[0], x);
+        if (WS)
         {
-            d.FB = _mm_add_ps(d.FB, d.dFB);
-            __m128 input = vMul(d.FB, d.FBlineL);
-            input = vAdd(d.DL[k], sdsp::softclip_ps(input));
-            __m128 mask = _mm_load_ps((float *)&d.FU[0].active);
-            __m128 x = input, y = d.DR[k];
-
-            if (A)
-                x = g.FU1ptr(&d.FU[0], x);
-            if (WS)
-            {
-                d.wsLPF = _mm_mul_ps(hb_c, _mm_add_ps(d.wsLPF, _mm_and_ps(mask, x)));
-                d.Drive = _mm_add_ps(d.Drive, d.dDrive);
-                x = g.WSptr(&d.WSS[0], d.wsLPF, d.Drive);
-            }
-
-            if (A || WS)
-            {
-                d.Mix1 = _mm_add_ps(d.Mix1, d.dMix1);
-                x = _mm_add_ps(_mm_mul_ps(input, _mm_sub_ps(one, d.Mix1)), _mm_mul_ps(x, d.Mix1));
-            }
+            d.wsLPF = _mm_mul_ps(hb_c, _mm_add_ps(d.wsLPF, _mm_and_ps(mask, x)));
+            d.Drive = _mm_add_ps(d.Drive, d.dDrive);
+            x = g.WSptr(&d.WSS[0], d.wsLPF, d.Drive);
+        }
 
-            y = _mm_add_ps(x, y);
+        if (A || WS)
+        {
+            d.Mix1 = _mm_add_ps(d.Mix1, d.dMix1);
+            x = _mm_add_ps(_mm_mul_ps(input, _mm_sub_ps(one, d.Mix1)), _mm_mul_ps(x, d.Mix1));
+        }
 
-            if (B)
-                y = g.FU2ptr(&d.FU[1], y);
+        y = _mm_add_ps(x, y);
 
-            d.Mix2 = _mm_add_ps(d.Mix2, d.dMix2);
-            x = _mm_add_ps(_mm_mul_ps(x, _mm_sub_ps(one, d.Mix2)), _mm_mul_ps(y, d.Mix2));
-            d.Gain = _mm_add_ps(d.Gain, d.dGain);
-            __m128 out = _mm_and_ps(mask, _mm_mul_ps(x, d.Gain));
-            d.FBlineL = out;
+        if (B)
+            y = g.FU2ptr(&d.FU[1], y);
 
-            // output stage
-            MWriteOutputs(out)
-        }
-        break;
+        d.Mix2 = _mm_add_ps(d.Mix2, d.dMix2);
+        x = _mm_add_ps(_mm_mul_ps(x, _mm_sub_ps(one, d.Mix2)), _mm_mul_ps(y, d.Mix2));
+        d.Gain = _mm_add_ps(d.Gain, d.dGain);
+        __m128 out = _mm_and_ps(mask, _mm_mul_ps(x, d.Gain));
+        d.FBlineL = out;
+
+        // output stage
+        MWriteOutputs(out)
+    }
+    break;
     case fc_serial3: // filter 2 is only heard in the feedback path, good for physical modelling
                      // with comb as f2
-        for (int k = 0; k < BLOCK_SIZE_OS; k++)
+    {
+        d.FB = _mm_add_ps(d.FB, d.dFB);
+        __m128 input = vMul(d.FB, d.FBlineL);
+        input = vAdd(d.DL[k], sdsp::softclip_ps(input));
+        __m128 x = input, y = d.DR[k];
+        __m128 mask = _mm_load_ps((float *)&d.FU[0].active);
+
+        if (A)
+            x = g.FU1ptr(&d.FU[0], x);
+        if (WS)
         {
-            d.FB = _mm_add_ps(d.FB, d.dFB);
-            __m128 input = vMul(d.FB, d.FBlineL);
-            input = vAdd(d.DL[k], sdsp::softclip_ps(input));
-            __m128 x = input, y = d.DR[k];
-            __m128 mask = _mm_load_ps((float *)&d.FU[0].active);
-
-            if (A)
-                x = g.FU1ptr(&d.FU[0], x);
-            if (WS)
-            {
-                d.wsLPF = _mm_mul_ps(hb_c, _mm_add_ps(d.wsLPF, _mm_and_ps(mask, x)));
-                d.Drive = _mm_add_ps(d.Drive, d.dDrive);
-                x = g.WSptr(&d.WSS[0], d.wsLPF, d.Drive);
-            }
-
-            if (A || WS)
-            {
-                d.Mix1 = _mm_add_ps(d.Mix1, d.dMix1);
-                x = _mm_add_ps(_mm_mul_ps(input, _mm_sub_ps(one, d.Mix1)), _mm_mul_ps(x, d.Mix1));
-            }
-
-            // output stage
-            d.Gain = _mm_add_ps(d.Gain, d.dGain);
-            x = _mm_and_ps(mask, _mm_mul_ps(x, d.Gain));
-
-            MWriteOutputs(x)
-
-                y = _mm_add_ps(x, y);
-
-            if (B)
-                y = g.FU2ptr(&d.FU[1], y);
-
-            d.Mix2 = _mm_add_ps(d.Mix2, d.dMix2);
-            x = _mm_add_ps(_mm_mul_ps(x, _mm_sub_ps(one, d.Mix2)), _mm_mul_ps(y, d.Mix2));
+            d.wsLPF = _mm_mul_ps(hb_c, _mm_add_ps(d.wsLPF, _mm_and_ps(mask, x)));
+            d.Drive = _mm_add_ps(d.Drive, d.dDrive);
+            x = g.WSptr(&d.WSS[0], d.wsLPF, d.Drive);
+        }
 
-            d.FBlineL = y;
+        if (A || WS)
+        {
+            d.Mix1 = _mm_add_ps(d.Mix1, d.dMix1);
+            x = _mm_add_ps(_mm_mul_ps(input, _mm_sub_ps(one, d.Mix1)), _mm_mul_ps(x, d.Mix1));
         }
-        break;
+
+        // output stage
+        d.Gain = _mm_add_ps(d.Gain, d.dGain);
+        x = _mm_and_ps(mask, _mm_mul_ps(x, d.Gain));
+
+        MWriteOutputs(x)
+
+            y = _mm_add_ps(x, y);
+
+        if (B)
+            y = g.FU2ptr(&d.FU[1], y);
+
+        d.Mix2 = _mm_add_ps(d.Mix2, d.dMix2);
+        x = _mm_add_ps(_mm_mul_ps(x, _mm_sub_ps(one, d.Mix2)), _mm_mul_ps(y, d.Mix2));
+
+        d.FBlineL = y;
+    }
+    break;
     case fc_dual1:
-        for (int k = 0; k < BLOCK_SIZE_OS; k++)
-        {
-            d.FB = _mm_add_ps(d.FB, d.dFB);
-            __m128 fb = _mm_mul_ps(d.FB, d.FBlineL);
-            fb = sdsp::softclip_ps(fb);
-            __m128 x = _mm_add_ps(d.DL[k], fb);
-            __m128 y = _mm_add_ps(d.DR[k], fb);
-            __m128 mask = _mm_load_ps((float *)&d.FU[0].active);
-
-            if (A)
-                x = g.FU1ptr(&d.FU[0], x);
-            if (B)
-                y = g.FU2ptr(&d.FU[1], y);
+    {
+        d.FB = _mm_add_ps(d.FB, d.dFB);
+        __m128 fb = _mm_mul_ps(d.FB, d.FBlineL);
+        fb = sdsp::softclip_ps(fb);
+        __m128 x = _mm_add_ps(d.DL[k], fb);
+        __m128 y = _mm_add_ps(d.DR[k], fb);
+        __m128 mask = _mm_load_ps((float *)&d.FU[0].active);
+
+        if (A)
+            x = g.FU1ptr(&d.FU[0], x);
+        if (B)
+            y = g.FU2ptr(&d.FU[1], y);
 
-            d.Mix1 = _mm_add_ps(d.Mix1, d.dMix1);
-            d.Mix2 = _mm_add_ps(d.Mix2, d.dMix2);
-            x = _mm_add_ps(_mm_mul_ps(x, d.Mix1), _mm_mul_ps(y, d.Mix2));
-
-            if (WS)
-            {
-                d.wsLPF = _mm_mul_ps(hb_c, _mm_add_ps(d.wsLPF, _mm_and_ps(mask, x)));
-                d.Drive = _mm_add_ps(d.Drive, d.dDrive);
-                x = g.WSptr(&d.WSS[0], d.wsLPF, d.Drive);
-            }
-
-            d.Gain = _mm_add_ps(d.Gain, d.dGain);
-            __m128 out = _mm_and_ps(mask, _mm_mul_ps(x, d.Gain));
-            d.FBlineL = out;
-            // output stage
-            MWriteOutputs(out)
+        d.Mix1 = _mm_add_ps(d.Mix1, d.dMix1);
+        d.Mix2 = _mm_add_ps(d.Mix2, d.dMix2);
+        x = _mm_add_ps(_mm_mul_ps(x, d.Mix1), _mm_mul_ps(y, d.Mix2));
+
+        if (WS)
+        {
+            d.wsLPF = _mm_mul_ps(hb_c, _mm_add_ps(d.wsLPF, _mm_and_ps(mask, x)));
+            d.Drive = _mm_add_ps(d.Drive, d.dDrive);
+            x = g.WSptr(&d.WSS[0], d.wsLPF, d.Drive);
         }
-        break;
+
+        d.Gain = _mm_add_ps(d.Gain, d.dGain);
+        __m128 out = _mm_and_ps(mask, _mm_mul_ps(x, d.Gain));
+        d.FBlineL = out;
+        // output stage
+        MWriteOutputs(out)
+    }
+    break;
     case fc_dual2:
-        for (int k = 0; k < BLOCK_SIZE_OS; k++)
+    {
+        d.FB = _mm_add_ps(d.FB, d.dFB);
+        __m128 fb = _mm_mul_ps(d.FB, d.FBlineL);
+        fb = sdsp::softclip_ps(fb);
+        __m128 x = _mm_add_ps(d.DL[k], fb);
+        __m128 y = _mm_add_ps(d.DR[k], fb);
+        __m128 mask = _mm_load_ps((float *)&d.FU[0].active);
+
+        if (A)
+            x = g.FU1ptr(&d.FU[0], x);
+        if (WS)
         {
-            d.FB = _mm_add_ps(d.FB, d.dFB);
-            __m128 fb = _mm_mul_ps(d.FB, d.FBlineL);
-            fb = sdsp::softclip_ps(fb);
-            __m128 x = _mm_add_ps(d.DL[k], fb);
-            __m128 y = _mm_add_ps(d.DR[k], fb);
-            __m128 mask = _mm_load_ps((float *)&d.FU[0].active);
-
-            if (A)
-                x = g.FU1ptr(&d.FU[0], x);
-            if (WS)
-            {
-                d.wsLPF = _mm_mul_ps(hb_c, _mm_add_ps(d.wsLPF, _mm_and_ps(mask, x)));
-                d.Drive = _mm_add_ps(d.Drive, d.dDrive);
-                x = g.WSptr(&d.WSS[0], d.wsLPF, d.Drive);
-            }
-
-            if (B)
-                y = g.FU2ptr(&d.FU[1], y);
+            d.wsLPF = _mm_mul_ps(hb_c, _mm_add_ps(d.wsLPF, _mm_and_ps(mask, x)));
+            d.Drive = _mm_add_ps(d.Drive, d.dDrive);
+            x = g.WSptr(&d.WSS[0], d.wsLPF, d.Drive);
+        }
 
-            d.Mix1 = _mm_add_ps(d.Mix1, d.dMix1);
-            d.Mix2 = _mm_add_ps(d.Mix2, d.dMix2);
-            x = _mm_add_ps(_mm_mul_ps(x, d.Mix1), _mm_mul_ps(y, d.Mix2));
+        if (B)
+            y = g.FU2ptr(&d.FU[1], y);
 
-            d.Gain = _mm_add_ps(d.Gain, d.dGain);
-            __m128 out = _mm_and_ps(mask, _mm_mul_ps(x, d.Gain));
-            d.FBlineL = out;
-            // output stage
-            MWriteOutputs(out)
-        }
-        break;
+        d.Mix1 = _mm_add_ps(d.Mix1, d.dMix1);
+        d.Mix2 = _mm_add_ps(d.Mix2, d.dMix2);
+        x = _mm_add_ps(_mm_mul_ps(x, d.Mix1), _mm_mul_ps(y, d.Mix2));
+
+        d.Gain = _mm_add_ps(d.Gain, d.dGain);
+        __m128 out = _mm_and_ps(mask, _mm_mul_ps(x, d.Gain));
+        d.FBlineL = out;
+        // output stage
+        MWriteOutputs(out)
+    }
+    break;
     case fc_ring:
-        for (int k = 0; k < BLOCK_SIZE_OS; k++)
-        {
-            d.FB = _mm_add_ps(d.FB, d.dFB);
-            __m128 fb = _mm_mul_ps(d.FB, d.FBlineL);
-            fb = sdsp::softclip_ps(fb);
-            __m128 x = _mm_add_ps(d.DL[k], fb);
-            __m128 y = _mm_add_ps(d.DR[k], fb);
-            __m128 mask = _mm_load_ps((float *)&d.FU[0].active);
-
-            if (A)
-                x = g.FU1ptr(&d.FU[0], x);
-            if (B)
-                y = g.FU2ptr(&d.FU[1], y);
+    {
+        d.FB = _mm_add_ps(d.FB, d.dFB);
+        __m128 fb = _mm_mul_ps(d.FB, d.FBlineL);
+        fb = sdsp::softclip_ps(fb);
+        __m128 x = _mm_add_ps(d.DL[k], fb);
+        __m128 y = _mm_add_ps(d.DR[k], fb);
+        __m128 mask = _mm_load_ps((float *)&d.FU[0].active);
+
+        if (A)
+            x = g.FU1ptr(&d.FU[0], x);
+        if (B)
+            y = g.FU2ptr(&d.FU[1], y);
 
-            d.Mix1 = _mm_add_ps(d.Mix1, d.dMix1);
-            d.Mix2 = _mm_add_ps(d.Mix2, d.dMix2);
+        d.Mix1 = _mm_add_ps(d.Mix1, d.dMix1);
+        d.Mix2 = _mm_add_ps(d.Mix2, d.dMix2);
+
+        x = _mm_mul_ps(
+            _mm_add_ps(_mm_mul_ps(_mm_sub_ps(one, d.Mix1), y), _mm_mul_ps(x, d.Mix1)),
+            _mm_add_ps(_mm_mul_ps(_mm_sub_ps(one, d.Mix2), x), _mm_mul_ps(y, d.Mix2)));
 
-            x = _mm_mul_ps(
-                _mm_add_ps(_mm_mul_ps(_mm_sub_ps(one, d.Mix1), y), _mm_mul_ps(x, d.Mix1)),
-                _mm_add_ps(_mm_mul_ps(_mm_sub_ps(one, d.Mix2), x), _mm_mul_ps(y, d.Mix2)));
-
-            if (WS)
-            {
-                d.wsLPF = _mm_mul_ps(hb_c, _mm_add_ps(d.wsLPF, x));
-                d.Drive = _mm_add_ps(d.Drive, d.dDrive);
-                x = g.WSptr(&d.WSS[0], _mm_and_ps(mask, d.wsLPF), d.Drive);
-            }
-
-            d.Gain = _mm_add_ps(d.Gain, d.dGain);
-            __m128 out = _mm_and_ps(mask, _mm_mul_ps(x, d.Gain));
-            d.FBlineL = out;
-            // output stage
-            MWriteOutputs(out)
+        if (WS)
+        {
+            d.wsLPF = _mm_mul_ps(hb_c, _mm_add_ps(d.wsLPF, x));
+            d.Drive = _mm_add_ps(d.Drive, d.dDrive);
+            x = g.WSptr(&d.WSS[0], _mm_and_ps(mask, d.wsLPF), d.Drive);
         }
-        break;
+
+        d.Gain = _mm_add_ps(d.Gain, d.dGain);
+        __m128 out = _mm_and_ps(mask, _mm_mul_ps(x, d.Gain));
+        d.FBlineL = out;
+        // output stage
+        MWriteOutputs(out)
+    }
+    break;
     case fc_stereo:
-        for (int k = 0; k < BLOCK_SIZE_OS; k++)
+    {
+        d.FB = _mm_add_ps(d.FB, d.dFB);
+        __m128 fb = _mm_mul_ps(d.FB, d.FBlineL);
+        fb = sdsp::softclip_ps(fb);
+        __m128 x = _mm_add_ps(d.DL[k], fb);
+        __m128 y = _mm_add_ps(d.DR[k], fb);
+        __m128 mask = _mm_load_ps((float *)&d.FU[0].active);
+
+        if (A)
+            x = g.FU1ptr(&d.FU[0], x);
+        if (B)
+            y = g.FU2ptr(&d.FU[1], y);
+
+        if (WS)
         {
-            d.FB = _mm_add_ps(d.FB, d.dFB);
-            __m128 fb = _mm_mul_ps(d.FB, d.FBlineL);
-            fb = sdsp::softclip_ps(fb);
-            __m128 x = _mm_add_ps(d.DL[k], fb);
-            __m128 y = _mm_add_ps(d.DR[k], fb);
-            __m128 mask = _mm_load_ps((float *)&d.FU[0].active);
-
-            if (A)
-                x = g.FU1ptr(&d.FU[0], x);
-            if (B)
-                y = g.FU2ptr(&d.FU[1], y);
-
-            if (WS)
-            {
-                d.Drive = _mm_add_ps(d.Drive, d.dDrive);
-                x = g.WSptr(&d.WSS[0], _mm_and_ps(mask, x), d.Drive);
-                y = g.WSptr(&d.WSS[1], _mm_and_ps(mask, y), d.Drive);
-            }
+            d.Drive = _mm_add_ps(d.Drive, d.dDrive);
+            x = g.WSptr(&d.WSS[0], _mm_and_ps(mask, x), d.Drive);
+            y = g.WSptr(&d.WSS[1], _mm_and_ps(mask, y), d.Drive);
+        }
 
-            d.Mix1 = _mm_add_ps(d.Mix1, d.dMix1);
-            d.Mix2 = _mm_add_ps(d.Mix2, d.dMix2);
-            x = _mm_mul_ps(x, d.Mix1);
-            y = _mm_mul_ps(y, d.Mix2);
+        d.Mix1 = _mm_add_ps(d.Mix1, d.dMix1);
+        d.Mix2 = _mm_add_ps(d.Mix2, d.dMix2);
+        x = _mm_mul_ps(x, d.Mix1);
+        y = _mm_mul_ps(y, d.Mix2);
 
-            d.Gain = _mm_add_ps(d.Gain, d.dGain);
-            x = _mm_and_ps(mask, _mm_mul_ps(x, d.Gain));
-            y = _mm_and_ps(mask, _mm_mul_ps(y, d.Gain));
-            d.FBlineL = _mm_add_ps(x, y);
+        d.Gain = _mm_add_ps(d.Gain, d.dGain);
+        x = _mm_and_ps(mask, _mm_mul_ps(x, d.Gain));
+        y = _mm_and_ps(mask, _mm_mul_ps(y, d.Gain));
+        d.FBlineL = _mm_add_ps(x, y);
 
-            // output stage
-            MWriteOutputsDual(x, y) AssertReasonableAudioFloat(OutL[k]);
-            AssertReasonableAudioFloat(OutR[k]);
-        }
-        break;
+        // output stage
+        MWriteOutputsDual(x, y) AssertReasonableAudioFloat(OutL[k]);
+        AssertReasonableAudioFloat(OutR[k]);
+    }
+    break;
     case fc_wide:
-        for (int k = 0; k < BLOCK_SIZE_OS; k++)
+    {
+        d.FB = _mm_add_ps(d.FB, d.dFB);
+        __m128 fbL = _mm_mul_ps(d.FB, d.FBlineL);
+        __m128 fbR = _mm_mul_ps(d.FB, d.FBlineR);
+        __m128 xin = _mm_add_ps(d.DL[k], sdsp::softclip_ps(fbL));
+        __m128 yin = _mm_add_ps(d.DR[k], sdsp::softclip_ps(fbR));
+        __m128 x = xin;
+        __m128 y = yin;
+
+        __m128 mask = _mm_load_ps((float *)&d.FU[0].active);
+
+        if (A)
         {
-            d.FB = _mm_add_ps(d.FB, d.dFB);
-            __m128 fbL = _mm_mul_ps(d.FB, d.FBlineL);
-            __m128 fbR = _mm_mul_ps(d.FB, d.FBlineR);
-            __m128 xin = _mm_add_ps(d.DL[k], sdsp::softclip_ps(fbL));
-            __m128 yin = _mm_add_ps(d.DR[k], sdsp::softclip_ps(fbR));
-            __m128 x = xin;
-            __m128 y = yin;
-
-            __m128 mask = _mm_load_ps((float *)&d.FU[0].active);
-
-            if (A)
-            {
-                x = g.FU1ptr(&d.FU[0], x);
-                y = g.FU1ptr(&d.FU[2], y);
-            }
-
-            if (WS)
-            {
-                d.Drive = _mm_add_ps(d.Drive, d.dDrive);
-                x = g.WSptr(&d.WSS[0], _mm_and_ps(mask, x), d.Drive);
-                y = g.WSptr(&d.WSS[1], _mm_and_ps(mask, y), d.Drive);
-            }
-
-            if (A || WS)
-            {
-                d.Mix1 = _mm_add_ps(d.Mix1, d.dMix1);
-                __m128 t = _mm_sub_ps(one, d.Mix1);
-                x = _mm_add_ps(_mm_mul_ps(xin, t), _mm_mul_ps(x, d.Mix1));
-                y = _mm_add_ps(_mm_mul_ps(yin, t), _mm_mul_ps(y, d.Mix1));
-            }
-
-            if (B)
-            {
-                __m128 z = g.FU2ptr(&d.FU[1], x);
-                __m128 w = g.FU2ptr(&d.FU[3], y);
-
-                d.Mix2 = _mm_add_ps(d.Mix2, d.dMix2);
-                __m128 t = _mm_sub_ps(one, d.Mix2);
-                x = _mm_add_ps(_mm_mul_ps(x, t), _mm_mul_ps(z, d.Mix2));
-                y = _mm_add_ps(_mm_mul_ps(y, t), _mm_mul_ps(w, d.Mix2));
-            }
-
-            d.Gain = _mm_add_ps(d.Gain, d.dGain);
-            x = _mm_and_ps(mask, _mm_mul_ps(x, d.Gain));
-            y = _mm_and_ps(mask, _mm_mul_ps(y, d.Gain));
-            d.FBlineL = x;
-            d.FBlineR = y;
-
-            // output stage
-            MWriteOutputsDual(x, y) AssertReasonableAudioFloat(OutL[k]);
-            AssertReasonableAudioFloat(OutR[k]);
+            x = g.FU1ptr(&d.FU[0], x);
+            y = g.FU1ptr(&d.FU[2], y);
         }
-        break;
-    }
-}
 
-template <int config> FBQFPtr GetFBQPointer2(bool A, bool WS, bool B)
-{
-    if (A)
-    {
-        if (B)
+        if (WS)
         {
-            if (WS)
-                return ProcessFBQuad<config, 1, 1, 1>;
-            else
-                return ProcessFBQuad<config, 1, 0, 1>;
+            d.Drive = _mm_add_ps(d.Drive, d.dDrive);
+            x = g.WSptr(&d.WSS[0], _mm_and_ps(mask, x), d.Drive);
+            y = g.WSptr(&d.WSS[1], _mm_and_ps(mask, y), d.Drive);
         }
-        else
+
+        if (A || WS)
         {
-            if (WS)
-                return ProcessFBQuad<config, 1, 1, 0>;
-            else
-                return ProcessFBQuad<config, 1, 0, 0>;
+            d.Mix1 = _mm_add_ps(d.Mix1, d.dMix1);
+            __m128 t = _mm_sub_ps(one, d.Mix1);
+            x = _mm_add_ps(_mm_mul_ps(xin, t), _mm_mul_ps(x, d.Mix1));
+            y = _mm_add_ps(_mm_mul_ps(yin, t), _mm_mul_ps(y, d.Mix1));
         }
-    }
-    else
-    {
+
         if (B)
         {
-            if (WS)
-                return ProcessFBQuad<config, 0, 1, 1>;
-            else
-                return ProcessFBQuad<config, 0, 0, 1>;
+            __m128 z = g.FU2ptr(&d.FU[1], x);
+            __m128 w = g.FU2ptr(&d.FU[3], y);
+
+            d.Mix2 = _mm_add_ps(d.Mix2, d.dMix2);
+            __m128 t = _mm_sub_ps(one, d.Mix2);
+            x = _mm_add_ps(_mm_mul_ps(x, t), _mm_mul_ps(z, d.Mix2));
+            y = _mm_add_ps(_mm_mul_ps(y, t), _mm_mul_ps(w, d.Mix2));
         }
-        else
+
+        d.Gain = _mm_add_ps(d.Gain, d.dGain);
+        x = _mm_and_ps(mask, _mm_mul_ps(x, d.Gain));
+        y = _mm_and_ps(mask, _mm_mul_ps(y, d.Gain));
+        d.FBlineL = x;
+        d.FBlineR = y;
+
+        // output stage
+        MWriteOutputsDual(x, y) AssertReasonableAudioFloat(OutL[k]);
+        AssertReasonableAudioFloat(OutR[k]);
+    }
+    break;
+    }
+}
+
+struct FBQuad
+{
+    typedef FBQFPtr ptr_t;
+
+    template <int config, bool A, bool WS, bool B>
+    static void process(QuadFilterChainState &d, fbq_global &g, float *OutL, float *OutR)
+    {
+        for (int k = 0; k < BLOCK_SIZE_OS; k++)
         {
-            if (WS)
-                return ProcessFBQuad<config, 0, 1, 0>;
-            else
-                return ProcessFBQuad<config, 0, 0, 0>;
+            ProcessFBSample<config, A, WS, B>(d, g, OutL, OutR, k);
         }
     }
-    return 0;
-}
+};
 
-FBQFPtr GetFBQPointer(int config, bool A, bool WS, bool B)
+struct FBOct
 {
-    switch (config)
+    typedef FBOctFPtr ptr_t;
+
+    template <int config, bool A, bool WS, bool B>
+    static void process(QuadFilterChainState *d, fbq_global &g, float *OutL, float *OutR)
     {
-    case fc_serial1:
-        return GetFBQPointer2<fc_serial1>(A, WS, B);
-    case fc_serial2:
-        return GetFBQPointer2<fc_serial2>(A, WS, B);
-    case fc_serial3:
-        return GetFBQPointer2<fc_serial3>(A, WS, B);
-    case fc_dual1:
-        return GetFBQPointer2<fc_dual1>(A, WS, B);
-    case fc_dual2:
-        return GetFBQPointer2<fc_dual2>(A, WS, B);
-    case fc_ring:
-        return GetFBQPointer2<fc_ring>(A, WS, B);
-    case fc_stereo:
-        return GetFBQPointer2<fc_stereo>(A, WS, B);
-    case fc_wide:
-        return GetFBQPointer2<fc_wide>(A, WS, B);
+        for (int k = 0; k < BLOCK_SIZE_OS; k++)
+        {
+            ProcessFBSample<config, A, WS, B>(d[0], g, OutL, OutR, k);
+            ProcessFBSample<config, A, WS, B>(d[1], g, OutL, OutR, k);
+        }
     }
-    return 0;
+};
+
+FBQFPtr GetFBQPointer(int config, bool A, bool WS, bool B)
+{
+    return GetFBPointer<FBQuad>(config, A, WS, B);
+}
+
+FBOctFPtr GetFBOctPointerSSE2(int config, bool A, bool WS, bool B)
+{
+    return GetFBPointer<FBOct>(config, A, WS, B);
+}
+
+FBOctFPtr GetFBOctPointer(int config, bool A, bool WS, bool B)
+{
+    static const bool avx2 = Surge::CPUFeatures::useAVX2() && octFilterChainAVX2Compiled();
+
+    // only without a feedback path, see QuadFilterChain.h
+    if (avx2 && config == fc_serial1)
+        return GetFBOctPointerAVX2(config, A, WS, B);
+
+    return GetFBOctPointerSSE2(config, A, WS, B);
 }
 
 void InitQuadFilterChainStateToZero(QuadFilterChainState *Q)
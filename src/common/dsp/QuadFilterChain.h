@@ -158,4 +158,29 @@ typedef void (*FBQFPtr)(QuadFilterChainState &, fbq_global &, float *, float *);
 
 FBQFPtr GetFBQPointer(int config, bool A, bool WS, bool B);
 
+/*
+ * The filter and waveshaper units are 4 wide, but a lot of their cost is the latency of each
+ * sample depending on the one before. So at higher polyphony the synth runs two adjacent
+ * QuadFilterChainStates through the same chain together, stepping both one sample at a time, which
+ * gives the CPU two independent dependency chains to overlap. The outputs accumulate in the same
+ * order as two FBQFPtr calls would, so the result is identical.
+ *
+ * There is also an AVX2 pair, in which the gain, mix, drive and feedback ramps, the feedback
+ * lines and the output stage run in eight lanes, with each half handed to the 4 wide filter
+ * and waveshaper units. It uses the same multiplies and adds in the same order, so it matches
+ * the SSE2 pair bit for bit. It only pays off for fc_serial1: every other configuration feeds
+ * the output back into the next sample, and that chain is latency bound, so one eight lane
+ * chain is no faster than two interleaved four lane ones. GetFBOctPointer therefore only picks
+ * it for fc_serial1, and only when CPUFeatures::useAVX2() says so.
+ */
+typedef void (*FBOctFPtr)(QuadFilterChainState *, fbq_global &, float *, float *);
+
+FBOctFPtr GetFBOctPointer(int config, bool A, bool WS, bool B);
+
+// the two implementations, mostly for the tests. The AVX2 one only exists if
+// octFilterChainAVX2Compiled() and the CPU supports it
+FBOctFPtr GetFBOctPointerSSE2(int config, bool A, bool WS, bool B);
+FBOctFPtr GetFBOctPointerAVX2(int config, bool A, bool WS, bool B);
+bool octFilterChainAVX2Compiled();
+
 #endif // SURGE_SRC_COMMON_DSP_QUADFILTERCHAIN_H
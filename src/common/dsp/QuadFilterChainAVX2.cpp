@@ -0,0 +1,510 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+/*
+ * The AVX2 version of the paired filter chain (see GetFBOctPointer). Like the oscillator
+ * kernels this file is compiled with the project's baseline flags and enables the wider ISA
+ * per function, so nothing in here runs unless the CPU has AVX2.
+ *
+ * Each __m256 holds the first QuadFilterChainState of the pair in its low half and the second
+ * in its high half. The ramps and feedback lines live in an OctRamps for the whole block and
+ * go back into the two states at the end; the filter and waveshaper units only ever see their
+ * own state's half. Every lane does exactly the multiplies and adds ProcessFBSample does, in
+ * the same order, and no FMA, so the two paths render identically.
+ */
+
+#include "QuadFilterChain.h"
+#include "QuadFilterChainDispatch.h"
+#include "SurgeStorage.h"
+#include "sst/basic-blocks/mechanics/simd-ops.h"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define SURGE_QFC_HAVE_AVX2 1
+#include <immintrin.h>
+
+#if defined(__GNUC__) || defined(__clang__)
+#define SURGE_QFC_AVX2_TARGET __attribute__((target("avx2")))
+#else
+#define SURGE_QFC_AVX2_TARGET
+#endif
+#else
+#define SURGE_QFC_HAVE_AVX2 0
+#endif
+
+#if SURGE_QFC_HAVE_AVX2
+namespace mech = sst::basic_blocks::mechanics;
+
+namespace
+{
+SURGE_QFC_AVX2_TARGET inline __m256 join(__m128 lo, __m128 hi)
+{
+    return _mm256_insertf128_ps(_mm256_castps128_ps256(lo), hi, 1);
+}
+
+SURGE_QFC_AVX2_TARGET inline __m128 lo(__m256 v) { return _mm256_castps256_ps128(v); }
+SURGE_QFC_AVX2_TARGET inline __m128 hi(__m256 v) { return _mm256_extractf128_ps(v, 1); }
+
+SURGE_QFC_AVX2_TARGET inline __m256 filter(sst::filters::FilterUnitQFPtr fn,
+                                           QuadFilterChainState *d, int unit, __m256 x)
+{
+    return join(fn(&d[0].FU[unit], lo(x)), fn(&d[1].FU[unit], hi(x)));
+}
+
+SURGE_QFC_AVX2_TARGET inline __m256 shape(fbq_global &g, QuadFilterChainState *d, int unit,
+                                          __m256 x, __m256 drive)
+{
+    return join(g.WSptr(&d[0].WSS[unit], lo(x), lo(drive)),
+                g.WSptr(&d[1].WSS[unit], hi(x), hi(drive)));
+}
+
+/*
+ * sdsp::softclip_ps in eight lanes: y = x - (4/27) x^3 with x clamped to [-1.5, 1.5], with
+ * the multiplies in the same order. It sits on the feedback path, where splitting the vector
+ * to call the 4 wide one costs more latency than the wider lanes save. The pair tests in
+ * UnitTestsFLT hold the two to the same bits.
+ */
+SURGE_QFC_AVX2_TARGET inline __m256 softclip(__m256 in)
+{
+    const auto a = _mm256_set1_ps(-4.f / 27.f);
+    const auto x_min = _mm256_set1_ps(-1.5f);
+    const auto x_max = _mm256_set1_ps(1.5f);
+
+    auto x = _mm256_max_ps(_mm256_min_ps(in, x_max), x_min);
+    auto xx = _mm256_mul_ps(x, x);
+    auto t = _mm256_mul_ps(x, a);
+    t = _mm256_mul_ps(t, xx);
+    return _mm256_add_ps(t, x);
+}
+
+// adds the first state's voices into Out[k], then the second's, like two FBQFPtr calls
+SURGE_QFC_AVX2_TARGET inline void accumulate(float *Out, int k, __m256 o)
+{
+    _mm_store_ss(&Out[k], _mm_add_ss(_mm_load_ss(&Out[k]), mech::sum_ps_to_ss(lo(o))));
+    _mm_store_ss(&Out[k], _mm_add_ss(_mm_load_ss(&Out[k]), mech::sum_ps_to_ss(hi(o))));
+}
+
+struct OctRamps
+{
+    __m256 Gain, FB, Mix1, Mix2, Drive;
+    __m256 dGain, dFB, dMix1, dMix2, dDrive;
+
+    __m256 wsLPF, FBlineL, FBlineR;
+
+    __m256 OutL, OutR, dOutL, dOutR;
+    __m256 Out2L, Out2R, dOut2L, dOut2R;
+
+    __m256 mask;
+};
+
+#define SURGE_QFC_OCT_FIELDS(X)                                                                    \
+    X(Gain) X(FB) X(Mix1) X(Mix2) X(Drive) X(dGain) X(dFB) X(dMix1) X(dMix2) X(dDrive) X(wsLPF)    \
+        X(FBlineL) X(FBlineR) X(OutL) X(OutR) X(dOutL) X(dOutR) X(Out2L) X(Out2R) X(dOut2L)        \
+            X(dOut2R)
+
+SURGE_QFC_AVX2_TARGET inline void loadRamps(OctRamps &r, QuadFilterChainState *d)
+{
+#define SURGE_QFC_LOAD(f) r.f = join(d[0].f, d[1].f);
+    SURGE_QFC_OCT_FIELDS(SURGE_QFC_LOAD)
+#undef SURGE_QFC_LOAD
+
+    // the units don't change their active masks, so these hold for the block
+    r.mask = join(_mm_load_ps((float *)&d[0].FU[0].active),
+                  _mm_load_ps((float *)&d[1].FU[0].active));
+}
+
+SURGE_QFC_AVX2_TARGET inline void storeRamps(const OctRamps &r, QuadFilterChainState *d)
+{
+#define SURGE_QFC_STORE(f)                                                                         \
+    d[0].f = lo(r.f);                                                                              \
+    d[1].f = hi(r.f);
+    SURGE_QFC_OCT_FIELDS(SURGE_QFC_STORE)
+#undef SURGE_QFC_STORE
+}
+
+/*
+ * The output stage only keeps the per-voice products here. FBOctAVX2::process sums them
+ * into OutL and OutR after the block, which keeps the horizontal adds and the scalar stores
+ * off the per-sample dependency chain without changing the order anything is added in.
+ */
+struct OctOutputs
+{
+    __m256 L[BLOCK_SIZE_OS], R[BLOCK_SIZE_OS];
+};
+
+SURGE_QFC_AVX2_TARGET inline void writeOutputs(OctRamps &r, OctOutputs &o, __m256 x, int k)
+{
+    r.OutL = _mm256_add_ps(r.OutL, r.dOutL);
+    r.OutR = _mm256_add_ps(r.OutR, r.dOutR);
+    o.L[k] = _mm256_mul_ps(x, r.OutL);
+    o.R[k] = _mm256_mul_ps(x, r.OutR);
+}
+
+SURGE_QFC_AVX2_TARGET inline void writeOutputsDual(OctRamps &r, OctOutputs &o, __m256 x,
+                                                   __m256 y, int k)
+{
+    r.OutL = _mm256_add_ps(r.OutL, r.dOutL);
+    r.OutR = _mm256_add_ps(r.OutR, r.dOutR);
+    r.Out2L = _mm256_add_ps(r.Out2L, r.dOut2L);
+    r.Out2R = _mm256_add_ps(r.Out2R, r.dOut2R);
+    o.L[k] = _mm256_add_ps(_mm256_mul_ps(x, r.OutL), _mm256_mul_ps(y, r.Out2L));
+    o.R[k] = _mm256_add_ps(_mm256_mul_ps(x, r.OutR), _mm256_mul_ps(y, r.Out2R));
+}
+
+// one sample of ProcessFBSample for both states of the pair
+template <int config, bool A, bool WS, bool B>
+SURGE_QFC_AVX2_TARGET inline void ProcessOctSample(QuadFilterChainState *d, OctRamps &r,
+                                                   OctOutputs &o, fbq_global &g, int k)
+{
+    const __m256 hb_c = _mm256_set1_ps(0.5f);
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 mask = r.mask;
+
+    switch (config)
+    {
+    case fc_serial1:
+    {
+        __m256 input = join(d[0].DL[k], d[1].DL[k]);
+        __m256 x = input, y = join(d[0].DR[k], d[1].DR[k]);
+
+        if (A)
+            x = filter(g.FU1ptr, d, 0, x);
+        if (WS)
+        {
+            r.wsLPF = _mm256_mul_ps(hb_c, _mm256_add_ps(r.wsLPF, _mm256_and_ps(mask, x)));
+            r.Drive = _mm256_add_ps(r.Drive, r.dDrive);
+            x = shape(g, d, 0, r.wsLPF, r.Drive);
+        }
+
+        if (A || WS)
+        {
+            r.Mix1 = _mm256_add_ps(r.Mix1, r.dMix1);
+            x = _mm256_add_ps(_mm256_mul_ps(input, _mm256_sub_ps(one, r.Mix1)),
+                              _mm256_mul_ps(x, r.Mix1));
+        }
+
+        y = _mm256_add_ps(x, y);
+
+        if (B)
+            y = filter(g.FU2ptr, d, 1, y);
+
+        r.Mix2 = _mm256_add_ps(r.Mix2, r.dMix2);
+        x = _mm256_add_ps(_mm256_mul_ps(x, _mm256_sub_ps(one, r.Mix2)), _mm256_mul_ps(y, r.Mix2));
+        r.Gain = _mm256_add_ps(r.Gain, r.dGain);
+        __m256 out = _mm256_and_ps(mask, _mm256_mul_ps(x, r.Gain));
+
+        writeOutputs(r, o, out, k);
+    }
+    break;
+    case fc_serial2:
+    {
+        r.FB = _mm256_add_ps(r.FB, r.dFB);
+        __m256 input = _mm256_mul_ps(r.FB, r.FBlineL);
+        input = _mm256_add_ps(join(d[0].DL[k], d[1].DL[k]), softclip(input));
+        __m256 x = input, y = join(d[0].DR[k], d[1].DR[k]);
+
+        if (A)
+            x = filter(g.FU1ptr, d, 0, x);
+        if (WS)
+        {
+            r.wsLPF = _mm256_mul_ps(hb_c, _mm256_add_ps(r.wsLPF, _mm256_and_ps(mask, x)));
+            r.Drive = _mm256_add_ps(r.Drive, r.dDrive);
+            x = shape(g, d, 0, r.wsLPF, r.Drive);
+        }
+
+        if (A || WS)
+        {
+            r.Mix1 = _mm256_add_ps(r.Mix1, r.dMix1);
+            x = _mm256_add_ps(_mm256_mul_ps(input, _mm256_sub_ps(one, r.Mix1)),
+                              _mm256_mul_ps(x, r.Mix1));
+        }
+
+        y = _mm256_add_ps(x, y);
+
+        if (B)
+            y = filter(g.FU2ptr, d, 1, y);
+
+        r.Mix2 = _mm256_add_ps(r.Mix2, r.dMix2);
+        x = _mm256_add_ps(_mm256_mul_ps(x, _mm256_sub_ps(one, r.Mix2)), _mm256_mul_ps(y, r.Mix2));
+        r.Gain = _mm256_add_ps(r.Gain, r.dGain);
+        __m256 out = _mm256_and_ps(mask, _mm256_mul_ps(x, r.Gain));
+        r.FBlineL = out;
+
+        writeOutputs(r, o, out, k);
+    }
+    break;
+    case fc_serial3:
+    {
+        r.FB = _mm256_add_ps(r.FB, r.dFB);
+        __m256 input = _mm256_mul_ps(r.FB, r.FBlineL);
+        input = _mm256_add_ps(join(d[0].DL[k], d[1].DL[k]), softclip(input));
+        __m256 x = input, y = join(d[0].DR[k], d[1].DR[k]);
+
+        if (A)
+            x = filter(g.FU1ptr, d, 0, x);
+        if (WS)
+        {
+            r.wsLPF = _mm256_mul_ps(hb_c, _mm256_add_ps(r.wsLPF, _mm256_and_ps(mask, x)));
+            r.Drive = _mm256_add_ps(r.Drive, r.dDrive);
+            x = shape(g, d, 0, r.wsLPF, r.Drive);
+        }
+
+        if (A || WS)
+        {
+            r.Mix1 = _mm256_add_ps(r.Mix1, r.dMix1);
+            x = _mm256_add_ps(_mm256_mul_ps(input, _mm256_sub_ps(one, r.Mix1)),
+                              _mm256_mul_ps(x, r.Mix1));
+        }
+
+        r.Gain = _mm256_add_ps(r.Gain, r.dGain);
+        x = _mm256_and_ps(mask, _mm256_mul_ps(x, r.Gain));
+
+        writeOutputs(r, o, x, k);
+
+        y = _mm256_add_ps(x, y);
+
+        if (B)
+            y = filter(g.FU2ptr, d, 1, y);
+
+        r.Mix2 = _mm256_add_ps(r.Mix2, r.dMix2);
+
+        r.FBlineL = y;
+    }
+    break;
+    case fc_dual1:
+    {
+        r.FB = _mm256_add_ps(r.FB, r.dFB);
+        __m256 fb = softclip(_mm256_mul_ps(r.FB, r.FBlineL));
+        __m256 x = _mm256_add_ps(join(d[0].DL[k], d[1].DL[k]), fb);
+        __m256 y = _mm256_add_ps(join(d[0].DR[k], d[1].DR[k]), fb);
+
+        if (A)
+            x = filter(g.FU1ptr, d, 0, x);
+        if (B)
+            y = filter(g.FU2ptr, d, 1, y);
+
+        r.Mix1 = _mm256_add_ps(r.Mix1, r.dMix1);
+        r.Mix2 = _mm256_add_ps(r.Mix2, r.dMix2);
+        x = _mm256_add_ps(_mm256_mul_ps(x, r.Mix1), _mm256_mul_ps(y, r.Mix2));
+
+        if (WS)
+        {
+            r.wsLPF = _mm256_mul_ps(hb_c, _mm256_add_ps(r.wsLPF, _mm256_and_ps(mask, x)));
+            r.Drive = _mm256_add_ps(r.Drive, r.dDrive);
+            x = shape(g, d, 0, r.wsLPF, r.Drive);
+        }
+
+        r.Gain = _mm256_add_ps(r.Gain, r.dGain);
+        __m256 out = _mm256_and_ps(mask, _mm256_mul_ps(x, r.Gain));
+        r.FBlineL = out;
+
+        writeOutputs(r, o, out, k);
+    }
+    break;
+    case fc_dual2:
+    {
+        r.FB = _mm256_add_ps(r.FB, r.dFB);
+        __m256 fb = softclip(_mm256_mul_ps(r.FB, r.FBlineL));
+        __m256 x = _mm256_add_ps(join(d[0].DL[k], d[1].DL[k]), fb);
+        __m256 y = _mm256_add_ps(join(d[0].DR[k], d[1].DR[k]), fb);
+
+        if (A)
+            x = filter(g.FU1ptr, d, 0, x);
+        if (WS)
+        {
+            r.wsLPF = _mm256_mul_ps(hb_c, _mm256_add_ps(r.wsLPF, _mm256_and_ps(mask, x)));
+            r.Drive = _mm256_add_ps(r.Drive, r.dDrive);
+            x = shape(g, d, 0, r.wsLPF, r.Drive);
+        }
+
+        if (B)
+            y = filter(g.FU2ptr, d, 1, y);
+
+        r.Mix1 = _mm256_add_ps(r.Mix1, r.dMix1);
+        r.Mix2 = _mm256_add_ps(r.Mix2, r.dMix2);
+        x = _mm256_add_ps(_mm256_mul_ps(x, r.Mix1), _mm256_mul_ps(y, r.Mix2));
+
+        r.Gain = _mm256_add_ps(r.Gain, r.dGain);
+        __m256 out = _mm256_and_ps(mask, _mm256_mul_ps(x, r.Gain));
+        r.FBlineL = out;
+
+        writeOutputs(r, o, out, k);
+    }
+    break;
+    case fc_ring:
+    {
+        r.FB = _mm256_add_ps(r.FB, r.dFB);
+        __m256 fb = softclip(_mm256_mul_ps(r.FB, r.FBlineL));
+        __m256 x = _mm256_add_ps(join(d[0].DL[k], d[1].DL[k]), fb);
+        __m256 y = _mm256_add_ps(join(d[0].DR[k], d[1].DR[k]), fb);
+
+        if (A)
+            x = filter(g.FU1ptr, d, 0, x);
+        if (B)
+            y = filter(g.FU2ptr, d, 1, y);
+
+        r.Mix1 = _mm256_add_ps(r.Mix1, r.dMix1);
+        r.Mix2 = _mm256_add_ps(r.Mix2, r.dMix2);
+
+        x = _mm256_mul_ps(
+            _mm256_add_ps(_mm256_mul_ps(_mm256_sub_ps(one, r.Mix1), y), _mm256_mul_ps(x, r.Mix1)),
+            _mm256_add_ps(_mm256_mul_ps(_mm256_sub_ps(one, r.Mix2), x), _mm256_mul_ps(y, r.Mix2)));
+
+        if (WS)
+        {
+            r.wsLPF = _mm256_mul_ps(hb_c, _mm256_add_ps(r.wsLPF, x));
+            r.Drive = _mm256_add_ps(r.Drive, r.dDrive);
+            x = shape(g, d, 0, _mm256_and_ps(mask, r.wsLPF), r.Drive);
+        }
+
+        r.Gain = _mm256_add_ps(r.Gain, r.dGain);
+        __m256 out = _mm256_and_ps(mask, _mm256_mul_ps(x, r.Gain));
+        r.FBlineL = out;
+
+        writeOutputs(r, o, out, k);
+    }
+    break;
+    case fc_stereo:
+    {
+        r.FB = _mm256_add_ps(r.FB, r.dFB);
+        __m256 fb = softclip(_mm256_mul_ps(r.FB, r.FBlineL));
+        __m256 x = _mm256_add_ps(join(d[0].DL[k], d[1].DL[k]), fb);
+        __m256 y = _mm256_add_ps(join(d[0].DR[k], d[1].DR[k]), fb);
+
+        if (A)
+            x = filter(g.FU1ptr, d, 0, x);
+        if (B)
+            y = filter(g.FU2ptr, d, 1, y);
+
+        if (WS)
+        {
+            r.Drive = _mm256_add_ps(r.Drive, r.dDrive);
+            x = shape(g, d, 0, _mm256_and_ps(mask, x), r.Drive);
+            y = shape(g, d, 1, _mm256_and_ps(mask, y), r.Drive);
+        }
+
+        r.Mix1 = _mm256_add_ps(r.Mix1, r.dMix1);
+        r.Mix2 = _mm256_add_ps(r.Mix2, r.dMix2);
+        x = _mm256_mul_ps(x, r.Mix1);
+        y = _mm256_mul_ps(y, r.Mix2);
+
+        r.Gain = _mm256_add_ps(r.Gain, r.dGain);
+        x = _mm256_and_ps(mask, _mm256_mul_ps(x, r.Gain));
+        y = _mm256_and_ps(mask, _mm256_mul_ps(y, r.Gain));
+        r.FBlineL = _mm256_add_ps(x, y);
+
+        writeOutputsDual(r, o, x, y, k);
+    }
+    break;
+    case fc_wide:
+    {
+        r.FB = _mm256_add_ps(r.FB, r.dFB);
+        __m256 fbL = _mm256_mul_ps(r.FB, r.FBlineL);
+        __m256 fbR = _mm256_mul_ps(r.FB, r.FBlineR);
+        __m256 xin = _mm256_add_ps(join(d[0].DL[k], d[1].DL[k]), softclip(fbL));
+        __m256 yin = _mm256_add_ps(join(d[0].DR[k], d[1].DR[k]), softclip(fbR));
+        __m256 x = xin;
+        __m256 y = yin;
+
+        if (A)
+        {
+            x = filter(g.FU1ptr, d, 0, x);
+            y = filter(g.FU1ptr, d, 2, y);
+        }
+
+        if (WS)
+        {
+            r.Drive = _mm256_add_ps(r.Drive, r.dDrive);
+            x = shape(g, d, 0, _mm256_and_ps(mask, x), r.Drive);
+            y = shape(g, d, 1, _mm256_and_ps(mask, y), r.Drive);
+        }
+
+        if (A || WS)
+        {
+            r.Mix1 = _mm256_add_ps(r.Mix1, r.dMix1);
+            __m256 t = _mm256_sub_ps(one, r.Mix1);
+            x = _mm256_add_ps(_mm256_mul_ps(xin, t), _mm256_mul_ps(x, r.Mix1));
+            y = _mm256_add_ps(_mm256_mul_ps(yin, t), _mm256_mul_ps(y, r.Mix1));
+        }
+
+        if (B)
+        {
+            __m256 z = filter(g.FU2ptr, d, 1, x);
+            __m256 w = filter(g.FU2ptr, d, 3, y);
+
+            r.Mix2 = _mm256_add_ps(r.Mix2, r.dMix2);
+            __m256 t = _mm256_sub_ps(one, r.Mix2);
+            x = _mm256_add_ps(_mm256_mul_ps(x, t), _mm256_mul_ps(z, r.Mix2));
+            y = _mm256_add_ps(_mm256_mul_ps(y, t), _mm256_mul_ps(w, r.Mix2));
+        }
+
+        r.Gain = _mm256_add_ps(r.Gain, r.dGain);
+        x = _mm256_and_ps(mask, _mm256_mul_ps(x, r.Gain));
+        y = _mm256_and_ps(mask, _mm256_mul_ps(y, r.Gain));
+        r.FBlineL = x;
+        r.FBlineR = y;
+
+        writeOutputsDual(r, o, x, y, k);
+    }
+    break;
+    }
+}
+
+struct FBOctAVX2
+{
+    typedef FBOctFPtr ptr_t;
+
+    template <int config, bool A, bool WS, bool B>
+    SURGE_QFC_AVX2_TARGET static void process(QuadFilterChainState *d, fbq_global &g,
+                                              float *OutL, float *OutR)
+    {
+        OctRamps r;
+        OctOutputs o;
+        loadRamps(r, d);
+
+        for (int k = 0; k < BLOCK_SIZE_OS; k++)
+        {
+            ProcessOctSample<config, A, WS, B>(d, r, o, g, k);
+        }
+
+        storeRamps(r, d);
+
+        for (int k = 0; k < BLOCK_SIZE_OS; k++)
+        {
+            accumulate(OutL, k, o.L[k]);
+            accumulate(OutR, k, o.R[k]);
+        }
+    }
+};
+} // namespace
+
+bool octFilterChainAVX2Compiled() { return true; }
+
+FBOctFPtr GetFBOctPointerAVX2(int config, bool A, bool WS, bool B)
+{
+    return GetFBPointer<FBOctAVX2>(config, A, WS, B);
+}
+#else
+bool octFilterChainAVX2Compiled() { return false; }
+
+// never selected; present so the dispatch links on every architecture
+FBOctFPtr GetFBOctPointerAVX2(int, bool, bool, bool) { return nullptr; }
+#endif
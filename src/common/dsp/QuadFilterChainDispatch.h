@@ -0,0 +1,96 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+#ifndef SURGE_SRC_COMMON_DSP_QUADFILTERCHAINDISPATCH_H
+#define SURGE_SRC_COMMON_DSP_QUADFILTERCHAINDISPATCH_H
+
+/*
+ * Picks the instantiation of P::process for a filter block configuration and which of
+ * filter A, the waveshaper and filter B are on. Shared by the SSE2 chains in
+ * QuadFilterChain.cpp and the AVX2 pairs in QuadFilterChainAVX2.cpp.
+ */
+
+#include "SurgeStorage.h"
+
+template <typename P, int config> typename P::ptr_t GetFBPointer2(bool A, bool WS, bool B)
+{
+    if (A)
+    {
+        if (B)
+        {
+            if (WS)
+                return P::template process<config, 1, 1, 1>;
+            else
+                return P::template process<config, 1, 0, 1>;
+        }
+        else
+        {
+            if (WS)
+                return P::template process<config, 1, 1, 0>;
+            else
+                return P::template process<config, 1, 0, 0>;
+        }
+    }
+    else
+    {
+        if (B)
+        {
+            if (WS)
+                return P::template process<config, 0, 1, 1>;
+            else
+                return P::template process<config, 0, 0, 1>;
+        }
+        else
+        {
+            if (WS)
+                return P::template process<config, 0, 1, 0>;
+            else
+                return P::template process<config, 0, 0, 0>;
+        }
+    }
+    return 0;
+}
+
+template <typename P> typename P::ptr_t GetFBPointer(int config, bool A, bool WS, bool B)
+{
+    switch (config)
+    {
+    case fc_serial1:
+        return GetFBPointer2<P, fc_serial1>(A, WS, B);
+    case fc_serial2:
+        return GetFBPointer2<P, fc_serial2>(A, WS, B);
+    case fc_serial3:
+        return GetFBPointer2<P, fc_serial3>(A, WS, B);
+    case fc_dual1:
+        return GetFBPointer2<P, fc_dual1>(A, WS, B);
+    case fc_dual2:
+        return GetFBPointer2<P, fc_dual2>(A, WS, B);
+    case fc_ring:
+        return GetFBPointer2<P, fc_ring>(A, WS, B);
+    case fc_stereo:
+        return GetFBPointer2<P, fc_stereo>(A, WS, B);
+    case fc_wide:
+        return GetFBPointer2<P, fc_wide>(A, WS, B);
+    }
+    return 0;
+}
+
+#endif // SURGE_SRC_COMMON_DSP_QUADFILTERCHAINDISPATCH_H
@@ -173,6 +173,9 @@ SurgeVoice::SurgeVoice(SurgeStorage *storage, SurgeSceneStorage *oscene, pdata *
     assert(storage);
     assert(oscene);
 
+    rng.g.seed(storage->rand_u32());
+    SurgeStorage::ScopedRenderRNG voiceRNG(rng);
+
     sampleRateReset();
     memcpy(localcopy, paramptr, sizeof(localcopy));
 
@@ -504,9 +507,10 @@ void SurgeVoice::switch_toggled()
     /*
      * Since we have updated the keytrack output here we need to re-update the localcopy modulators
      */
-    vector<ModulationRouting>::iterator iter;
-    iter = scene->modulation_voice.begin();
-    while (iter != scene->modulation_voice.end())
+    auto &modulation_voice = storage->audioModulationRouting().voice[state.scene_id];
+    vector<ModulationRouting>::const_iterator iter;
+    iter = modulation_voice.begin();
+    while (iter != modulation_voice.end())
     {
         int src_id = iter->source_id;
         int dst_id = iter->destination_id;
@@ -1006,6 +1010,8 @@ inline void all_ring_modes_block(float *__restrict src1_l, float *__restrict src
 
 bool SurgeVoice::process_block(QuadFilterChainState &Q, int Qe)
 {
+    SurgeStorage::ScopedRenderRNG voiceRNG(rng);
+
     calc_ctrldata<0>(&Q, Qe);
 
     bool is_wide = scene->filterblock_configuration.val.i == fc_wide;
@@ -1242,11 +1248,27 @@ bool SurgeVoice::process_block(QuadFilterChainState &Q, int Qe)
     // pre-filter gain
     osclevels[le_pfg].multiply_2_blocks(output[0], output[1], BLOCK_SIZE_OS_QUAD);
 
-    for (int i = 0; i < BLOCK_SIZE_OS; i++)
+    // a late onset shifts what goes into the lanes rather than the block itself
+    const int shift = onsetDelay * OSC_OVERSAMPLING;
+
+    for (int i = 0; i < shift; i++)
+    {
+        _mm_store_ss(((float *)&Q.DL[i] + Qe), _mm_load_ss(&onsetTail[0][i]));
+        _mm_store_ss(((float *)&Q.DR[i] + Qe), _mm_load_ss(&onsetTail[1][i]));
+    }
+
+    for (int i = shift; i < BLOCK_SIZE_OS; i++)
     {
-        _mm_store_ss(((float *)&Q.DL[i] + Qe), _mm_load_ss(&output[0][i]));
-        _mm_store_ss(((float *)&Q.DR[i] + Qe), _mm_load_ss(&output[1][i]));
+        _mm_store_ss(((float *)&Q.DL[i] + Qe), _mm_load_ss(&output[0][i - shift]));
+        _mm_store_ss(((float *)&Q.DR[i] + Qe), _mm_load_ss(&output[1][i - shift]));
     }
+
+    if (shift > 0)
+    {
+        std::copy(output[0] + BLOCK_SIZE_OS - shift, output[0] + BLOCK_SIZE_OS, onsetTail[0]);
+        std::copy(output[1] + BLOCK_SIZE_OS - shift, output[1] + BLOCK_SIZE_OS, onsetTail[1]);
+    }
+
     SetQFB(&Q, Qe);
 
     age++;
@@ -1256,11 +1278,32 @@ bool SurgeVoice::process_block(QuadFilterChainState &Q, int Qe)
     return state.keep_playing;
 }
 
+void SurgeVoice::setOnsetDelay(int samples)
+{
+    onsetDelay = limit_range(samples, 0, BLOCK_SIZE - 1);
+
+    if (onsetDelay == 0)
+        return;
+
+    // the constructor has taken the modulators' first full step; make the next one short
+    const float fraction = 1.f - (float)onsetDelay * BLOCK_SIZE_INV;
+
+    ampEGSource.shortenNextBlock(fraction);
+    filterEGSource.shortenNextBlock(fraction);
+
+    for (int i = 0; i < n_lfos_voice; i++)
+    {
+        if (i == 0 || scene->modsource_doprocess[ms_lfo1 + i])
+            lfo[i].shortenNextBlock(fraction);
+    }
+}
+
 template <bool noLFOSources> void SurgeVoice::applyModulationToLocalcopy()
 {
-    vector<ModulationRouting>::iterator iter;
-    iter = scene->modulation_voice.begin();
-    while (iter != scene->modulation_voice.end())
+    auto &routing = storage->audioModulationRouting();
+    vector<ModulationRouting>::const_iterator iter;
+    iter = routing.voice[state.scene_id].begin();
+    while (iter != routing.voice[state.scene_id].end())
     {
         int src_id = iter->source_id;
         int dst_id = iter->destination_id;
@@ -1269,6 +1312,15 @@ template <bool noLFOSources> void SurgeVoice::applyModulationToLocalcopy()
         if (noLFOSources && isLFO((::modsources)src_id))
         {
         }
+        else if (src_id >= ms_lfo1 && src_id < ms_lfo1 + n_lfos_voice &&
+                 lfo[src_id - ms_lfo1].outputsFromBank())
+        {
+            // the scene's VoiceLFOBank ran this LFO's block, so take its output from the lane
+            auto out = lfo[src_id - ms_lfo1].outputsFromBank();
+
+            localcopy[dst_id].f += depth * out[iter->source_index * VoiceLFOBank::outputStride] *
+                                   (1.0 - iter->muted);
+        }
         else if (modsources[src_id])
         {
             localcopy[dst_id].f +=
@@ -1282,8 +1334,8 @@ template <bool noLFOSources> void SurgeVoice::applyModulationToLocalcopy()
         // See github issue 1214. This basically compensates for
         // channel AT being per-voice in MPE mode (since it is per channel)
         // vs per-scene (since it is per keyboard in non MPE mode).
-        iter = scene->modulation_scene.begin();
-        while (iter != scene->modulation_scene.end())
+        iter = routing.scene[state.scene_id].begin();
+        while (iter != routing.scene[state.scene_id].end())
         {
             int src_id = iter->source_id;
             if (src_id == ms_aftertouch && modsources[src_id])
@@ -1722,3 +1774,30 @@ bool SurgeVoice::matchesChannelKeyId(int16_t channel, int16_t key, int32_t nid)
 
     return chanMatch && keyMatch && nidMatch;
 }
+
+void SurgeVoice::addLFOsToBank(VoiceLFOBank &bank)
+{
+    // the same LFOs calc_ctrldata calls process_block on
+    for (int i = 0; i < n_lfos_voice; ++i)
+    {
+        if ((i == 0 || scene->modsource_doprocess[ms_lfo1 + i]) && lfo[i].canRunInBank())
+        {
+            bank.add(i, &lfo[i]);
+        }
+    }
+}
+
+void SurgeVoice::addEnvelopesToBank(VoiceEnvelopeBank &bank)
+{
+    // a retrigger lands between the LFOs and the envelopes in calc_ctrldata, so leave those
+    for (int i = 0; i < n_lfos_voice; ++i)
+    {
+        if ((i == 0 || scene->modsource_doprocess[ms_lfo1 + i]) && lfo[i].canRetriggerEnvelopes())
+        {
+            return;
+        }
+    }
+
+    bank.add(0, &ampEGSource);
+    bank.add(1, &filterEGSource);
+}
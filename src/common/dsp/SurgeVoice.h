@@ -27,6 +27,8 @@
 #include "SurgeVoiceState.h"
 #include "ADSRModulationSource.h"
 #include "LFOModulationSource.h"
+#include "VoiceLFOBank.h"
+#include "VoiceEnvelopeBank.h"
 #include <vembertech/lipol.h>
 #include "QuadFilterChain.h"
 #include <array>
@@ -65,8 +67,32 @@ class alignas(16) SurgeVoice
     SurgeVoiceState state;
     int age, age_release;
 
+    /*
+     * The voice's own random number generator, seeded from the storage's on construction (so
+     * on the audio thread). It is the current generator while the voice is constructed and
+     * while process_block runs, so the noise, drift and S&H a voice draws are the same on
+     * whichever thread it renders.
+     */
+    SurgeStorage::RNGGen rng;
+
+    /*
+     * Host rate samples into its first block at which this voice's note landed. The whole
+     * pre-filter signal runs that far behind the block grid for the life of the voice, so the
+     * oscillators start on the note's own sample; the end of each block waits in onsetTail
+     * and goes into the filter lanes ahead of the next. setOnsetDelay also shortens the first
+     * step of the envelopes and voice LFOs by the same amount, so they start there too.
+     */
+    void setOnsetDelay(int samples);
+    int onsetDelay{0};
+    float onsetTail alignas(16)[2][BLOCK_SIZE_OS]{};
+
     bool matchesChannelKeyId(int16_t channel, int16_t key, int32_t host_noteid);
 
+    // Adds the LFOs the next calc_ctrldata will process, and which the bank can run
+    void addLFOsToBank(VoiceLFOBank &bank);
+    // Adds the amp and filter envelopes, unless an LFO may retrigger them in calc_ctrldata
+    void addEnvelopesToBank(VoiceEnvelopeBank &bank);
+
     /*
      * Begin implementing host-provided identifiers for voices for polyphonic
      * modulators, note expressions, and so on
@@ -21,6 +21,8 @@
  */
 #include "Wavetable.h"
 #include <assert.h>
+#include <algorithm>
+#include <utility>
 #include "DSPUtils.h"
 #include <vembertech/basic_dsp.h>
 #include "SurgeStorage.h"
@@ -114,14 +116,25 @@ Wavetable::Wavetable()
 
 Wavetable::~Wavetable()
 {
-    free(TableF32Data);
-    free(TableI16Data);
+    if (!sharedData)
+    {
+        free(TableF32Data);
+        free(TableI16Data);
+    }
 }
 
 void Wavetable::allocPointers(size_t newSize)
 {
-    free(TableF32Data);
-    free(TableI16Data);
+    if (sharedData)
+    {
+        sharedData.reset();
+    }
+    else
+    {
+        free(TableF32Data);
+        free(TableI16Data);
+    }
+
     dataSizes = newSize;
     TableF32Data = (float *)malloc(dataSizes * sizeof(float));
     TableI16Data = (short *)malloc(dataSizes * sizeof(short));
@@ -131,6 +144,15 @@ void Wavetable::allocPointers(size_t newSize)
 
 void Wavetable::Copy(Wavetable *wt)
 {
+    if (wt->sharedData)
+    {
+        // copying a shared table just takes another reference on it
+        shareFrom(wt->sharedData);
+        queue_id = -1;
+        current_id = wt->current_id;
+        return;
+    }
+
     size = wt->size;
     size_po2 = wt->size_po2;
     flags = wt->flags;
@@ -141,9 +163,9 @@ void Wavetable::Copy(Wavetable *wt)
     queue_id = -1;
     everBuilt = wt->everBuilt;
 
-    if (dataSizes < wt->dataSizes)
+    if (dataSizes < wt->dataSizes || sharedData)
     {
-        allocPointers(wt->dataSizes);
+        allocPointers(std::max(dataSizes, wt->dataSizes));
     }
 
     memcpy(TableF32Data, wt->TableF32Data, dataSizes * sizeof(float));
@@ -174,6 +196,70 @@ void Wavetable::Copy(Wavetable *wt)
     current_id = wt->current_id;
 }
 
+void Wavetable::swapContents(Wavetable &other)
+{
+    // only the subtable columns either table can address need their pointers exchanged
+    int columns = min_F32_tables;
+
+    if (everBuilt)
+    {
+        columns = std::max(columns, (int)n_tables);
+    }
+
+    if (other.everBuilt)
+    {
+        columns = std::max(columns, (int)other.n_tables);
+    }
+
+    columns = std::min(columns, max_subtables);
+
+    for (int i = 0; i < max_mipmap_levels; i++)
+    {
+        std::swap_ranges(TableF32WeakPointers[i], TableF32WeakPointers[i] + columns,
+                         other.TableF32WeakPointers[i]);
+        std::swap_ranges(TableI16WeakPointers[i], TableI16WeakPointers[i] + columns,
+                         other.TableI16WeakPointers[i]);
+    }
+
+    std::swap(TableF32Data, other.TableF32Data);
+    std::swap(TableI16Data, other.TableI16Data);
+    std::swap(dataSizes, other.dataSizes);
+    std::swap(sharedData, other.sharedData);
+
+    std::swap(everBuilt, other.everBuilt);
+    std::swap(size, other.size);
+    std::swap(n_tables, other.n_tables);
+    std::swap(size_po2, other.size_po2);
+    std::swap(flags, other.flags);
+    std::swap(dt, other.dt);
+}
+
+void Wavetable::shareFrom(const std::shared_ptr<const Wavetable> &source)
+{
+    if (!sharedData)
+    {
+        free(TableF32Data);
+        free(TableI16Data);
+    }
+
+    sharedData = source;
+
+    // the source is never written to again, so these are only ever read through
+    TableF32Data = const_cast<float *>(source->TableF32Data);
+    TableI16Data = const_cast<short *>(source->TableI16Data);
+    dataSizes = source->dataSizes;
+
+    memcpy(TableF32WeakPointers, source->TableF32WeakPointers, sizeof(TableF32WeakPointers));
+    memcpy(TableI16WeakPointers, source->TableI16WeakPointers, sizeof(TableI16WeakPointers));
+
+    everBuilt = source->everBuilt;
+    size = source->size;
+    n_tables = source->n_tables;
+    size_po2 = source->size_po2;
+    flags = source->flags;
+    dt = source->dt;
+}
+
 bool Wavetable::BuildWT(void *wdata, wt_header &wh, bool AppendSilence)
 {
     assert(wdata);
@@ -184,9 +270,9 @@ bool Wavetable::BuildWT(void *wdata, wt_header &wh, bool AppendSilence)
 
     size_t req_size = RequiredWTSize(size, n_tables);
 
-    if (req_size > dataSizes)
+    if (req_size > dataSizes || sharedData)
     {
-        allocPointers(req_size);
+        allocPointers(std::max(req_size, dataSizes));
     }
 
     int wdata_tables = n_tables;
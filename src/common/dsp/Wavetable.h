@@ -21,6 +21,7 @@
  */
 #ifndef SURGE_SRC_COMMON_DSP_WAVETABLE_H
 #define SURGE_SRC_COMMON_DSP_WAVETABLE_H
+#include <memory>
 #include <string>
 #include <StringOps.h>
 const int max_wtable_size = 4096;
@@ -45,6 +46,11 @@ class Wavetable
     Wavetable();
     ~Wavetable();
     void Copy(Wavetable *wt);
+    // exchanges the table data (not the queue or id state) with other without allocating
+    void swapContents(Wavetable &other);
+    // points the table data at an immutable, already built table rather than copying it. the
+    // data is copied back out the first time this table is built into or copied over
+    void shareFrom(const std::shared_ptr<const Wavetable> &source);
     bool BuildWT(void *wdata, wt_header &wh, bool AppendSilence);
     void MipMapWT();
 
@@ -63,6 +69,8 @@ class Wavetable
     size_t dataSizes;
     float *TableF32Data;
     short *TableI16Data;
+    // set while TableF32Data and TableI16Data belong to a shared table, which keeps it alive
+    std::shared_ptr<const Wavetable> sharedData;
 
     int current_id, queue_id;
     bool refresh_display;
@@ -27,20 +27,25 @@ namespace Surge
 {
 namespace WavetableScript
 {
-std::vector<float> evaluateScriptAtFrame(const std::string &eqn, int resolution, int frame,
-                                         int nFrames)
+/*
+ * Each evaluation leases its own state, so several threads can render wavetables at once.
+ */
+static Surge::LuaSupport::StatePool &statePool()
 {
-#if HAS_LUA
-    static lua_State *L = nullptr;
-    if (L == nullptr)
-    {
-        L = lua_open();
-        luaL_openlibs(L);
-    }
+    static Surge::LuaSupport::StatePool pool;
+    return pool;
+}
 
+static std::vector<float> evaluateScriptAtFrameIn(lua_State *L, const std::string &eqn,
+                                                  int resolution, int frame, int nFrames)
+{
+#if HAS_LUA
     auto values = std::vector<float>();
+    if (!L)
+        return values;
 
     auto wg = Surge::LuaSupport::SGLD("WavetableScript::evaluate", L);
+
     std::string emsg;
     auto res = Surge::LuaSupport::parseStringDefiningFunction(L, eqn.c_str(), "generate", emsg);
     if (res)
@@ -107,6 +112,13 @@ std::vector<float> evaluateScriptAtFrame(const std::string &eqn, int resolution,
 #endif
 }
 
+std::vector<float> evaluateScriptAtFrame(const std::string &eqn, int resolution, int frame,
+                                         int nFrames)
+{
+    auto lease = statePool().lease();
+    return evaluateScriptAtFrameIn(lease.L, eqn, resolution, frame, nFrames);
+}
+
 bool constructWavetable(const std::string &eqn, int resolution, int frames, wt_header &wh,
                         float **wavdata)
 {
@@ -116,9 +128,10 @@ bool constructWavetable(const std::string &eqn, int resolution, int frames, wt_h
     wh.flags = 0;
     *wavdata = wd;
 
+    auto lease = statePool().lease();
     for (int i = 0; i < frames; ++i)
     {
-        auto v = evaluateScriptAtFrame(eqn, resolution, i, frames);
+        auto v = evaluateScriptAtFrameIn(lease.L, eqn, resolution, i, frames);
         memcpy(&(wd[i * resolution]), &(v[0]), resolution * sizeof(float));
     }
     return true;
@@ -33,8 +33,15 @@ namespace WavetableScript
 {
 /*
  * Unlike the LFO modulator this is called at render time of the wavetable
- * not at the evaluation or synthesis time. As such I expect you call it from
- * one thread at a time and just you know generally be careful.
+ * not at the evaluation or synthesis time. Each call leases a lua state from
+ * a shared pool, so it is fine to render from more than one thread at once.
+ *
+ * A script sees the globals and math.random stream left in its state by
+ * earlier scripts, as it did when there was one static state. Calls which
+ * don't overlap get the same state back, and constructWavetable holds one
+ * state for all its frames, but two threads rendering at once each get their
+ * own state, so scripts which rely on carrying globals from one call to the
+ * next should render from a single thread.
  */
 std::vector<float> evaluateScriptAtFrame(const std::string &eqn, int resolution, int frame,
                                          int nFrames);
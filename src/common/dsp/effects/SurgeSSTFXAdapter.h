@@ -156,6 +156,14 @@ template <typename T> struct SurgeSSTFXBase : T
 {
     SurgeSSTFXBase(SurgeStorage *storage, FxStorage *fxdata, pdata *pd) : T(storage, fxdata, pd) {}
 
+    // the sst-effects base keeps its own copies of these pointers, so move those too
+    void bindParameters(FxStorage *fxdata, pdata *pd) override
+    {
+        Effect::bindParameters(fxdata, pd);
+        T::fxStorage = fxdata;
+        T::valueStorage = pd;
+    }
+
     void init() override
     {
         // the values are not copied to the modulation array in all cases at init.
@@ -178,6 +178,8 @@ void AirWindowsEffect::resetCtrlTypes(bool useStreamedValues)
             }
             else
                 fxdata->p[i + 1].val.f = airwin->getParameter(i);
+
+            fxdata->p[i + 1].markChanged();
         }
 
         // set any FX parameters current Airwindows effect isn't using to none/generic param name
@@ -167,13 +167,36 @@ class ADSRModulationSource : public ModulationSource
     }
     bool is_idle() { return (envstate == s_idle) && (idlecount > 0); }
     bool correctAnalogMode{false};
+
+    /*
+     * Make the next process_block move the envelope on by only this fraction of a block, so a
+     * voice whose note lands partway into a block starts its envelopes on the note's sample.
+     */
+    void shortenNextBlock(float fraction) { blockFraction = fraction; }
+
+    /*
+     * Whether a VoiceEnvelopeBank can step this envelope in its lanes. The corrected analog mode
+     * is only used by the tests, so it stays scalar.
+     */
+    bool canRunInBank() const { return !(lc[mode].b && correctAnalogMode); }
+
     virtual void process_block() override
     {
+        const float fraction = blockFraction;
+        blockFraction = 1.f;
+
+        if (batched)
+        {
+            // a VoiceEnvelopeBank has run this block already
+            batched = false;
+            return;
+        }
+
         if (lc[mode].b)
         {
             if (correctAnalogMode)
             {
-                doCorrectAnalogMode();
+                doCorrectAnalogMode(fraction);
                 return;
             }
             /*
@@ -225,25 +248,8 @@ class ADSRModulationSource : public ModulationSource
             __m128 diff_v_r = _mm_min_ss(_mm_setzero_ps(), _mm_sub_ss(v_release, v_c1));
 
             // calculate coefficients for envelope
-            const float shortest = 6.f;
-            const float longest = -2.f;
-            const float coeff_offset = 2.f - log(storage->samplerate / BLOCK_SIZE) / log(2.f);
-
-            float coef_A =
-                powf(2.f, std::min(0.f, coeff_offset - lc[a].f * (adsr->a.temposync
-                                                                      ? storage->temposyncratio
-                                                                      : 1.f)));
-            float coef_D =
-                powf(2.f, std::min(0.f, coeff_offset - lc[d].f * (adsr->d.temposync
-                                                                      ? storage->temposyncratio
-                                                                      : 1.f)));
-            float coef_R =
-                envstate == s_uberrelease
-                    ? 6.f
-                    : powf(2.f,
-                           std::min(0.f, coeff_offset - lc[r].f * (adsr->r.temposync
-                                                                       ? storage->temposyncratio
-                                                                       : 1.f)));
+            float coef_A, coef_D, coef_R;
+            analogCoefficients(fraction, coef_A, coef_D, coef_R);
 
             v_c1 = _mm_add_ss(v_c1, _mm_mul_ss(diff_v_a, _mm_load_ss(&coef_A)));
             v_c1 = _mm_add_ss(v_c1, _mm_mul_ss(diff_v_d, _mm_load_ss(&coef_D)));
@@ -270,8 +276,7 @@ class ADSRModulationSource : public ModulationSource
             {
             case (s_attack):
             {
-                phase += storage->envelope_rate_linear_nowrap(lc[a].f) *
-                         (adsr->a.temposync ? storage->temposyncratio : 1.f);
+                phase += digitalRate(fraction);
                 if (phase >= 1)
                 {
                     phase = 1;
@@ -301,8 +306,7 @@ class ADSRModulationSource : public ModulationSource
                 {
                 phase = sustain;
                 }*/
-                float rate = storage->envelope_rate_linear_nowrap(lc[d].f) *
-                             (adsr->d.temposync ? storage->temposyncratio : 1.f);
+                float rate = digitalRate(fraction);
 
                 float l_lo, l_hi;
 
@@ -352,8 +356,7 @@ class ADSRModulationSource : public ModulationSource
             break;
             case (s_release):
             {
-                phase -= storage->envelope_rate_linear_nowrap(lc[r].f) *
-                         (adsr->r.temposync ? storage->temposyncratio : 1.f);
+                phase -= digitalRate(fraction);
                 output = phase;
                 for (int i = 0; i < lc[r_s].i; i++)
                     output *= phase;
@@ -368,7 +371,7 @@ class ADSRModulationSource : public ModulationSource
             break;
             case (s_uberrelease):
             {
-                phase -= storage->envelope_rate_linear_nowrap(-6.5);
+                phase -= digitalRate(fraction);
                 output = phase;
                 for (int i = 0; i < lc[r_s].i; i++)
                     output *= phase;
@@ -389,22 +392,13 @@ class ADSRModulationSource : public ModulationSource
         }
     }
 
-    void doCorrectAnalogMode()
+    void doCorrectAnalogMode(float fraction = 1.f)
     {
-        const float coeff_offset = 2.f - log(storage->samplerate / BLOCK_SIZE) / log(2.f);
-
-        float coef_A = powf(
-            2.f, std::min(0.f, coeff_offset -
-                                   lc[a].f * (adsr->a.temposync ? storage->temposyncratio : 1.f)));
-        float coef_D = powf(
-            2.f, std::min(0.f, coeff_offset -
-                                   lc[d].f * (adsr->d.temposync ? storage->temposyncratio : 1.f)));
-        float coef_R =
-            envstate == s_uberrelease
-                ? 6.f
-                : powf(2.f, std::min(0.f, coeff_offset - lc[r].f * (adsr->r.temposync
-                                                                        ? storage->temposyncratio
-                                                                        : 1.f)));
+        float coef_A = analogCoefficient(coefCache[0], lc[a].f, adsr->a.temposync);
+        float coef_D = analogCoefficient(coefCache[1], lc[d].f, adsr->d.temposync);
+        float coef_R = envstate == s_uberrelease
+                           ? 6.f
+                           : analogCoefficient(coefCache[2], lc[r].f, adsr->r.temposync);
 
         const float v_cc = 1.01f;
         auto gate = (envstate == s_attack) || (envstate == s_decay);
@@ -420,6 +414,13 @@ class ADSRModulationSource : public ModulationSource
         float normD = std::max(0.05f, 1 - S);
         coef_D /= normD;
 
+        if (fraction < 1.f)
+        {
+            coef_A = partialCoefficient(coef_A, fraction);
+            coef_D = partialCoefficient(coef_D, fraction);
+            coef_R = partialCoefficient(coef_R, fraction);
+        }
+
         float v_attack = corr_discharge ? 0 : v_gate;
 
         float v_decay = corr_discharge ? S : v_cc;
@@ -443,6 +444,94 @@ class ADSRModulationSource : public ModulationSource
     int getEnvState() { return envstate; }
 
   private:
+    friend class VoiceEnvelopeBank;
+
+    // set by a VoiceEnvelopeBank which has stepped the coming block
+    bool batched{false};
+
+    // how far the digital envelope's phase moves this block in its current stage
+    float digitalRate(float fraction)
+    {
+        switch (envstate)
+        {
+        case s_attack:
+            return storage->envelope_rate_linear_nowrap(lc[a].f) *
+                   (adsr->a.temposync ? storage->temposyncratio : 1.f) * fraction;
+        case s_decay:
+            return storage->envelope_rate_linear_nowrap(lc[d].f) *
+                   (adsr->d.temposync ? storage->temposyncratio : 1.f) * fraction;
+        case s_release:
+            return storage->envelope_rate_linear_nowrap(lc[r].f) *
+                   (adsr->r.temposync ? storage->temposyncratio : 1.f) * fraction;
+        case s_uberrelease:
+            return storage->envelope_rate_linear_nowrap(-6.5) * fraction;
+        default:
+            return 0.f;
+        }
+    }
+
+    // the attack, decay and release coefficients of the (uncorrected) analog envelope
+    void analogCoefficients(float fraction, float &coef_A, float &coef_D, float &coef_R)
+    {
+        coef_A = analogCoefficient(coefCache[0], lc[a].f, adsr->a.temposync);
+        coef_D = analogCoefficient(coefCache[1], lc[d].f, adsr->d.temposync);
+        coef_R = envstate == s_uberrelease
+                     ? 6.f
+                     : analogCoefficient(coefCache[2], lc[r].f, adsr->r.temposync);
+
+        if (fraction < 1.f)
+        {
+            coef_A = partialCoefficient(coef_A, fraction);
+            coef_D = partialCoefficient(coef_D, fraction);
+            coef_R = partialCoefficient(coef_R, fraction);
+        }
+    }
+
+    /*
+     * The analog stages move by a powf of the (possibly modulated) stage time every block. That
+     * time rarely changes from one block to the next, so keep each coefficient along with what
+     * it was made from and only recompute when one of those moves.
+     */
+    struct CoefficientCache
+    {
+        float time{0.f}, syncratio{0.f}, samplerate{0.f}, coef{0.f};
+        bool valid{false};
+    } coefCache[3];
+
+    float analogCoefficient(CoefficientCache &c, float time, bool temposync)
+    {
+        float ratio = temposync ? storage->temposyncratio : 1.f;
+
+        if (!c.valid || c.time != time || c.syncratio != ratio ||
+            c.samplerate != storage->samplerate)
+        {
+            const float coeff_offset = 2.f - log(storage->samplerate / BLOCK_SIZE) / log(2.f);
+
+            c.coef = powf(2.f, std::min(0.f, coeff_offset - time * ratio));
+            c.time = time;
+            c.syncratio = ratio;
+            c.samplerate = storage->samplerate;
+            c.valid = true;
+        }
+
+        return c.coef;
+    }
+
+    /*
+     * Each analog stage closes coef of the gap to its target per block, leaving 1 - coef of it,
+     * so a fraction of a block leaves (1 - coef)^fraction. The uber-release's 6 overshoots by
+     * design and is just scaled.
+     */
+    static float partialCoefficient(float coef, float fraction)
+    {
+        if (coef > 1.f)
+            return coef * fraction;
+
+        return 1.f - powf(1.f - coef, fraction);
+    }
+
+    float blockFraction{1.f};
+
     ADSRStorage *adsr = nullptr;
     SurgeVoiceState *state = nullptr;
     SurgeStorage *storage = nullptr;
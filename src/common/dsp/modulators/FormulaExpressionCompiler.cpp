@@ -0,0 +1,734 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+#include "FormulaExpressionCompiler.h"
+#include "basic_dsp.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+
+namespace Surge
+{
+namespace Formula
+{
+
+namespace
+{
+struct Token
+{
+    enum Type
+    {
+        NAME,
+        NUMBER,
+        STRING,
+        OP,
+        END
+    } type;
+    std::string text;
+    double number{0};
+};
+
+// Count the '=' in a long bracket opening at p ('[', '[=[', ...), or -1 if it isn't one
+int longBracketLevel(const std::string &src, size_t p)
+{
+    if (p >= src.size() || src[p] != '[')
+        return -1;
+    size_t q = p + 1;
+    while (q < src.size() && src[q] == '=')
+        q++;
+    if (q < src.size() && src[q] == '[')
+        return (int)(q - p - 1);
+    return -1;
+}
+
+// Skip past the close of a long bracket of a given level which opened at p
+bool skipLongBracket(const std::string &src, size_t &p, int level)
+{
+    auto close = "]" + std::string(level, '=') + "]";
+    auto e = src.find(close, p + level + 2);
+    if (e == std::string::npos)
+        return false;
+    p = e + close.size();
+    return true;
+}
+
+bool tokenize(const std::string &src, std::vector<Token> &toks)
+{
+    size_t p = 0;
+    while (p < src.size())
+    {
+        auto c = src[p];
+        if (std::isspace((unsigned char)c))
+        {
+            p++;
+            continue;
+        }
+        if (src.compare(p, 2, "--") == 0)
+        {
+            auto level = longBracketLevel(src, p + 2);
+            if (level >= 0)
+            {
+                p += 2;
+                if (!skipLongBracket(src, p, level))
+                    return false;
+            }
+            else
+            {
+                auto e = src.find('\n', p);
+                p = (e == std::string::npos) ? src.size() : e + 1;
+            }
+            continue;
+        }
+        if (std::isalpha((unsigned char)c) || c == '_')
+        {
+            auto s = p;
+            while (p < src.size() && (std::isalnum((unsigned char)src[p]) || src[p] == '_'))
+                p++;
+            toks.push_back({Token::NAME, src.substr(s, p - s)});
+            continue;
+        }
+        if (std::isdigit((unsigned char)c) ||
+            (c == '.' && p + 1 < src.size() && std::isdigit((unsigned char)src[p + 1])))
+        {
+            char *e{nullptr};
+            auto v = std::strtod(src.c_str() + p, &e);
+            auto len = (size_t)(e - (src.c_str() + p));
+            if (len == 0)
+                return false;
+            toks.push_back({Token::NUMBER, src.substr(p, len), v});
+            p += len;
+            continue;
+        }
+        if (c == '"' || c == '\'')
+        {
+            auto s = p++;
+            while (p < src.size() && src[p] != c)
+            {
+                if (src[p] == '\\')
+                    p++;
+                p++;
+            }
+            if (p >= src.size())
+                return false;
+            p++;
+            toks.push_back({Token::STRING, src.substr(s, p - s)});
+            continue;
+        }
+        auto level = longBracketLevel(src, p);
+        if (level >= 0)
+        {
+            auto s = p;
+            if (!skipLongBracket(src, p, level))
+                return false;
+            toks.push_back({Token::STRING, src.substr(s, p - s)});
+            continue;
+        }
+        for (auto op : {"...", "..", "==", "~=", "<=", ">=", "::"})
+        {
+            if (src.compare(p, strlen(op), op) == 0)
+            {
+                toks.push_back({Token::OP, op});
+                p += strlen(op);
+                c = 0;
+                break;
+            }
+        }
+        if (c != 0)
+        {
+            toks.push_back({Token::OP, std::string(1, c)});
+            p++;
+        }
+    }
+    toks.push_back({Token::END, ""});
+    return true;
+}
+
+struct Builtin
+{
+    const char *name;
+    int arity; // -1 is 'one or more', folded pairwise
+    NativeProgram::Function fn;
+};
+
+// These are all in 'math', which setSurgeFunctionEnvironment also flattens into the function's
+// environment, so we accept them with or without the prefix. clamp and limit_range are ours.
+static const Builtin builtins[] = {
+    {"abs", 1, NativeProgram::fn_abs},     {"floor", 1, NativeProgram::fn_floor},
+    {"ceil", 1, NativeProgram::fn_ceil},   {"sqrt", 1, NativeProgram::fn_sqrt},
+    {"exp", 1, NativeProgram::fn_exp},     {"log", 1, NativeProgram::fn_log},
+    {"log10", 1, NativeProgram::fn_log10}, {"sin", 1, NativeProgram::fn_sin},
+    {"cos", 1, NativeProgram::fn_cos},     {"tan", 1, NativeProgram::fn_tan},
+    {"asin", 1, NativeProgram::fn_asin},   {"acos", 1, NativeProgram::fn_acos},
+    {"atan", 1, NativeProgram::fn_atan},   {"sinh", 1, NativeProgram::fn_sinh},
+    {"cosh", 1, NativeProgram::fn_cosh},   {"tanh", 1, NativeProgram::fn_tanh},
+    {"min", -1, NativeProgram::fn_min},    {"max", -1, NativeProgram::fn_max},
+    {"pow", 2, NativeProgram::fn_pow},     {"fmod", 2, NativeProgram::fn_fmod},
+    {"atan2", 2, NativeProgram::fn_atan2}, {"clamp", 3, NativeProgram::fn_clamp},
+    {"limit_range", 3, NativeProgram::fn_clamp},
+};
+
+const Builtin *findBuiltin(const std::string &n)
+{
+    for (const auto &b : builtins)
+        if (n == b.name)
+            return &b;
+    return nullptr;
+}
+
+struct Field
+{
+    const char *name;
+    StateKey key;
+    bool voice;
+};
+
+// The numeric fields valueAt writes on every call. is_voice and released are booleans, and
+// everything else (output, or whatever init added) isn't ours to know, so neither compile.
+static const Field fields[] = {
+    {"intphase", sk_intphase, false},   {"cycle", sk_cycle, false},
+    {"phase", sk_phase, false},         {"delay", sk_delay, false},
+    {"decay", sk_decay, false},         {"attack", sk_attack, false},
+    {"hold", sk_hold, false},           {"sustain", sk_sustain, false},
+    {"release", sk_release, false},     {"rate", sk_rate, false},
+    {"amplitude", sk_amplitude, false}, {"startphase", sk_startphase, false},
+    {"deform", sk_deform, false},       {"tempo", sk_tempo, false},
+    {"songpos", sk_songpos, false},     {"key", sk_key, true},
+    {"velocity", sk_velocity, true},    {"channel", sk_channel, true},
+};
+
+struct Compiler
+{
+    const std::vector<Token> &toks;
+    size_t p;
+    std::string param;
+    std::vector<std::string> locals;
+    NativeProgram &prog;
+    int depth{0}, maxDepth{0};
+
+    Compiler(const std::vector<Token> &t, size_t start, NativeProgram &pr)
+        : toks(t), p(start), prog(pr)
+    {
+    }
+
+    const Token &tok() const { return toks[p]; }
+    bool isOp(const char *o) const { return tok().type == Token::OP && tok().text == o; }
+    bool isName(const char *n) const { return tok().type == Token::NAME && tok().text == n; }
+
+    bool expectOp(const char *o)
+    {
+        if (!isOp(o))
+            return false;
+        p++;
+        return true;
+    }
+
+    void emit(NativeProgram::Op op, int delta, uint8_t arg = 0, double value = 0)
+    {
+        prog.code.push_back({op, arg, value});
+        depth += delta;
+        maxDepth = std::max(maxDepth, depth);
+    }
+
+    int localIndex(const std::string &n) const
+    {
+        for (auto i = 0U; i < locals.size(); ++i)
+            if (locals[i] == n)
+                return (int)i;
+        return -1;
+    }
+
+    bool call(const Builtin *b)
+    {
+        if (!expectOp("("))
+            return false;
+        int args = 0;
+        if (!isOp(")"))
+        {
+            do
+            {
+                if (!expression(0))
+                    return false;
+                args++;
+                if (b->arity < 0 && args > 1)
+                    emit(NativeProgram::op_call2, -1, b->fn);
+            } while (expectOp(","));
+        }
+        if (!expectOp(")"))
+            return false;
+
+        if (b->arity < 0)
+            return args >= 1;
+        if (args != b->arity)
+            return false;
+
+        switch (args)
+        {
+        case 1:
+            emit(NativeProgram::op_call1, 0, b->fn);
+            break;
+        case 2:
+            emit(NativeProgram::op_call2, -1, b->fn);
+            break;
+        case 3:
+            emit(NativeProgram::op_call3, -2, b->fn);
+            break;
+        }
+        return true;
+    }
+
+    bool builtin(const std::string &n)
+    {
+        if (n == "pi")
+        {
+            emit(NativeProgram::op_const, 1, 0, 3.14159265358979323846);
+            return true;
+        }
+        auto b = findBuiltin(n);
+        return b && call(b);
+    }
+
+    bool simple()
+    {
+        auto &t = tok();
+        if (t.type == Token::NUMBER)
+        {
+            p++;
+            emit(NativeProgram::op_const, 1, 0, t.number);
+            return true;
+        }
+        if (expectOp("("))
+            return expression(0) && expectOp(")");
+        if (t.type != Token::NAME)
+            return false;
+
+        auto n = t.text;
+        p++;
+
+        if (n == param)
+        {
+            if (!expectOp(".") || tok().type != Token::NAME)
+                return false;
+            auto f = tok().text;
+            p++;
+            if (f == "macros")
+            {
+                if (!expectOp("[") || tok().type != Token::NUMBER)
+                    return false;
+                auto m = tok().number;
+                p++;
+                if (!expectOp("]") || m != std::floor(m) || m < 1 || m > n_customcontrollers)
+                    return false;
+                prog.macrosUsed |= 1U << (int)(m - 1);
+                emit(NativeProgram::op_input, 1, NativeProgram::macroInput + (int)(m - 1));
+                return true;
+            }
+            for (const auto &fd : fields)
+            {
+                if (f == fd.name)
+                {
+                    prog.usesVoice = prog.usesVoice || fd.voice;
+                    emit(NativeProgram::op_input, 1, fd.key);
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        auto li = localIndex(n);
+        if (li >= 0)
+        {
+            emit(NativeProgram::op_local, 1, li);
+            return true;
+        }
+
+        if (n == "math")
+        {
+            if (!expectOp(".") || tok().type != Token::NAME)
+                return false;
+            n = tok().text;
+            p++;
+        }
+        return builtin(n);
+    }
+
+    // Precedence climbing with lua's own priorities, so -x^2 is -(x^2) and ^ is right assoc
+    bool expression(int limit)
+    {
+        static constexpr int unaryPriority{8};
+
+        if (expectOp("-"))
+        {
+            if (!expression(unaryPriority))
+                return false;
+            emit(NativeProgram::op_neg, 0);
+        }
+        else if (!simple())
+        {
+            return false;
+        }
+
+        while (tok().type == Token::OP)
+        {
+            NativeProgram::Op op;
+            int left, right;
+            auto &o = tok().text;
+            if (o == "+" || o == "-")
+            {
+                op = (o == "+") ? NativeProgram::op_add : NativeProgram::op_sub;
+                left = right = 6;
+            }
+            else if (o == "*" || o == "/" || o == "%")
+            {
+                op = (o == "*")   ? NativeProgram::op_mul
+                     : (o == "/") ? NativeProgram::op_div
+                                  : NativeProgram::op_mod;
+                left = right = 7;
+            }
+            else if (o == "^")
+            {
+                op = NativeProgram::op_pow;
+                left = 10;
+                right = 9;
+            }
+            else
+            {
+                // comparisons, concatenation and so on end the expression; the caller decides
+                break;
+            }
+            if (left <= limit)
+                break;
+            p++;
+            if (!expression(right))
+                return false;
+            emit(op, -1);
+        }
+        return true;
+    }
+
+    bool assignable(const std::string &n) const
+    {
+        return n != param && n != "math" && n != "pi" && !findBuiltin(n) && localIndex(n) < 0;
+    }
+
+    // p sits just after 'function process'
+    bool process()
+    {
+        if (!expectOp("(") || tok().type != Token::NAME)
+            return false;
+        param = tok().text;
+        p++;
+        if (!expectOp(")"))
+            return false;
+
+        while (isName("local"))
+        {
+            p++;
+            if (tok().type != Token::NAME || !assignable(tok().text))
+                return false;
+            auto n = tok().text;
+            p++;
+            if (!expectOp("=") || !expression(0))
+                return false;
+            // the local only comes into scope after its own initializer, as in lua
+            if (locals.size() >= NativeProgram::maxLocals)
+                return false;
+            locals.push_back(n);
+            emit(NativeProgram::op_store, -1, locals.size() - 1);
+            expectOp(";");
+        }
+
+        if (!isName(param.c_str()))
+            return false;
+        p++;
+        if (!expectOp(".") || !isName("output"))
+            return false;
+        p++;
+        if (!expectOp("=") || !expression(0))
+            return false;
+        expectOp(";");
+
+        if (!isName("return"))
+            return false;
+        p++;
+        if (!isName(param.c_str()))
+            return false;
+        p++;
+        expectOp(";");
+        if (!isName("end"))
+            return false;
+
+        return depth == 1 && maxDepth <= NativeProgram::maxStack;
+    }
+};
+} // namespace
+
+std::shared_ptr<const NativeProgram> compileNativeProgram(const std::string &formula)
+{
+    std::vector<Token> toks;
+    if (!tokenize(formula, toks))
+        return nullptr;
+
+    /*
+     * A formula may define or assign its own sin, clamp, pi and so on, which lua would then call
+     * in place of ours. Rather than work out whether it does so where process can see it, don't
+     * compile anything which assigns to one of those names anywhere in the chunk.
+     */
+    for (size_t t = 0; t + 1 < toks.size(); ++t)
+    {
+        if (toks[t].type != Token::NAME)
+            continue;
+        auto &n = toks[t].text;
+        if (!findBuiltin(n) && n != "pi" && n != "math")
+            continue;
+        auto &next = toks[t + 1];
+        // '=' or ',' (the name is, or may be, a target) or after 'function' (it is defined)
+        if ((next.type == Token::OP && (next.text == "=" || next.text == ",")) ||
+            (t > 0 && toks[t - 1].type == Token::NAME && toks[t - 1].text == "function"))
+            return nullptr;
+    }
+
+    /*
+     * The chunk must be nothing but top level function definitions. Walk over them by
+     * counting block openers and closers, and remember where process starts. We don't care
+     * what the other functions (init, helpers) do since they aren't what we're replacing.
+     */
+    size_t processAt = 0;
+    size_t i = 0;
+    while (toks[i].type != Token::END)
+    {
+        if (toks[i].type == Token::NAME && toks[i].text == "local")
+            i++;
+        if (toks[i].type != Token::NAME || toks[i].text != "function")
+            return nullptr;
+        if (i + 2 >= toks.size() || toks[i + 1].type != Token::NAME ||
+            toks[i + 2].type != Token::OP || toks[i + 2].text != "(")
+            return nullptr;
+        if (toks[i + 1].text == "process")
+        {
+            if (processAt != 0)
+                return nullptr;
+            processAt = i + 2;
+        }
+
+        int depth = 0;
+        do
+        {
+            auto &t = toks[i];
+            if (t.type == Token::END)
+                return nullptr;
+            if (t.type == Token::NAME)
+            {
+                if (t.text == "function" || t.text == "if" || t.text == "do" ||
+                    t.text == "repeat")
+                    depth++;
+                else if (t.text == "end" || t.text == "until")
+                    depth--;
+            }
+            i++;
+        } while (depth > 0);
+    }
+
+    if (processAt == 0)
+        return nullptr;
+
+    auto prog = std::make_shared<NativeProgram>();
+    Compiler c(toks, processAt, *prog);
+    if (!c.process())
+        return nullptr;
+    return prog;
+}
+
+double NativeProgram::evaluate(const double inputs[n_inputs]) const
+{
+    double stack[maxStack], locals[maxLocals];
+    int sp = -1;
+
+    for (const auto &in : code)
+    {
+        switch (in.op)
+        {
+        case op_const:
+            stack[++sp] = in.value;
+            break;
+        case op_input:
+            stack[++sp] = inputs[in.arg];
+            break;
+        case op_local:
+            stack[++sp] = locals[in.arg];
+            break;
+        case op_store:
+            locals[in.arg] = stack[sp--];
+            break;
+        case op_neg:
+            stack[sp] = -stack[sp];
+            break;
+        case op_add:
+            sp--;
+            stack[sp] += stack[sp + 1];
+            break;
+        case op_sub:
+            sp--;
+            stack[sp] -= stack[sp + 1];
+            break;
+        case op_mul:
+            sp--;
+            stack[sp] *= stack[sp + 1];
+            break;
+        case op_div:
+            sp--;
+            stack[sp] /= stack[sp + 1];
+            break;
+        case op_mod:
+        {
+            // lua's a % b is a - floor(a / b) * b, not fmod
+            sp--;
+            auto a = stack[sp], b = stack[sp + 1];
+            stack[sp] = a - std::floor(a / b) * b;
+        }
+        break;
+        case op_pow:
+            sp--;
+            stack[sp] = std::pow(stack[sp], stack[sp + 1]);
+            break;
+        case op_call1:
+        {
+            auto &x = stack[sp];
+            switch (in.arg)
+            {
+            case fn_abs:
+                x = std::fabs(x);
+                break;
+            case fn_floor:
+                x = std::floor(x);
+                break;
+            case fn_ceil:
+                x = std::ceil(x);
+                break;
+            case fn_sqrt:
+                x = std::sqrt(x);
+                break;
+            case fn_exp:
+                x = std::exp(x);
+                break;
+            case fn_log:
+                x = std::log(x);
+                break;
+            case fn_log10:
+                x = std::log10(x);
+                break;
+            case fn_sin:
+                x = std::sin(x);
+                break;
+            case fn_cos:
+                x = std::cos(x);
+                break;
+            case fn_tan:
+                x = std::tan(x);
+                break;
+            case fn_asin:
+                x = std::asin(x);
+                break;
+            case fn_acos:
+                x = std::acos(x);
+                break;
+            case fn_atan:
+                x = std::atan(x);
+                break;
+            case fn_sinh:
+                x = std::sinh(x);
+                break;
+            case fn_cosh:
+                x = std::cosh(x);
+                break;
+            case fn_tanh:
+                x = std::tanh(x);
+                break;
+            }
+        }
+        break;
+        case op_call2:
+        {
+            sp--;
+            auto &a = stack[sp];
+            auto b = stack[sp + 1];
+            switch (in.arg)
+            {
+            case fn_min:
+                a = (b < a) ? b : a;
+                break;
+            case fn_max:
+                a = (b > a) ? b : a;
+                break;
+            case fn_pow:
+                a = std::pow(a, b);
+                break;
+            case fn_fmod:
+                a = std::fmod(a, b);
+                break;
+            case fn_atan2:
+                a = std::atan2(a, b);
+                break;
+            }
+        }
+        break;
+        case op_call3:
+            // clamp is the only three argument function
+            sp -= 2;
+            stack[sp] = limit_range(stack[sp], stack[sp + 1], stack[sp + 2]);
+            break;
+        }
+    }
+    return stack[0];
+}
+
+namespace
+{
+std::mutex retiredProgramsMutex;
+std::vector<std::shared_ptr<const NativeProgram>> retiredPrograms;
+} // namespace
+
+void retireNativeProgram(std::shared_ptr<const NativeProgram> program)
+{
+    if (!program)
+        return;
+
+    std::lock_guard<std::mutex> g(retiredProgramsMutex);
+    retiredPrograms.push_back(std::move(program));
+}
+
+void releaseRetiredNativePrograms()
+{
+    std::unique_lock<std::mutex> g(retiredProgramsMutex, std::try_to_lock);
+    if (!g.owns_lock() || retiredPrograms.empty())
+        return;
+
+    // a program only this list holds can't be handed to an evaluator again
+    retiredPrograms.erase(std::remove_if(retiredPrograms.begin(), retiredPrograms.end(),
+                                         [](const auto &p) { return p.use_count() == 1; }),
+                          retiredPrograms.end());
+}
+
+} // namespace Formula
+} // namespace Surge
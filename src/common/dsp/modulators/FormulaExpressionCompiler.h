@@ -0,0 +1,137 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+#ifndef SURGE_SRC_COMMON_DSP_MODULATORS_FORMULAEXPRESSIONCOMPILER_H
+#define SURGE_SRC_COMMON_DSP_MODULATORS_FORMULAEXPRESSIONCOMPILER_H
+
+#include "FormulaModulationHelper.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Surge
+{
+namespace Formula
+{
+
+/*
+ * Most formula modulators are a line or two of arithmetic on the phase and a few LFO
+ * parameters. For those we don't need lua at all. compileNativeProgram looks at a formula and,
+ * if its process function is of the form
+ *
+ *     function process(state)
+ *         local x = <expression>      -- any number of these
+ *         state.output = <expression>
+ *         return state
+ *     end
+ *
+ * where the expressions only use numbers, + - * / % ^, the math library functions, locals
+ * and the numeric fields of the state (including state.macros[n]), lowers it to a little
+ * stack program which valueAt can run without touching the lua state. Anything else
+ * (any other statement, any other field, a string, a call we don't know) and it returns
+ * nullptr and the formula runs in lua as always. The init function is left alone, since it
+ * still runs in lua at prepare time.
+ */
+struct NativeProgram
+{
+    // Inputs are indexed by StateKey for the state fields, with the macros after those
+    static constexpr int macroInput{n_stateKeys};
+    static constexpr int n_inputs{n_stateKeys + n_customcontrollers};
+
+    static constexpr int maxStack{32};
+    static constexpr int maxLocals{16};
+
+    enum Op : uint8_t
+    {
+        op_const,
+        op_input,
+        op_local,
+        op_store,
+        op_neg,
+        op_add,
+        op_sub,
+        op_mul,
+        op_div,
+        op_mod,
+        op_pow,
+        op_call1,
+        op_call2,
+        op_call3,
+    };
+
+    enum Function : uint8_t
+    {
+        fn_abs,
+        fn_floor,
+        fn_ceil,
+        fn_sqrt,
+        fn_exp,
+        fn_log,
+        fn_log10,
+        fn_sin,
+        fn_cos,
+        fn_tan,
+        fn_asin,
+        fn_acos,
+        fn_atan,
+        fn_sinh,
+        fn_cosh,
+        fn_tanh,
+        fn_min,
+        fn_max,
+        fn_pow,
+        fn_fmod,
+        fn_atan2,
+        fn_clamp,
+    };
+
+    struct Instruction
+    {
+        Op op;
+        uint8_t arg;
+        double value;
+    };
+
+    std::vector<Instruction> code;
+
+    bool usesVoice{false};  // reads key, velocity or channel, which only voice LFOs have
+    uint32_t macrosUsed{0}; // bit i is state.macros[i + 1]
+
+    double evaluate(const double inputs[n_inputs]) const;
+};
+
+std::shared_ptr<const NativeProgram> compileNativeProgram(const std::string &formula);
+
+/*
+ * When setFormula replaces a program an evaluator may still hold it, and we don't want the
+ * audio thread to drop the last reference. So replaced programs are retired here, and
+ * releaseRetiredNativePrograms frees the ones nothing else holds any more. The synth calls
+ * that at the end of each processControl; it only try-locks, so it never waits on an editor.
+ */
+void retireNativeProgram(std::shared_ptr<const NativeProgram> program);
+void releaseRetiredNativePrograms();
+
+} // namespace Formula
+} // namespace Surge
+
+#endif // SURGE_SRC_COMMON_DSP_MODULATORS_FORMULAEXPRESSIONCOMPILER_H
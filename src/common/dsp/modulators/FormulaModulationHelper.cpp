@@ -21,9 +21,12 @@
  */
 
 #include "FormulaModulationHelper.h"
+#include "FormulaExpressionCompiler.h"
 #include "LuaSupport.h"
 #include "SurgeVoice.h"
 #include "SurgeStorage.h"
+#include <algorithm>
+#include <chrono>
 #include <thread>
 #include <functional>
 #include "fmt/core.h"
@@ -33,155 +36,493 @@ namespace Surge
 namespace Formula
 {
 
-void setupStorage(SurgeStorage *s) { s->formulaGlobalData = std::make_unique<GlobalData>(); }
-bool prepareForEvaluation(SurgeStorage *storage, FormulaModulatorStorage *fs, EvaluatorState &s,
-                          bool is_display)
+static constexpr const char *stateKeyNames[n_stateKeys] = {
+    "intphase",
+    "cycle",
+    "phase",
+    "delay",
+    "decay",
+    "attack",
+    "hold",
+    "sustain",
+    "release",
+    "rate",
+    "amplitude",
+    "startphase",
+    "deform",
+    "tempo",
+    "songpos",
+    "released",
+    "is_voice",
+    "key",
+    "velocity",
+    "channel",
+    "retrigger_AEG",
+    "retrigger_FEG",
+    "macros",
+    "output",
+    "use_envelope",
+    "clamp_output",
+};
+
+static void releaseRefs(EvaluatorState &s)
 {
-    auto &stateData = *storage->formulaGlobalData;
-    bool firstTimeThrough = false;
-    if (!is_display)
-    {
-        static int aid = 1;
-        if (stateData.audioState == nullptr)
-        {
 #if HAS_LUA
-            stateData.audioState = lua_open();
-            luaL_openlibs((lua_State *)(stateData.audioState));
-#endif
-            firstTimeThrough = true;
-        }
-        s.L = (lua_State *)(stateData.audioState);
-        snprintf(s.stateName, TXT_SIZE, "audiostate_%d", aid);
-        aid++;
-        if (aid < 0)
-            aid = 1;
-    }
-    else
+    if (s.L)
     {
-        static int did = 1;
-        if (stateData.displayState == nullptr)
-        {
-#if HAS_LUA
-            stateData.displayState = lua_open();
-            luaL_openlibs((lua_State *)(stateData.displayState));
-#endif
-            firstTimeThrough = true;
-        }
-        s.L = (lua_State *)(stateData.displayState);
-        snprintf(s.stateName, TXT_SIZE, "dispstate_%d", did);
-        did++;
-        if (did < 0)
-            did = 1;
+        luaL_unref(s.L, LUA_REGISTRYINDEX, s.funcRef);
+        luaL_unref(s.L, LUA_REGISTRYINDEX, s.stateRef);
+        luaL_unref(s.L, LUA_REGISTRYINDEX, s.macrosRef);
     }
+#endif
+    s.funcRef = -1;
+    s.stateRef = -1;
+    s.macrosRef = -1;
+    s.native = nullptr;
+}
+
+/*
+ * Every state we evaluate formulas in starts like this: the prelude, the state key strings
+ * interned in the registry and the error stub.
+ */
+static bool openPreparedState(PreparedState &ps)
+{
+    ps.L = Surge::LuaSupport::openSurgeState();
 
 #if HAS_LUA
+    if (!ps.L)
+        return false;
 
-    auto lg = Surge::LuaSupport::SGLD("prepareForEvaluation", s.L);
+    auto lg = Surge::LuaSupport::SGLD("openPreparedState", ps.L);
 
-    if (firstTimeThrough)
+    for (int k = 0; k < n_stateKeys; ++k)
     {
-        Surge::LuaSupport::loadSurgePrelude(s.L);
-        auto reserved0 = std::string(R"FN(
+        lua_pushstring(ps.L, stateKeyNames[k]);
+        ps.keyRefs[k] = luaL_ref(ps.L, LUA_REGISTRYINDEX);
+    }
+
+    auto reserved0 = std::string(R"FN(
 function surge_reserved_formula_error_stub(m)
     return 0;
 end
 )FN");
-        std::string emsg;
-        bool r0 = Surge::LuaSupport::parseStringDefiningFunction(
-            s.L, reserved0, "surge_reserved_formula_error_stub", emsg);
-        if (r0)
-        {
-            lua_setglobal(s.L, "surge_reserved_formula_error_stub");
-        }
+    std::string emsg;
+    bool r0 = Surge::LuaSupport::parseStringDefiningFunction(
+        ps.L, reserved0, "surge_reserved_formula_error_stub", emsg);
+    if (r0)
+    {
+        lua_setglobal(ps.L, "surge_reserved_formula_error_stub");
+    }
+    else
+    {
+        lua_pop(ps.L, 1);
     }
 
-    // OK so now evaluate the formula. This is a mistake - the loading and
-    // compiling can be expensive so lets look it up by hash first
-    auto h = fs->formulaHash;
+    return true;
+#else
+    return false;
+#endif
+}
+
+/*
+ * Define a formula's process and init in a state, unless it has them already, and return
+ * whether process is usable. The loading and compiling can be expensive so formulas are
+ * looked up by hash, with the formula string stored next to the functions to catch a
+ * collision. Anything to report goes in error.
+ */
+static bool compileFormula(PreparedState &ps, size_t h, const std::string &formula,
+                           bool is_display, std::string &error)
+{
+#if HAS_LUA
+    auto L = ps.L;
+    if (!L)
+        return false;
+
+    auto lg = Surge::LuaSupport::SGLD("compileFormula", L);
+
     auto pvn = std::string("pvn") + std::to_string(is_display) + "_" + std::to_string(h);
     auto pvf = pvn + "_f";
     auto pvfInit = pvn + "_fInit";
-    snprintf(s.funcName, TXT_SIZE, "%s", pvf.c_str());
-    snprintf(s.funcNameInit, TXT_SIZE, "%s", pvfInit.c_str());
+
+    ps.compiledHashes.insert(h);
 
     // Handle hash collisions
-    lua_getglobal(s.L, pvn.c_str());
-    s.isvalid = false;
+    lua_getglobal(L, pvn.c_str());
 
     bool hasString = false;
-    if (lua_isstring(s.L, -1))
+    if (lua_isstring(L, -1))
     {
-        if (fs->formulaString != lua_tostring(s.L, -1))
+        if (formula != lua_tostring(L, -1))
         {
-            s.adderror("Hash Collision in function. Bad luck!");
+            error += "Hash Collision in function. Bad luck!";
         }
         else
         {
             hasString = true;
         }
     }
-    lua_pop(s.L, 1); // we don't need the string or whatever on the stack
+    lua_pop(L, 1); // we don't need the string or whatever on the stack
+
     if (hasString)
     {
-        snprintf(s.funcName, TXT_SIZE, "%s", pvf.c_str());
-        snprintf(s.funcNameInit, TXT_SIZE, "%s", pvfInit.c_str());
         // CHECK that I can actually get the function here
-        lua_getglobal(s.L, s.funcName);
-        s.isvalid = lua_isfunction(s.L, -1);
-        lua_pop(s.L, 1);
+        lua_getglobal(L, pvf.c_str());
+        bool valid = lua_isfunction(L, -1);
+        lua_pop(L, 1);
+
+        return valid && ps.knownBadFunctions.find(pvf) == ps.knownBadFunctions.end();
+    }
+
+    bool valid = false;
+    std::string emsg;
+    int res = Surge::LuaSupport::parseStringDefiningMultipleFunctions(L, formula,
+                                                                      {"process", "init"}, emsg);
+
+    if (res >= 1)
+    {
+        // Great - rename it and nuke process
+        lua_setglobal(L, pvf.c_str());
+        lua_pushnil(L);
+        lua_setglobal(L, "process");
+
+        // Then get it and set its env
+        lua_getglobal(L, pvf.c_str());
+        Surge::LuaSupport::setSurgeFunctionEnvironment(L);
+        lua_pop(L, 1);
+
+        lua_setglobal(L, pvfInit.c_str());
+        lua_pushnil(L);
+        lua_setglobal(L, "init");
+
+        // Then get it and set its env
+        lua_getglobal(L, pvfInit.c_str());
+        Surge::LuaSupport::setSurgeFunctionEnvironment(L);
+        lua_pop(L, 1);
+
+        valid = true;
+    }
+    else
+    {
+        error += "Unable to determine 'process' or 'init' function : " + emsg;
+        lua_pop(L, 1); // process
+        lua_pop(L, 1); // process
+        ps.knownBadFunctions.insert(pvf);
+    }
+
+    // this happens here because we did parse it at least. Don't parse again until it is changed
+    lua_pushstring(L, formula.c_str());
+    lua_setglobal(L, pvn.c_str());
 
-        if (stateData.knownBadFunctions.find(s.funcName) != stateData.knownBadFunctions.end())
+    return valid;
+#else
+    return false;
+#endif
+}
+
+GlobalData::GlobalData(SurgeStorage *s) : storage(s)
+{
+    compilerThread = std::thread([this]() { compilerLoop(); });
+}
+
+GlobalData::~GlobalData()
+{
+    {
+        std::lock_guard<std::mutex> g(compilerMutex);
+        compilerRunning = false;
+    }
+    compilerCV.notify_one();
+    compilerThread.join();
+
+#if HAS_LUA
+    for (auto &ps : states)
+    {
+        if (ps->L)
+            lua_close(ps->L);
+    }
+
+    if (displayState.L)
+        lua_close(displayState.L);
+#endif
+}
+
+PreparedState *GlobalData::leaseState(size_t formulaHash)
+{
+    PreparedState *res{nullptr};
+    bool wake{false};
+
+    {
+        std::lock_guard<std::mutex> g(poolMutex);
+
+        auto it = std::find_if(idle.rbegin(), idle.rend(), [formulaHash](auto *ps) {
+            return ps->compiledHashes.count(formulaHash) > 0;
+        });
+
+        if (it != idle.rend())
+        {
+            res = *it;
+            idle.erase(std::next(it).base());
+        }
+        else if (!idle.empty())
         {
-            s.isvalid = false;
+            res = idle.back();
+            idle.pop_back();
         }
+
+        wake = idle.size() < spareWanted;
     }
-    else
+
+    // like the other loaders, wake the compiler thread without taking its lock
+    if (wake || !res)
+        compilerCV.notify_one();
+
+    if (!res)
+    {
+        // nothing spare, so open one here. The compiler thread catches it up once it is back
+        auto ps = std::make_unique<PreparedState>();
+        openPreparedState(*ps);
+        res = ps.get();
+        statesOpenedOnLease++;
+
+        std::lock_guard<std::mutex> g(poolMutex);
+        states.push_back(std::move(ps));
+        idle.reserve(states.size());
+    }
+
+    return res;
+}
+
+void GlobalData::returnState(PreparedState *ps)
+{
+    std::lock_guard<std::mutex> g(poolMutex);
+
+    // idle always has room for every state, so this doesn't allocate
+    idle.push_back(ps);
+}
+
+std::pair<size_t, size_t> GlobalData::idleStatesWithFormula(size_t formulaHash)
+{
+    std::lock_guard<std::mutex> g(poolMutex);
+
+    auto n = std::count_if(idle.begin(), idle.end(), [formulaHash](auto *ps) {
+        return ps->compiledHashes.count(formulaHash) > 0;
+    });
+
+    return {(size_t)n, idle.size()};
+}
+
+void GlobalData::compilerLoop()
+{
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lk(compilerMutex);
+            compilerCV.wait_for(lk, std::chrono::milliseconds(20));
+
+            if (!compilerRunning)
+            {
+                return;
+            }
+        }
+
+        pickUpFormulas();
+
+        if (formulas.empty())
+        {
+            continue;
+        }
+
+        auto wanted = spareStatesWanted();
+        spareWanted = wanted;
+
+        // open states until there are enough spare, each with every formula compiled in
+        while (true)
+        {
+            {
+                std::lock_guard<std::mutex> g(poolMutex);
+                if (idle.size() >= wanted)
+                {
+                    break;
+                }
+            }
+
+            auto ps = std::make_unique<PreparedState>();
+            if (!openPreparedState(*ps))
+            {
+                break;
+            }
+            compileFormulas(*ps);
+
+            std::lock_guard<std::mutex> g(poolMutex);
+            idle.reserve(states.size() + 1);
+            idle.push_back(ps.get());
+            states.push_back(std::move(ps));
+        }
+
+        // and bring the idle states up to date with formulas which arrived since they opened
+        while (true)
+        {
+            PreparedState *ps{nullptr};
+            {
+                std::lock_guard<std::mutex> g(poolMutex);
+                auto it = std::find_if(idle.begin(), idle.end(), [this](auto *p) {
+                    return p->formulasCompiled < formulas.size();
+                });
+
+                if (it == idle.end())
+                {
+                    break;
+                }
+
+                ps = *it;
+                idle.erase(it);
+            }
+
+            compileFormulas(*ps);
+            returnState(ps);
+        }
+    }
+}
+
+void GlobalData::compileFormulas(PreparedState &ps)
+{
+    for (; ps.formulasCompiled < formulas.size(); ++ps.formulasCompiled)
     {
+        auto &f = formulas[ps.formulasCompiled];
         std::string emsg;
-        int res = Surge::LuaSupport::parseStringDefiningMultipleFunctions(
-            s.L, fs->formulaString, {"process", "init"}, emsg);
+        compileFormula(ps, f.first, f.second, false, emsg);
+    }
+}
 
-        if (res >= 1)
+void GlobalData::pickUpFormulas()
+{
+    auto &patch = storage->getPatch();
+
+    for (int sc = 0; sc < n_scenes; ++sc)
+    {
+        for (int l = 0; l < n_lfos; ++l)
         {
-            // Great - rename it and nuke process
-            lua_setglobal(s.L, s.funcName);
-            lua_pushnil(s.L);
-            lua_setglobal(s.L, "process");
+            if (patch.scene[sc].lfo[l].shape.val.i != lt_formula)
+            {
+                continue;
+            }
+
+            /*
+             * The editor and the patch loader change formulas on their own threads, so take a
+             * copy only once the hash has held still for a poll, and keep the copy only if it
+             * hashes the same.
+             */
+            auto &fs = patch.formulamods[sc][l];
+            auto h = fs.formulaHash;
 
-            // Then get it and set its env
-            lua_getglobal(s.L, s.funcName);
-            Surge::LuaSupport::setSurgeFunctionEnvironment(s.L);
-            lua_pop(s.L, 1);
+            if (h != seenHash[sc][l])
+            {
+                seenHash[sc][l] = h;
+                continue;
+            }
 
-            lua_setglobal(s.L, s.funcNameInit);
-            lua_pushnil(s.L);
-            lua_setglobal(s.L, "init");
+            if (formulaHashes.count(h))
+            {
+                continue;
+            }
 
-            // Then get it and set its env
-            lua_getglobal(s.L, s.funcNameInit);
-            Surge::LuaSupport::setSurgeFunctionEnvironment(s.L);
-            lua_pop(s.L, 1);
+            auto f = fs.formulaString;
+            if (std::hash<std::string>{}(f) == h)
+            {
+                formulas.emplace_back(h, std::move(f));
+                formulaHashes.insert(h);
+            }
+        }
+    }
+}
 
-            stateData.functionsPerFMS[fs].insert(s.funcName);
-            stateData.functionsPerFMS[fs].insert(s.funcNameInit);
+size_t GlobalData::spareStatesWanted()
+{
+    auto &patch = storage->getPatch();
+    size_t nVoice{0}, nScene{0};
 
-            s.isvalid = true;
+    for (int sc = 0; sc < n_scenes; ++sc)
+    {
+        for (int l = 0; l < n_lfos; ++l)
+        {
+            if (patch.scene[sc].lfo[l].shape.val.i == lt_formula)
+            {
+                (l < n_lfos_voice ? nVoice : nScene)++;
+            }
         }
-        else
+    }
+
+    // as with the memory pools, half of what the voice formulas could use at full polyphony
+    auto n = nScene + nVoice * patch.polylimit.val.i / 2;
+    return std::clamp(n, minSpareStates, maxSpareStates);
+}
+
+void setupStorage(SurgeStorage *s) { s->formulaGlobalData = std::make_unique<GlobalData>(s); }
+
+bool prepareForEvaluation(SurgeStorage *storage, FormulaModulatorStorage *fs, EvaluatorState &s,
+                          bool is_display)
+{
+    auto &stateData = *storage->formulaGlobalData;
+
+    /*
+     * An attack on an existing modulator re-prepares it, so let go of what we held. A leased
+     * state goes back and we lease again, since the idle ones are the ones kept compiled.
+     */
+    cleanEvaluatorState(s);
+
+    if (!is_display)
+    {
+        s.prepared = stateData.leaseState(fs->formulaHash);
+        s.leasedFrom = &stateData;
+    }
+    else
+    {
+        if (!stateData.displayState.L)
         {
-            s.adderror("Unable to determine 'process' or 'init' function : " + emsg);
-            lua_pop(s.L, 1); // process
-            lua_pop(s.L, 1); // process
-            stateData.knownBadFunctions.insert(s.funcName);
+            openPreparedState(stateData.displayState);
         }
+        s.prepared = &stateData.displayState;
+    }
+
+    s.L = s.prepared->L;
+    s.keyRefs = s.prepared->keyRefs;
+    s.isvalid = false;
 
-        // this happens here because we did parse it at least. Don't parse again until it is changed
-        lua_pushstring(s.L, fs->formulaString.c_str());
-        lua_setglobal(s.L, pvn.c_str());
+#if HAS_LUA
+    if (!s.L)
+    {
+        return true;
+    }
+
+    auto lg = Surge::LuaSupport::SGLD("prepareForEvaluation", s.L);
+
+    auto h = fs->formulaHash;
+    auto pvf = std::string("pvn") + std::to_string(is_display) + "_" + std::to_string(h) + "_f";
+    auto pvfInit = pvf + "Init";
+    snprintf(s.funcName, TXT_SIZE, "%s", pvf.c_str());
+    snprintf(s.funcNameInit, TXT_SIZE, "%s", pvfInit.c_str());
+
+    if (!is_display && !s.prepared->compiledHashes.count(h))
+    {
+        stateData.compilesOnLease++;
+    }
+
+    std::string emsg;
+    s.isvalid = compileFormula(*s.prepared, h, fs->formulaString, is_display, emsg);
+    if (!emsg.empty())
+    {
+        s.adderror(emsg);
     }
 
     if (s.isvalid)
     {
+        // Hold the process function by reference so valueAt needn't look it up by name
+        lua_getglobal(s.L, s.funcName);
+        s.funcRef = luaL_ref(s.L, LUA_REGISTRYINDEX);
+
+        // The macros table is made once per state and refilled in place on each evaluation
+        lua_createtable(s.L, n_customcontrollers, 0);
+        s.macrosRef = luaL_ref(s.L, LUA_REGISTRYINDEX);
+
         // Create my state object each time
         lua_getglobal(s.L, s.funcNameInit);
         lua_createtable(s.L, 0, 10);
@@ -247,7 +588,7 @@ end
                     s.adderror("The init() function must return a table. This usually means "
                                "that you didn't close the init() function with 'return state' "
                                "before the 'end' statement.");
-                    stateData.knownBadFunctions.insert(s.funcName);
+                    s.prepared->knownBadFunctions.insert(s.funcName);
                 }
             }
             else
@@ -256,12 +597,11 @@ end
                 std::ostringstream oss;
                 oss << "Failed to evaluate 'init' function. " << lua_tostring(s.L, -1);
                 s.adderror(oss.str());
-                stateData.knownBadFunctions.insert(s.funcName);
+                s.prepared->knownBadFunctions.insert(s.funcName);
             }
         }
 
-        // FIXME - we have to clean this up when evaluation is done
-        lua_setglobal(s.L, s.stateName);
+        s.stateRef = luaL_ref(s.L, LUA_REGISTRYINDEX);
 
         // the modulator state which is now bound to the state name
         lua_pop(s.L, -1);
@@ -271,7 +611,7 @@ end
         {
             auto sub = Surge::LuaSupport::SGLD("prepareForEvaluation::subscriptions", s.L);
 
-            lua_getglobal(s.L, s.stateName);
+            lua_rawgeti(s.L, LUA_REGISTRYINDEX, s.stateRef);
             if (!lua_istable(s.L, -1))
             {
                 lua_pop(s.L, -1);
@@ -289,6 +629,15 @@ end
                         s.useEnvelope = lua_toboolean(s.L, -1);
                     }
                     lua_pop(s.L, 1);
+
+                    s.nativeClamp = true;
+                    lua_rawgeti(s.L, LUA_REGISTRYINDEX, s.keyRefs[sk_clamp_output]);
+                    lua_gettable(s.L, -2);
+                    if (lua_isboolean(s.L, -1))
+                    {
+                        s.nativeClamp = lua_toboolean(s.L, -1);
+                    }
+                    lua_pop(s.L, 1);
                 }
 
                 // now let's read off those subscriptions
@@ -339,13 +688,40 @@ end
                 lua_pop(s.L, 1); // the modulator state
             }
         }
+
+        /*
+         * On the audio thread, see if process is simple enough to skip lua. The display
+         * states always run in lua so the debugger shows the state table as process leaves it.
+         */
+        if (!is_display && s.isvalid)
+        {
+            auto prog = std::atomic_load(&fs->nativeProgram);
+            uint32_t subscribed = 0;
+            for (int i = 0; i < n_customcontrollers; ++i)
+                if (s.subMacros[i])
+                    subscribed |= 1U << i;
+
+            // an unsubscribed macro or a voice field on a scene LFO is nil in lua, which is an
+            // error we want lua to report
+            if (prog && (!prog->usesVoice || s.isVoice) && (prog->macrosUsed & ~subscribed) == 0)
+                s.native = prog;
+        }
     }
 
-    if (is_display)
     {
-        // Move to support
+        /*
+         * Seed the RNG. The display always starts from the same seed. A leased state is seeded
+         * from the generator of whoever prepares it (a voice installs its own), so what a
+         * formula draws doesn't depend on which state it got or what ran in it before.
+         */
+        double seed = 8675309;
+        if (!is_display)
+        {
+            auto &rng = storage->currentRNGGen();
+            seed = rng.u32(rng.g);
+        }
+
         auto dg = Surge::LuaSupport::SGLD("set RNG", s.L);
-        // Seed the RNG
         lua_getglobal(s.L, "math");
         // > math
         if (lua_isnil(s.L, -1))
@@ -364,7 +740,7 @@ end
             }
             else
             {
-                lua_pushnumber(s.L, 8675309);
+                lua_pushnumber(s.L, seed);
                 lua_pcall(s.L, 1, 0, 0);
             }
         }
@@ -391,39 +767,19 @@ end
     return true;
 }
 
-void removeFunctionsAssociatedWith(SurgeStorage *storage, FormulaModulatorStorage *fs)
+bool cleanEvaluatorState(EvaluatorState &s)
 {
-#if HAS_LUA
-    auto &stateData = *storage->formulaGlobalData;
-
-    auto S = stateData.audioState;
-    if (!S)
-        return;
-    if (stateData.functionsPerFMS.find(fs) == stateData.functionsPerFMS.end())
-        return;
+    releaseRefs(s);
 
-#if 0
-    for (const auto &fn : functionsPerFMS[fs])
+    if (s.leasedFrom && s.prepared)
     {
-        lua_pushnil(S);
-        lua_setglobal(S, fn.c_str());
+        s.leasedFrom->returnState(s.prepared);
     }
-#endif
 
-    stateData.functionsPerFMS.erase(fs);
-#endif
-}
-
-bool cleanEvaluatorState(EvaluatorState &s)
-{
-#if HAS_LUA
-    if (s.L && s.stateName[0] != 0)
-    {
-        lua_pushnil(s.L);
-        lua_setglobal(s.L, s.stateName);
-        s.stateName[0] = 0;
-    }
-#endif
+    s.prepared = nullptr;
+    s.leasedFrom = nullptr;
+    s.keyRefs = nullptr;
+    s.L = nullptr;
     return true;
 }
 
@@ -431,7 +787,12 @@ bool initEvaluatorState(EvaluatorState &s)
 {
     s.funcName[0] = 0;
     s.funcNameInit[0] = 0;
-    s.stateName[0] = 0;
+    s.funcRef = -1;
+    s.stateRef = -1;
+    s.macrosRef = -1;
+    s.keyRefs = nullptr;
+    s.prepared = nullptr;
+    s.leasedFrom = nullptr;
     s.L = nullptr;
     return true;
 }
@@ -448,131 +809,155 @@ void valueAt(int phaseIntPart, float phaseFracPart, SurgeStorage *storage,
     if (!s->isvalid)
         return;
 
+    if (s->native && !justSetup)
+    {
+        double inputs[NativeProgram::n_inputs];
+        inputs[sk_intphase] = phaseIntPart;
+        inputs[sk_cycle] = phaseIntPart;
+        inputs[sk_phase] = phaseFracPart;
+        inputs[sk_delay] = s->del;
+        inputs[sk_decay] = s->dec;
+        inputs[sk_attack] = s->a;
+        inputs[sk_hold] = s->h;
+        inputs[sk_sustain] = s->s;
+        inputs[sk_release] = s->r;
+        inputs[sk_rate] = s->rate;
+        inputs[sk_amplitude] = s->amp;
+        inputs[sk_startphase] = s->phase;
+        inputs[sk_deform] = s->deform;
+        inputs[sk_tempo] = s->tempo;
+        inputs[sk_songpos] = s->songpos;
+        inputs[sk_key] = s->key;
+        inputs[sk_velocity] = s->velocity;
+        inputs[sk_channel] = s->channel;
+        for (int i = 0; i < n_customcontrollers; ++i)
+            inputs[NativeProgram::macroInput + i] = s->macrovalues[i];
+
+        auto r = (float)s->native->evaluate(inputs);
+        s->isFinite = std::isfinite(r);
+        output[0] = s->isFinite ? r : 0.f;
+        if (s->nativeClamp)
+            output[0] = limitpm1(output[0]);
+
+        s->retrigger_AEG = false;
+        s->retrigger_FEG = false;
+        return;
+    }
+
     auto gs = Surge::LuaSupport::SGLD("valueAt", s->L);
     struct OnErrorReplaceWithZero
     {
-        OnErrorReplaceWithZero(lua_State *L, std::string fn) : L(L), fn(fn) {}
+        OnErrorReplaceWithZero(lua_State *L, const char *fn) : L(L), fn(fn) {}
         ~OnErrorReplaceWithZero()
         {
             if (replace)
             {
                 // std::cout << "Would nuke " << fn << std::endl;
                 lua_getglobal(L, "surge_reserved_formula_error_stub");
-                lua_setglobal(L, fn.c_str());
+                lua_setglobal(L, fn);
             }
         }
         lua_State *L;
-        std::string fn;
+        const char *fn;
         bool replace = true;
     } onerr(s->L, s->funcName);
     /*
      * So: make the stack my evaluation func then my table; then push my table
-     * values; then call my function; then update my global
+     * values; then call my function; then update my state reference. Everything
+     * here goes through registry references and interned keys so an evaluation
+     * doesn't hash strings or build tables.
      */
-    lua_getglobal(s->L, s->funcName);
-    if (!lua_isfunction(s->L, -1))
+    auto L = s->L;
+    auto keys = s->keyRefs;
+
+    lua_rawgeti(L, LUA_REGISTRYINDEX, s->funcRef);
+    if (!lua_isfunction(L, -1))
     {
         s->isvalid = false;
-        lua_pop(s->L, 1);
+        lua_pop(L, 1);
         return;
     }
-    lua_getglobal(s->L, s->stateName);
-
-    lua_pushstring(s->L, "av");
-    lua_gettable(s->L, -2);
-    lua_pop(s->L, 1);
+    lua_rawgeti(L, LUA_REGISTRYINDEX, s->stateRef);
 
     // Stack is now func > table  so we can update the table
-    lua_pushstring(s->L, "intphase");
-    lua_pushinteger(s->L, phaseIntPart);
-    lua_settable(s->L, -3);
+    auto addi = [L, keys](StateKey k, int i) {
+        lua_rawgeti(L, LUA_REGISTRYINDEX, keys[k]);
+        lua_pushinteger(L, i);
+        lua_settable(L, -3);
+    };
 
-    // Alias cycle for intphase
-    lua_pushstring(s->L, "cycle");
-    lua_pushinteger(s->L, phaseIntPart);
-    lua_settable(s->L, -3);
-
-    auto addn = [s](const char *q, float f) {
-        lua_pushstring(s->L, q);
-        lua_pushnumber(s->L, f);
-        lua_settable(s->L, -3);
+    auto addn = [L, keys](StateKey k, float f) {
+        lua_rawgeti(L, LUA_REGISTRYINDEX, keys[k]);
+        lua_pushnumber(L, f);
+        lua_settable(L, -3);
     };
 
-    auto addb = [s](const char *q, bool b) {
-        lua_pushstring(s->L, q);
-        lua_pushboolean(s->L, b);
-        lua_settable(s->L, -3);
+    auto addb = [L, keys](StateKey k, bool b) {
+        lua_rawgeti(L, LUA_REGISTRYINDEX, keys[k]);
+        lua_pushboolean(L, b);
+        lua_settable(L, -3);
     };
 
-    auto addnil = [s](const char *q) {
-        lua_pushstring(s->L, q);
-        lua_pushnil(s->L);
-        lua_settable(s->L, -3);
+    auto addnil = [L, keys](StateKey k) {
+        lua_rawgeti(L, LUA_REGISTRYINDEX, keys[k]);
+        lua_pushnil(L);
+        lua_settable(L, -3);
     };
 
-    addn("phase", phaseFracPart);
+    addi(sk_intphase, phaseIntPart);
+    // Alias cycle for intphase
+    addi(sk_cycle, phaseIntPart);
 
-    if (true /* s->subLfoEnvelope */)
-    {
-        addn("delay", s->del);
-        addn("decay", s->dec);
-        addn("attack", s->a);
-        addn("hold", s->h);
-        addn("sustain", s->s);
-        addn("release", s->r);
-    }
-    if (true /* s->subLfoParams */)
-    {
-        addn("rate", s->rate);
-        addn("amplitude", s->amp);
-        addn("startphase", s->phase);
-        addn("deform", s->deform);
-    }
+    addn(sk_phase, phaseFracPart);
 
-    if (true /* s->subTiming */)
-    {
-        addn("tempo", s->tempo);
-        addn("songpos", s->songpos);
-        addb("released", s->released);
-    }
+    addn(sk_delay, s->del);
+    addn(sk_decay, s->dec);
+    addn(sk_attack, s->a);
+    addn(sk_hold, s->h);
+    addn(sk_sustain, s->s);
+    addn(sk_release, s->r);
 
-    if (/* s->subVoice  && */ s->isVoice)
-    {
-        addb("is_voice", s->isVoice);
-        addn("key", s->key);
-        addn("velocity", s->velocity);
-        addn("channel", s->channel);
-        addb("released", s->released);
-    }
-    else
+    addn(sk_rate, s->rate);
+    addn(sk_amplitude, s->amp);
+    addn(sk_startphase, s->phase);
+    addn(sk_deform, s->deform);
+
+    addn(sk_tempo, s->tempo);
+    addn(sk_songpos, s->songpos);
+    addb(sk_released, s->released);
+
+    addb(sk_is_voice, s->isVoice);
+    if (s->isVoice)
     {
-        addb("is_voice", false);
+        addn(sk_key, s->key);
+        addn(sk_velocity, s->velocity);
+        addn(sk_channel, s->channel);
     }
 
-    addnil("retrigger_AEG");
-    addnil("retrigger_FEG");
+    addnil(sk_retrigger_AEG);
+    addnil(sk_retrigger_FEG);
 
     if (s->subAnyMacro)
     {
-        // load the macros
-        lua_pushstring(s->L, "macros");
-        lua_createtable(s->L, n_customcontrollers, 0);
+        // refill the macros table we made at prepare time and hang it back on the state,
+        // since the function is free to have replaced or dropped it
+        lua_rawgeti(L, LUA_REGISTRYINDEX, keys[sk_macros]);
+        lua_rawgeti(L, LUA_REGISTRYINDEX, s->macrosRef);
         for (int i = 0; i < n_customcontrollers; ++i)
         {
             if (s->subMacros[i])
             {
-                lua_pushinteger(s->L, i + 1);
-                lua_pushnumber(s->L, s->macrovalues[i]);
-                lua_settable(s->L, -3);
+                lua_pushnumber(L, s->macrovalues[i]);
+                lua_rawseti(L, -2, i + 1);
             }
         }
-        lua_settable(s->L, -3);
+        lua_settable(L, -3);
     }
 
     if (justSetup)
     {
         // Don't call but still clear me from the stack
-        lua_pop(s->L, 2);
+        lua_pop(L, 2);
         return;
     }
 
@@ -607,11 +992,11 @@ void valueAt(int phaseIntPart, float phaseFracPart, SurgeStorage *storage,
             lua_pop(s->L, 1);
             return;
         }
-        // Store the value and keep it on top of the stack
-        lua_setglobal(s->L, s->stateName);
-        lua_getglobal(s->L, s->stateName);
+        // Store the value in our existing reference and keep it on top of the stack
+        lua_pushvalue(s->L, -1);
+        lua_rawseti(s->L, LUA_REGISTRYINDEX, s->stateRef);
 
-        lua_pushstring(s->L, "output");
+        lua_rawgeti(s->L, LUA_REGISTRYINDEX, s->keyRefs[sk_output]);
         lua_gettable(s->L, -2);
         // top of stack is now the result
         float res = 0.0;
@@ -643,8 +1028,7 @@ void valueAt(int phaseIntPart, float phaseFracPart, SurgeStorage *storage,
                     if (idx > max_formula_outputs)
                         oss << " which means your result is too long.";
                     s->adderror(oss.str());
-                    auto &stateData = *storage->formulaGlobalData;
-                    stateData.knownBadFunctions.insert(s->funcName);
+                    s->prepared->knownBadFunctions.insert(s->funcName);
                     s->isvalid = false;
 
                     idx = 0;
@@ -660,21 +1044,21 @@ void valueAt(int phaseIntPart, float phaseFracPart, SurgeStorage *storage,
         }
         else
         {
-            auto &stateData = *storage->formulaGlobalData;
+            auto &knownBad = s->prepared->knownBadFunctions;
 
-            if (stateData.knownBadFunctions.find(s->funcName) != stateData.knownBadFunctions.end())
+            if (knownBad.find(s->funcName) != knownBad.end())
                 s->adderror(
                     "You must define the 'output' field in the returned table as a number or "
                     "float array");
-            stateData.knownBadFunctions.insert(s->funcName);
+            knownBad.insert(s->funcName);
             s->isvalid = false;
         };
         // pop the result and the function
         lua_pop(s->L, 1);
 
-        auto getBoolDefault = [s](const char *n, bool def) -> bool {
+        auto getBoolDefault = [s](StateKey k, bool def) -> bool {
             auto res = def;
-            lua_pushstring(s->L, n);
+            lua_rawgeti(s->L, LUA_REGISTRYINDEX, s->keyRefs[k]);
             lua_gettable(s->L, -2);
             if (lua_isboolean(s->L, -1))
             {
@@ -684,11 +1068,11 @@ void valueAt(int phaseIntPart, float phaseFracPart, SurgeStorage *storage,
             return res;
         };
 
-        s->useEnvelope = getBoolDefault("use_envelope", true);
-        s->retrigger_AEG = getBoolDefault("retrigger_AEG", false);
-        s->retrigger_FEG = getBoolDefault("retrigger_FEG", false);
+        s->useEnvelope = getBoolDefault(sk_use_envelope, true);
+        s->retrigger_AEG = getBoolDefault(sk_retrigger_AEG, false);
+        s->retrigger_FEG = getBoolDefault(sk_retrigger_FEG, false);
 
-        auto doClamp = getBoolDefault("clamp_output", true);
+        auto doClamp = getBoolDefault(sk_clamp_output, true);
         if (doClamp)
         {
             for (int i = 0; i < 8; ++i)
@@ -720,7 +1104,7 @@ std::vector<DebugRow> createDebugDataOfModState(const EvaluatorState &es)
 #if HAS_LUA
     std::vector<DebugRow> rows;
     Surge::LuaSupport::SGLD guard("debugViewGuard", es.L);
-    lua_getglobal(es.L, es.stateName);
+    lua_rawgeti(es.L, LUA_REGISTRYINDEX, es.stateRef);
     if (!lua_istable(es.L, -1))
     {
         lua_pop(es.L, -1);
@@ -894,7 +1278,7 @@ std::variant<float, std::string, bool> runOverModStateForTesting(const std::stri
         return false;
     }
 
-    lua_getglobal(es.L, es.stateName);
+    lua_rawgeti(es.L, LUA_REGISTRYINDEX, es.stateRef);
     if (!lua_istable(es.L, -1))
     {
         lua_pop(es.L, -1);
@@ -26,8 +26,13 @@
 #include "SurgeStorage.h"
 #include "StringOps.h"
 #include "LuaSupport.h"
-#include <variant>
+#include <atomic>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#include <variant>
 
 class SurgeVoice;
 
@@ -35,12 +40,121 @@ namespace Surge
 {
 namespace Formula
 {
+struct NativeProgram;
 
-struct GlobalData
+/*
+ * The state table fields we write on every evaluation. Their key strings are interned once per
+ * lua_State and held in the registry, so valueAt never has to hash or push a string by name.
+ */
+enum StateKey
 {
+    sk_intphase,
+    sk_cycle,
+    sk_phase,
+    sk_delay,
+    sk_decay,
+    sk_attack,
+    sk_hold,
+    sk_sustain,
+    sk_release,
+    sk_rate,
+    sk_amplitude,
+    sk_startphase,
+    sk_deform,
+    sk_tempo,
+    sk_songpos,
+    sk_released,
+    sk_is_voice,
+    sk_key,
+    sk_velocity,
+    sk_channel,
+    sk_retrigger_AEG,
+    sk_retrigger_FEG,
+    sk_macros,
+    sk_output,
+    sk_use_envelope,
+    sk_clamp_output,
+
+    n_stateKeys
+};
+
+/*
+ * A lua state made ready for formula evaluation: the surge prelude, the error stub and the
+ * interned state keys, and then every formula compiled into it so far. The display has one
+ * of these to itself. Everything else leases one from GlobalData.
+ */
+struct PreparedState
+{
+    lua_State *L{nullptr};
+    int keyRefs[n_stateKeys];
+
     std::unordered_set<std::string> knownBadFunctions; // these are functions which cause an error
-    std::unordered_map<FormulaModulatorStorage *, std::unordered_set<std::string>> functionsPerFMS;
-    void *audioState{nullptr}, *displayState{nullptr};
+    std::unordered_set<size_t> compiledHashes;          // formula hashes compiled into L
+    size_t formulasCompiled{0};                         // how far through GlobalData::formulas
+};
+
+/*
+ * A lua state can only be used by one thread at a time, and an evaluator's state table (the
+ * one init() returns and process() keeps handing back) lives in the state it was prepared
+ * on. Voices move between the audio thread, the voice render pool and the scene worker from
+ * block to block, so a state per thread would leave a voice's table behind. Instead each
+ * evaluator which runs on the audio side leases a state of its own in prepareForEvaluation
+ * and keeps it until cleanEvaluatorState. Whichever thread renders a voice then has the
+ * voice's states to itself, and a voice evaluates the same on any of them.
+ *
+ * The compiler thread keeps the pool ready. It polls the patch for the formulas its formula
+ * LFOs use, opens states so there are enough spare for the patch at its polyphony, and
+ * compiles every formula it has seen into every idle state, so a formula edited in the
+ * editor is compiled into all of them without the audio thread. A patch with no formula
+ * LFOs opens no states.
+ *
+ * prepareForEvaluation prefers an idle state which already has its formula. If it gets one
+ * without, because the formula changed a moment ago, it compiles it there and bumps
+ * compilesOnLease. If there is no idle state at all it opens one on the calling thread and
+ * bumps statesOpenedOnLease. Both are fallbacks, as with MemoryPool::emergencyAllocations.
+ */
+struct GlobalData
+{
+    explicit GlobalData(SurgeStorage *s);
+    ~GlobalData();
+
+    GlobalData(const GlobalData &) = delete;
+    GlobalData &operator=(const GlobalData &) = delete;
+
+    PreparedState *leaseState(size_t formulaHash);
+    void returnState(PreparedState *ps);
+
+    // how many idle states have the formula compiled in, and how many are idle
+    std::pair<size_t, size_t> idleStatesWithFormula(size_t formulaHash);
+
+    PreparedState displayState; // UI thread only, prepared on first use
+
+    std::atomic<uint64_t> compilesOnLease{0}, statesOpenedOnLease{0};
+
+    static constexpr size_t minSpareStates{4}, maxSpareStates{64};
+
+  private:
+    void compilerLoop();
+    void compileFormulas(PreparedState &ps);
+    void pickUpFormulas();
+    size_t spareStatesWanted();
+
+    SurgeStorage *storage;
+
+    std::mutex poolMutex;
+    std::vector<std::unique_ptr<PreparedState>> states;
+    std::vector<PreparedState *> idle;
+    std::atomic<size_t> spareWanted{minSpareStates};
+
+    // compiler thread only. formulas are compiled into every pooled state in this order
+    std::vector<std::pair<size_t, std::string>> formulas;
+    std::unordered_set<size_t> formulaHashes;
+    size_t seenHash[n_scenes][n_lfos]{};
+
+    std::thread compilerThread;
+    std::mutex compilerMutex;
+    std::condition_variable compilerCV;
+    bool compilerRunning{true};
 };
 
 static constexpr int max_formula_outputs{max_lfo_indices};
@@ -50,7 +164,14 @@ struct EvaluatorState
     bool released;
     char funcName[TXT_SIZE];
     char funcNameInit[TXT_SIZE];
-    char stateName[TXT_SIZE];
+
+    // registry references into L, resolved once in prepareForEvaluation. -1 is 'none'
+    int funcRef{-1}, stateRef{-1}, macrosRef{-1};
+    const int *keyRefs{nullptr};
+
+    // set by prepareForEvaluation when process can skip lua altogether
+    std::shared_ptr<const NativeProgram> native;
+    bool nativeClamp{true};
 
     bool isvalid = false;
     bool useEnvelope = true;
@@ -84,15 +205,16 @@ struct EvaluatorState
 
     int activeoutputs;
 
-    lua_State *L{nullptr}; // This is assigned by prepareForEvaluation to be one per thread
+    // assigned by prepareForEvaluation: a state leased from leasedFrom, or the display state
+    PreparedState *prepared{nullptr};
+    GlobalData *leasedFrom{nullptr};
+    lua_State *L{nullptr};
 };
 
 void setupStorage(SurgeStorage *s);
 
 bool initEvaluatorState(EvaluatorState &s);
-bool cleanEvaluatorState(EvaluatorState &s);
-void removeFunctionsAssociatedWith(SurgeStorage *,
-                                   FormulaModulatorStorage *fs); // audio thread only please
+bool cleanEvaluatorState(EvaluatorState &s); // and hand back its leased state
 bool prepareForEvaluation(SurgeStorage *storage, FormulaModulatorStorage *fs, EvaluatorState &s,
                           bool is_display);
 
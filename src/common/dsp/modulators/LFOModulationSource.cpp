@@ -535,37 +535,39 @@ void LFOModulationSource::retriggerEnvelopeFrom(float start)
     }
 }
 
-void LFOModulationSource::process_block()
+float LFOModulationSource::currentRate()
 {
-    if ((!phaseInitialized) || (lfo->trigmode.val.i == lm_keytrigger && lfo->rate.deactivated))
+    // The rate only changes when it is modulated or edited, so most blocks can reuse the last
+    // conversion rather than paying for the pow again
+    if (!rateCacheValid || localcopy[rate].f != rateCacheIn ||
+        lfo->rate.temposync != rateCacheSync || storage->dsamplerate_os_inv != rateCacheSRInv)
     {
-        initPhaseFromStartPhase();
-    }
-
-    retrigger_FEG = false;
-    retrigger_AEG = false;
-
-    int s = lfo->shape.val.i;
-    float frate = 0;
+        if (!lfo->rate.temposync)
+        {
+            rateCacheOut = storage->envelope_rate_linear_nowrap(-localcopy[rate].f);
+        }
+        else
+        {
+            /*
+            ** The approximation above drifts quite a lot especially on things like
+            *  dotted-quarters-vs-beat-at-not-120 BPM
+            ** See #2675 for sample patches. So do the calculation exactly.
+            **
+            ** envrate is blocksize / samplerate 2^-x
+            ** so let's just do that
+            */
+            rateCacheOut = (double)BLOCK_SIZE_OS * storage->dsamplerate_os_inv *
+                           pow(2.0, localcopy[rate].f); // since x = -localcopy, -x == localcopy
+        }
 
-    if (!lfo->rate.temposync)
-    {
-        frate = storage->envelope_rate_linear_nowrap(-localcopy[rate].f);
-    }
-    else
-    {
-        /*
-        ** The approximation above drifts quite a lot especially on things like
-        *  dotted-quarters-vs-beat-at-not-120 BPM
-        ** See #2675 for sample patches. So do the calculation exactly.
-        **
-        ** envrate is blocksize / samplerate 2^-x
-        ** so let's just do that
-        */
-        frate = (double)BLOCK_SIZE_OS * storage->dsamplerate_os_inv *
-                pow(2.0, localcopy[rate].f); // since x = -localcopy, -x == localcopy
+        rateCacheIn = localcopy[rate].f;
+        rateCacheSync = lfo->rate.temposync;
+        rateCacheSRInv = storage->dsamplerate_os_inv;
+        rateCacheValid = true;
     }
 
+    float frate = rateCacheOut;
+
     if (lfo->rate.deactivated)
     {
         frate = 0.0;
@@ -576,67 +578,130 @@ void LFOModulationSource::process_block()
         frate *= storage->temposyncratio;
     }
 
-    phase += frate * ratemult;
+    return frate;
+}
 
-    if (frate == 0 && phase == 0 && s == lt_stepseq)
+float LFOModulationSource::startBatchedPhase()
+{
+    if ((!phaseInitialized) || (lfo->trigmode.val.i == lm_keytrigger && lfo->rate.deactivated))
     {
-        phase = 0.001; // step forward a smidge
+        initPhaseFromStartPhase();
     }
 
-    if (env_state != lfoeg_stuck && env_state != lfoeg_msegrelease)
+    batchedRate = currentRate() * nextBlockFraction;
+
+    return batchedRate * ratemult;
+}
+
+float LFOModulationSource::currentEnvelopeRate()
+{
+    float envrate = 0;
+
+    switch (env_state)
     {
-        float envrate = 0;
+    case lfoeg_delay:
+        envrate = storage->envelope_rate_linear_nowrap(localcopy[idelay].f);
 
-        switch (env_state)
+        if (lfo->delay.temposync)
         {
-        case lfoeg_delay:
-            envrate = storage->envelope_rate_linear_nowrap(localcopy[idelay].f);
+            envrate *= storage->temposyncratio;
+        }
 
-            if (lfo->delay.temposync)
-            {
-                envrate *= storage->temposyncratio;
-            }
+        break;
+    case lfoeg_attack:
+        envrate = storage->envelope_rate_linear_nowrap(localcopy[iattack].f);
 
-            break;
-        case lfoeg_attack:
-            envrate = storage->envelope_rate_linear_nowrap(localcopy[iattack].f);
+        if (lfo->attack.temposync)
+        {
+            envrate *= storage->temposyncratio;
+        }
 
-            if (lfo->attack.temposync)
-            {
-                envrate *= storage->temposyncratio;
-            }
+        break;
+    case lfoeg_hold:
+        envrate = storage->envelope_rate_linear_nowrap(localcopy[ihold].f);
 
-            break;
-        case lfoeg_hold:
-            envrate = storage->envelope_rate_linear_nowrap(localcopy[ihold].f);
+        if (lfo->hold.temposync)
+        {
+            envrate *= storage->temposyncratio;
+        }
 
-            if (lfo->hold.temposync)
-            {
-                envrate *= storage->temposyncratio;
-            }
+        break;
+    case lfoeg_decay:
+        envrate = storage->envelope_rate_linear_nowrap(localcopy[idecay].f);
 
-            break;
-        case lfoeg_decay:
-            envrate = storage->envelope_rate_linear_nowrap(localcopy[idecay].f);
+        if (lfo->decay.temposync)
+        {
+            envrate *= storage->temposyncratio;
+        }
 
-            if (lfo->decay.temposync)
-            {
-                envrate *= storage->temposyncratio;
-            }
+        break;
+    case lfoeg_release:
+        envrate = storage->envelope_rate_linear_nowrap(localcopy[irelease].f);
 
-            break;
-        case lfoeg_release:
-            envrate = storage->envelope_rate_linear_nowrap(localcopy[irelease].f);
+        if (lfo->release.temposync)
+        {
+            envrate *= storage->temposyncratio;
+        }
 
-            if (lfo->release.temposync)
-            {
-                envrate *= storage->temposyncratio;
-            }
+        break;
+    };
 
-            break;
-        };
+    return envrate;
+}
 
-        env_phase += envrate;
+float LFOModulationSource::clampedMagnitude()
+{
+    return limit_range(lfo->magnitude.get_extended(localcopy[magn].f), -3.f, 3.f);
+}
+
+void LFOModulationSource::process_block()
+{
+    float frate = 0;
+    bool wrapped = false;
+
+    const float fraction = nextBlockFraction;
+    nextBlockFraction = 1.f;
+
+    retrigger_FEG = false;
+    retrigger_AEG = false;
+
+    if (batched == batched_outputs)
+    {
+        // a VoiceLFOBank has run the whole block, and the voice reads the outputs from its lane
+        batched = batched_none;
+        return;
+    }
+
+    bankOutputs = nullptr;
+
+    if (batched != batched_none)
+    {
+        // a VoiceLFOBank has already advanced (and if need be wrapped) the phase for this block
+        frate = batchedRate;
+        wrapped = batchedWrap;
+    }
+    else
+    {
+        if ((!phaseInitialized) || (lfo->trigmode.val.i == lm_keytrigger && lfo->rate.deactivated))
+        {
+            initPhaseFromStartPhase();
+        }
+
+        frate = currentRate() * fraction;
+        phase += frate * ratemult;
+    }
+
+    int s = lfo->shape.val.i;
+
+    if (frate == 0 && phase == 0 && s == lt_stepseq)
+    {
+        phase = 0.001; // step forward a smidge
+    }
+
+    // the bank runs the envelope stages along with the phase
+    if (batched == batched_none && env_state != lfoeg_stuck && env_state != lfoeg_msegrelease)
+    {
+        env_phase += currentEnvelopeRate() * fraction;
 
         float sustainlevel = localcopy[isustain].f;
 
@@ -689,9 +754,15 @@ void LFOModulationSource::process_block()
         };
     }
 
-    if (phase >= 1 || phase < 0)
+    batched = batched_none;
+
+    if (wrapped || phase >= 1 || phase < 0)
     {
-        if (phase >= 2)
+        if (wrapped)
+        {
+            // the bank has wrapped it already
+        }
+        else if (phase >= 2)
         {
             float ipart;
 
@@ -1284,7 +1355,7 @@ void LFOModulationSource::process_block()
             outputEnvVal = useenvval;
         }
     }
-    auto magnf = limit_range(lfo->magnitude.get_extended(localcopy[magn].f), -3.f, 3.f);
+    auto magnf = clampedMagnitude();
 
     output_multi[0] = (useenvval + useenv0) * magnf * io2;
     output_multi[1] = io2;
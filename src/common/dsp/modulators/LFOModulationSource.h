@@ -63,6 +63,34 @@ class LFOModulationSource : public ModulationSource
     virtual void retriggerEnvelopeFrom(float);
     virtual void completedModulation();
 
+    /*
+     * A VoiceLFOBank runs the per-block work of a scene's voice LFOs in SIMD lanes before the
+     * voices render: always the phase and the envelope, and for the simpler shapes the outputs
+     * too. The next process_block carries on from wherever the bank stopped. When the bank
+     * produced the outputs, outputsFromBank points at this LFO's lane of them (one output every
+     * VoiceLFOBank::outputStride floats) until the next scalar process_block; otherwise it is
+     * null.
+     */
+    bool canRunInBank() const
+    {
+        return lfo->shape.val.i != lt_mseg && lfo->shape.val.i != lt_formula;
+    }
+    const float *outputsFromBank() const { return bankOutputs; }
+
+    // whether this block's process_block may set retrigger_AEG or retrigger_FEG
+    bool canRetriggerEnvelopes() const
+    {
+        auto s = lfo->shape.val.i;
+        return s == lt_mseg || s == lt_formula || (s == lt_stepseq && ss->trigmask != 0);
+    }
+
+    /*
+     * Make the next block (batched or not) advance the phase and the envelope by only this
+     * fraction of a block. A voice whose note lands partway into a block uses it so its LFOs
+     * run from the note's own sample, like its oscillators.
+     */
+    void shortenNextBlock(float fraction) { nextBlockFraction = fraction; }
+
     enum EnvelopeRetriggerMode
     {
         FROM_ZERO,
@@ -129,6 +157,7 @@ class LFOModulationSource : public ModulationSource
     bool phaseInitialized;
     void initPhaseFromStartPhase();
     void msegEnvelopePhaseAdjustment();
+    float currentRate();
 
     float phase, target, noise, noised1, env_phase, priorPhase;
     int unwrappedphase_intpart;
@@ -143,6 +172,32 @@ class LFOModulationSource : public ModulationSource
 
     float onepoleState[3];
 
+    // the phase increment for the rate last seen by process_block, and what it was made from
+    float rateCacheIn{0}, rateCacheOut{0};
+    double rateCacheSRInv{0};
+    bool rateCacheSync{false}, rateCacheValid{false};
+
+    /*
+     * Set by a VoiceLFOBank for the process_block which picks up after it: how far the bank
+     * got, and the rate and wrap it advanced the phase with.
+     */
+    friend class VoiceLFOBank;
+    enum BatchedStages
+    {
+        batched_none,
+        batched_envelope,
+        batched_outputs,
+    } batched{batched_none};
+    float batchedRate{0};
+    bool batchedWrap{false};
+    const float *bankOutputs{nullptr};
+
+    float startBatchedPhase();
+    float currentEnvelopeRate();
+    float clampedMagnitude();
+
+    float nextBlockFraction{1.f};
+
     std::default_random_engine gen;
     std::uniform_real_distribution<float> distro;
     std::function<float()> urng;
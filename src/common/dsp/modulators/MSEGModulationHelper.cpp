@@ -21,6 +21,7 @@
  */
 
 #include "MSEGModulationHelper.h"
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 #include "DebugHelpers.h"
@@ -32,6 +33,25 @@ namespace Surge
 namespace MSEG
 {
 
+/*
+ * segmentStart and segmentEnd are running sums of the durations, so rather than walk the
+ * segments we can bisect for the first one ending after (or at, with includeEnd) t and check
+ * it starts at or before t. That is the same segment the walk finds, zero length ones included.
+ */
+static int segmentContaining(const MSEGStorage *ms, double t, bool includeEnd)
+{
+    auto b = ms->segmentEnd.begin();
+    auto e = b + ms->n_activeSegments;
+    auto it = includeEnd
+                  ? std::lower_bound(b, e, t, [](float end, double x) { return end < x; })
+                  : std::upper_bound(b, e, t, [](double x, float end) { return x < end; });
+    if (it == e)
+        return -1;
+
+    auto idx = (int)(it - b);
+    return (t >= ms->segmentStart[idx]) ? idx : -1;
+}
+
 void rebuildCache(MSEGStorage *ms)
 {
     forceToConstrainedNormalForm(ms);
@@ -182,15 +202,7 @@ float valueAt(int ip, float fup, float df, MSEGStorage *ms, EvaluatorState *es,
             double adjustedPhase = up - es->releaseStartPhase + ms->segmentEnd[ms->loop_end];
 
             // so now find the index
-            idx = -1;
-
-            for (int ai = 0; ai < ms->n_activeSegments && idx < 0; ai++)
-            {
-                if (ms->segmentStart[ai] <= adjustedPhase && ms->segmentEnd[ai] > adjustedPhase)
-                {
-                    idx = ai;
-                }
-            }
+            idx = segmentContaining(ms, adjustedPhase, false);
 
             if (idx < 0)
             {
@@ -209,7 +221,7 @@ float valueAt(int ip, float fup, float df, MSEGStorage *ms, EvaluatorState *es,
 
     // std::cout << up << " " << idx << std::endl;
 
-    auto r = ms->segments[idx];
+    const auto &r = ms->segments[idx];
     bool segInit = false;
 
     if (idx != es->lastEval || es->has_triggered)
@@ -749,17 +761,11 @@ int timeToSegment(MSEGStorage *ms, double t, bool ignoreLoops, float &amountAlon
             }
         }
 
-        int idx = -1;
+        int idx = segmentContaining(ms, t, false);
 
-        for (int i = 0; i < ms->n_activeSegments; ++i)
+        if (idx >= 0)
         {
-            if (t >= ms->segmentStart[i] && t < ms->segmentEnd[i])
-            {
-                idx = i;
-                amountAlongSegment = t - ms->segmentStart[i];
-
-                break;
-            }
+            amountAlongSegment = t - ms->segmentStart[idx];
         }
 
         return idx;
@@ -773,13 +779,14 @@ int timeToSegment(MSEGStorage *ms, double t, bool ignoreLoops, float &amountAlon
         // So are we before the first loop end point
         if (t <= ms->durationToLoopEnd)
         {
-            for (int i = 0; i < ms->n_activeSegments; ++i)
-                if (t >= ms->segmentStart[i] && t <= ms->segmentEnd[i])
-                {
-                    amountAlongSegment = t - ms->segmentStart[i];
+            auto i = segmentContaining(ms, t, true);
 
-                    return i;
-                }
+            if (i >= 0)
+            {
+                amountAlongSegment = t - ms->segmentStart[i];
+
+                return i;
+            }
         }
         else if (ms->loop_start > ms->loop_end && ms->loop_start >= 0 && ms->loop_end >= 0)
         {
@@ -807,13 +814,14 @@ int timeToSegment(MSEGStorage *ms, double t, bool ignoreLoops, float &amountAlon
             // and we need to offset it by the starting point
             nt += ms->segmentStart[ls];
 
-            for (int i = 0; i < ms->n_activeSegments; ++i)
-                if (nt >= ms->segmentStart[i] && nt <= ms->segmentEnd[i])
-                {
-                    amountAlongSegment = nt - ms->segmentStart[i];
+            auto i = segmentContaining(ms, nt, true);
 
-                    return i;
-                }
+            if (i >= 0)
+            {
+                amountAlongSegment = nt - ms->segmentStart[i];
+
+                return i;
+            }
         }
 
         return 0;
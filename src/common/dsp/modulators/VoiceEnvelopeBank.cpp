@@ -0,0 +1,309 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+
+#include "VoiceLFOBank.h"
+#include "VoiceEnvelopeBank.h"
+#include <cmath>
+
+namespace
+{
+inline __m128 select(__m128 mask, __m128 a, __m128 b)
+{
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+inline __m128 is(__m128 v, float f) { return _mm_cmpeq_ps(v, _mm_set1_ps(f)); }
+
+// std::clamp, lane by lane
+inline __m128 clamp(__m128 v, __m128 lo, __m128 hi)
+{
+    return select(_mm_cmplt_ps(v, lo), lo, select(_mm_cmplt_ps(hi, v), hi, v));
+}
+} // namespace
+
+void VoiceEnvelopeBank::process()
+{
+    for (int i = 0; i < 4; ++i)
+    {
+        auto &g = groups[i];
+
+        if (g.n == 0)
+            continue;
+
+        // pad the last quad with lanes which stay put
+        int padded = (g.n + 3) & ~3;
+
+        if (i & 1)
+        {
+            processAnalog(g, padded);
+        }
+        else
+        {
+            processDigital(g, padded);
+        }
+    }
+}
+
+void VoiceEnvelopeBank::processAnalog(Group &g, int padded)
+{
+    for (int i = 0; i < g.n; ++i)
+    {
+        auto e = g.envs[i];
+
+        g.v_c1[i] = e->_v_c1;
+        g.v_c1_delayed[i] = e->_v_c1_delayed;
+        g.discharge[i] = e->_discharge;
+        g.state[i] = (e->envstate == s_attack || e->envstate == s_decay) ? 1.f : 0.f;
+        g.sustain[i] = limit_range(e->lc[e->s].f, 0.f, 1.f);
+        e->analogCoefficients(e->blockFraction, g.coefA[i], g.coefD[i], g.coefR[i]);
+    }
+
+    for (int i = g.n; i < padded; ++i)
+    {
+        g.v_c1[i] = 0.f;
+        g.v_c1_delayed[i] = 0.f;
+        g.discharge[i] = 0.f;
+        g.state[i] = 0.f;
+        g.sustain[i] = 0.f;
+        g.coefA[i] = 0.f;
+        g.coefD[i] = 0.f;
+        g.coefR[i] = 0.f;
+    }
+
+    // ADSRModulationSource::process_block's analog mode, four envelopes at a time
+    const auto zero = _mm_setzero_ps(), one = _mm_set1_ps(1.f), v_cc_vec = _mm_set1_ps(1.5f);
+
+    for (int i = 0; i < padded; i += 4)
+    {
+        auto v_c1 = _mm_load_ps(&g.v_c1[i]);
+        auto v_c1_delayed = _mm_load_ps(&g.v_c1_delayed[i]);
+        auto discharge = _mm_load_ps(&g.discharge[i]);
+
+        auto v_gate = _mm_and_ps(_mm_cmpgt_ps(_mm_load_ps(&g.state[i]), zero), v_cc_vec);
+        auto v_is_gate = _mm_cmpgt_ps(v_gate, zero);
+
+        discharge = _mm_and_ps(_mm_or_ps(_mm_cmpgt_ps(v_c1_delayed, one), discharge), v_is_gate);
+
+        v_c1_delayed = v_c1;
+
+        auto S = _mm_load_ps(&g.sustain[i]);
+        S = _mm_mul_ps(S, S);
+        auto v_attack = _mm_andnot_ps(discharge, v_gate);
+        auto v_decay = _mm_or_ps(_mm_andnot_ps(discharge, v_cc_vec), _mm_and_ps(discharge, S));
+        auto v_release = v_gate;
+
+        auto diff_v_a = _mm_max_ps(zero, _mm_sub_ps(v_attack, v_c1));
+
+        auto diff_vd_kernel = _mm_sub_ps(v_decay, v_c1);
+        auto diff_vd_kernel_min = _mm_min_ps(zero, diff_vd_kernel);
+        auto dis_and_gate = _mm_and_ps(discharge, v_is_gate);
+        auto diff_v_d = select(dis_and_gate, diff_vd_kernel, diff_vd_kernel_min);
+
+        auto diff_v_r = _mm_min_ps(zero, _mm_sub_ps(v_release, v_c1));
+
+        v_c1 = _mm_add_ps(v_c1, _mm_mul_ps(diff_v_a, _mm_load_ps(&g.coefA[i])));
+        v_c1 = _mm_add_ps(v_c1, _mm_mul_ps(diff_v_d, _mm_load_ps(&g.coefD[i])));
+        v_c1 = _mm_add_ps(v_c1, _mm_mul_ps(diff_v_r, _mm_load_ps(&g.coefR[i])));
+
+        _mm_store_ps(&g.v_c1[i], v_c1);
+        _mm_store_ps(&g.v_c1_delayed[i], v_c1_delayed);
+        _mm_store_ps(&g.discharge[i], discharge);
+    }
+
+    for (int i = 0; i < g.n; ++i)
+    {
+        auto e = g.envs[i];
+
+        e->_v_c1 = g.v_c1[i];
+        e->_v_c1_delayed = g.v_c1_delayed[i];
+        e->_discharge = g.discharge[i];
+        e->output = e->_v_c1;
+
+        const float SILENCE_THRESHOLD = 1e-6;
+
+        if (g.state[i] == 0.f && e->_discharge == 0.f && e->_v_c1 < SILENCE_THRESHOLD)
+        {
+            e->envstate = s_idle;
+            e->output = 0;
+            e->idlecount++;
+        }
+
+        e->batched = true;
+    }
+}
+
+void VoiceEnvelopeBank::processDigital(Group &g, int padded)
+{
+    int longestRelease = 0;
+
+    for (int i = 0; i < g.n; ++i)
+    {
+        auto e = g.envs[i];
+        auto lc = e->lc;
+
+        g.state[i] = e->envstate;
+        g.phase[i] = e->phase;
+        g.output[i] = e->output;
+        g.scalestage[i] = e->scalestage;
+        g.rate[i] = e->digitalRate(e->blockFraction);
+        g.sustain[i] = lc[e->s].f;
+        g.attackShape[i] = lc[e->a_s].i;
+        g.decayShape[i] = lc[e->d_s].i;
+        g.releaseShape[i] = lc[e->r_s].i;
+        longestRelease = std::max(longestRelease, lc[e->r_s].i);
+
+        // the decay's special cases only depend on where the block starts, so settle them here
+        g.floorDecay[i] = 0.f;
+        g.capDecay[i] = 0.f;
+        g.cubeRoot[i] = 0.f;
+
+        if (e->envstate == s_decay)
+        {
+            auto phase = e->phase;
+            auto rate = g.rate[i];
+
+            if ((lc[e->s].f < 1e-3 && phase < 1e-4) || (lc[e->s].f == 0 && lc[e->d].f < -7))
+                g.floorDecay[i] = 1.f;
+            if (rate > 1.0)
+                g.capDecay[i] = 1.f;
+            if (lc[e->d_s].i == 2)
+                g.cubeRoot[i] = powf(phase, 0.3333333f);
+        }
+    }
+
+    for (int i = g.n; i < padded; ++i)
+    {
+        g.state[i] = s_idle;
+        g.phase[i] = 0.f;
+        g.output[i] = 0.f;
+        g.scalestage[i] = 0.f;
+        g.rate[i] = 0.f;
+        g.sustain[i] = 0.f;
+        g.attackShape[i] = 0.f;
+        g.decayShape[i] = 0.f;
+        g.releaseShape[i] = 0.f;
+        g.floorDecay[i] = 0.f;
+        g.capDecay[i] = 0.f;
+        g.cubeRoot[i] = 0.f;
+    }
+
+    /*
+     * Every lane works out the attack, decay and release steps from where it is, and keeps the
+     * one for its own stage. Idle lanes keep everything.
+     */
+    const auto zero = _mm_setzero_ps(), one = _mm_set1_ps(1.f), two = _mm_set1_ps(2.f),
+               three = _mm_set1_ps(3.f);
+
+    for (int i = 0; i < padded; i += 4)
+    {
+        auto st = _mm_load_ps(&g.state[i]);
+        auto phase = _mm_load_ps(&g.phase[i]);
+        auto output = _mm_load_ps(&g.output[i]);
+        auto rate = _mm_load_ps(&g.rate[i]);
+        auto sus = _mm_load_ps(&g.sustain[i]);
+
+        auto inAttack = is(st, s_attack), inDecay = is(st, s_decay);
+        auto inRelease = _mm_or_ps(is(st, s_release), is(st, s_uberrelease));
+
+        // attack
+        auto pa = _mm_add_ps(phase, rate);
+        auto attackDone = _mm_cmpge_ps(pa, one);
+        pa = select(attackDone, one, pa);
+
+        auto as = _mm_load_ps(&g.attackShape[i]);
+        auto oa = select(is(as, 0), _mm_sqrt_ps(pa),
+                         select(is(as, 1), pa, select(is(as, 2), _mm_mul_ps(pa, pa), output)));
+
+        // decay, between a low and a high bound which depend on the shape
+        auto rr = _mm_mul_ps(rate, rate);
+
+        auto sx = _mm_sqrt_ps(phase);
+        auto sxr = _mm_mul_ps(_mm_mul_ps(two, sx), rate);
+        auto lo1 = _mm_add_ps(_mm_sub_ps(phase, sxr), rr);
+        auto hi1 = _mm_add_ps(_mm_add_ps(phase, sxr), rr);
+        lo1 = select(_mm_cmpneq_ps(_mm_load_ps(&g.floorDecay[i]), zero), zero, lo1);
+        lo1 = select(_mm_and_ps(_mm_cmpneq_ps(_mm_load_ps(&g.capDecay[i]), zero),
+                                _mm_cmpgt_ps(lo1, sus)),
+                     sus, lo1);
+
+        auto cr = _mm_load_ps(&g.cubeRoot[i]);
+        auto t1 = _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(three, cr), cr), rate);
+        auto t2 = _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(three, cr), rate), rate);
+        auto t3 = _mm_mul_ps(rr, rate);
+        auto lo2 = _mm_sub_ps(_mm_add_ps(_mm_sub_ps(phase, t1), t2), t3);
+        auto hi2 = _mm_add_ps(_mm_add_ps(_mm_add_ps(phase, t1), t2), t3);
+
+        auto lo0 = _mm_sub_ps(phase, rate);
+        auto hi0 = _mm_add_ps(phase, rate);
+
+        auto ds = _mm_load_ps(&g.decayShape[i]);
+        auto lo = select(is(ds, 1), lo1, select(is(ds, 2), lo2, lo0));
+        auto hi = select(is(ds, 1), hi1, select(is(ds, 2), hi2, hi0));
+        auto pd = clamp(sus, lo, hi);
+
+        // release, and the quick uber-release which differs only by its rate
+        auto pr = _mm_sub_ps(phase, rate);
+        auto orl = pr;
+        auto rs = _mm_load_ps(&g.releaseShape[i]);
+
+        for (int k = 0; k < longestRelease; ++k)
+        {
+            orl = select(_mm_cmplt_ps(_mm_set1_ps(k), rs), _mm_mul_ps(orl, pr), orl);
+        }
+
+        auto released = _mm_cmplt_ps(pr, zero);
+        orl = select(released, zero, orl);
+        orl = _mm_mul_ps(orl, _mm_load_ps(&g.scalestage[i]));
+
+        phase = select(inAttack, pa, select(inDecay, pd, select(inRelease, pr, phase)));
+        output = select(inAttack, oa, select(inDecay, pd, select(inRelease, orl, output)));
+        st = select(_mm_and_ps(inAttack, attackDone), _mm_set1_ps(s_decay),
+                    select(_mm_and_ps(inRelease, released), _mm_set1_ps(s_idle), st));
+
+        _mm_store_ps(&g.state[i], st);
+        _mm_store_ps(&g.phase[i], phase);
+        _mm_store_ps(&g.output[i], clamp(output, zero, one));
+    }
+
+    for (int i = 0; i < g.n; ++i)
+    {
+        auto e = g.envs[i];
+        auto was = e->envstate;
+
+        e->envstate = (int)g.state[i];
+        e->phase = g.phase[i];
+        e->output = g.output[i];
+
+        if (was == s_attack && e->envstate == s_decay)
+        {
+            e->sustain = e->lc[e->s].f;
+        }
+
+        if (was == s_idle)
+        {
+            e->idlecount++;
+        }
+
+        e->batched = true;
+    }
+}
@@ -0,0 +1,103 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+#ifndef SURGE_SRC_COMMON_DSP_MODULATORS_VOICEENVELOPEBANK_H
+#define SURGE_SRC_COMMON_DSP_MODULATORS_VOICEENVELOPEBANK_H
+
+#include "ADSRModulationSource.h"
+
+/*
+ * The amp and filter envelopes of a scene's voices, stepped four voices at a time. Before the
+ * voices render (and after the VoiceLFOBank), the synth adds the envelopes of every voice whose
+ * LFOs cannot retrigger them this block and calls process. The envelopes are split by the mode
+ * their voice is in, analog or digital. Each lane keeps its own stage, and the stage maths is
+ * worked out for every lane and picked per lane by masks. The results go back into each
+ * ADSRModulationSource, so get_output and is_idle work as before and the voice's own
+ * process_block just skips the block.
+ *
+ * The analog lanes run the same SSE code the envelope runs on its own, four wide. In the
+ * digital lanes the stage rates, and the cube root of the cubic decay, are looked up per lane
+ * first. The results are the ones the envelope gives on its own, to the bit unless the
+ * compiler fuses multiplies and adds in the scalar code.
+ */
+class VoiceEnvelopeBank
+{
+  public:
+    void clear()
+    {
+        for (auto &g : groups)
+            g.n = 0;
+    }
+    // which is 0 for the amp envelope and 1 for the filter envelope
+    void add(int which, ADSRModulationSource *e)
+    {
+        assert(which == 0 || which == 1);
+
+        if (!e->canRunInBank())
+            return;
+
+        auto &g = groups[which * 2 + (e->lc[e->mode].b ? 1 : 0)];
+
+        assert(g.n < MAX_VOICES);
+        g.envs[g.n++] = e;
+    }
+    int size() const
+    {
+        int res = 0;
+        for (auto &g : groups)
+            res += g.n;
+        return res;
+    }
+
+    void process();
+
+  private:
+    struct Group
+    {
+        int n{0};
+        ADSRModulationSource *envs[MAX_VOICES];
+
+        // shared
+        float state alignas(16)[MAX_VOICES], output alignas(16)[MAX_VOICES];
+
+        // analog
+        float v_c1 alignas(16)[MAX_VOICES], v_c1_delayed alignas(16)[MAX_VOICES];
+        float discharge alignas(16)[MAX_VOICES], sustain alignas(16)[MAX_VOICES];
+        float coefA alignas(16)[MAX_VOICES], coefD alignas(16)[MAX_VOICES];
+        float coefR alignas(16)[MAX_VOICES];
+
+        // digital
+        float phase alignas(16)[MAX_VOICES], rate alignas(16)[MAX_VOICES];
+        float scalestage alignas(16)[MAX_VOICES], cubeRoot alignas(16)[MAX_VOICES];
+        float attackShape alignas(16)[MAX_VOICES], decayShape alignas(16)[MAX_VOICES];
+        float releaseShape alignas(16)[MAX_VOICES], floorDecay alignas(16)[MAX_VOICES];
+        float capDecay alignas(16)[MAX_VOICES];
+    };
+
+    void processAnalog(Group &g, int padded);
+    void processDigital(Group &g, int padded);
+
+    // amp digital, amp analog, filter digital, filter analog
+    Group groups[4];
+};
+
+#endif // SURGE_SRC_COMMON_DSP_MODULATORS_VOICEENVELOPEBANK_H
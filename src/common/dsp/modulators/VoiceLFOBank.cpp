@@ -0,0 +1,454 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+
+#include "VoiceLFOBank.h"
+#include <cmath>
+
+namespace
+{
+inline __m128 select(__m128 mask, __m128 a, __m128 b)
+{
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+/*
+ * The deform corrections are worked out in double in the scalar code, so to give the same
+ * floats back they are worked out in double here too, two lanes at a time.
+ */
+template <typename F, typename... V> inline __m128 inDouble(F f, V... v)
+{
+    auto lo = f(_mm_cvtps_pd(v)...);
+    auto hi = f(_mm_cvtps_pd(_mm_movehl_ps(v, v))...);
+
+    return _mm_movelh_ps(_mm_cvtpd_ps(lo), _mm_cvtpd_ps(hi));
+}
+} // namespace
+
+void VoiceLFOBank::process()
+{
+    for (auto &r : rows)
+    {
+        if (r.n == 0)
+            continue;
+
+        // pad the last quad with lanes which stay put
+        int padded = (r.n + 3) & ~3;
+
+        gather(r, padded);
+        advancePhases(r, padded);
+        advanceEnvelopes(r, padded);
+
+        bool withOutputs = evaluateShapes(r, padded);
+
+        if (withOutputs)
+        {
+            evaluateOutputs(r, padded);
+        }
+
+        scatter(r, withOutputs);
+    }
+}
+
+void VoiceLFOBank::gather(Row &r, int padded)
+{
+    for (int i = 0; i < r.n; ++i)
+    {
+        auto l = r.lfos[i];
+
+        r.increment[i] = l->startBatchedPhase();
+        r.phase[i] = l->phase;
+        r.fraction[i] = l->nextBlockFraction;
+        r.envState[i] = l->env_state;
+        r.envPhase[i] = l->env_phase;
+        r.envVal[i] = l->env_val;
+        r.envRate[i] = l->currentEnvelopeRate();
+        r.sustain[i] = l->localcopy[l->isustain].f;
+        r.releaseStart[i] = l->env_releasestart;
+        r.deform[i] = l->localcopy[l->ideform].f;
+        r.magnitude[i] = l->clampedMagnitude();
+
+        // restarting from the last value reshapes the outputs, which only the scalar code does
+        r.complete[i] = (l->envRetrigMode == LFOModulationSource::FROM_LAST) ? 0.f : 1.f;
+    }
+
+    for (int i = r.n; i < padded; ++i)
+    {
+        r.increment[i] = 0.f;
+        r.phase[i] = 0.f;
+        r.fraction[i] = 0.f;
+        r.envState[i] = lfoeg_off;
+        r.envPhase[i] = 0.f;
+        r.envVal[i] = 0.f;
+        r.envRate[i] = 0.f;
+        r.sustain[i] = 0.f;
+        r.releaseStart[i] = 0.f;
+        r.deform[i] = 0.f;
+        r.magnitude[i] = 0.f;
+        r.complete[i] = 0.f;
+        r.shape[i] = 0.f;
+    }
+}
+
+void VoiceLFOBank::advancePhases(Row &r, int padded)
+{
+    const auto zero = _mm_setzero_ps(), one = _mm_set1_ps(1.f), two = _mm_set1_ps(2.f);
+
+    for (int i = 0; i < padded; i += 4)
+    {
+        auto p = _mm_add_ps(_mm_load_ps(&r.phase[i]), _mm_load_ps(&r.increment[i]));
+
+        /*
+         * One step over the end of the cycle is the only wrap we do here. A phase which ends up
+         * at 2 or more, or below zero, is left for process_block to bring back into range, so
+         * that lane stops after the envelope.
+         */
+        auto w = _mm_and_ps(_mm_cmpge_ps(p, one), _mm_cmplt_ps(p, two));
+
+        p = _mm_sub_ps(p, _mm_and_ps(w, one));
+
+        auto inRange = _mm_and_ps(_mm_cmpge_ps(p, zero), _mm_cmplt_ps(p, one));
+
+        _mm_store_ps(&r.phase[i], p);
+        _mm_store_ps(&r.wrapped[i], _mm_and_ps(w, one));
+        _mm_store_ps(&r.complete[i], _mm_and_ps(inRange, _mm_load_ps(&r.complete[i])));
+    }
+}
+
+void VoiceLFOBank::advanceEnvelopes(Row &r, int padded)
+{
+    const auto zero = _mm_setzero_ps(), one = _mm_set1_ps(1.f);
+    const auto delay = _mm_set1_ps(lfoeg_delay), attack = _mm_set1_ps(lfoeg_attack),
+               hold = _mm_set1_ps(lfoeg_hold), decay = _mm_set1_ps(lfoeg_decay),
+               release = _mm_set1_ps(lfoeg_release), stuck = _mm_set1_ps(lfoeg_stuck);
+
+    for (int i = 0; i < padded; i += 4)
+    {
+        auto st = _mm_load_ps(&r.envState[i]);
+        auto ep0 = _mm_load_ps(&r.envPhase[i]);
+        auto ev0 = _mm_load_ps(&r.envVal[i]);
+        auto sus = _mm_load_ps(&r.sustain[i]);
+
+        // only delay through release move; off, stuck and MSEG release lanes keep everything
+        auto staged = _mm_and_ps(_mm_cmpge_ps(st, delay), _mm_cmple_ps(st, release));
+
+        auto ep = _mm_add_ps(ep0, _mm_mul_ps(_mm_load_ps(&r.envRate[i]),
+                                             _mm_load_ps(&r.fraction[i])));
+
+        // past the end of a stage: delay, attack and hold go on to the next one, and decay and
+        // release get stuck at the sustain level and at zero
+        auto over = _mm_and_ps(staged, _mm_cmpgt_ps(ep, one));
+        auto toStuck = _mm_and_ps(over, _mm_cmpge_ps(st, decay));
+        auto nst = select(over, select(toStuck, stuck, _mm_add_ps(st, one)), st);
+
+        ep = select(over, zero, ep);
+
+        auto ev = ev0;
+        ev = select(_mm_and_ps(toStuck, _mm_cmpeq_ps(st, decay)), sus, ev);
+        ev = select(_mm_and_ps(toStuck, _mm_cmpeq_ps(st, release)), zero, ev);
+        ev = select(_mm_cmpeq_ps(nst, delay), zero, ev);
+        ev = select(_mm_cmpeq_ps(nst, attack), ep, ev);
+        ev = select(_mm_cmpeq_ps(nst, hold), one, ev);
+        ev = select(_mm_cmpeq_ps(nst, decay), _mm_add_ps(_mm_sub_ps(one, ep), _mm_mul_ps(ep, sus)),
+                    ev);
+        ev = select(_mm_cmpeq_ps(nst, release),
+                    _mm_mul_ps(_mm_sub_ps(one, ep), _mm_load_ps(&r.releaseStart[i])), ev);
+
+        _mm_store_ps(&r.envState[i], select(staged, nst, st));
+        _mm_store_ps(&r.envPhase[i], select(staged, ep, ep0));
+        _mm_store_ps(&r.envVal[i], select(staged, ev, ev0));
+    }
+}
+
+bool VoiceLFOBank::evaluateShapes(Row &r, int padded)
+{
+    auto lead = r.lfos[0];
+    auto lfo = lead->lfo;
+    auto deformType = lfo->deform.deform_type;
+
+    const auto one = _mm_set1_ps(1.f), half = _mm_set1_ps(0.5f), two = _mm_set1_ps(2.f),
+               four = _mm_set1_ps(4.f);
+
+    // the undeformed waveform, which sine, triangle and ramp then bend the same way
+    switch (lfo->shape.val.i)
+    {
+    case lt_sine:
+    {
+        constexpr auto wst_sine = sst::waveshapers::WaveshaperType::wst_sine;
+
+        for (int i = 0; i < padded; i += 4)
+        {
+            auto p = _mm_load_ps(&r.phase[i]);
+
+            _mm_store_ps(&r.shape[i], _mm_sub_ps(two, _mm_mul_ps(four, p)));
+        }
+
+        // a table lookup, so a lane at a time
+        for (int i = 0; i < r.n; ++i)
+        {
+            r.shape[i] = lead->storage->lookup_waveshape_warp(wst_sine, r.shape[i]);
+        }
+
+        break;
+    }
+
+    case lt_tri:
+        for (int i = 0; i < padded; i += 4)
+        {
+            auto p = _mm_load_ps(&r.phase[i]);
+            auto folded = select(_mm_cmpgt_ps(p, half), _mm_sub_ps(one, p), p);
+
+            _mm_store_ps(&r.shape[i], _mm_add_ps(_mm_set1_ps(-1.f), _mm_mul_ps(four, folded)));
+        }
+
+        break;
+
+    case lt_ramp:
+        for (int i = 0; i < padded; i += 4)
+        {
+            auto p = _mm_load_ps(&r.phase[i]);
+
+            _mm_store_ps(&r.shape[i], _mm_sub_ps(one, _mm_mul_ps(two, p)));
+        }
+
+        break;
+
+    case lt_square:
+        for (int i = 0; i < padded; i += 4)
+        {
+            auto p = _mm_load_ps(&r.phase[i]);
+            auto edge = _mm_add_ps(half, _mm_mul_ps(half, _mm_load_ps(&r.deform[i])));
+
+            _mm_store_ps(&r.shape[i], select(_mm_cmpgt_ps(p, edge), _mm_set1_ps(-1.f), one));
+        }
+
+        return true;
+
+    case lt_envelope:
+        switch (deformType)
+        {
+        case type_1:
+            for (int i = 0; i < padded; i += 4)
+            {
+                auto d = _mm_load_ps(&r.deform[i]);
+
+                _mm_store_ps(&r.shape[i], _mm_add_ps(_mm_sub_ps(one, d),
+                                                     _mm_mul_ps(d, _mm_load_ps(&r.envVal[i]))));
+            }
+
+            return true;
+
+        case type_2:
+            // the power curve is a library call, so a lane at a time
+            for (int i = 0; i < r.n; ++i)
+            {
+                auto ev = r.envVal[i];
+                auto d = r.deform[i];
+
+                if (d > 0.f)
+                {
+                    r.shape[i] = std::pow(ev, 1.f + (9.0 * d));
+                }
+                else
+                {
+                    r.shape[i] = std::pow(ev, 1.f / (1.f + (4.0 * std::fabs(d))));
+                }
+
+                if (ev != 0.f)
+                {
+                    r.shape[i] /= ev;
+                }
+            }
+
+            return true;
+
+        default:
+            // the random deform draws from each LFO's own noise
+            return false;
+        }
+
+    default:
+        // noise, S&H and the step sequencer move their own history on as the phase wraps
+        return false;
+    }
+
+    switch (deformType)
+    {
+    case type_1:
+        for (int i = 0; i < padded; i += 4)
+        {
+            auto d = _mm_load_ps(&r.deform[i]);
+            auto a = _mm_mul_ps(half, _mm_max_ps(_mm_set1_ps(-3.f),
+                                                 _mm_min_ps(_mm_set1_ps(3.f), d)));
+            auto x = _mm_load_ps(&r.shape[i]);
+
+            // bend1, twice for extra pleasure
+            x = _mm_add_ps(_mm_sub_ps(x, _mm_mul_ps(_mm_mul_ps(a, x), x)), a);
+            x = _mm_add_ps(_mm_sub_ps(x, _mm_mul_ps(_mm_mul_ps(a, x), x)), a);
+
+            _mm_store_ps(&r.shape[i], x);
+        }
+
+        break;
+
+    case type_2:
+    {
+        // the bend itself is a sine of the value, so a lane at a time
+        for (int i = 0; i < r.n; ++i)
+        {
+            r.shape[i] = r.lfos[i]->bend2(r.shape[i]);
+        }
+
+        const auto flatFrom = _mm_set1_pd(-1 / 4.5), shift = _mm_set1_pd(1 / 4.5),
+                   spread = _mm_set1_pd(1.6), oned = _mm_set1_pd(1.0);
+
+        for (int i = 0; i < padded; i += 4)
+        {
+            // below -1/4.5 the bend overshoots, so it is scaled back down
+            auto x = inDouble(
+                [&](__m128d xd, __m128d dd) {
+                    auto keep = _mm_cmpge_pd(dd, flatFrom);
+                    auto div = _mm_sub_pd(oned, _mm_div_pd(_mm_add_pd(dd, shift), spread));
+
+                    return _mm_or_pd(_mm_and_pd(keep, xd),
+                                     _mm_andnot_pd(keep, _mm_div_pd(xd, div)));
+                },
+                _mm_load_ps(&r.shape[i]), _mm_load_ps(&r.deform[i]));
+
+            _mm_store_ps(&r.shape[i], x);
+        }
+
+        break;
+    }
+
+    case type_3:
+    {
+        for (int i = 0; i < r.n; ++i)
+        {
+            r.shape[i] = r.lfos[i]->bend3(r.shape[i]);
+        }
+
+        const auto halfd = _mm_set1_pd(0.5), tilt = _mm_set1_pd(0.06), oned = _mm_set1_pd(1.0);
+        const auto signBit = _mm_set1_ps(-0.f);
+
+        for (int i = 0; i < padded; i += 4)
+        {
+            auto d = _mm_load_ps(&r.deform[i]);
+
+            auto x = inDouble(
+                [&](__m128d xd, __m128d dd, __m128d absd) {
+                    auto squash = _mm_add_pd(oned, _mm_mul_pd(halfd, absd));
+
+                    return _mm_sub_pd(_mm_div_pd(xd, squash), _mm_mul_pd(tilt, dd));
+                },
+                _mm_load_ps(&r.shape[i]), d, _mm_andnot_ps(signBit, d));
+
+            _mm_store_ps(&r.shape[i], x);
+        }
+
+        break;
+    }
+    }
+
+    return true;
+}
+
+void VoiceLFOBank::evaluateOutputs(Row &r, int padded)
+{
+    auto lfo = r.lfos[0]->lfo;
+    bool constantEnvelope = lfo->delay.deactivated;
+    bool unipolar = lfo->unipolar.val.b;
+    bool scaled = lfo->lfoExtraAmplitude == LFOStorage::SCALED;
+    bool envelope = lfo->shape.val.i == lt_envelope;
+
+    const auto zero = _mm_setzero_ps(), one = _mm_set1_ps(1.f), half = _mm_set1_ps(0.5f);
+
+    for (int i = 0; i < padded; i += 4)
+    {
+        auto io = _mm_load_ps(&r.shape[i]);
+        auto magnf = _mm_load_ps(&r.magnitude[i]);
+        auto useenvval = constantEnvelope ? one : _mm_load_ps(&r.envVal[i]);
+
+        if (unipolar)
+        {
+            io = _mm_add_ps(half, _mm_mul_ps(half, io));
+        }
+
+        // as in process_block, with nothing to correct for a start from zero
+        auto o0 = _mm_mul_ps(_mm_mul_ps(_mm_add_ps(useenvval, zero), magnf), io);
+        auto o1 = io;
+        auto o2 = _mm_add_ps(useenvval, zero);
+
+        if (scaled)
+        {
+            o1 = _mm_mul_ps(o1, magnf);
+            o2 = _mm_mul_ps(o2, magnf);
+        }
+
+        if (envelope)
+        {
+            o1 = _mm_add_ps(_mm_mul_ps(o1, useenvval), zero);
+        }
+
+        _mm_store_ps(&r.output[0][i], o0);
+        _mm_store_ps(&r.output[1][i], o1);
+        _mm_store_ps(&r.output[2][i], o2);
+    }
+}
+
+void VoiceLFOBank::scatter(Row &r, bool withOutputs)
+{
+    for (int i = 0; i < r.n; ++i)
+    {
+        auto l = r.lfos[i];
+
+        l->phase = r.phase[i];
+        l->batchedWrap = r.wrapped[i] != 0.f;
+
+        if (l->batchedWrap)
+        {
+            l->unwrappedphase_intpart++;
+        }
+
+        l->env_state = (int)r.envState[i];
+        l->env_phase = r.envPhase[i];
+        l->env_val = r.envVal[i];
+
+        if (withOutputs && r.complete[i] != 0.f)
+        {
+            l->iout = r.shape[i];
+
+            for (int o = 0; o < 3; ++o)
+            {
+                l->output_multi[o] = r.output[o][i];
+            }
+
+            l->bankOutputs = &r.output[0][i];
+            l->batched = LFOModulationSource::batched_outputs;
+        }
+        else
+        {
+            l->bankOutputs = nullptr;
+            l->batched = LFOModulationSource::batched_envelope;
+        }
+    }
+}
@@ -0,0 +1,100 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+
+#ifndef SURGE_SRC_COMMON_DSP_MODULATORS_VOICELFOBANK_H
+#define SURGE_SRC_COMMON_DSP_MODULATORS_VOICELFOBANK_H
+
+#include "LFOModulationSource.h"
+
+/*
+ * The voice LFOs of a scene, laid out as one row per LFO slot with a lane per voice, so the
+ * per-block work of LFO N runs four voices at a time instead of one LFO at a time. Before a
+ * scene's voices render, the synth adds every voice LFO which calc_ctrldata is about to process
+ * and calls process. All the voices in a row share their LFOStorage, so the shape and deform
+ * switches are taken once per row and only the values differ between lanes.
+ *
+ * Each row advances and wraps the phase and runs the envelope stages for every lane. For the
+ * sine, triangle, ramp, square and (first two deforms of the) envelope shapes it then goes on
+ * to the shape and the three outputs, which SurgeVoice::applyModulationToLocalcopy reads from
+ * the row through outputsFromBank. The trig of the second and third deforms and the envelope
+ * power curve still go through the scalar library calls, one lane at a time. Noise, S&H, step
+ * sequencer lanes, lanes which retrigger from their last value, and lanes whose phase lands
+ * out of range stop after the envelope, and their process_block finishes the block.
+ * MSEG and formula LFOs are left out altogether.
+ *
+ * The lanes repeat the scalar arithmetic step for step, so the results are the ones the scalar
+ * path gives, to the bit unless the compiler fuses multiplies and adds in the scalar code.
+ */
+class VoiceLFOBank
+{
+  public:
+    // the distance between one output of a lane and its next output
+    static constexpr int outputStride{MAX_VOICES};
+
+    void clear()
+    {
+        for (auto &r : rows)
+            r.n = 0;
+    }
+    void add(int slot, LFOModulationSource *l)
+    {
+        assert(slot >= 0 && slot < n_lfos_voice && rows[slot].n < MAX_VOICES);
+        rows[slot].lfos[rows[slot].n++] = l;
+    }
+    int size() const
+    {
+        int res = 0;
+        for (auto &r : rows)
+            res += r.n;
+        return res;
+    }
+
+    void process();
+
+  private:
+    struct Row
+    {
+        int n{0};
+        LFOModulationSource *lfos[MAX_VOICES];
+
+        float phase alignas(16)[MAX_VOICES], increment alignas(16)[MAX_VOICES];
+        float wrapped alignas(16)[MAX_VOICES], fraction alignas(16)[MAX_VOICES];
+        float envState alignas(16)[MAX_VOICES], envPhase alignas(16)[MAX_VOICES];
+        float envVal alignas(16)[MAX_VOICES], envRate alignas(16)[MAX_VOICES];
+        float sustain alignas(16)[MAX_VOICES], releaseStart alignas(16)[MAX_VOICES];
+        float deform alignas(16)[MAX_VOICES], magnitude alignas(16)[MAX_VOICES];
+        float complete alignas(16)[MAX_VOICES], shape alignas(16)[MAX_VOICES];
+        float output alignas(16)[3][outputStride];
+    };
+
+    void gather(Row &r, int padded);
+    void advancePhases(Row &r, int padded);
+    void advanceEnvelopes(Row &r, int padded);
+    bool evaluateShapes(Row &r, int padded);
+    void evaluateOutputs(Row &r, int padded);
+    void scatter(Row &r, bool withOutputs);
+
+    Row rows[n_lfos_voice];
+};
+
+#endif // SURGE_SRC_COMMON_DSP_MODULATORS_VOICELFOBANK_H
@@ -22,6 +22,7 @@
 
 #include "ClassicOscillator.h"
 #include "DSPUtils.h"
+#include "OscillatorKernels.h"
 
 #include "sst/basic-blocks/mechanics/block-ops.h"
 #include "sst/basic-blocks/mechanics/simd-ops.h"
@@ -383,10 +384,7 @@ template <bool FM> void ClassicOscillator::convolute(int voice, bool stereo)
     */
     unsigned int m = ((ipos >> 16) & 0xff) * (FIRipol_N << 1);
     unsigned int lipolui16 = (ipos & 0xffff);
-    __m128 lipol128 = _mm_cvtsi32_ss(lipol128, lipolui16);
-    lipol128 = _mm_shuffle_ps(lipol128, lipol128, _MM_SHUFFLE(0, 0, 0, 0));
 
-    int k;
     const float s = 0.99952f;
     float sync = min((float)l_sync.v, (12 + 72 + 72) - pitch);
     float t;
@@ -492,51 +490,21 @@ template <bool FM> void ClassicOscillator::convolute(int voice, bool stereo)
         g *= panL[voice];
     }
 
+    /*
+    ** Convolve g with the sinc window and add it onto the buffer. The kernel is chosen
+    ** per CPU at startup; see OscillatorKernels.h.
+    */
+    const auto &kernels = Surge::Oscillator::Kernels::active();
+
     if (stereo)
     {
-        __m128 g128L = _mm_load_ss(&g);
-        g128L = _mm_shuffle_ps(g128L, g128L, _MM_SHUFFLE(0, 0, 0, 0));
-        __m128 g128R = _mm_load_ss(&gR);
-        g128R = _mm_shuffle_ps(g128R, g128R, _MM_SHUFFLE(0, 0, 0, 0));
-
-        for (k = 0; k < FIRipol_N; k += 4)
-        {
-            float *obfL = &oscbuffer[bufpos + k + delay];
-            float *obfR = &oscbufferR[bufpos + k + delay];
-            __m128 obL = _mm_loadu_ps(obfL);
-            __m128 obR = _mm_loadu_ps(obfR);
-            __m128 st = _mm_load_ps(&storage->sinctable[m + k]);
-            __m128 so = _mm_load_ps(&storage->sinctable[m + k + FIRipol_N]);
-            so = _mm_mul_ps(so, lipol128);
-            st = _mm_add_ps(st, so);
-            obL = _mm_add_ps(obL, _mm_mul_ps(st, g128L));
-            _mm_storeu_ps(obfL, obL);
-            obR = _mm_add_ps(obR, _mm_mul_ps(st, g128R));
-            _mm_storeu_ps(obfR, obR);
-        }
+        kernels.blitStereo(&oscbuffer[bufpos + delay], &oscbufferR[bufpos + delay],
+                           &storage->sinctable[m], (float)lipolui16, g, gR);
     }
     else
     {
-        /*
-        ** This is SSE for the convolution described above
-        */
-        __m128 g128 = _mm_load_ss(&g);
-        g128 = _mm_shuffle_ps(g128, g128, _MM_SHUFFLE(0, 0, 0, 0));
-
-        for (k = 0; k < FIRipol_N; k += 4)
-        {
-            float *obf = &oscbuffer[bufpos + k + delay]; // Get buffer[pos + delay + k ]
-            __m128 ob = _mm_loadu_ps(obf);
-            __m128 st = _mm_load_ps(
-                &storage->sinctable[m + k]); // get the sinctable for our fractional position
-            __m128 so =
-                _mm_load_ps(&storage->sinctable[m + k + FIRipol_N]); // get the sinctable deriv
-            so = _mm_mul_ps(so, lipol128); // scale the deriv by the lipol fractional time
-            st = _mm_add_ps(st, so);       // this is now st = sinctable + dt * dsinctable
-            st = _mm_mul_ps(st, g128);     // so this is now the convolved difference, g * kernel
-            ob = _mm_add_ps(ob, st);       // which we add back onto the buffer
-            _mm_storeu_ps(obf, ob);        // and store.
-        }
+        kernels.blitMono(&oscbuffer[bufpos + delay], &storage->sinctable[m], (float)lipolui16,
+                         g);
     }
 
     float olddc = dc_uni[voice];
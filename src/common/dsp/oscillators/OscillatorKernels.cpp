@@ -0,0 +1,93 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+#include "OscillatorKernels.h"
+#include "CPUFeatures.h"
+#include "SurgeStorage.h"
+
+static_assert(FIRipol_N % 4 == 0, "The SSE2 BLIT kernels step four taps at a time");
+
+namespace Surge
+{
+namespace Oscillator
+{
+namespace Kernels
+{
+static void blitMonoSSE2(float *buffer, const float *sinc, float lipol, float g)
+{
+    const auto lipol128 = _mm_set1_ps(lipol);
+    const auto g128 = _mm_set1_ps(g);
+
+    for (int k = 0; k < FIRipol_N; k += 4)
+    {
+        auto ob = _mm_loadu_ps(buffer + k);
+        auto st = _mm_load_ps(sinc + k);
+        auto so = _mm_mul_ps(_mm_load_ps(sinc + k + FIRipol_N), lipol128);
+        st = _mm_add_ps(st, so); // sinctable + dt * dsinctable at our fractional position
+        ob = _mm_add_ps(ob, _mm_mul_ps(st, g128));
+        _mm_storeu_ps(buffer + k, ob);
+    }
+}
+
+static void blitStereoSSE2(float *bufferL, float *bufferR, const float *sinc, float lipol,
+                           float gL, float gR)
+{
+    const auto lipol128 = _mm_set1_ps(lipol);
+    const auto g128L = _mm_set1_ps(gL);
+    const auto g128R = _mm_set1_ps(gR);
+
+    for (int k = 0; k < FIRipol_N; k += 4)
+    {
+        auto obL = _mm_loadu_ps(bufferL + k);
+        auto obR = _mm_loadu_ps(bufferR + k);
+        auto st = _mm_load_ps(sinc + k);
+        auto so = _mm_mul_ps(_mm_load_ps(sinc + k + FIRipol_N), lipol128);
+        st = _mm_add_ps(st, so);
+        obL = _mm_add_ps(obL, _mm_mul_ps(st, g128L));
+        _mm_storeu_ps(bufferL + k, obL);
+        obR = _mm_add_ps(obR, _mm_mul_ps(st, g128R));
+        _mm_storeu_ps(bufferR + k, obR);
+    }
+}
+
+const Table &sse2()
+{
+    static const Table t{"SSE2", blitMonoSSE2, blitStereoSSE2};
+    return t;
+}
+
+const Table *avx2()
+{
+    static const Table t{"AVX2", detail::blitMonoAVX2, detail::blitStereoAVX2};
+    static const bool usable = detail::avx2Compiled() && Surge::CPUFeatures::cpuSupportsAVX2();
+
+    return usable ? &t : nullptr;
+}
+
+const Table &active()
+{
+    static const Table &t = avx2() && Surge::CPUFeatures::avx2Allowed() ? *avx2() : sse2();
+    return t;
+}
+} // namespace Kernels
+} // namespace Oscillator
+} // namespace Surge
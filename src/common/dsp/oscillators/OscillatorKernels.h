@@ -0,0 +1,83 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+#ifndef SURGE_SRC_COMMON_DSP_OSCILLATORS_OSCILLATORKERNELS_H
+#define SURGE_SRC_COMMON_DSP_OSCILLATORS_OSCILLATORKERNELS_H
+
+/*
+ * The BLIT oscillators (Classic, Wavetable, S&H) spend most of their time convolving
+ * each impulse with the FIRipol_N tap windowed sinc and its time derivative. That kernel
+ * is built once per ISA level and picked at startup, so a baseline SSE2 binary still uses
+ * AVX2 on machines which have it (unless SURGE_SIMD_LEVEL=sse2, see CPUFeatures.h). ARM
+ * gets the SSE2 kernel through simde, which maps it onto NEON.
+ *
+ * Both kernels compute, for k in [0, FIRipol_N)
+ *
+ *   buffer[k] += (sinc[k] + lipol * sinc[k + FIRipol_N]) * g
+ *
+ * where sinc points at the sinctable row for the current fractional position and lipol is
+ * the 16 bit sub-position (the derivative row is pre-scaled by 1/65536). Both round each
+ * multiply and add separately, so they produce the same bits.
+ */
+
+namespace Surge
+{
+namespace Oscillator
+{
+namespace Kernels
+{
+typedef void (*BLITMonoFn)(float *buffer, const float *sinc, float lipol, float g);
+typedef void (*BLITStereoFn)(float *bufferL, float *bufferR, const float *sinc, float lipol,
+                             float gL, float gR);
+
+struct Table
+{
+    const char *name;
+    BLITMonoFn blitMono;
+    BLITStereoFn blitStereo;
+};
+
+/*
+ * The table chosen for this CPU. Resolved once on first use; the returned reference
+ * is stable for the life of the process.
+ */
+const Table &active();
+
+/*
+ * The individual tables, mostly for the tests. sse2() is always available; avx2()
+ * returns nullptr if the build or the CPU can't run it, whatever SURGE_SIMD_LEVEL says.
+ */
+const Table &sse2();
+const Table *avx2();
+
+namespace detail
+{
+bool avx2Compiled();
+void blitMonoAVX2(float *buffer, const float *sinc, float lipol, float g);
+void blitStereoAVX2(float *bufferL, float *bufferR, const float *sinc, float lipol, float gL,
+                    float gR);
+} // namespace detail
+} // namespace Kernels
+} // namespace Oscillator
+} // namespace Surge
+
+#endif // SURGE_SRC_COMMON_DSP_OSCILLATORS_OSCILLATORKERNELS_H
@@ -22,6 +22,7 @@
 
 #include "TwistOscillator.h"
 #include "DebugHelpers.h"
+#include "SurgeMemoryPools.h"
 
 #define TEST
 #ifndef _MSC_VER
@@ -32,8 +33,6 @@
 #endif
 #include "plaits/dsp/voice.h"
 
-#include "samplerate.h"
-
 std::string twist_engine_name(int i)
 {
     switch (i)
@@ -278,36 +277,33 @@ static struct EngineDynamicDeact : public ParameterDynamicDeactivationFunction
     }
 } etDynamicDeact;
 
-TwistOscillator::TwistOscillator(SurgeStorage *storage, OscillatorStorage *oscdata,
-                                 pdata *localcopy)
-    : Oscillator(storage, oscdata, localcopy), charFilt(storage)
+TwistVoiceState::TwistVoiceState(SurgeStorage *storage)
+    : lancRes(48000, storage->dsamplerate_os)
 {
-#if SAMPLERATE_LANCZOS
-    lancRes = std::make_unique<sst::basic_blocks::dsp::LanczosResampler<BLOCK_SIZE>>(
-        48000, storage->dsamplerate_os);
-    srcstate = nullptr;
-#else
-    int error;
-    srcstate = src_new(SRC_SINC_FASTEST, 2, &error);
-    // srcstate = src_new(SRC_LINEAR, 2, &error);
-    if (error != 0)
-    {
-        srcstate = nullptr;
-    }
-#endif
     voice = std::make_unique<plaits::Voice>();
-    shared_buffer = new char[16384];
-    alloc = std::make_unique<stmlib::BufferAllocator>(shared_buffer, 16384);
+    alloc = std::make_unique<stmlib::BufferAllocator>(shared_buffer, sizeof(shared_buffer));
     patch = std::make_unique<plaits::Patch>();
     mod = std::make_unique<plaits::Modulations>();
+}
 
-    // FM downsampling with a linear interpolator is absolutely fine
-    int error;
-    fmdownsamplestate = src_new(SRC_LINEAR, 1, &error);
-    if (error != 0)
-    {
-        fmdownsamplestate = nullptr;
-    }
+TwistVoiceState::~TwistVoiceState() = default;
+
+void TwistVoiceState::reset(SurgeStorage *storage)
+{
+    // the engine takes its buffers from the allocator in Init, so hand it the whole buffer again
+    alloc->Init(shared_buffer, sizeof(shared_buffer));
+
+    // the sample rate may have changed while we sat in the pool. this just sets up members,
+    // so rebuilding in place doesn't allocate
+    using resampler_t = sst::basic_blocks::dsp::LanczosResampler<BLOCK_SIZE>;
+    lancRes.~resampler_t();
+    new (&lancRes) resampler_t(48000, storage->dsamplerate_os);
+}
+
+TwistOscillator::TwistOscillator(SurgeStorage *storage, OscillatorStorage *oscdata,
+                                 pdata *localcopy)
+    : Oscillator(storage, oscdata, localcopy), charFilt(storage)
+{
 }
 
 float TwistOscillator::tuningAwarePitch(float pitch)
@@ -330,13 +326,22 @@ float TwistOscillator::tuningAwarePitch(float pitch)
 
 void TwistOscillator::init(float pitch, bool is_display, bool nonzero_drift)
 {
-    voice->Init(alloc.get());
+    // like the string delay lines, the display makes its own rather than race the audio thread
+    if (!state)
+    {
+        ownState = is_display;
+        state = ownState ? new TwistVoiceState(storage)
+                         : storage->memoryPools->twistVoiceStates.getItem(storage);
+    }
+    state->reset(storage);
+
+    state->voice->Init(state->alloc.get());
 
     charFilt.init(storage->getPatch().character.val.i);
 
     float tpitch = tuningAwarePitch(pitch);
-    memset((void *)patch.get(), 0, sizeof(plaits::Patch));
-    memset((void *)mod.get(), 0, sizeof(plaits::Modulations));
+    memset((void *)state->patch.get(), 0, sizeof(plaits::Patch));
+    memset((void *)state->mod.get(), 0, sizeof(plaits::Modulations));
 
     driftLFO.init(nonzero_drift);
 
@@ -355,32 +360,30 @@ void TwistOscillator::init(float pitch, bool is_display, bool nonzero_drift)
     memset(fmlagbuffer, 0, (BLOCK_SIZE_OS << 1) * sizeof(float));
     fmrp = 0;
     fmwp = (int)(BLOCK_SIZE_OS * 48000 * storage->dsamplerate_os_inv);
+    fmPos = 0;
+    fmLast = 0;
 
     process_block_internal<false, true>(pitch, 0, false, 0, std::ceil(cycleInSamples));
 }
 TwistOscillator::~TwistOscillator()
 {
-    if (shared_buffer)
-        delete[] shared_buffer;
-
-    if (srcstate)
-        srcstate = src_delete(srcstate);
+    if (!state)
+        return;
 
-    if (fmdownsamplestate)
-        fmdownsamplestate = src_delete(fmdownsamplestate);
+    if (ownState)
+        delete state;
+    else
+        storage->memoryPools->twistVoiceStates.returnItem(state);
 }
 
 template <bool FM, bool throwaway>
 void TwistOscillator::process_block_internal(float pitch, float drift, bool stereo, float FMdepth,
                                              int throwawayBlocks)
 {
-#if SAMPLERATE_SRC
-    if (!srcstate)
-        return;
-#endif
-
-    if (FM && !fmdownsamplestate)
-        return;
+    auto &voice = state->voice;
+    auto &patch = state->patch;
+    auto &mod = state->mod;
+    auto &lancRes = state->lancRes;
 
     pitch = tuningAwarePitch(pitch);
 
@@ -408,64 +411,43 @@ void TwistOscillator::process_block_internal(float pitch, float drift, bool ster
     // This setting allows us to correct it in VCV Rack.
     if (lpgIsOn && useCorrectLPGBlockSize)
         subblock = 12;
-#if SAMPLERATE_SRC
-    float src_in[subblock][2];
-    float src_out[BLOCK_SIZE_OS][2];
-
-    SRC_DATA sdata;
-    sdata.end_of_input = 0;
-    sdata.src_ratio = dsamplerate_os / 48000.0;
-#endif
-
     float normFMdepth = 0;
 
     if (FM)
     {
-        float dsmaster[BLOCK_SIZE_OS << 2];
-        SRC_DATA fmdata;
-        fmdata.end_of_input = 0;
-        fmdata.src_ratio = 48000.0 / storage->dsamplerate_os; // going INTO the plaits rate
-        fmdata.data_in = master_osc;
-        fmdata.data_out = &(dsmaster[0]);
-        fmdata.input_frames = BLOCK_SIZE_OS;
-        fmdata.output_frames = BLOCK_SIZE_OS << 2;
-        src_process(fmdownsamplestate, &fmdata);
-
         const float bl = -143.5, bhi = 71.7, oos = 1.0 / (bhi - bl);
         float adb = limit_range(amp_to_db(FMdepth), bl, bhi);
         float nfm = (adb - bl) * oos;
 
         normFMdepth = limit_range(nfm, 0.f, 1.f);
 
-        for (int i = 0; i < fmdata.output_frames_gen; ++i)
+        /*
+         * Linearly interpolate the FM source down to the plaits rate, which is absolutely fine
+         * for FM. fmPos counts input samples into this block, where -1 is the last sample of
+         * the previous block.
+         */
+        const double fmStep = storage->dsamplerate_os / 48000.0;
+
+        while (fmPos < BLOCK_SIZE_OS - 1)
         {
-            fmlagbuffer[fmwp] = dsmaster[i];
+            int idx = (int)std::floor(fmPos);
+            float frac = (float)(fmPos - idx);
+            float a = idx < 0 ? fmLast : master_osc[idx];
+            float b = master_osc[idx + 1];
+
+            fmlagbuffer[fmwp] = a + (b - a) * frac;
             fmwp = (fmwp + 1) & ((BLOCK_SIZE_OS << 1) - 1);
+            fmPos += fmStep;
         }
+
+        fmPos -= BLOCK_SIZE_OS;
+        fmLast = master_osc[BLOCK_SIZE_OS - 1];
     }
 
     int required_blocks = throwaway ? throwawayBlocks : BLOCK_SIZE_OS;
 
-#if SAMPLERATE_SRC
-    for (int i = 0; i < carrover_size; ++i)
-    {
-        if (oscdata->p[twist_aux_mix].extend_range)
-        {
-            output[i] = auxmix.v * carryover[i][1] + (1.0 - auxmix.v) * carryover[i][0];
-            outputR[i] = auxmix.v * carryover[i][0] + (1.0 - auxmix.v) * carryover[i][1];
-        }
-        else
-        {
-            output[i] = auxmix.v * carryover[i][1] + (1.0 - auxmix.v) * carryover[i][0];
-            outputR[i] = output[i];
-        }
-    }
-    int total_generated = carrover_size;
-    carrover_size = 0;
-#else
     int total_generated =
-        required_blocks - lancRes->inputsRequiredToGenerateOutputs(required_blocks);
-#endif
+        required_blocks - lancRes.inputsRequiredToGenerateOutputs(required_blocks);
 
     if (lpgIsOn)
     {
@@ -487,9 +469,6 @@ void TwistOscillator::process_block_internal(float pitch, float drift, bool ster
         morph.process();
         lpgdec.process();
         lpgcol.process();
-#if SAMPLERATE_SRC
-        auxmix.process();
-#endif
 
         if (FM)
         {
@@ -506,69 +485,22 @@ void TwistOscillator::process_block_internal(float pitch, float drift, bool ster
 
         voice->Render(*patch, *mod, poutput, subblock);
 
-#if SAMPLERATE_LANCZOS
         for (int i = 0; i < subblock; ++i)
         {
-            lancRes->push(poutput[i].out / 32768.f, poutput[i].aux / 32768.f);
+            lancRes.push(poutput[i].out / 32768.f, poutput[i].aux / 32768.f);
         }
         total_generated =
-            required_blocks - lancRes->inputsRequiredToGenerateOutputs(required_blocks);
-#else
-        for (int i = 0; i < subblock; ++i)
-        {
-            src_in[i][0] = poutput[i].out / 32768.f;
-            src_in[i][1] = poutput[i].aux / 32768.f;
-        }
-        sdata.data_in = &(src_in[0][0]);
-        sdata.data_out = &(src_out[0][0]);
-        sdata.input_frames = subblock;
-        sdata.output_frames = BLOCK_SIZE_OS;
-        auto res = src_process(srcstate, &sdata);
-        // FIXME - check res
-
-        for (int i = 0; i < sdata.output_frames_gen; ++i)
-        {
-            if (i + total_generated >= required_blocks)
-            {
-                carryover[carrover_size][0] = src_out[i][0];
-                carryover[carrover_size][1] = src_out[i][1];
-                carrover_size++;
-            }
-            else if (!throwaway)
-            {
-                if (oscdata->p[twist_aux_mix].extend_range)
-                {
-                    output[total_generated + i] =
-                        auxmix.v * src_out[i][1] + (1 - auxmix.v) * src_out[i][0];
-                    outputR[total_generated + i] =
-                        auxmix.v * src_out[i][0] + (1 - auxmix.v) * src_out[i][1];
-                }
-                else
-                {
-                    output[total_generated + i] =
-                        auxmix.v * src_out[i][1] + (1 - auxmix.v) * src_out[i][0];
-                    outputR[total_generated + i] = output[total_generated + i];
-                }
-            }
-        }
-        total_generated += sdata.output_frames_gen;
-        if (sdata.input_frames_used != subblock)
-        {
-            // FIXME
-            std::cout << "DEAL " << std::endl;
-        }
-#endif
+            required_blocks - lancRes.inputsRequiredToGenerateOutputs(required_blocks);
     }
 
-#if SAMPLERATE_LANCZOS
     if (throwaway)
     {
-        lancRes->advanceReadPointer(required_blocks);
+        lancRes.advanceReadPointer(required_blocks);
     }
     else
     {
         float tL[BLOCK_SIZE_OS], tR[BLOCK_SIZE_OS];
-        lancRes->populateNextBlockSizeOS(tL, tR);
+        lancRes.populateNextBlockSizeOS(tL, tR);
 
         for (int i = 0; i < BLOCK_SIZE_OS; ++i)
         {
@@ -585,8 +517,7 @@ void TwistOscillator::process_block_internal(float pitch, float drift, bool ster
             auxmix.process();
         }
     }
-    lancRes->renormalizePhases();
-#endif
+    lancRes.renormalizePhases();
 
     if (!throwaway && charFilt.doFilter)
     {
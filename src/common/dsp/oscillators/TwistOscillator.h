@@ -20,23 +20,17 @@
  * https://github.com/surge-synthesizer/surge
  */
 
-/*
- * What's our samplerate strategy
- */
-#include "globals.h"
-#define SAMPLERATE_SRC 0
-#define SAMPLERATE_LANCZOS 1
+#ifndef SURGE_SRC_COMMON_DSP_OSCILLATORS_TWISTOSCILLATOR_H
+#define SURGE_SRC_COMMON_DSP_OSCILLATORS_TWISTOSCILLATOR_H
 
+#include "globals.h"
 #include "OscillatorBase.h"
 #include <memory>
 #include "basic_dsp.h"
 #include "DSPUtils.h"
 #include "OscillatorCommonFunctions.h"
 
-#if SAMPLERATE_LANCZOS
-// #include "LanczosResampler.h"
 #include "sst/basic-blocks/dsp/LanczosResampler.h"
-#endif
 
 namespace plaits
 {
@@ -50,7 +44,26 @@ namespace stmlib
 class BufferAllocator;
 }
 
-struct SRC_STATE_tag;
+/*
+ * The plaits engine and the Lanczos resampler (whose kernel table is shared by every instance)
+ * from the fixed plaits rate for one voice. These are large, so voices take them from
+ * SurgeMemoryPools::twistVoiceStates rather than allocating as they spawn.
+ */
+struct TwistVoiceState
+{
+    explicit TwistVoiceState(SurgeStorage *storage);
+    ~TwistVoiceState();
+
+    // ready for a new voice, at the current sample rate
+    void reset(SurgeStorage *storage);
+
+    std::unique_ptr<plaits::Voice> voice;
+    std::unique_ptr<plaits::Patch> patch;
+    std::unique_ptr<plaits::Modulations> mod;
+    std::unique_ptr<stmlib::BufferAllocator> alloc;
+    alignas(16) char shared_buffer[16384];
+    sst::basic_blocks::dsp::LanczosResampler<BLOCK_SIZE> lancRes;
+};
 
 class TwistOscillator : public Oscillator
 {
@@ -88,28 +101,20 @@ class TwistOscillator : public Oscillator
         return clamp01((localcopy[oscdata->p[ps].param_id_in_scene].f + 1) * 0.5f);
     }
 
-    std::unique_ptr<plaits::Voice> voice;
-    std::unique_ptr<plaits::Patch> patch;
-    std::unique_ptr<plaits::Modulations> mod;
-    std::unique_ptr<stmlib::BufferAllocator> alloc;
-    char *shared_buffer{nullptr};
+    TwistVoiceState *state{nullptr};
+    bool ownState{false}; // display oscillators don't use the pool
 
-    // Keep this here for now even if using lanczos since I'm using SRC for FM still
-    SRC_STATE_tag *srcstate, *fmdownsamplestate;
     float fmlagbuffer[BLOCK_SIZE_OS << 1];
     int fmwp, fmrp;
+    double fmPos{0};
+    float fmLast{0};
 
     bool useCorrectLPGBlockSize{false}; // See #6760
 
-#if SAMPLERATE_LANCZOS
-    std::unique_ptr<sst::basic_blocks::dsp::LanczosResampler<BLOCK_SIZE>> lancRes;
-#endif
-
-    float carryover[BLOCK_SIZE_OS][2];
-    int carrover_size = 0;
-
     lag<float, true> harm, timb, morph, lpgcol, lpgdec, auxmix;
 
     Surge::Oscillator::DriftLFO driftLFO;
     Surge::Oscillator::CharacterFilter<float> charFilt;
 };
+
+#endif // SURGE_SRC_COMMON_DSP_OSCILLATORS_TWISTOSCILLATOR_H
@@ -0,0 +1,107 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+#include "CPUFeatures.h"
+
+#include <cstdlib>
+#include <cstring>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
+
+namespace Surge
+{
+namespace CPUFeatures
+{
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+static bool msvcHasAVX()
+{
+    int info[4];
+    __cpuid(info, 1);
+
+    const bool osxsave = info[2] & (1 << 27);
+    const bool avx = info[2] & (1 << 28);
+
+    // the OS also has to save the upper ymm halves across context switches
+    return osxsave && avx && (_xgetbv(0) & 0x6) == 0x6;
+}
+#endif
+
+bool cpuSupportsAVX2()
+{
+#if defined(__x86_64__) || defined(__i386__)
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    int info[4];
+    __cpuid(info, 0);
+
+    if (info[0] < 7 || !msvcHasAVX())
+    {
+        return false;
+    }
+
+    __cpuidex(info, 7, 0);
+
+    return info[1] & (1 << 5);
+#else
+    return false;
+#endif
+}
+
+bool cpuSupportsFMA()
+{
+#if defined(__x86_64__) || defined(__i386__)
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("fma");
+#else
+    return false;
+#endif
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    int info[4];
+    __cpuid(info, 1);
+
+    return (info[2] & (1 << 12)) && msvcHasAVX();
+#else
+    return false;
+#endif
+}
+
+bool avx2Allowed()
+{
+    auto *level = getenv("SURGE_SIMD_LEVEL");
+
+    return !(level && strcmp(level, "sse2") == 0);
+}
+
+bool useAVX2()
+{
+    static const bool use = cpuSupportsAVX2() && avx2Allowed();
+    return use;
+}
+} // namespace CPUFeatures
+} // namespace Surge
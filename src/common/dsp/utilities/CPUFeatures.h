@@ -0,0 +1,48 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+#ifndef SURGE_SRC_COMMON_DSP_UTILITIES_CPUFEATURES_H
+#define SURGE_SRC_COMMON_DSP_UTILITIES_CPUFEATURES_H
+
+/*
+ * Surge is built for an SSE2 baseline, which simde maps onto NEON on ARM. A few hot loops
+ * also carry an AVX2 version, compiled per function rather than per file, and pick it once
+ * at startup by asking here. Setting SURGE_SIMD_LEVEL=sse2 in the environment keeps every
+ * one of them on the baseline, which is handy for comparing renders across machines.
+ */
+
+namespace Surge
+{
+namespace CPUFeatures
+{
+// what the CPU (and the OS, for the upper ymm halves) can do, regardless of the override
+bool cpuSupportsAVX2();
+bool cpuSupportsFMA();
+
+// false if SURGE_SIMD_LEVEL asks for the baseline
+bool avx2Allowed();
+
+// cpuSupportsAVX2() && avx2Allowed(), resolved once
+bool useAVX2();
+} // namespace CPUFeatures
+} // namespace Surge
+
+#endif // SURGE_SRC_COMMON_DSP_UTILITIES_CPUFEATURES_H
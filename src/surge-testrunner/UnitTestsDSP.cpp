@@ -21,6 +21,7 @@
  */
 #include <iostream>
 #include <algorithm>
+#include <cstring>
 
 #include "HeadlessUtils.h"
 #include "Player.h"
@@ -32,6 +33,8 @@
 #include "samplerate.h"
 
 #include "SSEComplex.h"
+#include "OscillatorKernels.h"
+#include "SurgeMemoryPools.h"
 #include <complex>
 #include "sst/basic-blocks/mechanics/simd-ops.h"
 
@@ -818,4 +821,109 @@ TEST_CASE("Oscillator Onset", "[dsp]") // See issue 7570
                       << std::endl;*/
         }
     }
-}
\ No newline at end of file
+}
+
+TEST_CASE("Oscillator BLIT Kernels Agree", "[dsp]")
+{
+    namespace K = Surge::Oscillator::Kernels;
+
+    auto surge = Surge::Headless::createSurge(44100);
+    REQUIRE(surge);
+
+    std::vector<const K::Table *> tables{&K::sse2()};
+    if (K::avx2())
+        tables.push_back(K::avx2());
+
+    INFO("Active kernels are " << K::active().name);
+    REQUIRE((&K::active() == &K::sse2() || &K::active() == K::avx2()));
+
+    constexpr int bufsize = 64;
+
+    auto render = [&](const K::Table *t, float *out, float *outR, float *ref, float *refR) {
+        srand(7234);
+        for (int i = 0; i < 500; ++i)
+        {
+            auto pos = rand() % (bufsize - FIRipol_N);
+            auto m = (rand() & 0xff) * (FIRipol_N << 1);
+            auto lipol = (float)(rand() & 0xffff);
+            auto g = 2.f * rand() / RAND_MAX - 1.f;
+            auto gR = 2.f * rand() / RAND_MAX - 1.f;
+            auto *sinc = &surge->storage.sinctable[m];
+
+            bool stereo = i & 1;
+
+            for (int k = 0; k < FIRipol_N; ++k)
+            {
+                auto w = sinc[k] + lipol * sinc[k + FIRipol_N];
+                ref[pos + k] += w * g;
+                if (stereo)
+                    refR[pos + k] += w * gR;
+            }
+
+            if (stereo)
+                t->blitStereo(&out[pos], &outR[pos], sinc, lipol, g, gR);
+            else
+                t->blitMono(&out[pos], sinc, lipol, g);
+        }
+    };
+
+    for (auto *t : tables)
+    {
+        DYNAMIC_SECTION("Kernel " << t->name)
+        {
+            float ref[bufsize]{}, refR[bufsize]{}, out[bufsize]{}, outR[bufsize]{};
+            render(t, out, outR, ref, refR);
+
+            for (int i = 0; i < bufsize; ++i)
+            {
+                REQUIRE(out[i] == Approx(ref[i]).margin(1e-4));
+                REQUIRE(outR[i] == Approx(refR[i]).margin(1e-4));
+            }
+        }
+    }
+
+    if (K::avx2())
+    {
+        SECTION("AVX2 Renders The Same Bits As SSE2")
+        {
+            float ref[bufsize]{}, refR[bufsize]{};
+            float sseL[bufsize]{}, sseR[bufsize]{}, avxL[bufsize]{}, avxR[bufsize]{};
+
+            render(&K::sse2(), sseL, sseR, ref, refR);
+            render(K::avx2(), avxL, avxR, ref, refR);
+
+            REQUIRE(memcmp(sseL, avxL, sizeof(sseL)) == 0);
+            REQUIRE(memcmp(sseR, avxR, sizeof(sseR)) == 0);
+        }
+    }
+}
+
+TEST_CASE("Twist Voices Use Pooled Engine State", "[dsp]")
+{
+    auto surge = Surge::Headless::createSurge(44100);
+    REQUIRE(surge);
+
+    surge->storage.getPatch().scene[0].osc[0].queue_type = ot_twist;
+    for (int i = 0; i < 10; ++i)
+        surge->process();
+
+    surge->storage.memoryPools->resetOscillatorPools(&surge->storage);
+    surge->storage.memoryPools->twistVoiceStates.emergencyAllocations = 0;
+
+    for (int n = 0; n < 6; ++n)
+        surge->playNote(0, 48 + n * 3, 100, 0, -1);
+
+    float maxAmp = 0.f;
+    for (int i = 0; i < 200; ++i)
+    {
+        surge->process();
+        for (int s = 0; s < BLOCK_SIZE; ++s)
+            maxAmp = std::max(maxAmp, std::fabs(surge->output[0][s]));
+    }
+
+    for (int n = 0; n < 6; ++n)
+        surge->releaseNote(0, 48 + n * 3, 0);
+
+    REQUIRE(maxAmp > 0.01f);
+    REQUIRE(surge->storage.memoryPools->twistVoiceStates.emergencyAllocations == 0);
+}
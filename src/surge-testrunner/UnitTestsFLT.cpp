@@ -23,6 +23,7 @@
 #include <iomanip>
 #include <sstream>
 #include <algorithm>
+#include <cstring>
 
 #include "HeadlessUtils.h"
 #include "Player.h"
@@ -30,6 +31,7 @@
 #include "catch2/catch_amalgamated.hpp"
 
 #include "UnitTestUtilities.h"
+#include "CPUFeatures.h"
 
 using namespace Surge::Test;
 
@@ -100,3 +102,107 @@ TEST_CASE("Run Every Waveshaper", "[flt]")
         }
     }
 }
+
+TEST_CASE("Filter Chain Pairs Match Single Quads", "[flt]")
+{
+    for (int config = 0; config < n_filter_configs; ++config)
+    {
+        for (bool ws : {false, true})
+        {
+            INFO("Configuration " << config << " waveshaper " << ws);
+
+            auto single = std::make_unique<QuadFilterChainState[]>(2);
+            auto start = std::make_unique<QuadFilterChainState[]>(2);
+
+            std::minstd_rand gen(2112 + config);
+            std::uniform_real_distribution<float> dist(-1.f, 1.f);
+
+            for (int q = 0; q < 2; ++q)
+            {
+                auto &d = single[q];
+                InitQuadFilterChainStateToZero(&d);
+
+                for (int u = 0; u < 4; ++u)
+                    for (int i = 0; i < 4; ++i)
+                        d.FU[u].active[i] = (q == 1 && i == 3) ? 0 : 0xffffffff;
+
+                d.Gain = _mm_set1_ps(0.7f);
+                d.FB = _mm_set1_ps(0.3f);
+                d.Mix1 = _mm_set1_ps(0.6f);
+                d.Mix2 = _mm_set1_ps(0.4f);
+                d.Drive = _mm_set1_ps(0.5f);
+                d.OutL = _mm_set1_ps(0.5f);
+                d.OutR = _mm_set1_ps(0.5f);
+                d.Out2L = _mm_set1_ps(0.5f);
+                d.Out2R = _mm_set1_ps(0.5f);
+                d.dGain = _mm_set1_ps(-1e-3f);
+                d.dFB = _mm_set1_ps(2e-3f);
+                d.dMix1 = _mm_set1_ps(1e-3f);
+                d.dMix2 = _mm_set1_ps(-1e-3f);
+                d.dDrive = _mm_set1_ps(1e-3f);
+                d.dOutL = _mm_set1_ps(-1e-3f);
+                d.dOut2R = _mm_set1_ps(1e-3f);
+
+                for (int k = 0; k < BLOCK_SIZE_OS; ++k)
+                {
+                    d.DL[k] = _mm_set_ps(dist(gen), dist(gen), dist(gen), dist(gen));
+                    d.DR[k] = _mm_set_ps(dist(gen), dist(gen), dist(gen), dist(gen));
+                }
+
+                start[q] = d;
+            }
+
+            fbq_global g;
+            g.FU1ptr = nullptr;
+            g.FU2ptr = nullptr;
+            g.WSptr = ws ? sst::waveshapers::GetQuadWaveshaper(
+                               sst::waveshapers::WaveshaperType::wst_soft)
+                         : nullptr;
+
+            float singleL alignas(16)[BLOCK_SIZE_OS]{}, singleR alignas(16)[BLOCK_SIZE_OS]{};
+
+            auto quadFn = GetFBQPointer(config, false, ws, false);
+            REQUIRE(quadFn);
+
+            for (int blocks = 0; blocks < 4; ++blocks)
+            {
+                quadFn(single[0], g, singleL, singleR);
+                quadFn(single[1], g, singleL, singleR);
+            }
+
+            auto checkPair = [&](FBOctFPtr octFn) {
+                REQUIRE(octFn);
+
+                auto paired = std::make_unique<QuadFilterChainState[]>(2);
+                paired[0] = start[0];
+                paired[1] = start[1];
+                float pairedL alignas(16)[BLOCK_SIZE_OS]{}, pairedR alignas(16)[BLOCK_SIZE_OS]{};
+
+                for (int blocks = 0; blocks < 4; ++blocks)
+                {
+                    octFn(&paired[0], g, pairedL, pairedR);
+                }
+
+                for (int k = 0; k < BLOCK_SIZE_OS; ++k)
+                {
+                    REQUIRE(singleL[k] == pairedL[k]);
+                    REQUIRE(singleR[k] == pairedR[k]);
+                }
+
+                for (int q = 0; q < 2; ++q)
+                {
+                    REQUIRE(memcmp(&single[q].Gain, &paired[q].Gain, sizeof(__m128)) == 0);
+                    REQUIRE(memcmp(&single[q].FBlineL, &paired[q].FBlineL, sizeof(__m128)) == 0);
+                    REQUIRE(memcmp(&single[q].OutL, &paired[q].OutL, sizeof(__m128)) == 0);
+                }
+            };
+
+            checkPair(GetFBOctPointerSSE2(config, false, ws, false));
+
+            if (octFilterChainAVX2Compiled() && Surge::CPUFeatures::cpuSupportsAVX2())
+            {
+                checkPair(GetFBOctPointerAVX2(config, false, ws, false));
+            }
+        }
+    }
+}
@@ -32,6 +32,9 @@
 
 #include "UnitTestUtilities.h"
 #include "AudioInputEffect.h"
+#include "DelayEffect.h"
+#include <chrono>
+#include <thread>
 
 using namespace Surge::Test;
 
@@ -1081,3 +1084,142 @@ TEST_CASE("Audio Input Effect", "[fx]")
         }
     }
 }
+
+TEST_CASE("FX Are Built Off The Audio Thread", "[fx]")
+{
+    auto surge = Surge::Headless::createSurge(44100);
+    REQUIRE(surge);
+
+    for (int i = 0; i < 10; ++i)
+        surge->process();
+
+    surge->audio_processing_active = true;
+
+    for (auto type : {fxt_reverb2, fxt_delay, fxt_off, fxt_nimbus})
+    {
+        INFO("Spawning " << fx_type_names[type]);
+
+        auto *pt = &(surge->storage.getPatch().fx[0].type);
+        auto did = surge->idForParameter(pt);
+        surge->setParameter01(did, 1.f * type / (pt->val_max.i - pt->val_min.i), false);
+
+        // the request only leaves the audio thread; the slot runs dry until the effect lands
+        surge->process();
+        REQUIRE(surge->fxLoadSlots[0].state != SurgeSynthesizer::FxLoadSlot::IDLE);
+
+        auto start = std::chrono::steady_clock::now();
+        while (surge->fxLoadSlots[0].state != SurgeSynthesizer::FxLoadSlot::IDLE ||
+               surge->load_fx_needed)
+        {
+            surge->process();
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+            REQUIRE(std::chrono::steady_clock::now() - start < std::chrono::seconds(10));
+        }
+
+        REQUIRE(surge->storage.getPatch().fx[0].type.val.i == type);
+        REQUIRE((surge->fx[0] != nullptr) == (type != fxt_off));
+
+        surge->playNote(0, 60, 100, 0, -1);
+        for (int s = 0; s < 20; ++s)
+            surge->process();
+        surge->releaseNote(0, 60, 100);
+    }
+}
+
+TEST_CASE("FX Moved Off The Audio Thread Keep Their Modulation", "[fx]")
+{
+    auto surge = Surge::Headless::createSurge(44100);
+    REQUIRE(surge);
+
+    for (int i = 0; i < 10; ++i)
+        surge->process();
+
+    Surge::Test::setFX(surge, 0, fxt_combulator);
+    auto &patch = surge->storage.getPatch();
+    REQUIRE(surge->setModDepth01(patch.fx[0].p[2].id, ms_slfo1, 0, 0, 0.1));
+
+    surge->audio_processing_active = true;
+    surge->reorderFx(0, 1, SurgeSynthesizer::MOVE);
+
+    auto busy = [&surge]() {
+        for (const auto &slot : surge->fxLoadSlots)
+            if (slot.state != SurgeSynthesizer::FxLoadSlot::IDLE)
+                return true;
+        return (bool)surge->load_fx_needed;
+    };
+
+    surge->process();
+    auto start = std::chrono::steady_clock::now();
+    while (busy())
+    {
+        surge->process();
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+        REQUIRE(std::chrono::steady_clock::now() - start < std::chrono::seconds(10));
+    }
+
+    REQUIRE(patch.fx[0].type.val.i == fxt_off);
+    REQUIRE(patch.fx[1].type.val.i == fxt_combulator);
+    REQUIRE(surge->fx[0] == nullptr);
+    REQUIRE(surge->fx[1] != nullptr);
+    REQUIRE(patch.fx[1].p[2].ctrltype != ct_none);
+
+    REQUIRE(patch.modulation_global.size() == 1);
+    REQUIRE(surge->isActiveModulation(patch.fx[1].p[2].id, ms_slfo1, 0, 0));
+    REQUIRE(surge->getModDepth01(patch.fx[1].p[2].id, ms_slfo1, 0, 0) == Approx(0.1));
+
+    // and the audio thread sees the same routing
+    surge->process();
+    REQUIRE(surge->storage.audioModulationRouting().global.size() == 1);
+}
+
+TEST_CASE("FX Moved Off The Audio Thread Point At Their New Slot", "[fx]")
+{
+    auto surge = Surge::Headless::createSurge(44100);
+    REQUIRE(surge);
+
+    for (int i = 0; i < 10; ++i)
+        surge->process();
+
+    // a delay is an sst-effects effect, which keeps its own storage pointers as well
+    Surge::Test::setFX(surge, 0, fxt_delay);
+    auto &patch = surge->storage.getPatch();
+
+    surge->audio_processing_active = true;
+    surge->reorderFx(0, 2, SurgeSynthesizer::MOVE);
+
+    auto busy = [&surge]() {
+        for (const auto &slot : surge->fxLoadSlots)
+            if (slot.state != SurgeSynthesizer::FxLoadSlot::IDLE)
+                return true;
+        return (bool)surge->load_fx_needed;
+    };
+
+    surge->process();
+    auto start = std::chrono::steady_clock::now();
+    while (busy())
+    {
+        surge->process();
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+        REQUIRE(std::chrono::steady_clock::now() - start < std::chrono::seconds(10));
+    }
+
+    REQUIRE(patch.fx[2].type.val.i == fxt_delay);
+    auto *delay = dynamic_cast<DelayEffect *>(surge->fx[2].get());
+    REQUIRE(delay);
+
+    // every view the effect has of its parameters is the live patch's slot 2
+    REQUIRE(delay->fxStorage == &patch.fx[2]);
+    REQUIRE(delay->valueStorage == patch.globaldata);
+    for (int i = 0; i < n_fx_params; ++i)
+    {
+        INFO("Parameter " << i);
+        REQUIRE(delay->pd_float[i] == &patch.globaldata[patch.fx[2].p[i].id].f);
+        REQUIRE(delay->pd_int[i] == &patch.globaldata[patch.fx[2].p[i].id].i);
+    }
+
+    // and an edit to the moved slot reaches it
+    auto &fb = patch.fx[2].p[1];
+    surge->setParameter01(surge->idForParameter(&fb), 0.25f, false);
+    surge->process();
+    REQUIRE(*delay->pd_float[1] == fb.val.f);
+}
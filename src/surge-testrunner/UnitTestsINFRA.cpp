@@ -21,10 +21,14 @@
  */
 #include <iostream>
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
 
 #include "HeadlessUtils.h"
 #include "BiquadFilter.h"
 #include "MemoryPool.h"
+#include "RenderWorker.h"
 
 #include "sst/plugininfra/strnatcmp.h"
 
@@ -180,6 +184,84 @@ TEST_CASE("Memory Pool Works", "[infra]")
         REQUIRE(CountAlloc<3>::alloc == 160);
         REQUIRE(CountAlloc<3>::ct == 0);
     }
+
+    SECTION("Grow In The Background")
+    {
+        {
+            auto pool = std::make_unique<Surge::Memory::MemoryPool<CountAlloc<4>, 8, 4, 500, 6>>();
+            int wakes{0};
+            pool->wakeGrower = [&wakes]() { wakes++; };
+
+            std::deque<CountAlloc<4> *> tmp;
+            for (int i = 0; i < 2; ++i)
+                tmp.push_back(pool->getItem());
+            REQUIRE(wakes == 0);
+
+            tmp.push_back(pool->getItem());
+            REQUIRE(wakes == 1);
+
+            // stand in for the grower thread; the pool is asked for lowWater + growBy free items
+            pool->growInBackground();
+            REQUIRE(CountAlloc<4>::ct == 8 + 5);
+
+            for (int i = 0; i < 10; ++i)
+                tmp.push_back(pool->getItem());
+            REQUIRE(pool->emergencyAllocations == 0);
+
+            for (int i = 0; i < 10; ++i)
+                tmp.push_back(pool->getItem());
+            REQUIRE(pool->emergencyAllocations > 0);
+
+            auto emergencies = pool->emergencyAllocations.load();
+            pool->requestSize(100);
+            pool->growInBackground();
+
+            for (int i = 0; i < 50; ++i)
+                tmp.push_back(pool->getItem());
+            REQUIRE(pool->emergencyAllocations == emergencies);
+
+            for (auto *q : tmp)
+                pool->returnItem(q);
+        }
+        REQUIRE(CountAlloc<4>::ct == 0);
+    }
+}
+
+TEST_CASE("Render Worker Runs Each Job Exactly Once", "[infra]")
+{
+    Surge::Threading::RenderWorker worker;
+
+    struct Counts
+    {
+        std::atomic<int> runs{0};
+        std::atomic<int> onWorker{0};
+        std::thread::id joiner;
+    } counts;
+    counts.joiner = std::this_thread::get_id();
+
+    auto job = [](void *c) {
+        auto counts = static_cast<Counts *>(c);
+        counts->runs++;
+        if (std::this_thread::get_id() != counts->joiner)
+            counts->onWorker++;
+    };
+
+    int expected = 0;
+    for (int i = 0; i < 200; ++i)
+    {
+        // every so often let the worker park, so the join may have to take the job back
+        if (i % 20 == 0)
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+
+        worker.dispatch(job, &counts);
+        worker.join();
+        expected++;
+
+        REQUIRE(counts.runs == expected);
+    }
+
+    // each job ran either on the worker or, taken back by join, on this thread
+    REQUIRE(counts.onWorker + (int)worker.getReclaimCount() == expected);
 }
 
 TEST_CASE("strnatcmp With Spaces", "[infra]")
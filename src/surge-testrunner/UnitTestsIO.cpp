@@ -23,6 +23,7 @@
 #include <iomanip>
 #include <sstream>
 #include <algorithm>
+#include <fstream>
 
 #include "HeadlessUtils.h"
 #include "Player.h"
@@ -34,6 +35,7 @@
 #include <thread>
 
 #include "UserDefaults.h"
+#include "WavetableCache.h"
 #include <unordered_map>
 
 using namespace Surge::Test;
@@ -730,3 +732,422 @@ TEST_CASE("Mono Voice Priority Streams", "[io]")
         }
     }
 }
+
+TEST_CASE("Queued Patch Loads On The Loader Thread", "[io]")
+{
+    auto surge = Surge::Headless::createSurge(44100, true);
+    REQUIRE(surge.get());
+
+    if (surge->storage.patch_list.size() < 2)
+        return;
+
+    surge->audio_processing_active = true;
+
+    for (int target : {1, 0, 1})
+    {
+        INFO("Loading patch " << target);
+        surge->patchid_queue = target;
+
+        auto start = std::chrono::steady_clock::now();
+        while (surge->patchid_queue >= 0 ||
+               surge->patchLoadStage != SurgeSynthesizer::PATCH_LOAD_IDLE)
+        {
+            surge->process();
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+            REQUIRE(std::chrono::steady_clock::now() - start < std::chrono::seconds(10));
+        }
+
+        REQUIRE(surge->patchid == target);
+    }
+}
+
+TEST_CASE("Queued Patches Are Prepared While The Old One Plays", "[io]")
+{
+    auto surge = Surge::Headless::createSurge(44100, true);
+    auto direct = Surge::Headless::createSurge(44100, true);
+    REQUIRE(surge.get());
+    REQUIRE(direct.get());
+
+    if (surge->storage.patch_list.size() < 2)
+        return;
+
+    // what the loader does while the old patch plays
+    surge->patchid_queue = 1;
+    REQUIRE(surge->preparePatchLoad());
+    REQUIRE(surge->patchid_queue == -1);
+
+    int preparedTypes[n_fx_slots];
+    {
+        std::lock_guard<std::mutex> g(surge->preparedPatchMutex);
+        REQUIRE(surge->preparedPatch);
+        REQUIRE(surge->preparedPatch->load);
+
+        for (int s = 0; s < n_fx_slots; ++s)
+        {
+            preparedTypes[s] = surge->preparedPatch->fx[s].type;
+            REQUIRE((bool)surge->preparedPatch->fx[s].effect == (preparedTypes[s] != fxt_off));
+        }
+    }
+
+    // and what it does once the standby has taken over, which uses up the prepared patch
+    surge->loadPatch(1);
+    {
+        std::lock_guard<std::mutex> g(surge->preparedPatchMutex);
+        REQUIRE(!surge->preparedPatch);
+    }
+
+    direct->loadPatch(1);
+
+    auto &patch = surge->storage.getPatch();
+    auto &directPatch = direct->storage.getPatch();
+    REQUIRE(surge->patchSwitchEngine);
+    auto &standbyPatch = surge->patchSwitchEngine->storage.getPatch();
+
+    for (int s = 0; s < n_fx_slots; ++s)
+    {
+        INFO("FX slot " << s);
+        REQUIRE(patch.fx[s].type.val.i == preparedTypes[s]);
+        REQUIRE((bool)surge->fx[s] == (bool)direct->fx[s]);
+    }
+
+    for (int i = 0; i < patch.param_ptr.size(); ++i)
+    {
+        INFO("Parameter " << patch.param_ptr[i]->get_storage_name());
+        REQUIRE(patch.param_ptr[i]->val.i == directPatch.param_ptr[i]->val.i);
+        REQUIRE(standbyPatch.param_ptr[i]->val.i == directPatch.param_ptr[i]->val.i);
+    }
+
+    for (int sc = 0; sc < n_scenes; ++sc)
+    {
+        for (int o = 0; o < n_oscs; ++o)
+        {
+            REQUIRE(patch.scene[sc].osc[o].wt.n_tables == directPatch.scene[sc].osc[o].wt.n_tables);
+            REQUIRE(patch.scene[sc].osc[o].wt.size == directPatch.scene[sc].osc[o].wt.size);
+            REQUIRE(patch.scene[sc].osc[o].wavetable_display_name ==
+                    directPatch.scene[sc].osc[o].wavetable_display_name);
+        }
+    }
+}
+
+TEST_CASE("Queued Patch Switches Crossfade Without A Gap", "[io]")
+{
+    auto surge = Surge::Headless::createSurge(44100);
+    REQUIRE(surge.get());
+
+    surge->audio_processing_active = true;
+
+    // switch from the init patch to a copy of it, with a note held throughout
+    auto fn = fs::temp_directory_path() / "surge_test_patch_switch.fxp";
+    surge->savePatchToPath(fn, false);
+
+    surge->playNote(0, 60, 127, 0);
+    for (int i = 0; i < 10; ++i)
+    {
+        surge->process();
+    }
+
+    strncpy(surge->patchid_file, path_to_string(fn).c_str(), FILENAME_MAX);
+    surge->has_patchid_file = true;
+
+    bool crossfaded{false}, rangOut{false};
+    int blocks{0};
+
+    auto start = std::chrono::steady_clock::now();
+    while (surge->has_patchid_file || surge->patchLoadStage != SurgeSynthesizer::PATCH_LOAD_IDLE)
+    {
+        int stage = surge->patchLoadStage;
+
+        if (stage == SurgeSynthesizer::PATCH_LOAD_CROSSFADING && !crossfaded)
+        {
+            // a note played during the fade starts on the new patch
+            crossfaded = true;
+            surge->playNote(0, 64, 127, 0);
+            REQUIRE(surge->patchSwitchEngine->voices[0].size() == 1);
+        }
+
+        if (stage == SurgeSynthesizer::PATCH_LOAD_RINGING_OUT && !rangOut)
+        {
+            // and once the patch is in here, new notes start here again
+            rangOut = true;
+            surge->playNote(0, 67, 127, 0);
+            surge->releaseNote(0, 64, 0);
+            REQUIRE(surge->voices[0].size() == 1);
+            REQUIRE(surge->patchSwitchEngine->voices[0].size() == 1);
+        }
+
+        surge->process();
+        blocks++;
+
+        INFO("Block " << blocks << " at stage " << stage);
+        float peak{0.f};
+        for (int i = 0; i < BLOCK_SIZE; ++i)
+        {
+            peak = std::max(peak, std::fabs(surge->output[0][i]));
+        }
+        REQUIRE(peak > 0.f);
+        REQUIRE(std::chrono::steady_clock::now() - start < std::chrono::seconds(10));
+    }
+
+    REQUIRE(crossfaded);
+    REQUIRE(rangOut);
+    REQUIRE(surge->patchSwitchEngine->voices[0].empty());
+
+    fs::remove(fn);
+}
+
+TEST_CASE("Queued Wavetable Loads On The Loader Thread", "[io]")
+{
+    auto surge = Surge::Headless::createSurge(44100, true);
+    REQUIRE(surge.get());
+
+    if (surge->storage.wt_list.size() < 2)
+        return;
+
+    surge->audio_processing_active = true;
+
+    auto &osc = surge->storage.getPatch().scene[0].osc[0];
+    osc.type.val.i = ot_wavetable;
+
+    for (int target : {1, 0, 1})
+    {
+        INFO("Loading wavetable " << target);
+        surge->storage.queue_wt_load(&osc, target);
+
+        auto start = std::chrono::steady_clock::now();
+        while (osc.wt.queue_id != -1 || osc.wt.current_id != target)
+        {
+            surge->process();
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+            REQUIRE(std::chrono::steady_clock::now() - start < std::chrono::seconds(10));
+        }
+
+        REQUIRE(osc.wt.n_tables > 0);
+        REQUIRE(osc.wavetable_display_name == surge->storage.wt_list[target].name);
+    }
+}
+
+TEST_CASE("Wavetable Loads From Before A Patch Load Are Dropped", "[io]")
+{
+    auto surge = Surge::Headless::createSurge(44100, true);
+    REQUIRE(surge.get());
+
+    if (surge->storage.wt_list.size() < 2)
+        return;
+
+    surge->audio_processing_active = true;
+
+    auto &osc = surge->storage.getPatch().scene[0].osc[0];
+    auto &slot = surge->storage.wtLoadSlots[0][0];
+    osc.type.val.i = ot_wavetable;
+
+    surge->storage.queue_wt_load(&osc, 1);
+    surge->process();
+    REQUIRE(slot.state != SurgeStorage::WavetableLoadSlot::IDLE);
+
+    // what loadRaw does: the patch brings its own table while the old request is in flight
+    surge->storage.wavetableLoadGeneration++;
+    surge->storage.load_wt(0, &osc.wt, &osc);
+
+    auto start = std::chrono::steady_clock::now();
+    while (slot.state != SurgeStorage::WavetableLoadSlot::IDLE)
+    {
+        surge->process();
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+        REQUIRE(std::chrono::steady_clock::now() - start < std::chrono::seconds(10));
+    }
+
+    for (int i = 0; i < 10; ++i)
+        surge->process();
+
+    REQUIRE(osc.wt.current_id == 0);
+    REQUIRE(osc.wavetable_display_name == surge->storage.wt_list[0].name);
+}
+
+TEST_CASE("Wavetables Loaded Twice Share Their Data", "[io]")
+{
+    auto surge = Surge::Headless::createSurge(44100, true);
+    REQUIRE(surge.get());
+
+    if (surge->storage.wt_list.empty())
+        return;
+
+    auto &scene = surge->storage.getPatch().scene[0];
+
+    surge->storage.load_wt(0, &scene.osc[0].wt, &scene.osc[0]);
+    surge->storage.load_wt(0, &scene.osc[1].wt, &scene.osc[1]);
+
+    REQUIRE(scene.osc[0].wt.everBuilt);
+    REQUIRE(scene.osc[0].wt.sharedData);
+    REQUIRE(scene.osc[0].wt.TableF32Data == scene.osc[1].wt.TableF32Data);
+    REQUIRE(scene.osc[0].wt.n_tables == scene.osc[1].wt.n_tables);
+    REQUIRE(scene.osc[0].wavetable_display_name == scene.osc[1].wavetable_display_name);
+
+    SECTION("Copies Keep Sharing")
+    {
+        Wavetable copy;
+        copy.Copy(&scene.osc[0].wt);
+        REQUIRE(copy.TableF32Data == scene.osc[0].wt.TableF32Data);
+    }
+
+    SECTION("Building Into A Shared Table Detaches It")
+    {
+        auto shared = scene.osc[0].wt.TableF32Data;
+        auto first = scene.osc[0].wt.TableF32WeakPointers[0][0][0];
+
+        std::vector<float> saw(256);
+        for (int i = 0; i < 256; ++i)
+            saw[i] = i / 128.f - 1.f;
+
+        wt_header wh;
+        memset(&wh, 0, sizeof(wh));
+        wh.n_samples = 256;
+        wh.n_tables = 1;
+
+        REQUIRE(scene.osc[1].wt.BuildWT(saw.data(), wh, false));
+        REQUIRE(!scene.osc[1].wt.sharedData);
+        REQUIRE(scene.osc[1].wt.TableF32Data != shared);
+        REQUIRE(scene.osc[0].wt.TableF32WeakPointers[0][0][0] == first);
+    }
+}
+
+TEST_CASE("Wavetable Files Load Whole Or Short", "[io]")
+{
+    auto surge = Surge::Headless::createSurge(44100, true);
+    REQUIRE(surge.get());
+
+    const int samples = 256, frames = 2;
+    std::vector<float> data(samples * frames);
+    for (int i = 0; i < samples * frames; ++i)
+        data[i] = std::sin(2.0 * M_PI * i / samples);
+
+    wt_header wh;
+    memset(&wh, 0, sizeof(wh));
+    memcpy(wh.tag, "vawt", 4);
+    wh.n_samples = samples;
+    wh.n_tables = frames;
+
+    for (bool truncate : {false, true})
+    {
+        INFO("Truncated file " << truncate);
+
+        auto fn = (fs::temp_directory_path() /
+                   (truncate ? "surge_test_short.wt" : "surge_test_whole.wt"));
+        {
+            std::ofstream of(path_to_string(fn), std::ios::binary);
+            of.write((const char *)&wh, sizeof(wh));
+            of.write((const char *)data.data(),
+                     (truncate ? samples : samples * frames) * sizeof(float));
+        }
+
+        Wavetable wt;
+        surge->storage.load_wt(path_to_string(fn), &wt, nullptr);
+
+        REQUIRE(wt.everBuilt);
+        REQUIRE(wt.size == samples);
+        REQUIRE(wt.n_tables == frames);
+
+        for (int i = 0; i < samples; ++i)
+        {
+            REQUIRE(wt.TableF32WeakPointers[0][0][i] == data[i]);
+            REQUIRE(wt.TableF32WeakPointers[0][1][i] == (truncate ? 0.f : data[i + samples]));
+        }
+
+        fs::remove(fn);
+    }
+}
+
+TEST_CASE("Wavetable Cache Images Round Trip", "[io]")
+{
+    auto surge = Surge::Headless::createSurge(44100, true);
+    REQUIRE(surge.get());
+
+    if (surge->storage.wt_list.empty())
+        return;
+
+    Wavetable built;
+    surge->storage.load_wt(0, &built, nullptr);
+    REQUIRE(built.everBuilt);
+
+    auto dir = fs::temp_directory_path() / "surge_test_wavetable_cache";
+    std::string key = "test key|1|2|-1";
+
+    REQUIRE(Surge::Storage::WavetableCache::writeImage(dir, key, built));
+
+    Wavetable read;
+    REQUIRE(!Surge::Storage::WavetableCache::readImage(dir, "some other key", read));
+    REQUIRE(Surge::Storage::WavetableCache::readImage(dir, key, read));
+
+    REQUIRE(read.size == built.size);
+    REQUIRE(read.n_tables == built.n_tables);
+    REQUIRE(read.flags == built.flags);
+
+    for (int l = 0; l < max_mipmap_levels; ++l)
+    {
+        for (int t = 0; t < (int)built.n_tables; ++t)
+        {
+            auto bf = built.TableF32WeakPointers[l][t];
+            auto rf = read.TableF32WeakPointers[l][t];
+
+            REQUIRE((bf == nullptr) == (rf == nullptr));
+
+            if (bf)
+            {
+                REQUIRE(bf - built.TableF32Data == rf - read.TableF32Data);
+                REQUIRE(memcmp(bf, rf, (built.size >> l) * sizeof(float)) == 0);
+            }
+        }
+    }
+
+    fs::remove_all(dir);
+}
+
+TEST_CASE("Wavetable Cache Images Are Pruned", "[io]")
+{
+    auto surge = Surge::Headless::createSurge(44100, true);
+    REQUIRE(surge.get());
+
+    if (surge->storage.wt_list.empty())
+        return;
+
+    Wavetable built;
+    surge->storage.load_wt(0, &built, nullptr);
+    REQUIRE(built.everBuilt);
+
+    using WC = Surge::Storage::WavetableCache;
+    auto dir = fs::temp_directory_path() / "surge_test_wavetable_cache_prune";
+    fs::remove_all(dir);
+
+    // write three images, each last used longer ago than the next
+    std::vector<std::string> keys{"oldest|1", "middle|2", "newest|3"};
+    auto now = fs::file_time_type::clock::now();
+    uint64_t imageBytes{0};
+
+    for (int i = 0; i < 3; ++i)
+    {
+        REQUIRE(WC::writeImage(dir, keys[i], built));
+
+        // back date the image just written, which is the only one not back dated yet
+        for (const auto &e : fs::directory_iterator(dir))
+        {
+            if (fs::last_write_time(e.path()) > now - std::chrono::minutes(1))
+                fs::last_write_time(e.path(), now - std::chrono::minutes(30 - 10 * i));
+
+            imageBytes = std::max(imageBytes, (uint64_t)fs::file_size(e.path()));
+        }
+    }
+
+    // reading the oldest makes it the most recently used
+    Wavetable read;
+    REQUIRE(WC::readImage(dir, keys[0], read));
+
+    WC::pruneImages(dir, 2 * imageBytes);
+
+    REQUIRE(WC::readImage(dir, keys[0], read));
+    REQUIRE(!WC::readImage(dir, keys[1], read));
+    REQUIRE(WC::readImage(dir, keys[2], read));
+
+    WC::clearImages(dir);
+    REQUIRE(fs::is_empty(dir));
+
+    fs::remove_all(dir);
+}
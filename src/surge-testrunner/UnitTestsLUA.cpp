@@ -23,6 +23,8 @@
 #include <iomanip>
 #include <sstream>
 #include <algorithm>
+#include <set>
+#include <thread>
 
 #include "HeadlessUtils.h"
 #include "Player.h"
@@ -32,6 +34,7 @@
 #include "UnitTestUtilities.h"
 
 #include "FormulaModulationHelper.h"
+#include "FormulaExpressionCompiler.h"
 #include "WavetableScriptEvaluator.h"
 #include "LuaSupport.h"
 
@@ -607,6 +610,149 @@ end)FN");
     }
 }
 
+TEST_CASE("Formula State Is Kept By Reference", "[formula]")
+{
+    SECTION("Returned Tables Replace The State")
+    {
+        SurgeStorage storage;
+        FormulaModulatorStorage fs;
+        fs.setFormula(R"FN(
+function process(state)
+    local next = { calls = (state.calls or 0) + 1 }
+    next.output = next.calls / 100
+    return next
+end)FN");
+
+        Surge::Formula::EvaluatorState es, other;
+        Surge::Formula::prepareForEvaluation(&storage, &fs, es, true);
+        Surge::Formula::prepareForEvaluation(&storage, &fs, other, true);
+
+        auto top = lua_gettop(es.L);
+        float r[Surge::Formula::max_formula_outputs];
+        for (int i = 1; i <= 50; ++i)
+        {
+            Surge::Formula::valueAt(0, i / 64.f, &storage, &fs, &es, r);
+            REQUIRE(r[0] == Approx(i / 100.f));
+            REQUIRE(lua_gettop(es.L) == top);
+        }
+        REQUIRE(std::get<float>(Surge::Formula::extractModStateKeyForTesting("calls", es)) == 50);
+
+        // each state has its own table and the fields are written fresh each time
+        Surge::Formula::valueAt(3, 0.25, &storage, &fs, &other, r);
+        REQUIRE(r[0] == Approx(0.01));
+        Surge::Formula::valueAt(3, 0.25, &storage, &fs, &other, r, true);
+        REQUIRE(std::get<float>(Surge::Formula::extractModStateKeyForTesting("cycle", other)) ==
+                3);
+        REQUIRE(std::get<float>(Surge::Formula::extractModStateKeyForTesting("phase", other)) ==
+                Approx(0.25));
+
+        auto L = es.L;
+        Surge::Formula::cleanEvaluatorState(es);
+        Surge::Formula::cleanEvaluatorState(other);
+        REQUIRE(lua_gettop(L) == top);
+    }
+}
+
+TEST_CASE("Simple Formulas Skip Lua", "[formula]")
+{
+    SECTION("What Compiles")
+    {
+        auto compiles = [](const std::string &f) {
+            return Surge::Formula::compileNativeProgram(f) != nullptr;
+        };
+
+        REQUIRE(compiles(R"FN(
+function init(state)
+    if state.rate > 1 then state.fast = true end
+    return state
+end
+
+function process(state)
+    -- a comment, and a --[[ block ]] comment
+    local x = math.sin(state.phase * 2 * math.pi)
+    state.output = clamp(x * (1 + state.deform) - state.macros[3], -1, 1)
+    return state
+end)FN"));
+
+        REQUIRE(!compiles(R"FN(
+function process(state)
+    if state.phase > 0.5 then state.output = 1 else state.output = -1 end
+    return state
+end)FN"));
+        REQUIRE(!compiles(R"FN(
+function process(state)
+    p = state.phase
+    state.output = p
+    return state
+end)FN"));
+        REQUIRE(!compiles(R"FN(
+function process(state)
+    state.output = state.av + math.random()
+    return state
+end)FN"));
+        REQUIRE(!compiles(R"FN(
+function process(state)
+    state.output = { state.phase, 1 - state.phase }
+    return state
+end)FN"));
+
+        // a formula's own definitions of our builtins must win, as they do in lua
+        REQUIRE(!compiles(R"FN(
+function clamp(x, lo, hi)
+    return x
+end
+
+function process(state)
+    state.output = clamp(state.phase * 4, -1, 1)
+    return state
+end)FN"));
+        REQUIRE(!compiles(R"FN(
+function init(state)
+    math.sin = math.cos
+    return state
+end
+
+function process(state)
+    state.output = sin(state.phase)
+    return state
+end)FN"));
+    }
+
+    SECTION("Native Matches Lua")
+    {
+        for (auto f : {"state.phase * 2 - 1", "-state.phase ^ 2 + 2 ^ 3 ^ 0.5 / 4",
+                       "sin(state.phase * 2 * pi) * state.deform", "(state.cycle % 3) / 3 - 0.2",
+                       "max(state.phase, 0.2, 1 - state.phase) * 3 - 2", "1 / (state.phase - 0.5)"})
+        {
+            INFO("Formula is " << f);
+            SurgeStorage storage;
+            FormulaModulatorStorage fs;
+            fs.setFormula(std::string("function process(state)\n    state.output = ") + f +
+                          "\n    return state\nend\n");
+            REQUIRE(fs.nativeProgram);
+
+            Surge::Formula::EvaluatorState audio, display;
+            Surge::Formula::prepareForEvaluation(&storage, &fs, audio, false);
+            Surge::Formula::prepareForEvaluation(&storage, &fs, display, true);
+            audio.deform = display.deform = 0.4;
+            REQUIRE(audio.native);
+            REQUIRE(!display.native);
+
+            for (int i = 0; i < 200; ++i)
+            {
+                float ra[Surge::Formula::max_formula_outputs];
+                float rd[Surge::Formula::max_formula_outputs];
+                int ip = i / 40;
+                float fp = (i % 40) / 40.f;
+                Surge::Formula::valueAt(ip, fp, &storage, &fs, &audio, ra);
+                Surge::Formula::valueAt(ip, fp, &storage, &fs, &display, rd);
+                REQUIRE(ra[0] == Approx(rd[0]).margin(1e-6));
+                REQUIRE(audio.isFinite == display.isFinite);
+            }
+        }
+    }
+}
+
 TEST_CASE("Clamping", "[formula]")
 {
     SECTION("Test Clamped Function")
@@ -687,6 +833,42 @@ end
             }
         }
     }
+
+    SECTION("Renders From Several Threads")
+    {
+        const std::string s = R"FN(
+function generate(config)
+    res = {}
+    for i,x in ipairs(config.xs) do
+        res[i] = math.sin(x * (config.n+1) * 2 * math.pi) * (1 - 0.1 * config.n)
+    end
+    return res
+end
+        )FN";
+
+        static constexpr int nFrames{8}, nThreads{4};
+        std::vector<std::vector<float>> serial;
+        for (int fno = 0; fno < nFrames; ++fno)
+            serial.push_back(Surge::WavetableScript::evaluateScriptAtFrame(s, 256, fno, nFrames));
+
+        std::vector<std::vector<float>> threaded[nThreads];
+        std::vector<std::thread> threads;
+        for (int t = 0; t < nThreads; ++t)
+        {
+            threads.emplace_back([&s, &threaded, t]() {
+                for (int fno = 0; fno < nFrames; ++fno)
+                    threaded[t].push_back(
+                        Surge::WavetableScript::evaluateScriptAtFrame(s, 256, fno, nFrames));
+            });
+        }
+        for (auto &t : threads)
+            t.join();
+
+        // same frames whichever thread and state did the work
+        for (int t = 0; t < nThreads; ++t)
+            for (int fno = 0; fno < nFrames; ++fno)
+                REQUIRE(threaded[t][fno] == serial[fno]);
+    }
 }
 
 TEST_CASE("Simple Used Formula Modulator", "[formula]")
@@ -930,6 +1112,185 @@ end)FN");
     }
 }
 
+TEST_CASE("Lua Voice Formulas Render In Parallel", "[formula]")
+{
+    // process keeps a running value in its state and draws from math.random, and isn't native
+    auto formula = std::string(R"FN(
+function init(state)
+    state.acc = math.random()
+    return state
+end
+
+function process(state)
+    state.acc = state.acc * 0.9 + 0.1 * math.random()
+    if state.phase > 0.5 then
+        state.output = state.acc
+    else
+        state.output = -state.acc
+    end
+    return state
+end)FN");
+
+    auto serial = Surge::Test::surgeOnSine();
+    auto pooled = Surge::Test::surgeOnSine();
+
+    for (auto &s : {serial, pooled})
+    {
+        s->storage.getPatch().scene[0].lfo[0].shape.val.i = lt_formula;
+        auto pitchId = s->storage.getPatch().scene[0].osc[0].pitch.id;
+        s->setModDepth01(pitchId, ms_lfo1, 0, 0, 0.1);
+        s->storage.getPatch().formulamods[0][0].setFormula(formula);
+        s->storage.rngGen.g.seed(8675309);
+    }
+    REQUIRE(!serial->storage.getPatch().formulamods[0][0].nativeProgram);
+
+    pooled->setVoiceRenderThreads(2);
+    REQUIRE(pooled->voiceRenderThreads > 0);
+
+    for (int i = 0; i < 10; ++i)
+    {
+        serial->process();
+        pooled->process();
+    }
+
+    for (auto &s : {serial, pooled})
+    {
+        for (int k = 0; k < 13; ++k)
+        {
+            s->playNote(0, 48 + 2 * k, 60 + 4 * k, 0);
+        }
+    }
+
+    // every voice evaluates in a state of its own
+    std::set<lua_State *> states;
+    for (auto *v : pooled->voices[0])
+    {
+        auto lms = dynamic_cast<LFOModulationSource *>(v->modsources[ms_lfo1]);
+        REQUIRE(lms);
+        REQUIRE(lms->formulastate.isvalid);
+        REQUIRE(!lms->formulastate.native);
+        states.insert(lms->formulastate.L);
+    }
+    REQUIRE(states.size() == 13);
+
+    for (int blk = 0; blk < 300; ++blk)
+    {
+        serial->process();
+        pooled->process();
+
+        for (int c = 0; c < N_OUTPUTS; ++c)
+        {
+            for (int i = 0; i < BLOCK_SIZE; ++i)
+            {
+                INFO("Block " << blk << " channel " << c << " sample " << i);
+                REQUIRE(serial->output[c][i] == pooled->output[c][i]);
+            }
+        }
+    }
+}
+
+TEST_CASE("Edited Formulas Are Compiled Off The Audio Thread", "[formula]")
+{
+    auto formula = [](int version) {
+        return std::string(R"FN(
+function process(state)
+    state.version = )FN") +
+               std::to_string(version) + R"FN(
+    if state.phase > 0.5 then
+        state.output = 1
+    else
+        state.output = -1
+    end
+    return state
+end)FN";
+    };
+
+    auto surge = Surge::Test::surgeOnSine();
+    auto &fs = surge->storage.getPatch().formulamods[0][0];
+    auto &gd = *surge->storage.formulaGlobalData;
+
+    surge->storage.getPatch().scene[0].lfo[0].shape.val.i = lt_formula;
+    auto pitchId = surge->storage.getPatch().scene[0].osc[0].pitch.id;
+    surge->setModDepth01(pitchId, ms_lfo1, 0, 0, 0.1);
+
+    // the compiler thread picks the formula up and compiles it into every spare state
+    auto waitForIdleStates = [&gd](size_t h) {
+        for (int i = 0; i < 500; ++i)
+        {
+            auto [with, idle] = gd.idleStatesWithFormula(h);
+            if (idle >= Surge::Formula::GlobalData::minSpareStates && with == idle)
+                return true;
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        return false;
+    };
+
+    auto playChord = [&surge](int root) {
+        for (int k = 0; k < 3; ++k)
+            surge->playNote(0, root + 4 * k, 100, 0);
+        for (int i = 0; i < 10; ++i)
+            surge->process();
+    };
+
+    auto versionsPlaying = [&surge]() {
+        std::set<int> res;
+        for (auto *v : surge->voices[0])
+        {
+            auto lms = dynamic_cast<LFOModulationSource *>(v->modsources[ms_lfo1]);
+            auto ver = Surge::Formula::extractModStateKeyForTesting("version", lms->formulastate);
+            REQUIRE(std::get_if<float>(&ver));
+            res.insert((int)std::get<float>(ver));
+        }
+        return res;
+    };
+
+    fs.setFormula(formula(1));
+    REQUIRE(waitForIdleStates(fs.formulaHash));
+
+    playChord(60);
+    REQUIRE(versionsPlaying() == std::set<int>{1});
+
+    // edit it with the first chord still held
+    fs.setFormula(formula(2));
+    REQUIRE(waitForIdleStates(fs.formulaHash));
+
+    playChord(72);
+    REQUIRE(versionsPlaying() == std::set<int>{1, 2});
+
+    REQUIRE(gd.compilesOnLease.load() == 0);
+    REQUIRE(gd.statesOpenedOnLease.load() == 0);
+}
+
+TEST_CASE("Replaced Native Programs Are Freed Once Unused", "[formula]")
+{
+    FormulaModulatorStorage fs;
+    fs.setFormula(R"FN(
+function process(state)
+    state.output = state.phase
+    return state
+end)FN");
+
+    // an evaluator still holding the old program keeps it alive past the edit
+    auto held = std::atomic_load(&fs.nativeProgram);
+    REQUIRE(held);
+    std::weak_ptr<const Surge::Formula::NativeProgram> watch = held;
+
+    fs.setFormula(R"FN(
+function process(state)
+    state.output = -state.phase
+    return state
+end)FN");
+
+    Surge::Formula::releaseRetiredNativePrograms();
+    REQUIRE(!watch.expired());
+
+    // and once it lets go, the next release frees it
+    held.reset();
+    REQUIRE(!watch.expired());
+    Surge::Formula::releaseRetiredNativePrograms();
+    REQUIRE(watch.expired());
+}
+
 TEST_CASE("Two Surge XTs", "[formula]")
 {
     // this attempts but fails to reproduce 5753 but i left it here anyway
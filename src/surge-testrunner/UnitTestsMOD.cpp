@@ -24,6 +24,8 @@
 #include <iomanip>
 #include <sstream>
 #include <algorithm>
+#include <chrono>
+#include <thread>
 
 #include "HeadlessUtils.h"
 #include "Player.h"
@@ -32,6 +34,8 @@
 
 #include "UnitTestUtilities.h"
 #include "ModControl.h"
+#include "VoiceEnvelopeBank.h"
+#include "VoiceLFOBank.h"
 
 using namespace Surge::Test;
 
@@ -527,6 +531,148 @@ TEST_CASE("ADSR Envelope Behaviour", "[mod]")
     }
 }
 
+TEST_CASE("Analog Envelope Follows Stage Time Changes", "[mod]")
+{
+    auto surge = Surge::Headless::createSurge(44100);
+    REQUIRE(surge);
+
+    auto *adsrstorage = &(surge->storage.getPatch().scene[0].adsr[0]);
+    int ids, ide;
+    setupStorageRanges(&(adsrstorage->a), &(adsrstorage->mode), ids, ide);
+
+    auto svn = [](Parameter *p, float vn) {
+        p->set_value_f01(p->value_to_normalized(limit_range(vn, p->val_min.f, p->val_max.f)));
+    };
+
+    // The analog coefficients are cached between blocks, so a release time changed while
+    // the note is held has to be picked up at release
+    auto run = [&](bool shortenRelease) {
+        svn(&(adsrstorage->a), log2(0.01));
+        svn(&(adsrstorage->d), log2(0.01));
+        svn(&(adsrstorage->s), 0.8);
+        svn(&(adsrstorage->r), log2(2.0));
+        adsrstorage->mode.val.b = true;
+        copyScenedataSubset(&(surge->storage), 0, ids, ide);
+
+        ADSRModulationSource adsr;
+        adsr.init(&(surge->storage), adsrstorage, surge->storage.getPatch().scenedata[0],
+                  nullptr);
+        adsr.attack();
+
+        int blocksPerSecond = surge->storage.samplerate / BLOCK_SIZE;
+        for (int i = 0; i < blocksPerSecond / 5; ++i)
+            adsr.process_block();
+
+        if (shortenRelease)
+        {
+            svn(&(adsrstorage->r), log2(0.02));
+            copyScenedataSubset(&(surge->storage), 0, ids, ide);
+        }
+
+        adsr.release();
+        for (int i = 0; i < blocksPerSecond / 4; ++i)
+            adsr.process_block();
+
+        return adsr.get_output(0);
+    };
+
+    REQUIRE(run(false) > 0.1);
+    REQUIRE(run(true) < 1e-3);
+}
+
+TEST_CASE("Voice Envelope Bank Matches The Scalar Envelopes", "[mod]")
+{
+    auto surge = Surge::Headless::createSurge(44100);
+    REQUIRE(surge);
+
+    auto *adsrstorage = &(surge->storage.getPatch().scene[0].adsr[0]);
+
+    // seven of each, so each quad of lanes has some part filled
+    static constexpr int n = 7;
+    pdata localcopy[n][n_scene_params];
+
+    auto id = [](Parameter &p) { return p.param_id_in_scene; };
+
+    for (auto analog : {false, true})
+    {
+        for (int shape = 0; shape < 3; ++shape)
+        {
+            for (auto sustain : {0.f, 0.4f, 1.f})
+            {
+                INFO("Analog " << analog << " shape " << shape << " sustain " << sustain);
+
+                for (int i = 0; i < n; ++i)
+                {
+                    surge->storage.getPatch().copy_scenedata(localcopy[i], 0);
+
+                    // give every lane its own times, and some lanes their own shapes
+                    localcopy[i][id(adsrstorage->a)].f = -4.f + 0.5f * i;
+                    localcopy[i][id(adsrstorage->d)].f = -3.f + 0.3f * i;
+                    localcopy[i][id(adsrstorage->s)].f = sustain;
+                    localcopy[i][id(adsrstorage->r)].f = -3.5f + 0.2f * i;
+                    localcopy[i][id(adsrstorage->a_s)].i = (shape + (i == 3)) % 3;
+                    localcopy[i][id(adsrstorage->d_s)].i = (shape + (i == 4)) % 3;
+                    localcopy[i][id(adsrstorage->r_s)].i = (shape + (i == 1)) % 3;
+                    localcopy[i][id(adsrstorage->mode)].b = analog;
+                }
+
+                ADSRModulationSource scalar[n], batched[n];
+                for (int i = 0; i < n; ++i)
+                {
+                    for (auto *e : {&scalar[i], &batched[i]})
+                    {
+                        e->init(&(surge->storage), adsrstorage, localcopy[i], nullptr);
+                        e->attackFrom(i == 2 ? 0.25f : 0.f);
+                    }
+                }
+
+                VoiceEnvelopeBank bank;
+
+                for (int b = 0; b < 600; ++b)
+                {
+                    if (b == 300)
+                    {
+                        for (int i = 0; i < n; ++i)
+                        {
+                            if (i == n - 1)
+                            {
+                                scalar[i].uber_release();
+                                batched[i].uber_release();
+                            }
+                            else
+                            {
+                                scalar[i].release();
+                                batched[i].release();
+                            }
+                        }
+                    }
+
+                    bank.clear();
+                    for (int i = 0; i < n; ++i)
+                        bank.add(i & 1, &batched[i]);
+                    bank.process();
+
+                    for (int i = 0; i < n; ++i)
+                    {
+                        INFO("Block " << b << " envelope " << i);
+                        scalar[i].process_block();
+
+                        // the bank has already stepped the block, which process_block skips
+                        REQUIRE(batched[i].get_output(0) ==
+                                Approx(scalar[i].get_output(0)).margin(1e-5));
+                        batched[i].process_block();
+
+                        REQUIRE(batched[i].get_output(0) ==
+                                Approx(scalar[i].get_output(0)).margin(1e-5));
+                        REQUIRE(batched[i].getEnvState() == scalar[i].getEnvState());
+                        REQUIRE(batched[i].is_idle() == scalar[i].is_idle());
+                    }
+                }
+            }
+        }
+    }
+}
+
 TEST_CASE("Non-MPE Pitch Bend", "[mod]")
 {
     SECTION("Simple Bend Distances")
@@ -841,6 +987,167 @@ TEST_CASE("LFO Tempo Sync Drift in Latch Mode", "[mod]")
     }
 }
 
+TEST_CASE("LFO Rate Follows Modulation", "[mod]")
+{
+    auto surge = Surge::Headless::createSurge(44100);
+    REQUIRE(surge);
+
+    auto lfo = std::make_unique<LFOModulationSource>();
+    auto ss = std::make_unique<StepSequencerStorage>();
+    auto lfostorage = &(surge->storage.getPatch().scene[0].lfo[0]);
+    lfostorage->shape.val.i = lt_sine;
+
+    pdata localcopy[n_scene_params];
+    surge->storage.getPatch().copy_scenedata(localcopy, 0);
+    auto rid = lfostorage->rate.param_id_in_scene;
+
+    lfo->assign(&(surge->storage), lfostorage, localcopy, nullptr, ss.get(), nullptr, nullptr);
+    lfo->attack();
+    lfo->process_block();
+
+    // the phase increment is cached between blocks, so make sure each change to the rate
+    // (or to tempo sync) shows up on the very next block
+    for (auto sync : {false, true, false})
+    {
+        lfostorage->rate.temposync = sync;
+        for (auto r : {-2.f, -1.f, 0.5f, 0.5f, -1.f})
+        {
+            INFO("Rate " << r << " sync " << sync);
+            localcopy[rid].f = r;
+
+            double before = lfo->getIntPhase() + lfo->getPhase();
+            lfo->process_block();
+            double after = lfo->getIntPhase() + lfo->getPhase();
+
+            double expected = sync ? (double)BLOCK_SIZE_OS * surge->storage.dsamplerate_os_inv *
+                                         pow(2.0, r) * surge->storage.temposyncratio
+                                   : surge->storage.envelope_rate_linear_nowrap(-r);
+            REQUIRE(after - before == Approx(expected).margin(1e-6));
+        }
+    }
+}
+
+TEST_CASE("Voice LFO Bank Matches The Scalar LFO Path", "[mod]")
+{
+    auto surge = Surge::Headless::createSurge(44100);
+    REQUIRE(surge);
+
+    auto lfostorage = &(surge->storage.getPatch().scene[0].lfo[0]);
+    auto ss = std::make_unique<StepSequencerStorage>();
+    for (int i = 0; i < n_stepseqsteps; ++i)
+        ss->steps[i] = (i % 3) * 0.4f - 0.5f;
+
+    // five of each, so the bank has a part filled quad at the end
+    static constexpr int n = 5;
+    pdata localcopy[n][n_scene_params];
+    for (int i = 0; i < n; ++i)
+        surge->storage.getPatch().copy_scenedata(localcopy[i], 0);
+
+    auto rid = lfostorage->rate.param_id_in_scene;
+    auto sid = lfostorage->start_phase.param_id_in_scene;
+    auto did = lfostorage->deform.param_id_in_scene;
+
+    lfostorage->delay.deactivated = false;
+    for (auto *p : {&lfostorage->delay, &lfostorage->attack, &lfostorage->hold,
+                    &lfostorage->decay, &lfostorage->release})
+    {
+        for (int i = 0; i < n; ++i)
+            localcopy[i][p->param_id_in_scene].f = -3.f + 0.25f * i;
+    }
+
+    for (auto shape : {lt_sine, lt_tri, lt_square, lt_ramp, lt_noise, lt_snh, lt_envelope,
+                       lt_stepseq})
+    {
+        for (auto deform : {type_1, type_2, type_3})
+        {
+            lfostorage->shape.val.i = shape;
+            lfostorage->deform.deform_type = deform;
+            lfostorage->unipolar.val.b = (deform == type_2);
+
+            bool bankHasOutputs = shape == lt_sine || shape == lt_tri || shape == lt_square ||
+                                  shape == lt_ramp || (shape == lt_envelope && deform != type_3);
+
+            LFOModulationSource scalar[n], batched[n];
+            VoiceLFOBank bank;
+
+            for (int i = 0; i < n; ++i)
+            {
+                for (auto *l : {&scalar[i], &batched[i]})
+                {
+                    l->assign(&(surge->storage), lfostorage, localcopy[i], nullptr, ss.get(),
+                              nullptr, nullptr, true);
+
+                    // the last one restarts from where it was, which the bank leaves to the LFO
+                    if (i == n - 1)
+                    {
+                        l->envRetrigMode = LFOModulationSource::FROM_LAST;
+                        l->attackFrom(0.3f);
+                    }
+                    else
+                    {
+                        l->attack();
+                    }
+                }
+            }
+
+            for (int b = 0; b < 300; ++b)
+            {
+                // sweep the rate, the step sequencer shuffle and the deform as we go
+                for (int i = 0; i < n; ++i)
+                {
+                    localcopy[i][rid].f = -2.f + 9.f * b / 300.f + 0.1f * i;
+                    localcopy[i][sid].f = (b % 50) / 50.f - 0.5f;
+                    localcopy[i][did].f = ((b + 37 * i) % 100) / 50.f - 1.f;
+                }
+
+                if (b == 220)
+                {
+                    for (int i = 0; i < n; ++i)
+                    {
+                        scalar[i].release();
+                        batched[i].release();
+                    }
+                }
+
+                bank.clear();
+                for (int i = 0; i < n; ++i)
+                    bank.add(0, &batched[i]);
+                bank.process();
+
+                for (int i = 0; i < n; ++i)
+                {
+                    INFO("Shape " << shape << " deform " << deform << " block " << b << " lfo "
+                                  << i);
+                    scalar[i].process_block();
+                    batched[i].process_block();
+
+                    /*
+                     * The lanes do the scalar arithmetic step for step, but a compiler which
+                     * fuses multiplies and adds in the scalar code can move the last bit
+                     */
+                    REQUIRE(batched[i].getPhase() == Approx(scalar[i].getPhase()).margin(1e-5));
+                    REQUIRE(batched[i].getIntPhase() == scalar[i].getIntPhase());
+                    REQUIRE(batched[i].getStep() == scalar[i].getStep());
+                    REQUIRE(batched[i].getEnvState() == scalar[i].getEnvState());
+                    REQUIRE(batched[i].env_val == Approx(scalar[i].env_val).margin(1e-5));
+                    for (int o = 0; o < 3; ++o)
+                        REQUIRE(batched[i].get_output(o) ==
+                                Approx(scalar[i].get_output(o)).margin(1e-5));
+
+                    auto fromBank = batched[i].outputsFromBank();
+                    REQUIRE((fromBank != nullptr) == (bankHasOutputs && i != n - 1));
+                    if (fromBank)
+                    {
+                        for (int o = 0; o < 3; ++o)
+                            REQUIRE(fromBank[o * VoiceLFOBank::outputStride] ==
+                                    batched[i].get_output(o));
+                    }
+                }
+            }
+        }
+    }
+}
+
 TEST_CASE("MIDI Controller Smoothing", "[mod]")
 {
     SECTION("Legacy Mode")
@@ -1431,4 +1738,105 @@ TEST_CASE("Mod LFO Is Well Behaved", "[mod]")
             }
         }
     }
-}
\ No newline at end of file
+}
+TEST_CASE("Audio Thread Modulation Routing Snapshot", "[mod]")
+{
+    auto surge = Surge::Headless::createSurge(48000);
+    REQUIRE(surge);
+
+    auto &cutoff = surge->storage.getPatch().scene[0].filterunit[0].cutoff;
+    auto &storage = surge->storage;
+
+    for (int i = 0; i < 10; ++i)
+        surge->process();
+
+    auto voiceRoutes = storage.audioModulationRouting().voice[0].size();
+    auto sceneRoutes = storage.audioModulationRouting().scene[0].size();
+
+    SECTION("Edits Reach The Audio Thread On The Next Block")
+    {
+        REQUIRE(surge->setModDepth01(cutoff.id, ms_lfo1, 0, 0, 0.3));
+        REQUIRE(surge->setModDepth01(cutoff.id, ms_ctrl1, 0, 0, 0.2));
+
+        // nothing changes until the audio thread picks the snapshot up
+        REQUIRE(storage.audioModulationRouting().voice[0].size() == voiceRoutes);
+
+        surge->process();
+        REQUIRE(storage.audioModulationRouting().voice[0].size() == voiceRoutes + 1);
+        REQUIRE(storage.audioModulationRouting().scene[0].size() == sceneRoutes + 1);
+
+        surge->clearModulation(cutoff.id, ms_lfo1, 0, 0);
+        surge->process();
+        REQUIRE(storage.audioModulationRouting().voice[0].size() == voiceRoutes);
+        REQUIRE(storage.audioModulationRouting().scene[0].size() == sceneRoutes + 1);
+    }
+
+    SECTION("Many Edits Between Blocks Keep Only The Latest")
+    {
+        for (int i = 1; i <= 20; ++i)
+        {
+            REQUIRE(surge->setModDepth01(cutoff.id, ms_lfo1, 0, 0, 0.01 * i));
+        }
+
+        surge->process();
+        REQUIRE(storage.audioModulationRouting().voice[0].size() == voiceRoutes + 1);
+        REQUIRE(storage.audioModulationRouting().voice[0].back().depth ==
+                surge->storage.getPatch().scene[0].modulation_voice.back().depth);
+    }
+
+    SECTION("Meta Controller Swaps Land With Their Routing")
+    {
+        auto &patch = storage.getPatch();
+        REQUIRE(surge->setModDepth01(cutoff.id, ms_ctrl1, 0, 0, 0.2));
+        surge->process();
+
+        auto first = patch.scene[0].modsources[ms_ctrl1];
+        auto second = patch.scene[0].modsources[ms_ctrl2];
+        auto third = patch.scene[0].modsources[ms_ctrl3];
+
+        // as if a host were running us, so the swap waits for the next block
+        surge->audio_processing_active = true;
+        surge->swapMetaControllers(0, 1);
+        surge->swapMetaControllers(1, 2);
+        REQUIRE(patch.scene[0].modsources[ms_ctrl1] == first);
+
+        surge->process();
+        surge->audio_processing_active = false;
+
+        for (int sc = 0; sc < n_scenes; ++sc)
+        {
+            REQUIRE(patch.scene[sc].modsources[ms_ctrl1] == second);
+            REQUIRE(patch.scene[sc].modsources[ms_ctrl2] == third);
+            REQUIRE(patch.scene[sc].modsources[ms_ctrl3] == first);
+        }
+        REQUIRE(storage.audioModulationRouting().scene[0].back().source_id == ms_ctrl3);
+    }
+
+    SECTION("A Patch Loaded On The Audio Thread Gets Its Routing From The Loader")
+    {
+        auto src = Surge::Headless::createSurge(48000);
+        REQUIRE(src);
+        auto &srcCutoff = src->storage.getPatch().scene[0].filterunit[0].cutoff;
+        REQUIRE(src->setModDepth01(srcCutoff.id, ms_lfo1, 0, 0, 0.3));
+
+        void *d = nullptr;
+        auto sz = src->saveRaw(&d);
+        surge->enqueuePatchForLoad(d, sz);
+
+        bool arrived = false;
+        for (int i = 0; i < 200 && !arrived; ++i)
+        {
+            surge->process();
+
+            auto &routed = storage.audioModulationRouting().voice[0];
+            auto &edited = storage.getPatch().scene[0].modulation_voice;
+            arrived = !routed.empty() && routed.size() == edited.size() &&
+                      routed.back().source_id == ms_lfo1 &&
+                      routed.back().destination_id == edited.back().destination_id;
+            if (!arrived)
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+
+        REQUIRE(arrived);
+    }
+}
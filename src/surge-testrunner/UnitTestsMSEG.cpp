@@ -542,6 +542,58 @@ TEST_CASE("Zero Size Loops", "[mseg]")
     }
 }
 
+TEST_CASE("Segment Lookup Matches A Walk", "[mseg]")
+{
+    srand(1842);
+    for (int trial = 0; trial < 100; ++trial)
+    {
+        MSEGStorage ms;
+        ms.n_activeSegments = 2 + rand() % 20;
+        ms.loopMode = (trial % 2) ? MSEGStorage::LoopMode::LOOP : MSEGStorage::LoopMode::ONESHOT;
+        ms.endpointMode = MSEGStorage::EndpointMode::FREE;
+        for (int i = 0; i < ms.n_activeSegments; ++i)
+        {
+            // a few zero length segments, which the lookup has to skip just like the walk
+            ms.segments[i].duration = (rand() % 5 == 0) ? 0.f : (rand() % 100 + 1) / 100.f;
+            ms.segments[i].type = MSEGStorage::segment::LINEAR;
+            ms.segments[i].v0 = (rand() % 200 - 100) / 100.f;
+        }
+        ms.loop_start = rand() % ms.n_activeSegments;
+        ms.loop_end = ms.loop_start + rand() % (ms.n_activeSegments - ms.loop_start);
+        resetCP(&ms);
+        Surge::MSEG::rebuildCache(&ms);
+
+        auto walk = [&ms](double t, bool inclusive) {
+            for (int i = 0; i < ms.n_activeSegments; ++i)
+                if (t >= ms.segmentStart[i] &&
+                    (inclusive ? t <= ms.segmentEnd[i] : t < ms.segmentEnd[i]))
+                    return i;
+            return -1;
+        };
+
+        for (int s = 0; s < 500; ++s)
+        {
+            double t = ms.totalDuration * s / 499.0;
+            if (s % 7 == 0)
+                t = ms.segmentStart[s % ms.n_activeSegments];
+
+            float along = -1;
+            auto idx = Surge::MSEG::timeToSegment(&ms, t, true, along);
+            auto widx = walk(t >= ms.totalDuration ? t - ms.totalDuration : t, false);
+            REQUIRE(idx == widx);
+            if (idx >= 0)
+                REQUIRE(along == Approx(std::fmod(t, ms.totalDuration) - ms.segmentStart[idx]));
+
+            if (t <= ms.durationToLoopEnd)
+            {
+                idx = Surge::MSEG::timeToSegment(&ms, t, false, along);
+                widx = walk(t, true);
+                REQUIRE(idx == (widx < 0 ? 0 : widx));
+            }
+        }
+    }
+}
+
 /*
  * Tests to add
  * - loop point 0 (start = end + 1)
@@ -73,3 +73,120 @@ TEST_CASE("Param String Inversion", "[param]")
 #endif
     }
 }
+
+TEST_CASE("Changed Parameters Reach Scene And Global Data", "[param]")
+{
+    auto surge = Surge::Headless::createSurge(48000);
+    REQUIRE(surge);
+
+    auto &patch = surge->storage.getPatch();
+    auto sceneSlot = [&patch](const Parameter &p) -> pdata & {
+        return patch.scenedata[0][p.id - patch.scene_start[0]];
+    };
+
+    for (int i = 0; i < 10; ++i)
+        surge->process();
+
+    SECTION("Setters Are Copied The Next Block")
+    {
+        auto &cutoff = patch.scene[0].filterunit[0].cutoff;
+        SurgeSynthesizer::ID rid;
+        REQUIRE(surge->fromSynthSideId(cutoff.id, rid));
+        surge->setParameter01(rid, 0.27, false, false);
+        surge->process();
+        REQUIRE(sceneSlot(cutoff).f == cutoff.val.f);
+
+        auto &vol = patch.volume;
+        vol.set_value_f01(0.31);
+        surge->process();
+        REQUIRE(patch.globaldata[vol.id].f == vol.val.f);
+    }
+
+    SECTION("Marked Direct Writes Are Copied The Next Block")
+    {
+        auto &pitch = patch.scene[0].osc[0].pitch;
+        pitch.val.f = 3.5f;
+        pitch.markChanged();
+        surge->process();
+
+        REQUIRE(sceneSlot(pitch).f == 3.5f);
+    }
+
+    SECTION("Unmarked Direct Writes Are Picked Up By The Sweep")
+    {
+        auto &pitch = patch.scene[0].osc[0].pitch;
+        pitch.val.f = 2.5f;
+
+        int sweepBlocks = (n_global_params + n_scenes * n_scene_params) /
+                              SurgePatch::parameterSweepPerBlock +
+                          1;
+        for (int i = 0; i < sweepBlocks; ++i)
+            surge->process();
+
+        REQUIRE(sceneSlot(pitch).f == 2.5f);
+    }
+
+    SECTION("Clamping When A Range Shrinks Is Copied")
+    {
+        auto &p = patch.fx[0].p[0];
+        p.set_type(ct_pitch_extendable_very_low_minval);
+        p.set_extend_range(true);
+        p.val.f = -100.f;
+        p.markChanged();
+        surge->process();
+        REQUIRE(patch.globaldata[p.id].f == -100.f);
+
+        p.set_extend_range(false);
+        surge->process();
+
+        REQUIRE(p.val.f == -60.f);
+        REQUIRE(patch.globaldata[p.id].f == -60.f);
+    }
+
+    SECTION("Queued Oscillator Settings Are Copied")
+    {
+        auto &osc = patch.scene[0].osc[0];
+        REQUIRE(osc.p[0].valtype == vt_float);
+
+        TiXmlElement e("osc");
+        e.SetDoubleAttribute("p0", 0.42);
+        osc.queue_xmldata = &e;
+
+        for (int i = 0; i < 2; ++i)
+            surge->process();
+
+        REQUIRE(osc.queue_xmldata == nullptr);
+        REQUIRE(osc.p[0].val.f == Approx(0.42f));
+        REQUIRE(sceneSlot(osc.p[0]).f == osc.p[0].val.f);
+    }
+
+    SECTION("Monophonic Modulation Does Not Accumulate")
+    {
+        auto &pitch = patch.scene[0].osc[0].pitch;
+        pitch.val.f = 0.f;
+        surge->applyParameterMonophonicModulation(&pitch, 0.1);
+
+        for (int i = 0; i < 100; ++i)
+            surge->process();
+
+        auto expected = 0.1 * (pitch.val_max.f - pitch.val_min.f);
+        REQUIRE(sceneSlot(pitch).f == Approx(expected).margin(1e-5));
+    }
+
+    SECTION("Routed Modulation Does Not Accumulate")
+    {
+        auto &pitch = patch.scene[0].osc[0].pitch;
+        pitch.val.f = 0.f;
+        REQUIRE(surge->setModDepth01(pitch.id, ms_ctrl1, 0, 0, 0.1));
+        surge->setMacroParameter01(0, 1.f);
+
+        for (int i = 0; i < 200; ++i)
+            surge->process();
+        auto settled = sceneSlot(pitch).f;
+        REQUIRE(settled != 0.f);
+
+        for (int i = 0; i < 200; ++i)
+            surge->process();
+        REQUIRE(sceneSlot(pitch).f == Approx(settled).margin(1e-5));
+    }
+}
@@ -460,10 +460,13 @@ TEST_CASE("An Octave Is an Octave", "[tun]")
     {
         auto f60 = frequencyForNote(surge, 60);
         surge->storage.getPatch().scene[0].osc[0].octave.val.i = -1;
+        surge->storage.getPatch().scene[0].osc[0].octave.markChanged();
         auto f60m1 = frequencyForNote(surge, 60);
         surge->storage.getPatch().scene[0].osc[0].octave.val.i = 1;
+        surge->storage.getPatch().scene[0].osc[0].octave.markChanged();
         auto f60p1 = frequencyForNote(surge, 60);
         surge->storage.getPatch().scene[0].osc[0].octave.val.i = 0;
+        surge->storage.getPatch().scene[0].osc[0].octave.markChanged();
         auto f60z = frequencyForNote(surge, 60);
         REQUIRE(f60 == Approx(f60z).margin(0.1));
         REQUIRE(f60 == Approx(f60m1 * 2).margin(0.1));
@@ -474,10 +477,13 @@ TEST_CASE("An Octave Is an Octave", "[tun]")
     {
         auto f60 = frequencyForNote(surge, 60);
         surge->storage.getPatch().scene[0].octave.val.i = -1;
+        surge->storage.getPatch().scene[0].octave.markChanged();
         auto f60m1 = frequencyForNote(surge, 60);
         surge->storage.getPatch().scene[0].octave.val.i = 1;
+        surge->storage.getPatch().scene[0].octave.markChanged();
         auto f60p1 = frequencyForNote(surge, 60);
         surge->storage.getPatch().scene[0].octave.val.i = 0;
+        surge->storage.getPatch().scene[0].octave.markChanged();
         auto f60z = frequencyForNote(surge, 60);
         REQUIRE(f60 == Approx(f60z).margin(0.1));
         REQUIRE(f60 == Approx(f60m1 * 2).margin(0.1));
@@ -491,10 +497,13 @@ TEST_CASE("An Octave Is an Octave", "[tun]")
 
         auto f60 = frequencyForNote(surge, 60);
         surge->storage.getPatch().scene[0].osc[0].octave.val.i = -1;
+        surge->storage.getPatch().scene[0].osc[0].octave.markChanged();
         auto f60m1 = frequencyForNote(surge, 60);
         surge->storage.getPatch().scene[0].osc[0].octave.val.i = 1;
+        surge->storage.getPatch().scene[0].osc[0].octave.markChanged();
         auto f60p1 = frequencyForNote(surge, 60);
         surge->storage.getPatch().scene[0].osc[0].octave.val.i = 0;
+        surge->storage.getPatch().scene[0].osc[0].octave.markChanged();
         auto f60z = frequencyForNote(surge, 60);
         REQUIRE(f60 == Approx(f60z).margin(0.1));
         REQUIRE(f60 == Approx(f60m1 * 2).margin(0.1));
@@ -508,10 +517,13 @@ TEST_CASE("An Octave Is an Octave", "[tun]")
 
         auto f60 = frequencyForNote(surge, 60);
         surge->storage.getPatch().scene[0].octave.val.i = -1;
+        surge->storage.getPatch().scene[0].octave.markChanged();
         auto f60m1 = frequencyForNote(surge, 60);
         surge->storage.getPatch().scene[0].octave.val.i = 1;
+        surge->storage.getPatch().scene[0].octave.markChanged();
         auto f60p1 = frequencyForNote(surge, 60);
         surge->storage.getPatch().scene[0].octave.val.i = 0;
+        surge->storage.getPatch().scene[0].octave.markChanged();
         auto f60z = frequencyForNote(surge, 60);
         REQUIRE(f60 == Approx(f60z).margin(0.1));
         REQUIRE(f60 == Approx(f60m1 * 2).margin(0.1));
@@ -526,10 +538,13 @@ TEST_CASE("An Octave Is an Octave", "[tun]")
 
         auto f60 = frequencyForNote(surge, 60);
         surge->storage.getPatch().scene[0].osc[0].octave.val.i = -1;
+        surge->storage.getPatch().scene[0].osc[0].octave.markChanged();
         auto f60m1 = frequencyForNote(surge, 60);
         surge->storage.getPatch().scene[0].osc[0].octave.val.i = 1;
+        surge->storage.getPatch().scene[0].osc[0].octave.markChanged();
         auto f60p1 = frequencyForNote(surge, 60);
         surge->storage.getPatch().scene[0].osc[0].octave.val.i = 0;
+        surge->storage.getPatch().scene[0].osc[0].octave.markChanged();
         auto f60z = frequencyForNote(surge, 60);
         REQUIRE(f60 == Approx(f60z).margin(0.1));
         REQUIRE(f60 == Approx(f60m1 * 2).margin(0.1));
@@ -544,10 +559,13 @@ TEST_CASE("An Octave Is an Octave", "[tun]")
 
         auto f60 = frequencyForNote(surge, 60);
         surge->storage.getPatch().scene[0].octave.val.i = -1;
+        surge->storage.getPatch().scene[0].octave.markChanged();
         auto f60m1 = frequencyForNote(surge, 60);
         surge->storage.getPatch().scene[0].octave.val.i = 1;
+        surge->storage.getPatch().scene[0].octave.markChanged();
         auto f60p1 = frequencyForNote(surge, 60);
         surge->storage.getPatch().scene[0].octave.val.i = 0;
+        surge->storage.getPatch().scene[0].octave.markChanged();
         auto f60z = frequencyForNote(surge, 60);
         REQUIRE(f60 == Approx(f60z).margin(0.1));
         REQUIRE(f60 == Approx(f60m1 * 2).margin(0.1));
@@ -562,10 +580,13 @@ TEST_CASE("An Octave Is an Octave", "[tun]")
 
         auto f60 = frequencyForNote(surge, 60);
         surge->storage.getPatch().scene[0].osc[0].octave.val.i = -1;
+        surge->storage.getPatch().scene[0].osc[0].octave.markChanged();
         auto f60m1 = frequencyForNote(surge, 60);
         surge->storage.getPatch().scene[0].osc[0].octave.val.i = 1;
+        surge->storage.getPatch().scene[0].osc[0].octave.markChanged();
         auto f60p1 = frequencyForNote(surge, 60);
         surge->storage.getPatch().scene[0].osc[0].octave.val.i = 0;
+        surge->storage.getPatch().scene[0].osc[0].octave.markChanged();
         auto f60z = frequencyForNote(surge, 60);
         REQUIRE(f60 == Approx(f60z).margin(0.1));
         REQUIRE(f60 == Approx(f60m1 * 2).margin(0.1));
@@ -580,10 +601,13 @@ TEST_CASE("An Octave Is an Octave", "[tun]")
 
         auto f60 = frequencyForNote(surge, 60);
         surge->storage.getPatch().scene[0].octave.val.i = -1;
+        surge->storage.getPatch().scene[0].octave.markChanged();
         auto f60m1 = frequencyForNote(surge, 60);
         surge->storage.getPatch().scene[0].octave.val.i = 1;
+        surge->storage.getPatch().scene[0].octave.markChanged();
         auto f60p1 = frequencyForNote(surge, 60);
         surge->storage.getPatch().scene[0].octave.val.i = 0;
+        surge->storage.getPatch().scene[0].octave.markChanged();
         auto f60z = frequencyForNote(surge, 60);
         REQUIRE(f60 == Approx(f60z).margin(0.1));
         REQUIRE(f60 == Approx(f60m1 * 2).margin(0.1));
@@ -327,3 +327,388 @@ TEST_CASE("Play and release Frequency and Note ID", "[voice]")
         }
     }
 }
+
+TEST_CASE("Parallel Scene Rendering Matches Serial", "[voice]")
+{
+    auto serial = surgeOnSaw();
+    auto parallel = surgeOnSaw();
+
+    for (auto &s : {serial, parallel})
+    {
+        s->storage.getPatch().scenemode.val.i = sm_dual;
+        s->storage.getPatch().scene[1].filterunit[0].type.val.i =
+            sst::filters::FilterType::fut_lp24;
+        s->storage.rngGen.g.seed(8675309);
+
+        // noise and drift have the voices draw random numbers every block
+        for (auto &sc : s->storage.getPatch().scene)
+        {
+            sc.mute_noise.val.b = false;
+            sc.level_noise.val.f = 0.5f;
+            sc.drift.val.f = 1.f;
+        }
+    }
+    parallel->setRenderScenesInParallel(true);
+    REQUIRE(parallel->canRenderScenesInParallel());
+
+    for (int i = 0; i < 10; ++i)
+    {
+        serial->process();
+        parallel->process();
+    }
+
+    for (auto &s : {serial, parallel})
+    {
+        s->playNote(0, 60, 127, 0);
+        s->playNote(0, 64, 100, 0);
+        s->playNote(0, 67, 80, 0);
+    }
+
+    for (int blk = 0; blk < 500; ++blk)
+    {
+        if (blk == 300)
+        {
+            for (auto &s : {serial, parallel})
+            {
+                s->releaseNote(0, 64, 0);
+            }
+        }
+
+        serial->process();
+        parallel->process();
+
+        REQUIRE(serial->polydisplay == parallel->polydisplay);
+
+        for (int c = 0; c < N_OUTPUTS; ++c)
+        {
+            for (int i = 0; i < BLOCK_SIZE; ++i)
+            {
+                INFO("Block " << blk << " channel " << c << " sample " << i);
+                REQUIRE(serial->output[c][i] == parallel->output[c][i]);
+            }
+        }
+    }
+}
+
+TEST_CASE("Pooled Voice Rendering Matches Serial", "[voice]")
+{
+    auto serial = surgeOnSaw();
+    auto pooled = surgeOnSaw();
+
+    for (auto &s : {serial, pooled})
+    {
+        s->storage.getPatch().scene[0].filterunit[0].type.val.i =
+            sst::filters::FilterType::fut_lp24;
+        s->storage.rngGen.g.seed(8675309);
+
+        auto &sc = s->storage.getPatch().scene[0];
+        sc.mute_noise.val.b = false;
+        sc.level_noise.val.f = 0.5f;
+        sc.drift.val.f = 1.f;
+    }
+    pooled->setVoiceRenderThreads(2);
+    REQUIRE(pooled->voiceRenderThreads > 0);
+
+    for (int i = 0; i < 10; ++i)
+    {
+        serial->process();
+        pooled->process();
+    }
+
+    // 13 voices gives us three full chunks and a partial one
+    for (auto &s : {serial, pooled})
+    {
+        for (int k = 0; k < 13; ++k)
+        {
+            s->playNote(0, 48 + 2 * k, 60 + 4 * k, 0);
+        }
+    }
+
+    for (int blk = 0; blk < 500; ++blk)
+    {
+        if (blk == 200)
+        {
+            for (auto &s : {serial, pooled})
+            {
+                for (int k = 0; k < 13; k += 3)
+                {
+                    s->releaseNote(0, 48 + 2 * k, 0);
+                }
+            }
+        }
+
+        serial->process();
+        pooled->process();
+
+        REQUIRE(serial->polydisplay == pooled->polydisplay);
+
+        for (int c = 0; c < N_OUTPUTS; ++c)
+        {
+            for (int i = 0; i < BLOCK_SIZE; ++i)
+            {
+                INFO("Block " << blk << " channel " << c << " sample " << i);
+                REQUIRE(serial->output[c][i] == pooled->output[c][i]);
+            }
+        }
+    }
+}
+
+TEST_CASE("Note Onset Offset Within A Block", "[voice]")
+{
+    auto firstSound = [](int offset) {
+        auto s = surgeOnSine();
+        for (int i = 0; i < 5; ++i)
+            s->process();
+
+        s->noteOnsetOffset = offset;
+        s->playNote(0, 60, 127, 0);
+        s->noteOnsetOffset = 0;
+        s->process();
+
+        for (int i = 0; i < BLOCK_SIZE; ++i)
+            if (s->output[0][i] != 0.f)
+                return i;
+
+        return BLOCK_SIZE;
+    };
+
+    auto onTheBlock = firstSound(0);
+    REQUIRE(onTheBlock < BLOCK_SIZE / 2);
+
+    for (auto offset : {1, 7, BLOCK_SIZE / 2})
+    {
+        INFO("Onset offset " << offset);
+        REQUIRE(firstSound(offset) >= offset);
+        REQUIRE(firstSound(offset) < BLOCK_SIZE);
+    }
+
+    // The oscillators render the same blocks as an on-the-block voice's; what goes into the
+    // filter lanes runs behind by the offset, with the end of each block carried to the next
+    auto preFilter = [](int offset, int blocks, std::vector<float> &tails) {
+        auto s = surgeOnSine();
+        for (int i = 0; i < 5; ++i)
+            s->process();
+
+        s->noteOnsetOffset = offset;
+        s->playNote(0, 60, 127, 0);
+        s->noteOnsetOffset = 0;
+
+        std::vector<float> res;
+        for (int b = 0; b < blocks; ++b)
+        {
+            s->process();
+            auto *v = s->voices[0].front();
+            res.insert(res.end(), v->output[0], v->output[0] + BLOCK_SIZE_OS);
+            tails.insert(tails.end(), v->onsetTail[0], v->onsetTail[0] + offset * OSC_OVERSAMPLING);
+        }
+        return res;
+    };
+
+    std::vector<float> noTails;
+    auto onBlock = preFilter(0, 3, noTails);
+    REQUIRE(noTails.empty());
+
+    for (auto offset : {1, 7, BLOCK_SIZE / 2})
+    {
+        INFO("Onset offset " << offset);
+        std::vector<float> tails;
+        auto late = preFilter(offset, 3, tails);
+        auto shift = offset * OSC_OVERSAMPLING;
+
+        REQUIRE(late == onBlock);
+
+        for (int b = 0; b < 3; ++b)
+            for (int i = 0; i < shift; ++i)
+                REQUIRE(tails[b * shift + i] == late[(b + 1) * BLOCK_SIZE_OS - shift + i]);
+    }
+}
+
+TEST_CASE("Note Onset Offset Moves The Voice Modulators Too", "[voice]")
+{
+    // a slow attack and a slow LFO1, both still rising over the blocks we look at
+    auto run = [](int offset, bool mono, int blocks) {
+        auto s = surgeOnSine();
+        auto &sc = s->storage.getPatch().scene[0];
+        sc.adsr[0].a.val.f = 0.f;
+        sc.adsr[0].a.markChanged();
+        sc.lfo[0].rate.val.f = -3.f;
+        sc.lfo[0].rate.markChanged();
+        sc.lfo[0].start_phase.val.f = 0.f;
+        sc.lfo[0].start_phase.markChanged();
+        sc.lfo[0].trigmode.val.i = lm_keytrigger;
+        sc.lfo[0].trigmode.markChanged();
+        if (mono)
+        {
+            sc.polymode.val.i = pm_mono;
+            sc.polymode.markChanged();
+        }
+
+        for (int i = 0; i < 5; ++i)
+            s->process();
+
+        s->noteOnsetOffset = offset;
+        s->playNote(0, 60, 127, 0);
+        s->noteOnsetOffset = 0;
+
+        for (int b = 0; b < blocks; ++b)
+            s->process();
+
+        auto *v = s->voices[0].front();
+        REQUIRE(v->onsetDelay == offset);
+        return std::make_pair(v->modsources[ms_ampeg]->get_output(0),
+                              v->modsources[ms_lfo1]->get_output(0));
+    };
+
+    for (auto mono : {false, true})
+    {
+        for (auto offset : {7, BLOCK_SIZE / 2})
+        {
+            INFO("Onset offset " << offset << (mono ? " mono" : " poly"));
+
+            for (int blocks = 2; blocks < 5; ++blocks)
+            {
+                auto late = run(offset, mono, blocks);
+                auto ahead = run(0, mono, blocks);
+                auto behind = run(0, mono, blocks - 1);
+
+                REQUIRE(late.first < ahead.first);
+                REQUIRE(late.first > behind.first);
+                REQUIRE(late.second < ahead.second);
+                REQUIRE(late.second > behind.second);
+            }
+        }
+    }
+}
+
+TEST_CASE("Active Voice Table", "[voice]")
+{
+    // The table only reads the key, channel and note id of its voices, so any voices will do
+    auto s = surgeOnSine();
+    auto *vs = s->voices_array[1].data();
+
+    for (int i = 0; i < MAX_VOICES; ++i)
+    {
+        vs[i].state.channel = i % 3;
+        vs[i].state.key = 60 + i % 5;
+        vs[i].host_note_id = i % 7;
+    }
+
+    ActiveVoiceTable table;
+    std::vector<SurgeVoice *> model;
+
+    auto matches = [&]() {
+        REQUIRE(table.size() == model.size());
+        REQUIRE(std::equal(table.begin(), table.end(), model.begin(), model.end()));
+
+        for (int ch = 0; ch < 4; ++ch)
+        {
+            for (int key = 59; key < 66; ++key)
+            {
+                std::vector<SurgeVoice *> found, expected;
+                table.forEachWithNote(ch, key, [&](SurgeVoice *v) { found.push_back(v); });
+                for (auto *v : model)
+                    if (v->state.channel == ch && v->state.key == key)
+                        expected.push_back(v);
+                REQUIRE(found == expected);
+            }
+        }
+
+        for (int id = 0; id < 8; ++id)
+        {
+            REQUIRE(table.countWithHostNoteId(id) ==
+                    std::count_if(model.begin(), model.end(),
+                                  [id](auto *v) { return v->host_note_id == id; }));
+        }
+    };
+
+    srand(4432);
+    for (int step = 0; step < 2000; ++step)
+    {
+        auto r = rand() % 10;
+        if (r < 4 && model.size() < MAX_VOICES)
+        {
+            // add a voice not yet in the table
+            auto *v = &vs[rand() % MAX_VOICES];
+            if (!table.contains(v))
+            {
+                table.push_back(v);
+                model.push_back(v);
+            }
+        }
+        else if (r < 8 && !model.empty())
+        {
+            auto idx = rand() % model.size();
+            table.erase(table.begin() + idx);
+            model.erase(model.begin() + idx);
+        }
+        else if (!model.empty())
+        {
+            // as legato or reclaiming a voice would
+            auto *v = model[rand() % model.size()];
+            v->state.channel = rand() % 3;
+            v->state.key = 60 + rand() % 5;
+            v->host_note_id = rand() % 7;
+            table.updateNote(v);
+        }
+
+        if (step % 500 == 499)
+        {
+            table.clear();
+            model.clear();
+        }
+
+        matches();
+    }
+}
+
+TEST_CASE("Release Finds Voices By Channel And Key", "[voice]")
+{
+    auto s = surgeOnSine();
+
+    auto gated = [&s](int channel, int key) {
+        int res{0};
+        for (auto *v : s->voices[0])
+            res += v->state.gate && v->state.channel == channel && v->state.key == key;
+        return res;
+    };
+
+    for (auto ch : {0, 1})
+        for (auto key : {60, 64, 67})
+            s->playNote(ch, key, 100, 0);
+    for (int i = 0; i < 5; ++i)
+        s->process();
+
+    s->releaseNote(0, 64, 0);
+    s->chokeNote(1, 60, 0, -1);
+    for (int i = 0; i < 5; ++i)
+        s->process();
+
+    REQUIRE(gated(0, 60) == 1);
+    REQUIRE(gated(0, 64) == 0);
+    REQUIRE(gated(0, 67) == 1);
+    REQUIRE(gated(1, 60) == 0);
+    REQUIRE(gated(1, 64) == 1);
+    REQUIRE(gated(1, 67) == 1);
+
+    // mono legato moves the voice to the new key, and releasing that key has to find it
+    s->storage.getPatch().scene[0].polymode.val.i = pm_mono;
+    s->allNotesOff();
+    for (int i = 0; i < 20; ++i)
+        s->process();
+
+    s->playNote(0, 60, 100, 0);
+    s->playNote(0, 62, 100, 0);
+    for (int i = 0; i < 5; ++i)
+        s->process();
+    REQUIRE(gated(0, 62) == 1);
+
+    s->releaseNote(0, 62, 90);
+    s->releaseNote(0, 60, 80);
+    for (int i = 0; i < 5; ++i)
+        s->process();
+
+    int stillGated{0};
+    for (auto *v : s->voices[0])
+        stillGated += v->state.gate;
+    REQUIRE(stillGated == 0);
+}
@@ -565,7 +565,18 @@ void SurgeSynthProcessor::processBlock(juce::AudioBuffer<float> &buffer,
         inputIsLatent = true;
     }
 
-    for (int i = 0; i < buffer.getNumSamples(); i++)
+    /*
+     * Walk the host buffer in runs which end at the next engine block boundary, the next MIDI
+     * event or the end of the buffer, and move each run with whole-run copies. With no MIDI
+     * and a host buffer that is a multiple of BLOCK_SIZE this is one process() and a memcpy
+     * per output channel per block.
+     */
+    const int numSamples = buffer.getNumSamples();
+    const bool sceneAOut = sceneAOutput.getNumChannels() == 2;
+    const bool sceneBOut = sceneBOutput.getNumChannels() == 2;
+    int i = 0;
+
+    while (i < numSamples)
     {
         while (i == nextMidi)
         {
@@ -582,76 +593,109 @@ void SurgeSynthProcessor::processBlock(juce::AudioBuffer<float> &buffer,
             }
         }
 
-        auto outL = mainOutput.getWritePointer(0, i);
-        auto outR = mainOutput.getWritePointer(1, i);
-
-        if (blockPos == 0 && incL && incR)
+        if (blockPos == 0)
         {
-            surge->process_input = true;
+            if (surge->sampleAccurateNoteOnsets)
+            {
+                /*
+                 * Bring this block's note ons forward, each with its offset in the block. Stop
+                 * at the first other event so nothing changes order; it and whatever follows
+                 * it land at the next block boundary as usual.
+                 */
+                while (nextMidi >= 0 && nextMidi < i + BLOCK_SIZE &&
+                       (*midiIt).getMessage().isNoteOn())
+                {
+                    surge->noteOnsetOffset = nextMidi - i;
+                    applyMidi(*midiIt);
+                    midiIt++;
 
-            if (inputIsLatent)
+                    if (midiIt == midiMessages.cend())
+                    {
+                        nextMidi = -1;
+                    }
+                    else
+                    {
+                        nextMidi = (*midiIt).samplePosition;
+                    }
+                }
+
+                surge->noteOnsetOffset = 0;
+            }
+
+            if (incL && incR)
             {
-                memcpy(&(surge->input[0][0]), inputLatentBuffer[0], BLOCK_SIZE * sizeof(float));
-                memcpy(&(surge->input[1][0]), inputLatentBuffer[1], BLOCK_SIZE * sizeof(float));
+                surge->process_input = true;
+
+                if (inputIsLatent)
+                {
+                    memcpy(&(surge->input[0][0]), inputLatentBuffer[0],
+                           BLOCK_SIZE * sizeof(float));
+                    memcpy(&(surge->input[1][0]), inputLatentBuffer[1],
+                           BLOCK_SIZE * sizeof(float));
+                }
+                else
+                {
+                    memcpy(&(surge->input[0][0]), incL + i, BLOCK_SIZE * sizeof(float));
+                    memcpy(&(surge->input[1][0]), incR + i, BLOCK_SIZE * sizeof(float));
+                }
             }
             else
             {
-                auto inL = incL + i;
-                auto inR = incR + i;
-
-                memcpy(&(surge->input[0][0]), inL, BLOCK_SIZE * sizeof(float));
-                memcpy(&(surge->input[1][0]), inR, BLOCK_SIZE * sizeof(float));
+                surge->process_input = false;
             }
-        }
-        else
-        {
-            surge->process_input = false;
-        }
 
-        if (blockPos == 0)
-        {
             surge->process();
             surge->time_data.ppqPos +=
                 (double)BLOCK_SIZE * surge->time_data.tempo / (60. * surge->storage.samplerate);
         }
 
+        int run = std::min(BLOCK_SIZE - blockPos, numSamples - i);
+
+        if (nextMidi > i)
+        {
+            run = std::min(run, nextMidi - i);
+        }
+
+        const auto runBytes = run * sizeof(float);
+
         if (inputIsLatent && incL && incR)
         {
-            inputLatentBuffer[0][blockPos] = incL[i];
-            inputLatentBuffer[1][blockPos] = incR[i];
+            memcpy(&inputLatentBuffer[0][blockPos], incL + i, runBytes);
+            memcpy(&inputLatentBuffer[1][blockPos], incR + i, runBytes);
         }
 
-        *outL = surge->output[0][blockPos];
-        *outR = surge->output[1][blockPos];
+        memcpy(mainOutput.getWritePointer(0, i), &surge->output[0][blockPos], runBytes);
+        memcpy(mainOutput.getWritePointer(1, i), &surge->output[1][blockPos], runBytes);
 
         if (surge->activateExtraOutputs)
         {
-            if (sceneAOutput.getNumChannels() == 2)
+            if (sceneAOut)
             {
                 auto sAL = sceneAOutput.getWritePointer(0, i);
                 auto sAR = sceneAOutput.getWritePointer(1, i);
 
                 if (sAL && sAR)
                 {
-                    *sAL = surge->sceneout[0][0][blockPos];
-                    *sAR = surge->sceneout[0][1][blockPos];
+                    memcpy(sAL, &surge->sceneout[0][0][blockPos], runBytes);
+                    memcpy(sAR, &surge->sceneout[0][1][blockPos], runBytes);
                 }
             }
 
-            if (sceneBOutput.getNumChannels() == 2)
+            if (sceneBOut)
             {
                 auto sBL = sceneBOutput.getWritePointer(0, i);
                 auto sBR = sceneBOutput.getWritePointer(1, i);
 
                 if (sBL && sBR)
                 {
-                    *sBL = surge->sceneout[1][0][blockPos];
-                    *sBR = surge->sceneout[1][1][blockPos];
+                    memcpy(sBL, &surge->sceneout[1][0][blockPos], runBytes);
+                    memcpy(sBR, &surge->sceneout[1][1][blockPos], runBytes);
                 }
             }
         }
 
-        blockPos = (blockPos + 1) & (BLOCK_SIZE - 1);
+        i += run;
+        blockPos = (blockPos + run) & (BLOCK_SIZE - 1);
     }
 
     // This should, in theory, never happen, but better safe than sorry
@@ -850,6 +894,7 @@ void SurgeSynthProcessor::processBlockOSC()
                 newDisabledMask = curmask | msk;
             }
             surge->storage.getPatch().fx_disable.val.i = newDisabledMask;
+            surge->storage.getPatch().fx_disable.markChanged();
             if (surge->fx_suspend_bitmask != newDisabledMask)
             {
                 surge->fx_suspend_bitmask = newDisabledMask;
@@ -967,6 +1012,24 @@ void SurgeSynthProcessor::processBlockPostFunction()
 }
 
 #if HAS_CLAP_JUCE_EXTENSIONS
+// the events which start a voice, and so the only ones an onset offset applies to
+static bool isClapNoteOn(const clap_event_header_t *evt)
+{
+    if (evt->space_id != CLAP_CORE_EVENT_SPACE_ID)
+        return false;
+
+    if (evt->type == CLAP_EVENT_NOTE_ON)
+        return reinterpret_cast<const clap_event_note *>(evt)->velocity != 0;
+
+    if (evt->type == CLAP_EVENT_MIDI)
+    {
+        auto mevt = reinterpret_cast<const clap_event_midi *>(evt);
+        return (mevt->data[0] & 0xF0) == 0x90 && mevt->data[2] != 0;
+    }
+
+    return false;
+}
+
 clap_process_status SurgeSynthProcessor::clap_direct_process(const clap_process *process) noexcept
 {
     auto fpuguard = sst::plugininfra::cpufeatures::FPUStateGuard();
@@ -1031,7 +1094,10 @@ clap_process_status SurgeSynthProcessor::clap_direct_process(const clap_process
             haveSceneOut = false;
     }
 
-    for (int s = 0; s < process->frames_count; ++s)
+    const int frames = process->frames_count;
+    int s = 0;
+
+    while (s < frames)
     {
         if (blockPos == 0)
         {
@@ -1039,7 +1105,13 @@ clap_process_status SurgeSynthProcessor::clap_direct_process(const clap_process
             {
                 auto evt = ev->get(ev, currev);
 
+                if (surge->sampleAccurateNoteOnsets && isClapNoteOn(evt))
+                {
+                    surge->noteOnsetOffset = std::max((int)evt->time - s, 0);
+                }
+
                 process_clap_event(evt);
+                surge->noteOnsetOffset = 0;
 
                 currev++;
                 if (currev < evtsz)
@@ -1088,27 +1160,30 @@ clap_process_status SurgeSynthProcessor::clap_direct_process(const clap_process
                 }
             }
         }
-        *outL = surge->output[0][blockPos];
-        *outR = surge->output[1][blockPos];
-        outL++;
-        outR++;
+        // copy out up to the next block boundary in one go
+        const int run = std::min(BLOCK_SIZE - blockPos, frames - s);
+        const auto runBytes = run * sizeof(float);
+
+        memcpy(outL, &surge->output[0][blockPos], runBytes);
+        memcpy(outR, &surge->output[1][blockPos], runBytes);
+        outL += run;
+        outR += run;
 
         if (haveSceneOut)
         {
-            *sceneAL = surge->sceneout[0][0][blockPos];
-            *sceneAR = surge->sceneout[0][1][blockPos];
-            *sceneBL = surge->sceneout[1][0][blockPos];
-            *sceneBR = surge->sceneout[1][1][blockPos];
-
-            sceneAL++;
-            sceneAR++;
-            sceneBL++;
-            sceneBR++;
+            memcpy(sceneAL, &surge->sceneout[0][0][blockPos], runBytes);
+            memcpy(sceneAR, &surge->sceneout[0][1][blockPos], runBytes);
+            memcpy(sceneBL, &surge->sceneout[1][0][blockPos], runBytes);
+            memcpy(sceneBR, &surge->sceneout[1][1][blockPos], runBytes);
+
+            sceneAL += run;
+            sceneAR += run;
+            sceneBL += run;
+            sceneBR += run;
         }
 
-        // TO DO: Scene Output
-
-        blockPos = (blockPos + 1) & (BLOCK_SIZE - 1);
+        s += run;
+        blockPos = (blockPos + run) & (BLOCK_SIZE - 1);
     }
 
     // just in case
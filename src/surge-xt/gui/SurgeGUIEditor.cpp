@@ -4905,10 +4905,9 @@ bool SurgeGUIEditor::onDrop(const std::string &fname)
 
     if (fExt == ".wav" || fExt == ".wt")
     {
-        synth->storage.getPatch()
-            .scene[current_scene]
-            .osc[current_osc[current_scene]]
-            .wt.queue_filename = fname;
+        synth->storage.queue_wt_load(
+            &synth->storage.getPatch().scene[current_scene].osc[current_osc[current_scene]],
+            fname);
     }
     else if (fExt == ".scl")
     {
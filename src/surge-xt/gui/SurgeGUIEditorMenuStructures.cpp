@@ -1598,6 +1598,9 @@ juce::PopupMenu SurgeGUIEditor::makeDataMenu(const juce::Point<int> &where)
         this->synth->refresh_editor = true;
     });
 
+    dataSubMenu.addItem(Surge::GUI::toOSCase("Clear Wavetable Cache"),
+                        [this]() { this->synth->storage.clear_wavetable_cache(); });
+
     return dataSubMenu;
 }
 
@@ -1741,6 +1744,53 @@ juce::PopupMenu SurgeGUIEditor::makeMidiMenu(const juce::Point<int> &where)
     return midiSubMenu;
 }
 
+juce::PopupMenu SurgeGUIEditor::makeAudioEngineMenu(const juce::Point<int> &where)
+{
+    auto engineSubMenu = juce::PopupMenu();
+
+    bool parallelScenes = synth->renderScenesInParallel;
+
+    engineSubMenu.addItem(Surge::GUI::toOSCase("Render Scenes on Separate Threads"), true,
+                          parallelScenes, [this, parallelScenes]() {
+                              synth->setRenderScenesInParallel(!parallelScenes);
+                              Surge::Storage::updateUserDefaultValue(
+                                  &(this->synth->storage), Surge::Storage::RenderScenesInParallel,
+                                  !parallelScenes);
+                          });
+
+    auto threadsMenu = juce::PopupMenu();
+    int voiceThreads = synth->voiceRenderThreads;
+    int maxThreads = std::clamp((int)std::thread::hardware_concurrency() - 1, 1,
+                                SurgeSynthesizer::maxVoiceRenderThreads);
+
+    for (int i = 0; i <= maxThreads; ++i)
+    {
+        auto label = (i == 0) ? std::string("Off") : fmt::format("{}", i);
+
+        threadsMenu.addItem(label, true, (voiceThreads == i), [this, i]() {
+            synth->setVoiceRenderThreads(i);
+            Surge::Storage::updateUserDefaultValue(&(this->synth->storage),
+                                                   Surge::Storage::VoiceRenderThreads, i);
+        });
+    }
+
+    engineSubMenu.addSubMenu(Surge::GUI::toOSCase("Additional Voice Render Threads"), threadsMenu);
+
+    engineSubMenu.addSeparator();
+
+    bool accurateOnsets = synth->sampleAccurateNoteOnsets;
+
+    engineSubMenu.addItem(Surge::GUI::toOSCase("Sample Accurate Note Onsets"), true, accurateOnsets,
+                          [this, accurateOnsets]() {
+                              synth->sampleAccurateNoteOnsets = !accurateOnsets;
+                              Surge::Storage::updateUserDefaultValue(
+                                  &(this->synth->storage), Surge::Storage::SampleAccurateNoteOnsets,
+                                  !accurateOnsets);
+                          });
+
+    return engineSubMenu;
+}
+
 #if SURGE_HAS_OSC
 
 juce::PopupMenu SurgeGUIEditor::makeOSCMenu(const juce::Point<int> &where)
@@ -1898,6 +1948,9 @@ void SurgeGUIEditor::showSettingsMenu(const juce::Point<int> &where,
     auto tuningSubMenu = makeTuningMenu(where, false);
     settingsMenu.addSubMenu("Tuning", tuningSubMenu);
 
+    auto engineSubMenu = makeAudioEngineMenu(where);
+    settingsMenu.addSubMenu(Surge::GUI::toOSCase("Audio Engine"), engineSubMenu);
+
     settingsMenu.addSeparator();
 
 #if BUILD_IS_DEBUG
@@ -412,6 +412,7 @@ void SurgeGUIEditor::changeSelectedScene(int value)
 
     synth->release_if_latched[synth->storage.getPatch().scene_active.val.i] = true;
     synth->storage.getPatch().scene_active.val.i = current_scene;
+    synth->storage.getPatch().scene_active.markChanged();
 
     bool hasMSEG = isAnyOverlayPresent(MSEG_EDITOR);
     bool hasForm = isAnyOverlayPresent(FORMULA_EDITOR);
@@ -1636,6 +1637,7 @@ int32_t SurgeGUIEditor::controlModifierClicked(Surge::GUI::IComponentTagValue *c
                                                     else
                                                         p->val.i = p->val.i * 100;
                                                 }
+                                                p->markChanged();
 
                                                 synth->storage.getPatch().isDirty = true;
                                                 synth->refresh_editor = true;
@@ -3209,6 +3211,7 @@ int32_t SurgeGUIEditor::controlModifierClicked(Surge::GUI::IComponentTagValue *c
                     else
                         curr->val.b = false;
 
+                    curr->markChanged();
                     curr++;
                 }
 
@@ -3229,6 +3232,7 @@ int32_t SurgeGUIEditor::controlModifierClicked(Surge::GUI::IComponentTagValue *c
                     else
                         curr->val.b = false;
 
+                    curr->markChanged();
                     curr++;
                 }
 
@@ -3554,6 +3558,7 @@ void SurgeGUIEditor::valueChanged(Surge::GUI::IComponentTagValue *control)
         if (a < 0)
             a = nn - 1;
         synth->storage.getPatch().scene[current_scene].filterunit[idx].subtype.val.i = a;
+        synth->storage.getPatch().scene[current_scene].filterunit[idx].subtype.markChanged();
         synth->storage.subtypeMemory[current_scene][idx][t] = a;
         if (csc)
         {
@@ -3716,6 +3721,7 @@ void SurgeGUIEditor::valueChanged(Surge::GUI::IComponentTagValue *control)
         }
 
         synth->storage.getPatch().fx_disable.val.i = d;
+        synth->storage.getPatch().fx_disable.markChanged();
         fxc->setDeactivatedBitmask(d);
 
         int nfx = fxc->getCurrentEffect();
@@ -4030,6 +4036,7 @@ void SurgeGUIEditor::valueChanged(Surge::GUI::IComponentTagValue *control)
         if (a >= nn)
             a = 0;
         synth->storage.getPatch().scene[current_scene].filterunit[idx].subtype.val.i = a;
+        synth->storage.getPatch().scene[current_scene].filterunit[idx].subtype.markChanged();
         if (!nn)
             ((Surge::Widgets::Switch *)filtersubtype[idx])->setIntegerValue(0);
         else
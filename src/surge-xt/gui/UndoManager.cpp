@@ -913,7 +913,7 @@ struct UndoManagerImpl
             }
             if (p->current_id >= 0)
             {
-                os->wt.queue_id = p->current_id;
+                synth->storage.queue_wt_load(os, p->current_id);
             }
             else if (p->wt)
             {
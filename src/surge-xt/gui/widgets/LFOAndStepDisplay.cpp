@@ -1997,6 +1997,7 @@ void LFOAndStepDisplay::mouseDrag(const juce::MouseEvent &event)
                     auto prior = lfodata->shape.val.i;
 
                     lfodata->shape.val.i = i;
+                    lfodata->shape.markChanged();
 
                     sge->refresh_mod();
                     sge->broadcastPluginAutomationChangeFor(&(lfodata->shape));
@@ -2436,6 +2437,7 @@ void LFOAndStepDisplay::updateShapeTo(int i)
         auto prior = lfodata->shape.val.i;
 
         lfodata->shape.val.i = i;
+        lfodata->shape.markChanged();
 
         setupAccessibility();
 
@@ -67,7 +67,7 @@ OscillatorWaveformDisplay::OscillatorWaveformDisplay()
             announce += storage->wt_list[id].name;
             sge->enqueueAccessibleAnnouncement(announce);
 
-            oscdata->wt.queue_id = id;
+            storage->queue_wt_load(oscdata, id);
         }
     };
     ol->onReturnKey = [ov = ol.get()](OscillatorWaveformDisplay *d) {
@@ -93,7 +93,7 @@ OscillatorWaveformDisplay::OscillatorWaveformDisplay()
             announce += storage->wt_list[id].name;
             sge->enqueueAccessibleAnnouncement(announce);
 
-            oscdata->wt.queue_id = id;
+            storage->queue_wt_load(oscdata, id);
         }
     };
     ol->onReturnKey = [ov = ol.get()](OscillatorWaveformDisplay *d) {
@@ -1014,7 +1014,7 @@ void OscillatorWaveformDisplay::loadWavetable(int id)
             announce += storage->wt_list[id].name;
             sge->enqueueAccessibleAnnouncement(announce);
         }
-        oscdata->wt.queue_id = id;
+        storage->queue_wt_load(oscdata, id);
     }
 }
 
@@ -1044,7 +1044,7 @@ void OscillatorWaveformDisplay::loadWavetableFromFile()
             auto res = c.getResult();
             auto rString = res.getFullPathName().toStdString();
 
-            this->oscdata->wt.queue_filename = rString;
+            this->storage->queue_wt_load(this->oscdata, rString);
 
             auto dir = string_to_path(res.getParentDirectory().getFullPathName().toStdString());
 
@@ -1108,7 +1108,7 @@ void OscillatorWaveformDisplay::mouseDown(const juce::MouseEvent &event)
                         sge->enqueueAccessibleAnnouncement(announce);
                     }
 
-                    oscdata->wt.queue_id = id;
+                    storage->queue_wt_load(oscdata, id);
                 }
             }
             else
@@ -1134,7 +1134,7 @@ void OscillatorWaveformDisplay::mouseDown(const juce::MouseEvent &event)
                         sge->enqueueAccessibleAnnouncement(announce);
                     }
 
-                    oscdata->wt.queue_id = id;
+                    storage->queue_wt_load(oscdata, id);
                 }
             }
             else